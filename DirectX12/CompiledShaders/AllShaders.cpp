@@ -8,10 +8,18 @@
 #include "DS.h"
 #include "GS.h"
 #include "PS.h"
+#include "CullTilesCS.h"
+#include "TessellateCS.h"
+#include "RibbonVS.h"
+#include "TileHS.h"
 
 DEFINE_SHADER(VS)
 DEFINE_SHADER(HS)
 DEFINE_SHADER(DS)
 DEFINE_SHADER(GS)
 DEFINE_SHADER(PS)
+DEFINE_SHADER(CullTilesCS)
+DEFINE_SHADER(TessellateCS)
+DEFINE_SHADER(RibbonVS)
+DEFINE_SHADER(TileHS)
 
@@ -7,3 +7,7 @@ DECLARE_SHADER(HS)
 DECLARE_SHADER(DS)
 DECLARE_SHADER(GS)
 DECLARE_SHADER(PS)
+DECLARE_SHADER(CullTilesCS)
+DECLARE_SHADER(TessellateCS)
+DECLARE_SHADER(RibbonVS)
+DECLARE_SHADER(TileHS)
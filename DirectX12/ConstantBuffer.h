@@ -3,6 +3,8 @@
 
 const int RootSignature_ConstantBuffer_Index = 0;
 const int RootSignature_PrimitiveBuffer_Index = 1;
+const int RootSignature_DrawConstants_Index = 2;
+const int RootSignature_RibbonPoints_Index = 3;
 
 static const auto SizeX = 25.0f;
 static const auto SizeY = 100.0f;
@@ -5,6 +5,9 @@
 #include "Engine/CommandListManager.h"
 #include "Engine/CommandContext.h"
 #include "Engine/ColorBuffer.h"
+#include "Engine/FrameConstantRing.h"
+#include "Engine/ReadbackRing.h"
+#include "Engine/ImageExporter.h"
 
 #include "Math/Matrix4.h"
 
@@ -12,10 +15,14 @@
 #include "ConstantBuffer.h"
 
 #include "Renderer/BezierByGraficRenderer.h"
+#include "FrameBuilder.h"
 
 #include "IPreparePipelineState.h"
 #include "shellscalingapi.h"
 
+#include <array>
+#include <chrono>
+
 using Microsoft::WRL::ComPtr;
 using namespace DirectX;
 
@@ -33,10 +40,79 @@ private:
 
     BezierByGraficRenderer* m_bezierByGraficRenderer = nullptr;
 
+    FrameBuilder m_frameBuilder;
+    uint32_t m_backBuffer = 0;
+
+    // Buffers of the GPU-driven tiles, their states are planned with the other resources of the frame
+    uint32_t m_tiles = 0;
+    uint32_t m_tileDrawArguments = 0;
+    uint32_t m_tileDrawCount = 0;
+
+    // Buffers of the compute tessellation
+    TessellationPath m_tessellation = kTessellationHullShader;
+    uint32_t m_controlPoints = 0;
+    uint32_t m_ribbonPoints = 0;
+
+    // Frames read back for the QA archive and the workers writing them
+    ReadbackRing m_frameCapture;
+    ImageExporter* m_frameExporter = nullptr;
+
     // Constants for the scene
     std::shared_ptr<ConstantBuffer> m_ConstantBuffer;
 
     HWND m_hWnd = 0;
+
+    // Print the memory statistics as JSON every MemoryReportInterval frames
+    static const bool ReportMemoryStatistics = false;
+
+    // Print the submissions, command lists and barriers of a frame and the state changes the
+    // contexts issued and filtered every MemoryReportInterval frames
+    static const bool ReportFrameStatistics = false;
+
+    // Frames between two reports of the statistics and of the capture throughput
+    static const uint64_t MemoryReportInterval = 600;
+
+    // Compile the pipeline states in the background, the first frames stay empty until they are done
+    static const bool AsyncPipelineStates = true;
+
+    // Upload the fabric on the copy queue instead of waiting for every buffer on the CPU
+    static const bool CopyQueueUploads = true;
+
+    // Draw the fabric in tiles of rows instead of with one draw.  The tiles take their first
+    // patch and tessellation factor from root constants and need their own hull shader,
+    // TileHS.hlsl; the single draw with HS.hlsl is the one that shows the bug of the
+    // UHD 620/630, it stays the default.
+    static const bool TiledDraws = false;
+
+    // With TiledDraws: cull the tiles in a compute shader and draw the visible ones with one
+    // ExecuteIndirect, instead of recording a draw per tile on the worker threads
+    static const bool GpuDrivenTiles = true;
+
+    // Adapters that tessellate in a compute shader instead of the hull, domain and geometry
+    // shader, e.g. { 0x8086, 0x3E92 } for a UHD 630.  The hull shader path is the one that shows
+    // the bug of the UHD 620/630, it stays the default for every adapter not listed here.
+    // --tessellation=hull or --tessellation=compute on the command line overrides the list.
+    static constexpr std::array<TessellationAdapter, 0> ComputeTessellationAdapters = {};
+
+    // Read every frame back, the throughput is reported every MemoryReportInterval frames
+    static const bool CaptureFrames = false;
+
+    // Write the captured frames to CaptureFolder, frames are dropped while the exporter is full
+    static const bool ExportCapturedFrames = true;
+    static constexpr const wchar_t* CaptureFolder = L"Capture";
+    static const ImageFileFormat CaptureFileFormat = kImageFileQoi;
+
+    std::chrono::steady_clock::time_point m_InitStart;
+    bool m_FirstFrameReported = false;
+    bool m_FirstDrawReported = false;
+
+    std::chrono::steady_clock::time_point m_captureReportStart;
+
+    // Recording of the frames since the last report of the frame statistics
+    double m_recordingSeconds = 0.0;
+    uint64_t m_numDrawsRecorded = 0;
+    uint64_t m_numFramesRecorded = 0;
+    uint64_t m_numCapturedFrames = 0;
 public:
 
     Impl(void* hWnd) :
@@ -44,13 +120,21 @@ public:
         m_scissorRect(0, 0, static_cast<LONG>(0), static_cast<LONG>(0)),
         m_ConstantBuffer(std::make_shared<ConstantBuffer>()),
         m_Core(*GraphicsCore::Reserve(static_cast<HWND>(hWnd))),
-        m_rootSignature(m_Core)
+        m_rootSignature(m_Core),
+        m_frameBuilder(m_Core, this),
+        m_frameCapture(m_Core)
     {}
 
     void Destroy()
     {
         this->m_Core.m_pCommandManager->IdleGPU();
 
+        this->m_frameCapture.Flush(nullptr);
+        this->m_frameCapture.Destroy();
+
+        delete this->m_frameExporter;
+        this->m_frameExporter = nullptr;
+
         delete this->m_bezierByGraficRenderer;
 
         this->m_Core.Release();
@@ -78,7 +162,13 @@ public:
 
     void CreateRendererData()
     {
-        this->m_bezierByGraficRenderer->CreateData();
+        const auto start = std::chrono::steady_clock::now();
+
+        this->m_bezierByGraficRenderer->CreateData(CopyQueueUploads);
+
+        // With the copy queue the uploads may still run, the time to the first drawn frame includes them
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        Utility::Printf(L"Creating the renderer data: %.1f ms (%s uploads)\n", milliseconds, CopyQueueUploads ? L"copy queue" : L"blocking");
     }
 
     void Present()
@@ -100,12 +190,12 @@ public:
         renderContext.graphicsContext->SetRenderTargets(numRtvs, rtvs);
     }
 
-    void CreateGraphicContext(std::wstring id, RenderContext& renderContext)
+    void CreateGraphicContext(const wchar_t* id, RenderContext& renderContext)
     {
         renderContext.graphicsContext = &GraphicsContext::Begin(id, this->m_Core);
     }
 
-    void CreateAndInitGraphicContext(std::wstring id, RenderContext& renderContext)
+    void CreateAndInitGraphicContext(const wchar_t* id, RenderContext& renderContext)
     {
         this->CreateGraphicContext(id, renderContext);
         this->InitGraphicContext(renderContext);
@@ -127,6 +217,15 @@ public:
     {
         this->m_Core.HandleDeviceRemoved();
 
+        // Only block if the frame that last used this slot is still on the GPU.
+        this->m_Core.m_pCommandManager->WaitForFence(this->m_Core.m_FrameFences.BeginFrame());
+        this->m_Core.m_pFrameConstants->BeginFrame(this->m_Core.m_FrameFences.GetFrameIndex());
+
+        // Deferred frees of resources the GPU is done with
+        this->m_Core.m_pCommandManager->RunCompletedCallbacks();
+
+        this->DeliverCapturedFrames();
+
         auto renderContext = RenderContext();
         {
             {
@@ -142,53 +241,324 @@ public:
                 renderContext.scissorRect = &this->m_scissorRect;
 
                 renderContext.colorBuffer = &this->m_Core.m_pDisplayPlanes[this->m_Core.m_CurrentBufferIndex];
+
+                // Written once per frame, every draw binds the same address
+                renderContext.sceneConstants = this->m_Core.m_pFrameConstants->Upload(&*this->m_ConstantBuffer, sizeof(*this->m_ConstantBuffer));
             }
         }
 
-        // Setup
+        // All passes are recorded into one context and submitted once.
+        this->m_frameBuilder.BindResource(this->m_backBuffer, *renderContext.colorBuffer);
+        if (TiledDraws && GpuDrivenTiles)
+        {
+            this->m_frameBuilder.BindResource(this->m_tiles, this->m_bezierByGraficRenderer->GetTileBuffer());
+            this->m_frameBuilder.BindResource(this->m_tileDrawArguments, this->m_bezierByGraficRenderer->GetTileDrawArguments());
+            this->m_frameBuilder.BindResource(this->m_tileDrawCount, this->m_bezierByGraficRenderer->GetTileDrawCount());
+        }
+        if (this->m_tessellation == kTessellationComputeShader)
         {
-            this->CreateGraphicContext(L"Render-Setup", renderContext);
-            renderContext.graphicsContext->SetRootSignature(this->m_rootSignature);
+            this->m_frameBuilder.BindResource(this->m_controlPoints, this->m_bezierByGraficRenderer->GetControlPoints());
+            this->m_frameBuilder.BindResource(this->m_ribbonPoints, this->m_bezierByGraficRenderer->GetRibbonPoints());
+        }
+        this->m_frameBuilder.Execute(renderContext);
 
-            renderContext.graphicsContext->SetViewportAndScissor(*renderContext.viewPort, *renderContext.scissorRect);
+        // The whole frame goes to the GPU with one ExecuteCommandLists
+        ASSERT(this->m_frameBuilder.GetNumSubmissionsLastFrame() == 1, "Frame submitted %llu times",
+            static_cast<unsigned long long>(this->m_frameBuilder.GetNumSubmissionsLastFrame()));
 
-            renderContext.graphicsContext->TransitionResource(*renderContext.colorBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET);
-            renderContext.graphicsContext->FlushResourceBarriers();
+        this->m_recordingSeconds += this->m_frameBuilder.GetRecordingSecondsLastFrame();
+        this->m_numDrawsRecorded += this->m_frameBuilder.GetNumDrawsLastFrame();
+        ++this->m_numFramesRecorded;
 
-            D3D12_CPU_DESCRIPTOR_HANDLE rtvs[1];
-            int numRtvs = 1;
-            rtvs[0] = renderContext.colorBuffer->GetRTV();
+        this->m_Core.m_FrameFences.EndFrame(renderContext.lastFenceValue);
+        this->m_frameCapture.Submitted(renderContext.lastFenceValue);
 
-            renderContext.graphicsContext->SetRenderTargets(numRtvs, rtvs);
+        this->ReportTimeToFirstFrame(renderContext);
+
+        const uint64_t frameNumber = this->m_Core.m_FrameFences.GetFrameNumber();
+        if (frameNumber % MemoryReportInterval == 0)
+        {
+            if (ReportMemoryStatistics)
+            {
+                const std::string json = this->m_Core.m_MemoryStatistics.GetSnapshot(frameNumber).ToJson() + "\n";
+                Utility::Print(json.c_str());
+            }
+
+            this->ReportFrameBuilder();
+            this->ReportCaptureThroughput();
+        }
+    }
+
+    void ReportFrameBuilder()
+    {
+        if (!ReportFrameStatistics)
+        {
+            return;
+        }
+
+        Utility::Printf(L"Frame: %llu submissions, %zu command lists, %zu barriers in %zu calls\n",
+            static_cast<unsigned long long>(this->m_frameBuilder.GetNumSubmissionsLastFrame()),
+            this->m_frameBuilder.GetNumCommandListsLastFrame(),
+            this->m_frameBuilder.GetNumBarriersLastFrame(),
+            this->m_frameBuilder.GetNumBarrierBatchesLastFrame());
+
+        // The CPU cost of a draw: the recording time of the frames since the last report over their draws
+        if (this->m_numDrawsRecorded > 0)
+        {
+            Utility::Printf(L"Recording: %.3f ms per frame, %llu draws per frame, %.2f us per draw (%s)
+",
+                this->m_recordingSeconds * 1e3 / this->m_numFramesRecorded,
+                static_cast<unsigned long long>(this->m_numDrawsRecorded / this->m_numFramesRecorded),
+                this->m_recordingSeconds * 1e6 / this->m_numDrawsRecorded,
+                !TiledDraws ? L"single draw" : GpuDrivenTiles ? L"GPU-driven tiles" : L"tiles on the workers");
+        }
+        this->m_recordingSeconds = 0.0;
+        this->m_numDrawsRecorded = 0;
+        this->m_numFramesRecorded = 0;
+
+        // State changes of all contexts since the last report, issued to the command list / dropped
+        static const wchar_t* const categoryNames[StateFilterStats::kNumCategories] =
+        {
+            L"root signature", L"pipeline state", L"topology", L"vertex buffers", L"viewport", L"scissor", L"descriptor table"
+        };
+
+        const StateFilterStats filterStats = this->m_Core.m_pContextManager->ConsumeStateFilterStats();
+        for (int category = 0; category < StateFilterStats::kNumCategories; ++category)
+        {
+            Utility::Printf(L"  %-16s %10llu issued %10llu filtered\n", categoryNames[category],
+                static_cast<unsigned long long>(filterStats.Issued[category]),
+                static_cast<unsigned long long>(filterStats.Filtered[category]));
+        }
+    }
+
+    void DeliverCapturedFrames()
+    {
+        if (!CaptureFrames)
+        {
+            return;
+        }
+
+        // Only frames the GPU is done with, the render loop never waits here
+        this->m_frameCapture.Poll([this](const CapturedFrame& frame)
+        {
+            ++this->m_numCapturedFrames;
+
+            if (this->m_frameExporter != nullptr)
+            {
+                wchar_t path[MAX_PATH];
+                swprintf_s(path, L"%s\\frame_%06llu%s", CaptureFolder, static_cast<unsigned long long>(frame.FrameNumber), ImageEncoder::GetExtension(CaptureFileFormat));
+                this->m_frameExporter->TryExport(frame, path, CaptureFileFormat);
+            }
+        });
+    }
+
+    void ReportCaptureThroughput()
+    {
+        if (!CaptureFrames)
+        {
+            return;
+        }
 
+        const auto now = std::chrono::steady_clock::now();
+        const double seconds = std::chrono::duration<double>(now - this->m_captureReportStart).count();
+        const ReadbackRing::Statistics& statistics = this->m_frameCapture.GetStatistics();
+
+        Utility::Printf(L"Captured frames: %.1f per second at %ldx%ld, %llu dropped so far\n",
+            this->m_numCapturedFrames / seconds, this->m_scissorRect.right, this->m_scissorRect.bottom,
+            static_cast<unsigned long long>(statistics.NumDropped));
+
+        if (this->m_frameExporter != nullptr)
+        {
+            const ImageExporter::Statistics exported = this->m_frameExporter->GetStatistics();
+            Utility::Printf(L"Exported frames: %llu written, %llu refused by the full queue, %llu failed (%u workers)\n",
+                static_cast<unsigned long long>(exported.NumWritten), static_cast<unsigned long long>(exported.NumRefused),
+                static_cast<unsigned long long>(exported.NumFailed), this->m_frameExporter->GetNumWorkers());
+        }
+
+        this->m_captureReportStart = now;
+        this->m_numCapturedFrames = 0;
+    }
+
+    void ReportTimeToFirstFrame(const RenderContext& renderContext)
+    {
+        if (this->m_FirstDrawReported)
+        {
+            return;
+        }
+
+        const double milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - this->m_InitStart).count();
+        const wchar_t* mode = AsyncPipelineStates ? L"async" : L"sync";
+
+        if (!this->m_FirstFrameReported)
+        {
+            this->m_FirstFrameReported = true;
+            Utility::Printf(L"Time to first frame: %.1f ms (%s pipeline states)\n", milliseconds, mode);
+        }
+
+        if (renderContext.numDrawsCalled > 0)
+        {
+            this->m_FirstDrawReported = true;
+            Utility::Printf(L"Time to first drawn frame: %.1f ms (%s pipeline states)\n", milliseconds, mode);
+        }
+    }
+
+    void CreateFramePasses()
+    {
+        this->m_frameBuilder.ClearPasses();
+
+        // The back buffer is presented after the frame
+        this->m_backBuffer = this->m_frameBuilder.AddResource(D3D12_RESOURCE_STATE_PRESENT);
+
+        this->m_frameBuilder.AddPass(L"Clear", [](RenderContext& renderContext)
+        {
             // Clear the color Buffer
             renderContext.graphicsContext->ClearColor(*renderContext.colorBuffer);
+        },
+        { { this->m_backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET } });
+
+        // Uses of the draw pass, the ribbon points and the tile draws join the back buffer
+        std::vector<FrameBuilder::ResourceUse> drawUses = { { this->m_backBuffer, D3D12_RESOURCE_STATE_RENDER_TARGET } };
 
-            renderContext.numDrawsCalled = 0;
+        if (this->m_tessellation == kTessellationComputeShader)
+        {
+            this->m_controlPoints = this->m_frameBuilder.AddResource();
+            this->m_ribbonPoints = this->m_frameBuilder.AddResource();
+
+            // Dispatches only when the number of segments changed
+            this->m_frameBuilder.AddPass(L"Tessellate", [this](RenderContext& renderContext)
+            {
+                this->m_bezierByGraficRenderer->Tessellate(renderContext);
+            },
+            {
+                { this->m_controlPoints, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE },
+                { this->m_ribbonPoints, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }
+            });
+
+            drawUses.push_back({ this->m_ribbonPoints, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE });
+        }
+
+        if (!TiledDraws)
+        {
+            this->m_frameBuilder.AddPass(L"BezierByGrafic", [this](RenderContext& renderContext)
+            {
+                if (this->m_bezierByGraficRenderer->IsReady())
+                {
+                    this->m_bezierByGraficRenderer->Render(renderContext);
+                }
+            },
+            drawUses);
         }
+        else if (GpuDrivenTiles)
+        {
+            this->m_tiles = this->m_frameBuilder.AddResource();
+            this->m_tileDrawArguments = this->m_frameBuilder.AddResource();
+            this->m_tileDrawCount = this->m_frameBuilder.AddResource();
+
+            this->m_frameBuilder.AddPass(L"CullTiles", [this](RenderContext& renderContext)
+            {
+                this->m_bezierByGraficRenderer->CullTiles(renderContext);
+            },
+            {
+                { this->m_tiles, D3D12_RESOURCE_STATE_NON_PIXEL_SHADER_RESOURCE },
+                { this->m_tileDrawArguments, D3D12_RESOURCE_STATE_UNORDERED_ACCESS },
+                { this->m_tileDrawCount, D3D12_RESOURCE_STATE_UNORDERED_ACCESS }
+            });
 
-        this->m_bezierByGraficRenderer->Render(renderContext);
+            drawUses.push_back({ this->m_tileDrawArguments, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT });
+            drawUses.push_back({ this->m_tileDrawCount, D3D12_RESOURCE_STATE_INDIRECT_ARGUMENT });
 
-        // Indicate that the back buffer will now be used to present.
-        renderContext.graphicsContext->TransitionResource(*renderContext.colorBuffer, D3D12_RESOURCE_STATE_PRESENT);
+            // One call for all tiles, however many are visible
+            this->m_frameBuilder.AddPass(L"BezierByGrafic", [this](RenderContext& renderContext)
+            {
+                this->m_bezierByGraficRenderer->RenderTilesIndirect(renderContext);
+            },
+            drawUses);
+        }
+        else
+        {
+            // The tiles are recorded on the worker threads
+            this->m_frameBuilder.AddParallelPass(L"BezierByGrafic",
+                [this]()
+                {
+                    return this->m_bezierByGraficRenderer->IsReady() ? this->m_bezierByGraficRenderer->GetNumTiles() : 0;
+                },
+                [this](RenderContext& renderContext, uint32_t tileIndex)
+                {
+                    this->m_bezierByGraficRenderer->RenderTile(renderContext, tileIndex);
+                },
+                drawUses);
+        }
 
-        this->FinishGraphicContext(renderContext, true);
+        if (CaptureFrames)
+        {
+            // Copied in the frame's own command list, read once the frame retired
+            this->m_frameBuilder.AddPass(L"Capture", [this](RenderContext& renderContext)
+            {
+                this->m_frameCapture.Capture(*renderContext.graphicsContext, *renderContext.colorBuffer, this->m_Core.m_FrameFences.GetFrameNumber());
+            },
+            { { this->m_backBuffer, D3D12_RESOURCE_STATE_COPY_SOURCE } });
+        }
     }
 
     void Init()
     {
+        this->m_InitStart = std::chrono::steady_clock::now();
+
         this->CreateRootSignature();
         this->m_bezierByGraficRenderer = new BezierByGraficRenderer(this->m_Core, this);
 
+        this->m_tessellation = this->SelectTessellationPath();
+
         this->m_bezierByGraficRenderer->Init(
             this,
-            this->m_ConstantBuffer);
+            this->m_ConstantBuffer,
+            AsyncPipelineStates,
+            this->m_tessellation,
+            TiledDraws);
+
+        this->CreateRendererData();
 
-        this->m_bezierByGraficRenderer->CreateData();
+        if (CaptureFrames)
+        {
+            this->m_frameCapture.Create();
+            this->m_captureReportStart = std::chrono::steady_clock::now();
+
+            if (ExportCapturedFrames)
+            {
+                this->m_frameExporter = new ImageExporter();
+            }
+        }
+
+        this->CreateFramePasses();
 
         this->m_trafos.SetWorldSize(std::make_tuple(0.0f, SizeX, 0.0f, SizeY));
     }
 
+    TessellationPath SelectTessellationPath() const
+    {
+        // Whether the hull shader path shows the bug depends on the adapter
+        ComPtr<IDXGIAdapter1> adapter = this->m_Core.GetRecommendedAdapter();
+        DXGI_ADAPTER_DESC1 desc = {};
+        if (adapter == nullptr || FAILED(adapter->GetDesc1(&desc)))
+        {
+            wcscpy_s(desc.Description, L"unknown adapter");
+        }
+
+        // The CRT keeps the arguments of main()
+        TessellationPath tessellation = kTessellationHullShader;
+        const wchar_t* reason = L"command line";
+        if (!TessellationSelection::ParseCommandLine(__argc, __argv, tessellation))
+        {
+            tessellation = TessellationSelection::SelectForAdapter(
+                desc.VendorId, desc.DeviceId, ComputeTessellationAdapters.data(), ComputeTessellationAdapters.size());
+            reason = tessellation == kTessellationComputeShader ? L"adapter list" : L"default";
+        }
+
+        Utility::Printf(L"Tessellation: %s on %s (%04X:%04X), %s\n", tessellation == kTessellationComputeShader ? L"compute shader" : L"hull shader",
+            desc.Description, desc.VendorId, desc.DeviceId, reason);
+        return tessellation;
+    }
+
     void CreateRootSignature()
     {
         // Create a root signature consisting of a descriptor table with a single CBV.
@@ -197,9 +567,13 @@ public:
             D3D12_ROOT_SIGNATURE_FLAG_ALLOW_INPUT_ASSEMBLER_INPUT_LAYOUT;
 
         //m_rootSignature.Reset(3, 1);
-        this->m_rootSignature.Reset(2, 0);
+        this->m_rootSignature.Reset(4, 0);
         this->m_rootSignature[RootSignature_ConstantBuffer_Index].InitAsConstantBuffer(0, D3D12_SHADER_VISIBILITY_ALL);
 
+        // Read by the hull shader, or by RibbonVS with the compute tessellation
+        this->m_rootSignature[RootSignature_DrawConstants_Index].InitAsConstants(1, 2, D3D12_SHADER_VISIBILITY_ALL);
+        this->m_rootSignature[RootSignature_RibbonPoints_Index].InitAsBufferSRV(1, D3D12_SHADER_VISIBILITY_VERTEX);
+
         this->m_rootSignature[RootSignature_PrimitiveBuffer_Index].InitAsDescriptorTable(1, D3D12_SHADER_VISIBILITY_HULL);
         this->m_rootSignature[RootSignature_PrimitiveBuffer_Index].SetTableRange(
             0, D3D12_DESCRIPTOR_RANGE_TYPE_SRV, 0, 1, 0);
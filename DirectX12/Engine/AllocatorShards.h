@@ -0,0 +1,212 @@
+//
+// The bookkeeping of CommandAllocatorPool.  Discarded allocators go to the shard
+// of the discarding thread, ordered by their fence value, so a request finds
+// every reusable allocator at the front of a shard.  A thread looks at its own
+// shard first and then takes from the others.  The count of allocators is
+// reserved before one is created and the pending allocators are counted as
+// they come and go, so threads requesting at once never take the pool past its
+// high-water mark while a discarded allocator is pending.
+//
+// The shards know nothing about D3D: the caller creates and resets the
+// allocators and tells which fence value completed.
+//
+
+#pragma once
+
+#include <atomic>
+#include "VectorQueue.h"
+
+#include <mutex>
+#include <stdint.h>
+#include <utility>
+
+struct CommandAllocatorStatistics
+{
+    uint32_t NumAllocators = 0;
+    uint32_t PeakAllocators = 0;
+    uint32_t NumPending = 0;        // discarded, waiting for their fence or a request
+    uint64_t NumRequests = 0;
+    uint64_t NumReused = 0;         // from the shard of the requesting thread
+    uint64_t NumStolen = 0;         // from the shard of another thread
+    uint64_t NumCreated = 0;
+    uint64_t NumCapStalls = 0;      // requests sent back to wait at the high-water mark
+};
+
+template <typename T>
+class AllocatorShards
+{
+public:
+    static const uint32_t kNumShards = 8;
+
+    explicit AllocatorShards(uint32_t MaxAllocators) :
+        m_MaxAllocators(MaxAllocators),
+        m_NumAllocators(0),
+        m_PeakAllocators(0),
+        m_NumPending(0),
+        m_NumRequests(0),
+        m_NumReused(0),
+        m_NumStolen(0),
+        m_NumCreated(0),
+        m_NumCapStalls(0)
+    {
+    }
+
+    AllocatorShards(const AllocatorShards&) = delete;
+    AllocatorShards& operator=(const AllocatorShards&) = delete;
+
+    void SetMaxAllocators(uint32_t MaxAllocators) { m_MaxAllocators = MaxAllocators; }
+
+    // A discarded allocator whose fence completed, the one with the lowest fence value of the
+    // shard it comes from.  nullptr if there is none; the caller then asks Reserve().
+    T* Request(uint64_t CompletedFenceValue)
+    {
+        m_NumRequests.fetch_add(1, std::memory_order_relaxed);
+
+        const uint32_t ShardIndex = GetThreadShardIndex();
+
+        T* pAllocator = PopCompleted(m_Shards[ShardIndex], CompletedFenceValue);
+        if (pAllocator != nullptr)
+        {
+            m_NumReused.fetch_add(1, std::memory_order_relaxed);
+            return pAllocator;
+        }
+
+        for (uint32_t i = 1; i < kNumShards && pAllocator == nullptr; ++i)
+            pAllocator = PopCompleted(m_Shards[(ShardIndex + i) % kNumShards], CompletedFenceValue);
+
+        if (pAllocator != nullptr)
+            m_NumStolen.fetch_add(1, std::memory_order_relaxed);
+
+        return pAllocator;
+    }
+
+    // Counts an allocator the caller is about to create.  False at the high-water mark while an
+    // allocator is pending, the caller waits for GetOldestPendingFence() instead.  If nothing is
+    // pending all allocators are recording, waiting would never end and the pool has to grow.
+    bool Reserve()
+    {
+        uint32_t NumAllocators = m_NumAllocators.load(std::memory_order_relaxed);
+        do
+        {
+            if (NumAllocators >= m_MaxAllocators && m_NumPending.load(std::memory_order_relaxed) != 0)
+            {
+                m_NumCapStalls.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+        while (!m_NumAllocators.compare_exchange_weak(NumAllocators, NumAllocators + 1, std::memory_order_relaxed));
+
+        uint32_t PeakAllocators = m_PeakAllocators.load(std::memory_order_relaxed);
+        while (NumAllocators + 1 > PeakAllocators &&
+            !m_PeakAllocators.compare_exchange_weak(PeakAllocators, NumAllocators + 1, std::memory_order_relaxed))
+        {
+        }
+
+        m_NumCreated.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void Discard(uint64_t FenceValue, T* pAllocator)
+    {
+        Shard& shard = m_Shards[GetThreadShardIndex()];
+
+        std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+
+        // Fence values mostly arrive in order, the insertion point is found from the back
+        auto Position = shard.ReadyAllocators.end();
+        while (Position != shard.ReadyAllocators.begin() && (Position - 1)->first > FenceValue)
+            --Position;
+
+        // That fence value indicates we are free to reset the allocator
+        shard.ReadyAllocators.insert(Position, std::make_pair(FenceValue, pAllocator));
+        m_NumPending.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Lowest fence value of all pending allocators, 0 when none is pending
+    uint64_t GetOldestPendingFence()
+    {
+        uint64_t OldestFence = 0;
+
+        for (Shard& shard : m_Shards)
+        {
+            std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+
+            if (!shard.ReadyAllocators.empty() && (OldestFence == 0 || shard.ReadyAllocators.front().first < OldestFence))
+                OldestFence = shard.ReadyAllocators.front().first;
+        }
+
+        return OldestFence;
+    }
+
+    // Forgets the pending allocators, the caller releases every allocator it created
+    void Clear()
+    {
+        for (Shard& shard : m_Shards)
+        {
+            std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+            shard.ReadyAllocators.clear();
+        }
+
+        m_NumAllocators.store(0, std::memory_order_relaxed);
+        m_NumPending.store(0, std::memory_order_relaxed);
+    }
+
+    CommandAllocatorStatistics GetStatistics()
+    {
+        CommandAllocatorStatistics Stats;
+        Stats.NumAllocators = m_NumAllocators.load(std::memory_order_relaxed);
+        Stats.PeakAllocators = m_PeakAllocators.load(std::memory_order_relaxed);
+        Stats.NumPending = m_NumPending.load(std::memory_order_relaxed);
+        Stats.NumRequests = m_NumRequests.load(std::memory_order_relaxed);
+        Stats.NumReused = m_NumReused.load(std::memory_order_relaxed);
+        Stats.NumStolen = m_NumStolen.load(std::memory_order_relaxed);
+        Stats.NumCreated = m_NumCreated.load(std::memory_order_relaxed);
+        Stats.NumCapStalls = m_NumCapStalls.load(std::memory_order_relaxed);
+        return Stats;
+    }
+
+    size_t GetNumAllocators() const { return m_NumAllocators.load(std::memory_order_relaxed); }
+
+    // Threads are spread round robin over the shards the first time they come by
+    static uint32_t GetThreadShardIndex()
+    {
+        static std::atomic<uint32_t> s_NextShardIndex(0);
+        static thread_local const uint32_t t_ShardIndex = s_NextShardIndex.fetch_add(1, std::memory_order_relaxed) % kNumShards;
+        return t_ShardIndex;
+    }
+
+private:
+    struct alignas(64) Shard
+    {
+        std::mutex Mutex;
+        VectorQueue<std::pair<uint64_t, T*>> ReadyAllocators;   // ascending fence values
+    };
+
+    // Pops the front allocator of the shard if its fence completed
+    T* PopCompleted(Shard& shard, uint64_t CompletedFenceValue)
+    {
+        std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+
+        if (shard.ReadyAllocators.empty() || shard.ReadyAllocators.front().first > CompletedFenceValue)
+            return nullptr;
+
+        T* pAllocator = shard.ReadyAllocators.front().second;
+        shard.ReadyAllocators.pop_front();
+        m_NumPending.fetch_sub(1, std::memory_order_relaxed);
+        return pAllocator;
+    }
+
+    uint32_t m_MaxAllocators;
+
+    Shard m_Shards[kNumShards];
+
+    std::atomic<uint32_t> m_NumAllocators;
+    std::atomic<uint32_t> m_PeakAllocators;
+    std::atomic<uint32_t> m_NumPending;     // in the shards, changed under the lock of the shard
+
+    std::atomic<uint64_t> m_NumRequests;
+    std::atomic<uint64_t> m_NumReused;
+    std::atomic<uint64_t> m_NumStolen;
+    std::atomic<uint64_t> m_NumCreated;
+    std::atomic<uint64_t> m_NumCapStalls;
+};
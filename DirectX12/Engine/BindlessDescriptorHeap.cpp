@@ -0,0 +1,127 @@
+#include "pchDirectX.h"
+#include "BindlessDescriptorHeap.h"
+#include "GraphicsCore.h"
+#include "CommandListManager.h"
+
+BindlessDescriptorHeap::BindlessDescriptorHeap(GraphicsCore& core) :
+    m_Core(core),
+    m_CpuBase{ 0 },
+    m_GpuBase{ 0 },
+    m_DescriptorSize(0),
+    m_NextUnused(0)
+{
+}
+
+BindlessDescriptorHeap::~BindlessDescriptorHeap()
+{
+    Destroy();
+}
+
+void BindlessDescriptorHeap::Create()
+{
+    ASSERT(m_pHeap == nullptr);
+
+    D3D12_DESCRIPTOR_HEAP_DESC HeapDesc = {};
+    HeapDesc.Type = D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV;
+    HeapDesc.NumDescriptors = kNumDescriptors;
+    HeapDesc.Flags = D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE;
+    HeapDesc.NodeMask = 1;
+
+    ASSERT_SUCCEEDED(m_Core.m_pDevice->CreateDescriptorHeap(&HeapDesc, MY_IID_PPV_ARGS(m_pHeap.GetAddressOf())));
+    m_pHeap->SetName(L"BindlessDescriptorHeap");
+
+    m_CpuBase = m_pHeap->GetCPUDescriptorHandleForHeapStart();
+    m_GpuBase = m_pHeap->GetGPUDescriptorHandleForHeapStart();
+    m_DescriptorSize = m_Core.m_pDevice->GetDescriptorHandleIncrementSize(HeapDesc.Type);
+
+    m_Core.m_MemoryStatistics.OnAllocate(kMemoryBindlessDescriptorHeap, uint64_t(kNumDescriptors) * m_DescriptorSize);
+}
+
+void BindlessDescriptorHeap::Destroy()
+{
+    if (m_pHeap == nullptr)
+        return;
+
+    m_Core.m_MemoryStatistics.OnFree(kMemoryBindlessDescriptorHeap, uint64_t(kNumDescriptors) * m_DescriptorSize);
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    m_pHeap = nullptr;
+    m_NextUnused = 0;
+    m_FreeSlots.clear();
+    m_RetiredSlots = std::queue<std::pair<uint64_t, uint32_t>>();
+}
+
+void BindlessDescriptorHeap::ReleaseCompletedSlots()
+{
+    CommandListManager& CommandManager = *m_Core.m_pCommandManager;
+
+    while (!m_RetiredSlots.empty() && CommandManager.IsFenceComplete(m_RetiredSlots.front().first))
+    {
+        m_FreeSlots.push_back(m_RetiredSlots.front().second);
+        m_RetiredSlots.pop();
+    }
+}
+
+uint32_t BindlessDescriptorHeap::Register(D3D12_CPU_DESCRIPTOR_HANDLE View)
+{
+    ASSERT(m_pHeap != nullptr, "BindlessDescriptorHeap is not created");
+
+    uint32_t Index;
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+        ReleaseCompletedSlots();
+
+        if (!m_FreeSlots.empty())
+        {
+            Index = m_FreeSlots.back();
+            m_FreeSlots.pop_back();
+        }
+        else
+        {
+            ASSERT(m_NextUnused < kNumDescriptors, "Out of bindless descriptors");
+            Index = m_NextUnused++;
+        }
+    }
+
+    // The slot belongs to the caller now, no need to hold the lock for the copy
+    m_Core.m_pDevice->CopyDescriptorsSimple(1, GetCpuHandle(Index), View, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    return Index;
+}
+
+void BindlessDescriptorHeap::Free(uint32_t Index, uint64_t FenceValue)
+{
+    if (Index == kInvalidIndex)
+        return;
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    ASSERT(Index < m_NextUnused);
+    m_RetiredSlots.push(std::make_pair(FenceValue, Index));
+}
+
+D3D12_CPU_DESCRIPTOR_HANDLE BindlessDescriptorHeap::GetCpuHandle(uint32_t Index) const
+{
+    ASSERT(Index < kNumDescriptors);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE Handle = m_CpuBase;
+    Handle.ptr += size_t(Index) * m_DescriptorSize;
+    return Handle;
+}
+
+D3D12_GPU_DESCRIPTOR_HANDLE BindlessDescriptorHeap::GetGpuHandle(uint32_t Index) const
+{
+    ASSERT(Index < kNumDescriptors);
+
+    D3D12_GPU_DESCRIPTOR_HANDLE Handle = m_GpuBase;
+    Handle.ptr += uint64_t(Index) * m_DescriptorSize;
+    return Handle;
+}
+
+uint32_t BindlessDescriptorHeap::GetNumRegistered() const
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    return m_NextUnused - static_cast<uint32_t>(m_FreeSlots.size() + m_RetiredSlots.size());
+}
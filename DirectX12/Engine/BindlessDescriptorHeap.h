@@ -0,0 +1,62 @@
+//
+// One large shader-visible CBV/SRV/UAV heap that lives as long as the device.
+// Every resource view registered with it gets a stable slot index, written once
+// when the resource is created.  Draws bind the heap and point a descriptor table
+// at the slot; nothing is copied per draw as with DynamicDescriptorHeap.
+//
+// Freed slots are handed out again after the GPU passed the fence given to Free.
+//
+
+#pragma once
+
+#include <mutex>
+#include <queue>
+#include <utility>
+#include <vector>
+
+class GraphicsCore;
+
+class BindlessDescriptorHeap
+{
+public:
+    static const uint32_t kNumDescriptors = 65536;
+    static const uint32_t kInvalidIndex = UINT32_MAX;
+
+    BindlessDescriptorHeap(GraphicsCore& core);
+    ~BindlessDescriptorHeap();
+
+    BindlessDescriptorHeap(const BindlessDescriptorHeap&) = delete;
+    BindlessDescriptorHeap& operator=(const BindlessDescriptorHeap&) = delete;
+
+    void Create();
+    void Destroy();
+
+    // Copies the CPU-only view into a free slot and returns its index
+    uint32_t Register(D3D12_CPU_DESCRIPTOR_HANDLE View);
+
+    // The slot is reused after the GPU completed FenceValue (encoded as by CommandListManager)
+    void Free(uint32_t Index, uint64_t FenceValue);
+
+    D3D12_CPU_DESCRIPTOR_HANDLE GetCpuHandle(uint32_t Index) const;
+    D3D12_GPU_DESCRIPTOR_HANDLE GetGpuHandle(uint32_t Index) const;
+
+    ID3D12DescriptorHeap* GetHeapPointer() const { return m_pHeap.Get(); }
+
+    uint32_t GetNumRegistered() const;
+
+private:
+    // Requires m_Mutex to be held
+    void ReleaseCompletedSlots();
+
+    GraphicsCore& m_Core;
+
+    Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> m_pHeap;
+    D3D12_CPU_DESCRIPTOR_HANDLE m_CpuBase;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_GpuBase;
+    uint32_t m_DescriptorSize;
+
+    mutable std::mutex m_Mutex;
+    uint32_t m_NextUnused;
+    std::vector<uint32_t> m_FreeSlots;
+    std::queue<std::pair<uint64_t, uint32_t>> m_RetiredSlots;
+};
@@ -0,0 +1,161 @@
+#include "pchDirectX.h"
+#include "BuddyAllocator.h"
+
+BuddyAllocator::BuddyAllocator(uint64_t TotalSize, uint64_t MinBlockSize) :
+    m_TotalSize(TotalSize),
+    m_MinBlockSize(MinBlockSize),
+    m_MaxOrder(0),
+    m_AllocatedBytes(0),
+    m_RequestedBytes(0),
+    m_PendingFreeBytes(0),
+    m_NumAllocations(0)
+{
+    ASSERT(MinBlockSize > 0 && (MinBlockSize & (MinBlockSize - 1)) == 0);
+    ASSERT(TotalSize >= MinBlockSize && (TotalSize & (TotalSize - 1)) == 0);
+
+    while (GetBlockSize(m_MaxOrder) < TotalSize)
+        ++m_MaxOrder;
+
+    const size_t NumBlocks = static_cast<size_t>(TotalSize / MinBlockSize);
+    m_FreeHead.assign(m_MaxOrder + 1, kNone);
+    m_NextFree.assign(NumBlocks, kNone);
+    m_PrevFree.assign(NumBlocks, kNone);
+    m_BlockOrder.assign(NumBlocks, 0);
+    m_IsFree.assign(NumBlocks, 0);
+    m_RequestedSize.assign(NumBlocks, 0);
+
+    PushFree(0, m_MaxOrder);
+}
+
+uint32_t BuddyAllocator::GetOrder(uint64_t Size) const
+{
+    uint32_t Order = 0;
+    while (GetBlockSize(Order) < Size)
+        ++Order;
+    return Order;
+}
+
+void BuddyAllocator::PushFree(uint32_t Block, uint32_t Order)
+{
+    m_BlockOrder[Block] = static_cast<uint8_t>(Order);
+    m_IsFree[Block] = 1;
+
+    m_PrevFree[Block] = kNone;
+    m_NextFree[Block] = m_FreeHead[Order];
+    if (m_FreeHead[Order] != kNone)
+        m_PrevFree[m_FreeHead[Order]] = Block;
+    m_FreeHead[Order] = Block;
+}
+
+void BuddyAllocator::RemoveFree(uint32_t Block, uint32_t Order)
+{
+    ASSERT(m_IsFree[Block] && m_BlockOrder[Block] == Order);
+
+    if (m_PrevFree[Block] != kNone)
+        m_NextFree[m_PrevFree[Block]] = m_NextFree[Block];
+    else
+        m_FreeHead[Order] = m_NextFree[Block];
+
+    if (m_NextFree[Block] != kNone)
+        m_PrevFree[m_NextFree[Block]] = m_PrevFree[Block];
+
+    m_IsFree[Block] = 0;
+}
+
+uint64_t BuddyAllocator::Allocate(uint64_t Size, uint64_t Alignment)
+{
+    if (Size == 0 || Size > m_TotalSize || Alignment > m_TotalSize)
+        return kInvalidOffset;
+
+    // Blocks are aligned to their size, so a large alignment just means a larger block
+    const uint32_t Order = GetOrder(Size > Alignment ? Size : Alignment);
+
+    uint32_t FoundOrder = Order;
+    while (FoundOrder <= m_MaxOrder && m_FreeHead[FoundOrder] == kNone)
+        ++FoundOrder;
+
+    if (FoundOrder > m_MaxOrder)
+        return kInvalidOffset;
+
+    const uint32_t Block = m_FreeHead[FoundOrder];
+    RemoveFree(Block, FoundOrder);
+
+    // Split, the upper halves go back to the free lists
+    while (FoundOrder > Order)
+    {
+        --FoundOrder;
+        PushFree(Block + (1u << FoundOrder), FoundOrder);
+    }
+
+    m_BlockOrder[Block] = static_cast<uint8_t>(Order);
+    m_RequestedSize[Block] = Size;
+
+    m_AllocatedBytes += GetBlockSize(Order);
+    m_RequestedBytes += Size;
+    ++m_NumAllocations;
+
+    return Block * m_MinBlockSize;
+}
+
+void BuddyAllocator::Free(uint64_t Offset)
+{
+    ASSERT(Offset < m_TotalSize && Offset % m_MinBlockSize == 0);
+
+    uint32_t Block = static_cast<uint32_t>(Offset / m_MinBlockSize);
+    uint32_t Order = m_BlockOrder[Block];
+    ASSERT(!m_IsFree[Block], "Block freed twice");
+
+    m_AllocatedBytes -= GetBlockSize(Order);
+    m_RequestedBytes -= m_RequestedSize[Block];
+    --m_NumAllocations;
+
+    // Merge with the buddy as long as it is free and not split
+    while (Order < m_MaxOrder)
+    {
+        const uint32_t Buddy = Block ^ (1u << Order);
+        if (!m_IsFree[Buddy] || m_BlockOrder[Buddy] != Order)
+            break;
+
+        RemoveFree(Buddy, Order);
+        Block = Block < Buddy ? Block : Buddy;
+        ++Order;
+    }
+
+    PushFree(Block, Order);
+}
+
+void BuddyAllocator::FreeAfterFence(uint64_t Offset, uint64_t FenceValue)
+{
+    ASSERT(Offset < m_TotalSize && Offset % m_MinBlockSize == 0);
+
+    const uint32_t Block = static_cast<uint32_t>(Offset / m_MinBlockSize);
+    m_PendingFreeBytes += GetBlockSize(m_BlockOrder[Block]);
+    m_DeferredFrees.push_back({ Block, FenceValue });
+}
+
+uint64_t BuddyAllocator::GetAllocationSize(uint64_t Offset) const
+{
+    return GetBlockSize(m_BlockOrder[static_cast<size_t>(Offset / m_MinBlockSize)]);
+}
+
+BuddyAllocator::Statistics BuddyAllocator::GetStatistics() const
+{
+    Statistics Stats;
+    Stats.TotalSize = m_TotalSize;
+    Stats.AllocatedBytes = m_AllocatedBytes;
+    Stats.RequestedBytes = m_RequestedBytes;
+    Stats.FreeBytes = m_TotalSize - m_AllocatedBytes;
+    Stats.PendingFreeBytes = m_PendingFreeBytes;
+    Stats.NumAllocations = m_NumAllocations;
+
+    for (uint32_t Order = 0; Order <= m_MaxOrder; ++Order)
+    {
+        for (uint32_t Block = m_FreeHead[Order]; Block != kNone; Block = m_NextFree[Block])
+        {
+            ++Stats.NumFreeBlocks;
+            Stats.LargestFreeBlock = GetBlockSize(Order);
+        }
+    }
+
+    return Stats;
+}
@@ -0,0 +1,131 @@
+//
+// Binary buddy allocator over an abstract range of TotalSize bytes.  Blocks are
+// powers of two between MinBlockSize and TotalSize and are aligned to their size.
+// Allocation and free walk at most log2(TotalSize / MinBlockSize) levels, which is
+// a small constant for GPU heaps (11 for 64MB in 64KB blocks).  Freed blocks merge
+// with their buddy immediately.
+//
+// Frees can be deferred until a fence value completed: FreeAfterFence queues the
+// block, ReleaseCompleted(IsComplete) returns the blocks whose fence IsComplete
+// accepts.  The allocator only hands out offsets and knows nothing about D3D, so
+// it can be driven by tests and benchmarks without a device.
+//
+// Not thread-safe; callers lock.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class BuddyAllocator
+{
+public:
+    static constexpr uint64_t kInvalidOffset = UINT64_MAX;
+
+    struct Statistics
+    {
+        uint64_t TotalSize = 0;
+        uint64_t AllocatedBytes = 0;       // sum of block sizes handed out
+        uint64_t RequestedBytes = 0;       // sum of the sizes asked for
+        uint64_t FreeBytes = 0;
+        uint64_t LargestFreeBlock = 0;
+        uint64_t PendingFreeBytes = 0;     // waiting for their fence
+        uint32_t NumAllocations = 0;
+        uint32_t NumFreeBlocks = 0;
+
+        // 0 when all free memory is one block, towards 1 when it is scattered in small blocks
+        float GetExternalFragmentation() const
+        {
+            return FreeBytes == 0 ? 0.0f : 1.0f - static_cast<float>(LargestFreeBlock) / static_cast<float>(FreeBytes);
+        }
+
+        // Share of the handed out bytes lost to rounding up to block sizes
+        float GetInternalFragmentation() const
+        {
+            return AllocatedBytes == 0 ? 0.0f : 1.0f - static_cast<float>(RequestedBytes) / static_cast<float>(AllocatedBytes);
+        }
+    };
+
+    // TotalSize and MinBlockSize must be powers of two
+    BuddyAllocator(uint64_t TotalSize, uint64_t MinBlockSize);
+
+    // Returns the offset of a block of at least Size bytes aligned to Alignment, or kInvalidOffset
+    uint64_t Allocate(uint64_t Size, uint64_t Alignment = 0);
+
+    void Free(uint64_t Offset);
+
+    // The block is returned by ReleaseCompleted once FenceValue completed
+    void FreeAfterFence(uint64_t Offset, uint64_t FenceValue);
+
+    // Frees the deferred blocks whose fence IsComplete(FenceValue) reports done, returns how many
+    template <typename IsCompleteFunction>
+    uint32_t ReleaseCompleted(IsCompleteFunction IsComplete)
+    {
+        uint32_t NumReleased = 0;
+        size_t NumPending = 0;
+
+        for (const DeferredFree& Pending : m_DeferredFrees)
+        {
+            if (IsComplete(Pending.FenceValue))
+            {
+                m_PendingFreeBytes -= GetBlockSize(m_BlockOrder[Pending.Block]);
+                Free(Pending.Block * m_MinBlockSize);
+                ++NumReleased;
+            }
+            else
+            {
+                m_DeferredFrees[NumPending++] = Pending;
+            }
+        }
+        m_DeferredFrees.resize(NumPending);
+
+        return NumReleased;
+    }
+
+    // Size of the block at Offset
+    uint64_t GetAllocationSize(uint64_t Offset) const;
+
+    uint64_t GetTotalSize() const { return m_TotalSize; }
+    uint64_t GetMinBlockSize() const { return m_MinBlockSize; }
+    bool IsEmpty() const { return m_NumAllocations == 0 && m_DeferredFrees.empty(); }
+
+    Statistics GetStatistics() const;
+
+private:
+    static constexpr uint32_t kNone = UINT32_MAX;
+
+    struct DeferredFree
+    {
+        uint32_t Block;
+        uint64_t FenceValue;
+    };
+
+    uint64_t GetBlockSize(uint32_t Order) const { return m_MinBlockSize << Order; }
+    uint32_t GetOrder(uint64_t Size) const;
+
+    void PushFree(uint32_t Block, uint32_t Order);
+    void RemoveFree(uint32_t Block, uint32_t Order);
+
+    uint64_t m_TotalSize;
+    uint64_t m_MinBlockSize;
+    uint32_t m_MaxOrder;
+
+    // Free lists per order, linked through the first minimum sized block of every free block
+    std::vector<uint32_t> m_FreeHead;
+    std::vector<uint32_t> m_NextFree;
+    std::vector<uint32_t> m_PrevFree;
+    std::vector<uint8_t> m_BlockOrder;
+    std::vector<uint8_t> m_IsFree;
+
+    // Size requested for every allocated block, for the statistics
+    std::vector<uint64_t> m_RequestedSize;
+
+    std::vector<DeferredFree> m_DeferredFrees;
+
+    uint64_t m_AllocatedBytes;
+    uint64_t m_RequestedBytes;
+    uint64_t m_PendingFreeBytes;
+    uint32_t m_NumAllocations;
+};
@@ -100,6 +100,22 @@ void ColorBuffer::CreateDerivedViews(DXGI_FORMAT Format, uint32_t ArraySize, D3D
     }
 }
 
+void ColorBuffer::Destroy()
+{
+    PixelBuffer::Destroy();
+
+    this->m_core.FreeDescriptor(this->m_RTVHandle, D3D12_DESCRIPTOR_HEAP_TYPE_RTV);
+    this->m_core.FreeDescriptor(this->m_SRVHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    for (D3D12_CPU_DESCRIPTOR_HANDLE& UAVHandle : this->m_UAVHandle)
+    {
+        this->m_core.FreeDescriptor(UAVHandle, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    }
+
+    this->m_SRVHandle.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+    this->m_RTVHandle.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+    std::memset(this->m_UAVHandle, 0xFF, sizeof(this->m_UAVHandle));
+}
+
 void ColorBuffer::CreateFromSwapChain(const std::wstring& Name, ID3D12Resource* BaseResource )
 {
     this->AssociateWithResource(Name, BaseResource, D3D12_RESOURCE_STATE_PRESENT);
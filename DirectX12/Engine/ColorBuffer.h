@@ -40,6 +40,9 @@ public:
     void CreateShared(const std::wstring& Name, uint32_t Width, uint32_t Height, uint32_t NumMips,
                       D3D12_GPU_VIRTUAL_ADDRESS VidMemPtr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN);
 
+    // Releases the resource and gives the views back to the descriptor allocators
+    void Destroy() override;
+
     // Get pre-created CPU-visible descriptor handles
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetSRV(void) const { return m_SRVHandle; }
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetRTV(void) const { return m_RTVHandle; }
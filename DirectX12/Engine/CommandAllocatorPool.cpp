@@ -16,7 +16,8 @@
 
 CommandAllocatorPool::CommandAllocatorPool(D3D12_COMMAND_LIST_TYPE Type) :
     m_cCommandListType(Type),
-    m_Device(nullptr)
+    m_Device(nullptr),
+    m_Shards(kDefaultMaxAllocators)
 {
 }
 
@@ -25,59 +26,49 @@ CommandAllocatorPool::~CommandAllocatorPool()
     Shutdown();
 }
 
-void CommandAllocatorPool::Create(ID3D12Device * pDevice)
+void CommandAllocatorPool::Create(ID3D12Device * pDevice, uint32_t MaxAllocators)
 {
     m_Device = pDevice;
+    m_Shards.SetMaxAllocators(MaxAllocators);
 }
 
 void CommandAllocatorPool::Shutdown()
 {
+    m_Shards.Clear();
+
+    std::lock_guard<std::mutex> LockGuard(m_AllocatorMutex);
+
     for (size_t i = 0; i < m_AllocatorPool.size(); ++i)
         m_AllocatorPool[i]->Release();
 
     m_AllocatorPool.clear();
-
-    while(!m_ReadyAllocators.empty())
-    {
-        m_ReadyAllocators.pop();
-    }
 }
 
 ID3D12CommandAllocator * CommandAllocatorPool::RequestAllocator(uint64_t CompletedFenceValue)
 {
-    std::lock_guard<std::mutex> LockGuard(m_AllocatorMutex);
+    ID3D12CommandAllocator* pAllocator = m_Shards.Request(CompletedFenceValue);
+    if (pAllocator != nullptr)
+    {
+        ASSERT_SUCCEEDED(pAllocator->Reset());
+        return pAllocator;
+    }
 
-    ID3D12CommandAllocator* pAllocator = nullptr;
+    if (!m_Shards.Reserve())
+        return nullptr;
 
-    if (!m_ReadyAllocators.empty())
-    {
-        std::pair<uint64_t, ID3D12CommandAllocator*>& AllocatorPair = m_ReadyAllocators.front();
+    ASSERT_SUCCEEDED(m_Device->CreateCommandAllocator(m_cCommandListType, MY_IID_PPV_ARGS(&pAllocator)));
 
-        if (AllocatorPair.first <= CompletedFenceValue)
-        {
-            pAllocator = AllocatorPair.second;
-            ASSERT_SUCCEEDED(pAllocator->Reset());
-            m_ReadyAllocators.pop();
-        }
-    }
+    std::lock_guard<std::mutex> LockGuard(m_AllocatorMutex);
 
-    // If no allocator's were ready to be reused, create a new one
-    if (pAllocator == nullptr)
-    {
-        ASSERT_SUCCEEDED(m_Device->CreateCommandAllocator(m_cCommandListType, MY_IID_PPV_ARGS(&pAllocator)));
-        wchar_t AllocatorName[32];
-        swprintf(AllocatorName, 32, L"CommandAllocator %zu", m_AllocatorPool.size());
-        pAllocator->SetName(AllocatorName);
-        m_AllocatorPool.push_back(pAllocator);
-    }
+    wchar_t AllocatorName[32];
+    swprintf(AllocatorName, 32, L"CommandAllocator %zu", m_AllocatorPool.size());
+    pAllocator->SetName(AllocatorName);
+    m_AllocatorPool.push_back(pAllocator);
 
     return pAllocator;
 }
 
 void CommandAllocatorPool::DiscardAllocator(uint64_t FenceValue, ID3D12CommandAllocator * Allocator)
 {
-    std::lock_guard<std::mutex> LockGuard(m_AllocatorMutex);
-
-    // That fence value indicates we are free to reset the allocator
-    m_ReadyAllocators.push(std::make_pair(FenceValue, Allocator));
+    m_Shards.Discard(FenceValue, Allocator);
 }
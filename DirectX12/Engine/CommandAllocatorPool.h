@@ -13,30 +13,45 @@
 
 #pragma once
 
+#include "AllocatorShards.h"
 #include <vector>
-#include <queue>
 #include <mutex>
 #include <stdint.h>
 
+// Discarded allocators are kept and handed out again by AllocatorShards.  Beyond the high-water mark no
+// allocators are created while any discarded one is still pending; RequestAllocator returns nullptr and
+// the caller waits for GetOldestPendingFence().
 class CommandAllocatorPool
 {
 public:
+    static const uint32_t kDefaultMaxAllocators = 256;
+
+    typedef CommandAllocatorStatistics Statistics;
+
     CommandAllocatorPool(D3D12_COMMAND_LIST_TYPE Type);
     ~CommandAllocatorPool();
 
-    void Create(ID3D12Device* pDevice);
+    void Create(ID3D12Device* pDevice, uint32_t MaxAllocators = kDefaultMaxAllocators);
     void Shutdown();
 
+    // Returns nullptr when the pool is at its high-water mark and an allocator is still pending
     ID3D12CommandAllocator* RequestAllocator(uint64_t CompletedFenceValue);
     void DiscardAllocator(uint64_t FenceValue, ID3D12CommandAllocator* Allocator);
 
-    inline size_t Size() { return m_AllocatorPool.size(); }
+    // Lowest fence value of all pending allocators, 0 when none is pending
+    uint64_t GetOldestPendingFence() { return m_Shards.GetOldestPendingFence(); }
+
+    Statistics GetStatistics() { return m_Shards.GetStatistics(); }
+
+    inline size_t Size() { return m_Shards.GetNumAllocators(); }
 
 private:
     const D3D12_COMMAND_LIST_TYPE m_cCommandListType;
 
     ID3D12Device* m_Device;
+
+    AllocatorShards<ID3D12CommandAllocator> m_Shards;
+
     std::vector<ID3D12CommandAllocator*> m_AllocatorPool;
-    std::queue<std::pair<uint64_t, ID3D12CommandAllocator*>> m_ReadyAllocators;
     std::mutex m_AllocatorMutex;
 };
@@ -32,7 +32,7 @@ void ContextManager::DestroyAllContexts(void)
     }
 }
 
-CommandContext* ContextManager::AllocateContext(D3D12_COMMAND_LIST_TYPE Type, GraphicsCore& core, const std::wstring ID)
+CommandContext* ContextManager::AllocateContext(D3D12_COMMAND_LIST_TYPE Type, GraphicsCore& core, const wchar_t* ID)
 {
     std::lock_guard<std::mutex> LockGuard(m_ContextAllocationMutex);
 
@@ -62,10 +62,20 @@ void ContextManager::FreeContext(CommandContext* UsedContext)
 {
     ASSERT(UsedContext != nullptr);
     std::lock_guard<std::mutex> LockGuard(m_ContextAllocationMutex);
+    m_StateFilterTotals.Accumulate(UsedContext->m_StateFilter.GetStats());
+    UsedContext->m_StateFilter.ClearStats();
     m_AvailableContexts[UsedContext->m_Type].push(UsedContext);
 }
 
-CommandContext& CommandContext::Begin( const std::wstring ID, GraphicsCore& core)
+StateFilterStats ContextManager::ConsumeStateFilterStats()
+{
+    std::lock_guard<std::mutex> LockGuard(m_ContextAllocationMutex);
+    StateFilterStats Totals = m_StateFilterTotals;
+    m_StateFilterTotals.Clear();
+    return Totals;
+}
+
+CommandContext& CommandContext::Begin( const wchar_t* ID, GraphicsCore& core)
 {
     CommandContext* NewContext = core.m_pContextManager->AllocateContext(D3D12_COMMAND_LIST_TYPE_DIRECT, core, ID);
     NewContext->SetID(ID);
@@ -76,7 +86,17 @@ CommandContext& CommandContext::Begin( const std::wstring ID, GraphicsCore& core
     return *NewContext;
 }
 
-ComputeContext& ComputeContext::Begin(const std::wstring& ID, GraphicsCore& core, bool Async)
+CommandContext& CommandContext::Begin( const std::wstring& ID, GraphicsCore& core)
+{
+    CommandContext& NewContext = Begin(ID.c_str(), core);
+
+    // The context outlives the caller's string
+    NewContext.m_IDStorage = ID;
+    NewContext.SetID(NewContext.m_IDStorage.c_str());
+    return NewContext;
+}
+
+ComputeContext& ComputeContext::Begin(const wchar_t* ID, GraphicsCore& core, bool Async)
 {
     ComputeContext& NewContext = core.m_pContextManager->AllocateContext(
         Async ? D3D12_COMMAND_LIST_TYPE_COMPUTE : D3D12_COMMAND_LIST_TYPE_DIRECT, core, ID)->GetComputeContext();
@@ -116,6 +136,8 @@ uint64_t CommandContext::Flush(bool WaitForCompletion)
         m_CommandList->SetPipelineState(m_CurPipelineState);
     }
 
+    m_StateFilter.Invalidate();
+
     BindDescriptorHeaps();
 
     return FenceValue;
@@ -123,30 +145,57 @@ uint64_t CommandContext::Flush(bool WaitForCompletion)
 
 uint64_t CommandContext::Finish( bool WaitForCompletion )
 {
-    this->PIXEndEvent();
-    ASSERT(m_Type == D3D12_COMMAND_LIST_TYPE_DIRECT || m_Type == D3D12_COMMAND_LIST_TYPE_COMPUTE);
+    CommandContext* Self = this;
+    return FinishBatch(this->m_Core, &Self, 1, WaitForCompletion);
+}
 
-    FlushResourceBarriers();
+uint64_t CommandContext::FinishBatch( GraphicsCore& core, CommandContext* const* Contexts, UINT NumContexts, bool WaitForCompletion )
+{
+    ASSERT(NumContexts > 0 && NumContexts <= kMaxBatchedContexts);
 
-//    if (m_ID.length() > 0)
-        //EngineProfiling::EndBlock(this);
+    const D3D12_COMMAND_LIST_TYPE Type = Contexts[0]->m_Type;
+    ASSERT(Type == D3D12_COMMAND_LIST_TYPE_DIRECT || Type == D3D12_COMMAND_LIST_TYPE_COMPUTE);
 
-    ASSERT(m_CurrentAllocator != nullptr);
+    ID3D12CommandList* Lists[kMaxBatchedContexts];
 
-    CommandQueue& Queue = this->m_Core.m_pCommandManager->GetQueue(m_Type);
-    uint64_t FenceValue = Queue.ExecuteCommandList(m_CommandList);
-    Queue.DiscardAllocator(FenceValue, m_CurrentAllocator);
-    m_CurrentAllocator = nullptr;
+    for (UINT i = 0; i < NumContexts; ++i)
+    {
+        CommandContext& Context = *Contexts[i];
+        ASSERT(Context.m_Type == Type, "All contexts of a batch have to use the same queue");
+        ASSERT(Context.m_CurrentAllocator != nullptr);
+
+        Context.PIXEndEvent();
+        Context.FlushResourceBarriers();
+
+//        if (m_ID.length() > 0)
+            //EngineProfiling::EndBlock(this);
+
+        Lists[i] = Context.m_CommandList;
+    }
+
+    CommandQueue& Queue = core.m_pCommandManager->GetQueue(Type);
+    uint64_t FenceValue = Queue.ExecuteCommandLists(NumContexts, Lists);
+
+    for (UINT i = 0; i < NumContexts; ++i)
+    {
+        CommandContext& Context = *Contexts[i];
+
+        Queue.DiscardAllocator(FenceValue, Context.m_CurrentAllocator);
+        Context.m_CurrentAllocator = nullptr;
 
-    m_CpuLinearAllocator.CleanupUsedPages(FenceValue);
-    m_GpuLinearAllocator.CleanupUsedPages(FenceValue);
-    m_DynamicViewDescriptorHeap.CleanupUsedHeaps(FenceValue);
-    m_DynamicSamplerDescriptorHeap.CleanupUsedHeaps(FenceValue);
+        Context.m_CpuLinearAllocator.CleanupUsedPages(FenceValue);
+        Context.m_GpuLinearAllocator.CleanupUsedPages(FenceValue);
+        Context.m_DynamicViewDescriptorHeap.CleanupUsedHeaps(FenceValue);
+        Context.m_DynamicSamplerDescriptorHeap.CleanupUsedHeaps(FenceValue);
+    }
 
     if (WaitForCompletion)
-        this->m_Core.m_pCommandManager->WaitForFence(FenceValue);
+        core.m_pCommandManager->WaitForFence(FenceValue);
 
-    this->m_Core.m_pContextManager->FreeContext(this);
+    for (UINT i = 0; i < NumContexts; ++i)
+    {
+        core.m_pContextManager->FreeContext(Contexts[i]);
+    }
 
     return FenceValue;
 }
@@ -160,6 +209,7 @@ CommandContext::CommandContext(D3D12_COMMAND_LIST_TYPE Type, GraphicsCore& core)
     m_GpuLinearAllocator(kGpuExclusive, *core.m_pLinearAllocatorStatics)
 {
     m_OwningManager = nullptr;
+    m_ID = L"";
     m_CommandList = nullptr;
     m_CurrentAllocator = nullptr;
     ZeroMemory(m_CurrentDescriptorHeaps, sizeof(m_CurrentDescriptorHeaps));
@@ -176,12 +226,12 @@ CommandContext::~CommandContext( void )
         m_CommandList->Release();
 }
 
-void CommandContext::Initialize(const std::wstring ID)
+void CommandContext::Initialize(const wchar_t* ID)
 {
     this->m_Core.m_pCommandManager->CreateNewCommandList(m_Type, &m_CommandList, &m_CurrentAllocator, ID);
 }
 
-void CommandContext::Reset(const std::wstring ID)
+void CommandContext::Reset(const wchar_t* ID)
 {
     // We only call Reset() on previously freed contexts.  The command list persists, but we must
     // request a new allocator.
@@ -189,14 +239,21 @@ void CommandContext::Reset(const std::wstring ID)
     auto& queue = this->m_Core.m_pCommandManager->GetQueue(m_Type);
     m_CurrentAllocator = queue.RequestAllocator();
     m_CommandList->Reset(m_CurrentAllocator, nullptr);
-    m_CommandList->SetName(ID.c_str());
-    queue.m_CommandQueue->SetName(ID.c_str());
+
+    // The queue is shared by all contexts and keeps the name it got when it was created
+#ifdef NAME_COMMAND_LISTS
+    m_CommandList->SetName(ID);
+#else
+    (ID);
+#endif
 
     m_CurGraphicsRootSignature = nullptr;
     m_CurPipelineState = nullptr;
     m_CurComputeRootSignature = nullptr;
     m_NumBarriersToFlush = 0;
 
+    m_StateFilter.Invalidate();
+
     BindDescriptorHeaps();
 }
 
@@ -213,6 +270,9 @@ void CommandContext::BindDescriptorHeaps( void )
 
     if (NonNullHeaps > 0)
         m_CommandList->SetDescriptorHeaps(NonNullHeaps, HeapsToBind);
+
+    // Tables set before refer to the previously bound heaps
+    m_StateFilter.OnDescriptorHeapsBound();
 }
 
 void GraphicsContext::SetRenderTargets( UINT NumRTVs, const D3D12_CPU_DESCRIPTOR_HANDLE RTVs[], D3D12_CPU_DESCRIPTOR_HANDLE DSV )
@@ -304,14 +364,14 @@ void GraphicsContext::ClearDepthAndStencil( DepthBuffer& Target )
 
 void GraphicsContext::SetViewportAndScissor( const D3D12_VIEWPORT& vp, const D3D12_RECT& rect )
 {
-    ASSERT(rect.left < rect.right && rect.top < rect.bottom);
-    m_CommandList->RSSetViewports( 1, &vp );
-    m_CommandList->RSSetScissorRects( 1, &rect );
+    SetViewport(vp);
+    SetScissor(rect);
 }
 
 void GraphicsContext::SetViewport( const D3D12_VIEWPORT& vp )
 {
-    m_CommandList->RSSetViewports( 1, &vp );
+    if (m_StateFilter.SetViewport(vp))
+        m_CommandList->RSSetViewports( 1, &vp );
 }
 
 void GraphicsContext::SetViewport( FLOAT x, FLOAT y, FLOAT w, FLOAT h, FLOAT minDepth, FLOAT maxDepth )
@@ -323,13 +383,15 @@ void GraphicsContext::SetViewport( FLOAT x, FLOAT y, FLOAT w, FLOAT h, FLOAT min
     vp.MaxDepth = maxDepth;
     vp.TopLeftX = x;
     vp.TopLeftY = y;
-    m_CommandList->RSSetViewports( 1, &vp );
+    SetViewport(vp);
 }
 
 void GraphicsContext::SetScissor( const D3D12_RECT& rect )
 {
     ASSERT(rect.left < rect.right && rect.top < rect.bottom);
-    m_CommandList->RSSetScissorRects( 1, &rect );
+
+    if (m_StateFilter.SetScissor(rect))
+        m_CommandList->RSSetScissorRects( 1, &rect );
 }
 
 void CommandContext::TransitionResource(GpuResource& Resource, D3D12_RESOURCE_STATES NewState, bool FlushImmediate)
@@ -399,6 +461,35 @@ void CommandContext::BeginResourceTransition(GpuResource& Resource, D3D12_RESOUR
         FlushResourceBarriers();
 }
 
+void CommandContext::QueuePlannedTransition(GpuResource& Resource, D3D12_RESOURCE_STATES Before, D3D12_RESOURCE_STATES After,
+    D3D12_RESOURCE_BARRIER_FLAGS Flags)
+{
+    ASSERT(Before == Resource.m_UsageState, "Planned transition does not start in the state of the resource");
+
+    if (m_NumBarriersToFlush == 16)
+        FlushResourceBarriers();
+
+    D3D12_RESOURCE_BARRIER& BarrierDesc = m_ResourceBarrierBuffer[m_NumBarriersToFlush++];
+
+    BarrierDesc.Type = D3D12_RESOURCE_BARRIER_TYPE_TRANSITION;
+    BarrierDesc.Flags = Flags;
+    BarrierDesc.Transition.pResource = Resource.GetResource();
+    BarrierDesc.Transition.Subresource = D3D12_RESOURCE_BARRIER_ALL_SUBRESOURCES;
+    BarrierDesc.Transition.StateBefore = Before;
+    BarrierDesc.Transition.StateAfter = After;
+
+    // Same bookkeeping as BeginResourceTransition() and TransitionResource()
+    if (Flags == D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY)
+    {
+        Resource.m_TransitioningState = After;
+    }
+    else
+    {
+        Resource.m_UsageState = After;
+        Resource.m_TransitioningState = (D3D12_RESOURCE_STATES)-1;
+    }
+}
+
 void CommandContext::InsertUAVBarrier(GpuResource& Resource, bool FlushImmediate)
 {
     ASSERT(m_NumBarriersToFlush < 16, "Exceeded arbitrary limit on buffered barriers");
@@ -584,7 +675,8 @@ void CommandContext::InitializeBuffer(const std::wstring& name, GraphicsCore& co
     // copy data to the intermediate upload heap and then schedule a copy from the upload heap to the default texture
     InitContext.TransitionResource(Dest, D3D12_RESOURCE_STATE_COPY_DEST, true);
     InitContext.m_CommandList->CopyBufferRegion(Dest.GetResource(), Offset, mem.Buffer.GetResource(), 0, NumBytes);
-    InitContext.TransitionResource(Dest, D3D12_RESOURCE_STATE_GENERIC_READ, true);
+    // Finish() flushes it together with the submission
+    InitContext.TransitionResource(Dest, D3D12_RESOURCE_STATE_GENERIC_READ);
 
     // Execute the command list and wait for it to finish so we can release the upload buffer
     InitContext.Finish(true);
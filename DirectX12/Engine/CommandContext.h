@@ -24,6 +24,7 @@
 #include "LinearAllocator.h"
 #include "CommandSignature.h"
 #include "GraphicsCore.h"
+#include "StateFilter.h"
 #include <vector>
 
 class ColorBuffer;
@@ -63,14 +64,19 @@ class ContextManager
 public:
     ContextManager(void) {}
 
-    CommandContext* AllocateContext(D3D12_COMMAND_LIST_TYPE Type, GraphicsCore& core, const std::wstring ID);
+    CommandContext* AllocateContext(D3D12_COMMAND_LIST_TYPE Type, GraphicsCore& core, const wchar_t* ID);
     void FreeContext(CommandContext*);
     void DestroyAllContexts();
 
+    // Filter counters of all contexts freed since the last call; the totals are cleared.
+    StateFilterStats ConsumeStateFilterStats();
+
 private:
     std::vector<std::unique_ptr<CommandContext> > m_ContextPool[4];
     std::queue<CommandContext*> m_AvailableContexts[4];
     std::mutex m_ContextAllocationMutex;
+
+    StateFilterStats m_StateFilterTotals;
 };
 
 struct NonCopyable
@@ -89,13 +95,18 @@ private:
         D3D12_COMMAND_LIST_TYPE Type,
         GraphicsCore& core);
 
-    void Reset(const std::wstring ID);
+    void Reset(const wchar_t* ID);
 
 public:
 
     ~CommandContext(void);
 
-    static CommandContext& Begin(const std::wstring ID, GraphicsCore& core);
+    // ID is kept, not copied: pass a string literal or another string that outlives the context.
+    // Nothing is allocated, the command list is named after ID only in debug and profiling builds.
+    static CommandContext& Begin(const wchar_t* ID, GraphicsCore& core);
+
+    // For IDs built at run time, copies the ID into the context
+    static CommandContext& Begin(const std::wstring& ID, GraphicsCore& core);
 
     // Flush existing commands to the GPU but keep the context alive
     uint64_t Flush( bool WaitForCompletion = false );
@@ -103,8 +114,13 @@ public:
     // Flush existing commands and release the current context
     uint64_t Finish( bool WaitForCompletion = false );
 
+    // Submits the contexts in array order with a single ExecuteCommandLists call and releases all of
+    // them.  They must have been begun on the same queue type, e.g. by different recording threads.
+    static const UINT kMaxBatchedContexts = 64;
+    static uint64_t FinishBatch( GraphicsCore& core, CommandContext* const* Contexts, UINT NumContexts, bool WaitForCompletion = false );
+
     // Prepare to render by reserving a command list and command allocator
-    void Initialize(const std::wstring ID);
+    void Initialize(const wchar_t* ID);
 
     GraphicsContext& GetGraphicsContext() {
         ASSERT(m_Type != D3D12_COMMAND_LIST_TYPE_COMPUTE, "Cannot convert async compute context to graphics");
@@ -144,6 +160,11 @@ public:
     void BeginResourceTransition(GpuResource& Resource, D3D12_RESOURCE_STATES NewState, bool FlushImmediate = false);
     void InsertUAVBarrier(GpuResource& Resource, bool FlushImmediate = false);
     void InsertAliasBarrier(GpuResource& Before, GpuResource& After, bool FlushImmediate = false);
+
+    // Queues a transition planned ahead, e.g. by a ResourceStateTracker.  Flags may
+    // split the transition, the END_ONLY half has to follow in the same command list.
+    void QueuePlannedTransition(GpuResource& Resource, D3D12_RESOURCE_STATES Before, D3D12_RESOURCE_STATES After,
+        D3D12_RESOURCE_BARRIER_FLAGS Flags = D3D12_RESOURCE_BARRIER_FLAG_NONE);
     inline void FlushResourceBarriers(void);
 
     void InsertTimeStamp( ID3D12QueryHeap* pQueryHeap, uint32_t QueryIdx );
@@ -163,6 +184,8 @@ public:
 
     void SetPredication(ID3D12Resource* Buffer, UINT64 BufferOffset, D3D12_PREDICATION_OP Op);
 
+    const StateFilterStats& GetStateFilterStats() const { return m_StateFilter.GetStats(); }
+
 protected:
 
     void BindDescriptorHeaps( void );
@@ -176,6 +199,9 @@ protected:
     ID3D12PipelineState* m_CurPipelineState;
     ID3D12RootSignature* m_CurComputeRootSignature;
 
+    // Shadow copy of the state last set on the command list
+    StateFilter m_StateFilter;
+
     DynamicDescriptorHeap m_DynamicViewDescriptorHeap;        // HEAP_TYPE_CBV_SRV_UAV
     DynamicDescriptorHeap m_DynamicSamplerDescriptorHeap;    // HEAP_TYPE_SAMPLER
 
@@ -187,8 +213,9 @@ protected:
     LinearAllocator m_CpuLinearAllocator;
     LinearAllocator m_GpuLinearAllocator;
 
-    std::wstring m_ID;
-    void SetID(const std::wstring& ID) { m_ID = ID; }
+    const wchar_t* m_ID;
+    std::wstring m_IDStorage;       // only for IDs built at run time
+    void SetID(const wchar_t* ID) { m_ID = ID; }
 
     D3D12_COMMAND_LIST_TYPE m_Type;
 };
@@ -197,6 +224,11 @@ class GraphicsContext : public CommandContext
 {
 public:
 
+    static GraphicsContext& Begin(const wchar_t* ID, GraphicsCore& core)
+    {
+        return CommandContext::Begin(ID, core).GetGraphicsContext();
+    }
+
     static GraphicsContext& Begin(const std::wstring& ID, GraphicsCore& core)
     {
         return CommandContext::Begin(ID, core).GetGraphicsContext();
@@ -271,7 +303,7 @@ private:
 class ComputeContext : public CommandContext
 {
 public:
-    static ComputeContext& Begin(const std::wstring& ID, GraphicsCore &core, bool Async = false);
+    static ComputeContext& Begin(const wchar_t* ID, GraphicsCore &core, bool Async = false);
 
     void ClearUAV( GpuBuffer& Target );
     void ClearUAV( ColorBuffer& Target );
@@ -318,10 +350,13 @@ inline void CommandContext::FlushResourceBarriers( void )
 
 inline void GraphicsContext::SetRootSignature( const RootSignature& RootSig )
 {
-    if (RootSig.GetSignature() == m_CurGraphicsRootSignature)
+    const bool Filtered = RootSig.GetSignature() == m_CurGraphicsRootSignature;
+    m_StateFilter.Count(StateFilterStats::kRootSignature, Filtered);
+    if (Filtered)
         return;
 
     m_CommandList->SetGraphicsRootSignature(m_CurGraphicsRootSignature = RootSig.GetSignature());
+    m_StateFilter.OnGraphicsRootSignatureChanged();
 
     m_DynamicViewDescriptorHeap.ParseGraphicsRootSignature(RootSig);
     m_DynamicSamplerDescriptorHeap.ParseGraphicsRootSignature(RootSig);
@@ -329,7 +364,9 @@ inline void GraphicsContext::SetRootSignature( const RootSignature& RootSig )
 
 inline void ComputeContext::SetRootSignature( const RootSignature& RootSig )
 {
-    if (RootSig.GetSignature() == m_CurComputeRootSignature)
+    const bool Filtered = RootSig.GetSignature() == m_CurComputeRootSignature;
+    m_StateFilter.Count(StateFilterStats::kRootSignature, Filtered);
+    if (Filtered)
         return;
 
     m_CurComputeRootSignature = RootSig.GetSignature();
@@ -343,7 +380,9 @@ inline void ComputeContext::SetRootSignature( const RootSignature& RootSig )
 inline void CommandContext::SetPipelineState( const PSO& PSO )
 {
     ID3D12PipelineState* PipelineState = PSO.GetPipelineStateObject();
-    if (PipelineState == this->m_CurPipelineState)
+    const bool Filtered = PipelineState == this->m_CurPipelineState;
+    m_StateFilter.Count(StateFilterStats::kPipelineState, Filtered);
+    if (Filtered)
     {
         return;
     }
@@ -375,7 +414,8 @@ inline void GraphicsContext::SetBlendFactor( Color BlendFactor )
 
 inline void GraphicsContext::SetPrimitiveTopology( D3D12_PRIMITIVE_TOPOLOGY Topology )
 {
-    m_CommandList->IASetPrimitiveTopology(Topology);
+    if (m_StateFilter.SetPrimitiveTopology(Topology))
+        m_CommandList->IASetPrimitiveTopology(Topology);
 }
 
 inline void ComputeContext::SetConstantArray( UINT RootEntry, UINT NumConstants, const void* pConstants )
@@ -492,6 +532,8 @@ inline void GraphicsContext::SetDynamicVB( UINT Slot, size_t NumVertices, size_t
     VBView.SizeInBytes = (UINT)BufferSize;
     VBView.StrideInBytes = (UINT)VertexStride;
 
+    // Dynamic data lives at a new address each time, there is nothing to filter
+    m_StateFilter.OnVertexBufferChanged(Slot);
     m_CommandList->IASetVertexBuffers(Slot, 1, &VBView);
 }
 
@@ -623,6 +665,8 @@ inline void ComputeContext::SetDynamicDescriptor( UINT RootIndex, UINT Offset, D
 
 inline void GraphicsContext::SetDynamicDescriptors( UINT RootIndex, UINT Offset, UINT Count, const D3D12_CPU_DESCRIPTOR_HANDLE Handles[] )
 {
+    // The table is rebound into the dynamic heap at the next draw
+    m_StateFilter.OnDescriptorTableChanged(RootIndex);
     m_DynamicViewDescriptorHeap.SetGraphicsDescriptorHandles(RootIndex, Offset, Count, Handles);
 }
 
@@ -653,7 +697,10 @@ inline void ComputeContext::SetDynamicSamplers( UINT RootIndex, UINT Offset, UIN
 
 inline void GraphicsContext::SetDescriptorTable( UINT RootIndex, D3D12_GPU_DESCRIPTOR_HANDLE FirstHandle )
 {
-    m_CommandList->SetGraphicsRootDescriptorTable( RootIndex, FirstHandle );
+    ASSERT(RootIndex < StateFilter::kMaxDescriptorTables);
+
+    if (m_StateFilter.SetGraphicsDescriptorTable(RootIndex, FirstHandle))
+        m_CommandList->SetGraphicsRootDescriptorTable( RootIndex, FirstHandle );
 }
 
 inline void ComputeContext::SetDescriptorTable( UINT RootIndex, D3D12_GPU_DESCRIPTOR_HANDLE FirstHandle )
@@ -673,7 +720,10 @@ inline void GraphicsContext::SetVertexBuffer( UINT Slot, const D3D12_VERTEX_BUFF
 
 inline void GraphicsContext::SetVertexBuffers( UINT StartSlot, UINT Count, const D3D12_VERTEX_BUFFER_VIEW VBViews[] )
 {
-    m_CommandList->IASetVertexBuffers(StartSlot, Count, VBViews);
+    ASSERT(StartSlot + Count <= D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT);
+
+    if (m_StateFilter.SetVertexBuffers(StartSlot, Count, VBViews))
+        m_CommandList->IASetVertexBuffers(StartSlot, Count, VBViews);
 }
 
 inline void GraphicsContext::Draw(UINT VertexCount, UINT VertexStartOffset)
@@ -20,7 +20,8 @@ CommandQueue::CommandQueue(D3D12_COMMAND_LIST_TYPE Type) :
     m_CommandQueue(nullptr),
     m_pFence(nullptr),
     m_NextFenceValue((uint64_t)Type << 56 | 1),
-    m_LastCompletedFenceValue((uint64_t)Type << 56),
+    m_Timeline((uint64_t)Type << 56),
+    m_NumSubmissions(0),
     m_AllocatorPool(Type)
 {
 }
@@ -37,7 +38,9 @@ void CommandQueue::Shutdown()
 
     m_AllocatorPool.Shutdown();
 
-    CloseHandle(m_FenceEventHandle);
+    // Everything still deferred on this queue runs now, the GPU is idle
+    m_Timeline.RunAllCallbacks();
+    m_Timeline.Detach();
 
     m_pFence->Release();
     m_pFence = nullptr;
@@ -83,8 +86,7 @@ void CommandQueue::Create(ID3D12Device* pDevice, D3D12_COMMAND_QUEUE_FLAGS comma
     m_pFence->SetName(L"CommandListManager::m_pFence");
     m_pFence->Signal((uint64_t)m_Type << 56);
 
-    m_FenceEventHandle = CreateEvent(nullptr, false, false, nullptr);
-    ASSERT(m_FenceEventHandle != NULL);
+    m_Timeline.Attach(m_pFence);
 
     m_AllocatorPool.Create(pDevice);
 
@@ -98,7 +100,7 @@ void CommandListManager::Create()
     m_CopyQueue.Create(this->m_Core.m_pDevice, D3D12_COMMAND_QUEUE_FLAGS::D3D12_COMMAND_QUEUE_FLAG_DISABLE_GPU_TIMEOUT);
 }
 
-void CommandListManager::CreateNewCommandList( D3D12_COMMAND_LIST_TYPE Type, ID3D12GraphicsCommandList** List, ID3D12CommandAllocator** Allocator, const std::wstring ID)
+void CommandListManager::CreateNewCommandList( D3D12_COMMAND_LIST_TYPE Type, ID3D12GraphicsCommandList** List, ID3D12CommandAllocator** Allocator, const wchar_t* ID)
 {
     ASSERT(Type != D3D12_COMMAND_LIST_TYPE_BUNDLE, "Bundles are not yet supported");
     switch (Type)
@@ -110,17 +112,30 @@ void CommandListManager::CreateNewCommandList( D3D12_COMMAND_LIST_TYPE Type, ID3
     }
     
     ASSERT_SUCCEEDED( this->m_Core.m_pDevice->CreateCommandList(1, Type, *Allocator, nullptr, MY_IID_PPV_ARGS(List)) );
-    (*List)->SetName(ID.c_str());
+#ifdef NAME_COMMAND_LISTS
+    (*List)->SetName(ID);
+#else
+    (ID);
+#endif
 }
 
 uint64_t CommandQueue::ExecuteCommandList( ID3D12CommandList* List )
+{
+    return ExecuteCommandLists(1, &List);
+}
+
+uint64_t CommandQueue::ExecuteCommandLists( UINT NumLists, ID3D12CommandList* const* Lists )
 {
     std::lock_guard<std::mutex> LockGuard(m_FenceMutex);
 
-    ASSERT_SUCCEEDED(((ID3D12GraphicsCommandList*)List)->Close());
+    for (UINT i = 0; i < NumLists; ++i)
+    {
+        ASSERT_SUCCEEDED(((ID3D12GraphicsCommandList*)Lists[i])->Close());
+    }
 
-    // Kickoff the command list
-    m_CommandQueue->ExecuteCommandLists(1, &List);
+    // Kickoff the command lists
+    m_CommandQueue->ExecuteCommandLists(NumLists, Lists);
+    ++m_NumSubmissions;
 
     // Signal the next fence value (with the GPU)
     m_CommandQueue->Signal(m_pFence, m_NextFenceValue);
@@ -138,20 +153,14 @@ uint64_t CommandQueue::IncrementFence(void)
 
 bool CommandQueue::IsFenceComplete(uint64_t FenceValue)
 {
-    // Avoid querying the fence value by testing against the last one seen.
-    // The max() is to protect against an unlikely race condition that could cause the last
-    // completed fence value to regress.
-    if (FenceValue > m_LastCompletedFenceValue)
-        m_LastCompletedFenceValue = std::max(m_LastCompletedFenceValue, m_pFence->GetCompletedValue());
-
-    return FenceValue <= m_LastCompletedFenceValue;
+    return m_Timeline.IsComplete(FenceValue);
 }
 
-//void CommandQueue::StallForFence(uint64_t FenceValue)
-//{
-//    CommandQueue& Producer = Graphics::g_CommandManager.GetQueue((D3D12_COMMAND_LIST_TYPE)(FenceValue >> 56));
-//    m_CommandQueue->Wait(Producer.m_pFence, FenceValue);
-//}
+void CommandQueue::StallForFence(CommandQueue& Producer, uint64_t FenceValue)
+{
+    ASSERT(FenceValue < Producer.m_NextFenceValue, "The fence value was never signaled");
+    m_CommandQueue->Wait(Producer.m_pFence, FenceValue);
+}
 
 void CommandQueue::StallForProducer(CommandQueue& Producer)
 {
@@ -161,20 +170,7 @@ void CommandQueue::StallForProducer(CommandQueue& Producer)
 
 void CommandQueue::WaitForFence(uint64_t FenceValue)
 {
-    if (IsFenceComplete(FenceValue))
-        return;
-
-    // TODO:  Think about how this might affect a multi-threaded situation.  Suppose thread A
-    // wants to wait for fence 100, then thread B comes along and wants to wait for 99.  If
-    // the fence can only have one event set on completion, then thread B has to wait for 
-    // 100 before it knows 99 is ready.  Maybe insert sequential events?
-    {
-        std::lock_guard<std::mutex> LockGuard(m_EventMutex);
-
-        m_pFence->SetEventOnCompletion(FenceValue, m_FenceEventHandle);
-        WaitForSingleObject(m_FenceEventHandle, INFINITE);
-        m_LastCompletedFenceValue = FenceValue;
-    }
+    m_Timeline.Wait(FenceValue);
 }
 
 void CommandListManager::WaitForFence(uint64_t FenceValue)
@@ -183,11 +179,44 @@ void CommandListManager::WaitForFence(uint64_t FenceValue)
     Producer.WaitForFence(FenceValue);
 }
 
+void CommandListManager::WaitForAllFences(const uint64_t FenceValues[], uint32_t Count)
+{
+    for (uint32_t i = 0; i < Count; ++i)
+        WaitForFence(FenceValues[i]);
+}
+
+uint32_t CommandListManager::WaitForAnyFence(const uint64_t FenceValues[], uint32_t Count)
+{
+    ASSERT(Count <= kMaxWaitAnyFences, "Waiting for %u fences, at most %u", Count, kMaxWaitAnyFences);
+
+    // On the stack, waiting for a frame must not allocate
+    TimelineFence* Timelines[kMaxWaitAnyFences];
+    for (uint32_t i = 0; i < Count; ++i)
+        Timelines[i] = &GetQueue((D3D12_COMMAND_LIST_TYPE)(FenceValues[i] >> 56)).GetTimeline();
+
+    return TimelineFence::WaitAny(Timelines, FenceValues, Count);
+}
+
+uint32_t CommandListManager::RunCompletedCallbacks(void)
+{
+    return m_GraphicsQueue.GetTimeline().RunCompletedCallbacks()
+        + m_ComputeQueue.GetTimeline().RunCompletedCallbacks()
+        + m_CopyQueue.GetTimeline().RunCompletedCallbacks();
+}
+
 ID3D12CommandAllocator* CommandQueue::RequestAllocator()
 {
-    uint64_t CompletedFence = m_pFence->GetCompletedValue();
+    uint64_t CompletedFence = m_Timeline.GetCompletedValue();
+
+    ID3D12CommandAllocator* pAllocator = m_AllocatorPool.RequestAllocator(CompletedFence);
+    while (pAllocator == nullptr)
+    {
+        // The pool is at its high-water mark, wait for the allocator that frees up first
+        WaitForFence(m_AllocatorPool.GetOldestPendingFence());
+        pAllocator = m_AllocatorPool.RequestAllocator(m_Timeline.GetCompletedValue());
+    }
 
-    return m_AllocatorPool.RequestAllocator(CompletedFence);
+    return pAllocator;
 }
 
 void CommandQueue::DiscardAllocator(uint64_t FenceValue, ID3D12CommandAllocator* Allocator)
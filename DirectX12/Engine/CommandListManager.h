@@ -16,8 +16,16 @@
 #include <vector>
 #include <queue>
 #include <mutex>
+#include <atomic>
 #include <stdint.h>
 #include "CommandAllocatorPool.h"
+#include "D3D12TimelineFence.h"
+
+// Command lists are named after their context in debug and profiling builds only.  The
+// runtime copies every name, naming each context of each frame would allocate.
+#if defined(_DEBUG) || defined(PROFILE)
+#define NAME_COMMAND_LISTS 1
+#endif
 
 class GraphicsCore;
 
@@ -25,6 +33,7 @@ class CommandQueue
 {
     friend class CommandListManager;
     friend class CommandContext;
+    friend class UploadManager;
 
 public:
     CommandQueue(D3D12_COMMAND_LIST_TYPE Type);
@@ -41,7 +50,8 @@ public:
 
     uint64_t IncrementFence(void);
     bool IsFenceComplete(uint64_t FenceValue);
-    //void StallForFence(uint64_t FenceValue);
+    // This queue waits on the GPU until Producer passed FenceValue, the CPU does not wait
+    void StallForFence(CommandQueue& Producer, uint64_t FenceValue);
     void StallForProducer(CommandQueue& Producer);
     void WaitForFence(uint64_t FenceValue);
     void WaitForIdle(void) { WaitForFence(IncrementFence()); }
@@ -50,9 +60,20 @@ public:
 
     uint64_t GetNextFenceValue() { return m_NextFenceValue; }
 
+    // Number of ExecuteCommandLists calls issued on this queue so far
+    uint64_t GetNumSubmissions() const { return m_NumSubmissions; }
+
+    CommandAllocatorPool::Statistics GetAllocatorStatistics() { return m_AllocatorPool.GetStatistics(); }
+
+    // Completed values of this queue's fence, shared by everything that polls it
+    TimelineFence& GetTimeline() { return m_Timeline; }
+
 private:
 
     uint64_t ExecuteCommandList(ID3D12CommandList* List);
+
+    // Closes the lists and submits them in order with one ExecuteCommandLists call and one fence
+    uint64_t ExecuteCommandLists(UINT NumLists, ID3D12CommandList* const* Lists);
     ID3D12CommandAllocator* RequestAllocator(void);
     void DiscardAllocator(uint64_t FenceValueForReset, ID3D12CommandAllocator* Allocator);
 
@@ -62,13 +83,13 @@ private:
 
     CommandAllocatorPool m_AllocatorPool;
     std::mutex m_FenceMutex;
-    std::mutex m_EventMutex;
 
     // Lifetime of these objects is managed by the descriptor cache
     ID3D12Fence* m_pFence;
     uint64_t m_NextFenceValue;
-    uint64_t m_LastCompletedFenceValue;
-    HANDLE m_FenceEventHandle;
+    D3D12TimelineFence m_Timeline;
+
+    std::atomic<uint64_t> m_NumSubmissions;
 
 };
 
@@ -106,7 +127,7 @@ public:
         D3D12_COMMAND_LIST_TYPE Type,
         ID3D12GraphicsCommandList** List,
         ID3D12CommandAllocator** Allocator,
-        const std::wstring ID);
+        const wchar_t* ID);
 
     // Test to see if a fence has already been reached
     bool IsFenceComplete(uint64_t FenceValue)
@@ -117,6 +138,21 @@ public:
     // The CPU will wait for a fence to reach a specified value
     void WaitForFence(uint64_t FenceValue);
 
+    // Waits for fences of any queues, WaitForAnyFence returns the index of a completed one.
+    // WaitForAnyFence takes up to kMaxWaitAnyFences values.
+    static const uint32_t kMaxWaitAnyFences = 16;
+    void WaitForAllFences(const uint64_t FenceValues[], uint32_t Count);
+    uint32_t WaitForAnyFence(const uint64_t FenceValues[], uint32_t Count);
+
+    // Callback runs from RunCompletedCallbacks() once the GPU passed FenceValue, e.g. to free resources.
+    // A lambda capturing a pointer fits inside the std::function and does not allocate, larger ones may.
+    void OnFenceComplete(uint64_t FenceValue, std::function<void()> Callback)
+    {
+        GetQueue(D3D12_COMMAND_LIST_TYPE(FenceValue >> 56)).GetTimeline().OnComplete(FenceValue, std::move(Callback));
+    }
+
+    uint32_t RunCompletedCallbacks(void);
+
     // The CPU will wait for all command queues to empty (so that the GPU is idle)
     void IdleGPU(void)
     {
@@ -0,0 +1,31 @@
+#include "pchDirectX.h"
+#include "D3D12TimelineFence.h"
+
+namespace
+{
+    struct ThreadEvent
+    {
+        HANDLE Handle;
+
+        ThreadEvent() : Handle(CreateEvent(nullptr, FALSE, FALSE, nullptr)) { ASSERT(Handle != NULL); }
+        ~ThreadEvent() { CloseHandle(Handle); }
+    };
+}
+
+uint64_t D3D12TimelineFence::QueryCompletedValue()
+{
+    ASSERT(m_pFence != nullptr);
+    return m_pFence->GetCompletedValue();
+}
+
+void D3D12TimelineFence::WaitForValue(uint64_t Value, uint32_t TimeoutMs)
+{
+    ASSERT(m_pFence != nullptr);
+
+    // A wait that timed out leaves its completion registered, the event may be set early
+    // later on.  TimelineFence checks the value again after every wait.
+    static thread_local ThreadEvent t_Event;
+
+    ASSERT_SUCCEEDED(m_pFence->SetEventOnCompletion(Value, t_Event.Handle));
+    WaitForSingleObject(t_Event.Handle, TimeoutMs == kInfinite ? INFINITE : TimeoutMs);
+}
@@ -0,0 +1,25 @@
+//
+// TimelineFence on an ID3D12Fence.  Waits block on a per-thread event, so
+// several threads can wait on the same fence without serializing on a lock.
+//
+
+#pragma once
+
+#include "TimelineFence.h"
+
+class D3D12TimelineFence : public TimelineFence
+{
+public:
+    explicit D3D12TimelineFence(uint64_t InitialValue) : TimelineFence(InitialValue), m_pFence(nullptr) {}
+
+    // The fence stays owned by the caller
+    void Attach(ID3D12Fence* pFence) { m_pFence = pFence; }
+    void Detach() { m_pFence = nullptr; }
+
+protected:
+    uint64_t QueryCompletedValue() override;
+    void WaitForValue(uint64_t Value, uint32_t TimeoutMs) override;
+
+private:
+    ID3D12Fence* m_pFence;
+};
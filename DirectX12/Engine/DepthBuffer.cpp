@@ -32,6 +32,30 @@ void DepthBuffer::Create(const std::wstring& Name, uint32_t Width, uint32_t Heig
     this->CreateDerivedViews();
 }
 
+void DepthBuffer::Destroy()
+{
+    PixelBuffer::Destroy();
+
+    // Without stencil the read-only stencil views alias the depth views
+    const bool HasStencilViews = this->m_hDSV[2].ptr != this->m_hDSV[0].ptr;
+
+    this->m_core.FreeDescriptor(this->m_hDSV[0], D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+    this->m_core.FreeDescriptor(this->m_hDSV[1], D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+    if (HasStencilViews)
+    {
+        this->m_core.FreeDescriptor(this->m_hDSV[2], D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+        this->m_core.FreeDescriptor(this->m_hDSV[3], D3D12_DESCRIPTOR_HEAP_TYPE_DSV);
+    }
+
+    for (D3D12_CPU_DESCRIPTOR_HANDLE& DSVHandle : this->m_hDSV)
+        DSVHandle.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+
+    this->m_core.FreeDescriptor(this->m_hDepthSRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    this->m_core.FreeDescriptor(this->m_hStencilSRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    this->m_hDepthSRV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+    this->m_hStencilSRV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+}
+
 void DepthBuffer::CreateDerivedViews()
 {
     if (this->m_Format == DXGI_FORMAT_UNKNOWN)
@@ -0,0 +1,81 @@
+//
+// DescriptorFreeList keeps the ranges a DescriptorAllocator got back.  A freed
+// range waits for the fence of the last work that used it, then goes to the
+// free list of its descriptor count, where Acquire() finds it again.
+//
+// The class knows nothing about the heaps or the queues: the caller says which
+// fence values completed and locks.  Once every descriptor count in use has been
+// seen, retiring and acquiring do not allocate.
+//
+
+#pragma once
+
+#include <d3d12.h>
+#include "VectorQueue.h"
+#include <map>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class DescriptorFreeList
+{
+public:
+    // The Count descriptors at Handle are reused once FenceValue completed
+    void Retire(D3D12_CPU_DESCRIPTOR_HANDLE Handle, uint32_t Count, uint64_t FenceValue)
+    {
+        m_RetiredRanges.push_back({ FenceValue, Handle, Count });
+    }
+
+    // Moves the ranges whose fence completed to the free lists.  IsFenceComplete(uint64_t)
+    // is asked in the order the ranges were retired, up to the first one not done.
+    template <typename IsFenceCompleteFn>
+    void ReleaseCompleted(IsFenceCompleteFn&& IsFenceComplete)
+    {
+        while (!m_RetiredRanges.empty() && IsFenceComplete(m_RetiredRanges.front().FenceValue))
+        {
+            const RetiredRange& Range = m_RetiredRanges.front();
+            m_FreeRanges[Range.Count].push_back(Range.Handle);
+            m_RetiredRanges.pop_front();
+        }
+    }
+
+    // A released range of exactly Count descriptors, false if there is none
+    bool Acquire(uint32_t Count, D3D12_CPU_DESCRIPTOR_HANDLE& Handle)
+    {
+        auto FreeList = m_FreeRanges.find(Count);
+        if (FreeList == m_FreeRanges.end() || FreeList->second.empty())
+            return false;
+
+        Handle = FreeList->second.back();
+        FreeList->second.pop_back();
+        return true;
+    }
+
+    void Clear()
+    {
+        m_FreeRanges.clear();
+        m_RetiredRanges.clear();
+    }
+
+    size_t GetNumRetired() const { return m_RetiredRanges.size(); }
+
+    size_t GetNumFree() const
+    {
+        size_t NumFree = 0;
+        for (const auto& FreeList : m_FreeRanges)
+            NumFree += FreeList.second.size();
+        return NumFree;
+    }
+
+private:
+    struct RetiredRange
+    {
+        uint64_t FenceValue;
+        D3D12_CPU_DESCRIPTOR_HANDLE Handle;
+        uint32_t Count;
+    };
+
+    std::map<uint32_t, std::vector<D3D12_CPU_DESCRIPTOR_HANDLE>> m_FreeRanges;    // by descriptor count
+
+    VectorQueue<RetiredRange> m_RetiredRanges;     // in fence order
+};
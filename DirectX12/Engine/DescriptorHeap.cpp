@@ -25,6 +25,13 @@ const uint32_t cNumDescriptorsPerHeap = 256;
 
 void DescriptorAllocatorStatics::DestroyAll()
 {
+    for (auto& Heap : m_DescriptorHeapPool)
+    {
+        const D3D12_DESCRIPTOR_HEAP_DESC Desc = Heap->GetDesc();
+        this->m_core.m_MemoryStatistics.OnFree(kMemoryDescriptorAllocatorHeaps,
+            uint64_t(Desc.NumDescriptors) * this->m_core.m_pDevice->GetDescriptorHandleIncrementSize(Desc.Type));
+    }
+
     m_DescriptorHeapPool.clear();
 }
 
@@ -41,11 +48,29 @@ ID3D12DescriptorHeap* DescriptorAllocatorStatics::RequestNewHeap(D3D12_DESCRIPTO
     Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> pHeap;
     ASSERT_SUCCEEDED(this->m_core.m_pDevice->CreateDescriptorHeap(&Desc, MY_IID_PPV_ARGS(&pHeap)));
     m_DescriptorHeapPool.emplace_back(pHeap);
+
+    this->m_core.m_MemoryStatistics.OnAllocate(kMemoryDescriptorAllocatorHeaps,
+        uint64_t(cNumDescriptorsPerHeap) * this->m_core.m_pDevice->GetDescriptorHandleIncrementSize(Type));
     return pHeap.Get();
 }
 
+void DescriptorAllocator::ReleaseCompletedRanges()
+{
+    CommandListManager& CommandManager = *this->m_descriptorAllocatorStatics.m_core.m_pCommandManager;
+
+    m_FreeList.ReleaseCompleted([&CommandManager](uint64_t FenceValue) { return CommandManager.IsFenceComplete(FenceValue); });
+}
+
 D3D12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::Allocate( uint32_t Count )
 {
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    ReleaseCompletedRanges();
+
+    D3D12_CPU_DESCRIPTOR_HANDLE ret;
+    if (m_FreeList.Acquire(Count, ret))
+        return ret;
+
     if (m_CurrentHeap == nullptr || m_RemainingFreeHandles < Count)
     {
         m_CurrentHeap = this->m_descriptorAllocatorStatics.RequestNewHeap(m_Type);
@@ -56,12 +81,26 @@ D3D12_CPU_DESCRIPTOR_HANDLE DescriptorAllocator::Allocate( uint32_t Count )
             m_DescriptorSize = this->m_descriptorAllocatorStatics.m_core.m_pDevice->GetDescriptorHandleIncrementSize(m_Type);
     }
 
-    D3D12_CPU_DESCRIPTOR_HANDLE ret = m_CurrentHandle;
+    ret = m_CurrentHandle;
     m_CurrentHandle.ptr += Count * m_DescriptorSize;
     m_RemainingFreeHandles -= Count;
     return ret;
 }
 
+void DescriptorAllocator::Free( D3D12_CPU_DESCRIPTOR_HANDLE Handle, uint32_t Count, uint64_t FenceValue )
+{
+    if (Handle.ptr == D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN)
+        return;
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    // After Reset() the heaps are gone, nothing to give back
+    if (m_CurrentHeap == nullptr)
+        return;
+
+    m_FreeList.Retire(Handle, Count, FenceValue);
+}
+
 //
 // UserDescriptorHeap implementation
 //
@@ -13,9 +13,9 @@
 
 #pragma once
 
+#include "DescriptorFreeList.h"
 #include <mutex>
 #include <vector>
-#include <queue>
 #include <string>
 
 class GraphicsCore;
@@ -39,6 +39,9 @@ public:
 // This is an unbounded resource descriptor allocator.  It is intended to provide space for CPU-visible resource descriptors
 // as resources are created.  For those that need to be made shader-visible, they will need to be copied to a UserDescriptorHeap
 // or a DynamicDescriptorHeap.
+//
+// Freed ranges are kept in free lists by their descriptor count and handed out again once the GPU passed the fence
+// given to Free, so recreating resources of the same kind does not grow the heap pool.
 class DescriptorAllocator
 {
 public:
@@ -53,13 +56,23 @@ public:
 
     D3D12_CPU_DESCRIPTOR_HANDLE Allocate( uint32_t Count );
 
+    // The Count descriptors at Handle are reused after the GPU completed FenceValue (encoded as by CommandListManager)
+    void Free( D3D12_CPU_DESCRIPTOR_HANDLE Handle, uint32_t Count, uint64_t FenceValue );
+
     void Reset()
     {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
         m_CurrentHeap = nullptr;
         m_CurrentHandle = { 0 };
+        m_RemainingFreeHandles = 0;
+        m_FreeList.Clear();
     }
 
 protected:
+    // Requires m_Mutex to be held
+    void ReleaseCompletedRanges();
+
     DescriptorAllocatorStatics& m_descriptorAllocatorStatics;
 
     D3D12_DESCRIPTOR_HEAP_TYPE m_Type;
@@ -67,6 +80,9 @@ protected:
     D3D12_CPU_DESCRIPTOR_HANDLE m_CurrentHandle;
     uint32_t m_DescriptorSize;
     uint32_t m_RemainingFreeHandles;
+
+    std::mutex m_Mutex;
+    DescriptorFreeList m_FreeList;
 };
 
 
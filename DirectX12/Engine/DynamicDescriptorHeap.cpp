@@ -22,6 +22,20 @@
 // DynamicDescriptorHeap Implementation
 //
 
+void DynamicDescriptorHeapStatics::Destroy()
+{
+    for (auto& Pool : this->m_DescriptorHeapPool)
+    {
+        for (auto& Heap : Pool)
+        {
+            const D3D12_DESCRIPTOR_HEAP_DESC Desc = Heap->GetDesc();
+            this->m_core.m_MemoryStatistics.OnFree(kMemoryDynamicDescriptorHeaps,
+                uint64_t(Desc.NumDescriptors) * this->m_core.m_pDevice->GetDescriptorHandleIncrementSize(Desc.Type));
+        }
+        Pool.clear();
+    }
+}
+
 ID3D12DescriptorHeap* DynamicDescriptorHeapStatics::RequestDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE HeapType)
 {
     std::lock_guard<std::mutex> LockGuard(this->m_Mutex);
@@ -50,6 +64,9 @@ ID3D12DescriptorHeap* DynamicDescriptorHeapStatics::RequestDescriptorHeap(D3D12_
         Microsoft::WRL::ComPtr<ID3D12DescriptorHeap> HeapPtr;
         ASSERT_SUCCEEDED(this->m_core.m_pDevice->CreateDescriptorHeap(&HeapDesc, MY_IID_PPV_ARGS(&HeapPtr)));
         m_DescriptorHeapPool[idx].emplace_back(HeapPtr);
+
+        this->m_core.m_MemoryStatistics.OnAllocate(kMemoryDynamicDescriptorHeaps,
+            uint64_t(kNumDescriptorsPerHeap) * this->m_core.m_pDevice->GetDescriptorHandleIncrementSize(HeapType));
         return HeapPtr.Get();
     }
 }
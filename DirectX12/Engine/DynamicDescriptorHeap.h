@@ -41,11 +41,7 @@ public:
     ID3D12DescriptorHeap* RequestDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE HeapType);
     void DiscardDescriptorHeaps(D3D12_DESCRIPTOR_HEAP_TYPE HeapType, uint64_t FenceValueForReset, const std::vector<ID3D12DescriptorHeap*>& UsedHeaps);
 
-    void Destroy()
-    {
-        m_DescriptorHeapPool[0].clear();
-        m_DescriptorHeapPool[1].clear();
-    }
+    void Destroy();
 };
 
 // This class is a linear allocation system for dynamically generated descriptor tables.  It internally caches
@@ -0,0 +1,77 @@
+#include "pchDirectX.h"
+#include "FrameConstantRing.h"
+#include "GraphicsCore.h"
+
+FrameConstantRing::FrameConstantRing(GraphicsCore& core) :
+    m_Core(core),
+    m_CpuBase(nullptr),
+    m_GpuBase(0)
+{
+}
+
+FrameConstantRing::~FrameConstantRing()
+{
+    Destroy();
+}
+
+void FrameConstantRing::Create()
+{
+    ASSERT(m_pResource == nullptr);
+
+    const size_t BufferSize = kSliceSize * FrameFenceRing::MAX_FRAMES_IN_FLIGHT;
+
+    const CD3DX12_HEAP_PROPERTIES HeapProps(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC ResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(BufferSize);
+
+    ASSERT_SUCCEEDED(m_Core.m_pDevice->CreateCommittedResource(&HeapProps, D3D12_HEAP_FLAG_NONE,
+        &ResourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, MY_IID_PPV_ARGS(m_pResource.GetAddressOf())));
+    m_pResource->SetName(L"FrameConstantRing");
+
+    // Upload heaps may stay mapped for their whole lifetime
+    ASSERT_SUCCEEDED(m_pResource->Map(0, nullptr, reinterpret_cast<void**>(&m_CpuBase)));
+    m_GpuBase = m_pResource->GetGPUVirtualAddress();
+    m_Slices.Reset(kSliceSize, FrameFenceRing::MAX_FRAMES_IN_FLIGHT, kAlignment);
+
+    m_Core.m_MemoryStatistics.OnAllocate(kMemoryFrameConstantRing, BufferSize);
+}
+
+void FrameConstantRing::Destroy()
+{
+    if (m_pResource == nullptr)
+        return;
+
+    m_Core.m_MemoryStatistics.OnFree(kMemoryFrameConstantRing, kSliceSize * FrameFenceRing::MAX_FRAMES_IN_FLIGHT);
+
+    m_pResource->Unmap(0, nullptr);
+    m_pResource = nullptr;
+    m_CpuBase = nullptr;
+    m_GpuBase = 0;
+}
+
+void FrameConstantRing::BeginFrame(uint32_t FrameIndex)
+{
+    m_Slices.BeginFrame(FrameIndex);
+}
+
+ConstantAllocation FrameConstantRing::Allocate(size_t SizeInBytes)
+{
+    ConstantAllocation Allocation;
+
+    size_t Offset;
+    if (m_CpuBase == nullptr || !m_Slices.Allocate(SizeInBytes, Offset))
+        return Allocation;
+
+    Allocation.CpuAddress = m_CpuBase + Offset;
+    Allocation.GpuAddress = m_GpuBase + Offset;
+    return Allocation;
+}
+
+D3D12_GPU_VIRTUAL_ADDRESS FrameConstantRing::Upload(const void* Data, size_t SizeInBytes)
+{
+    const ConstantAllocation Allocation = Allocate(SizeInBytes);
+    if (!Allocation.IsValid())
+        return 0;
+
+    memcpy(Allocation.CpuAddress, Data, SizeInBytes);
+    return Allocation.GpuAddress;
+}
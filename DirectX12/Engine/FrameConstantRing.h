@@ -0,0 +1,61 @@
+//
+// Persistently mapped upload buffer for constants, split into one slice per
+// frame in flight.  BeginFrame() selects the slice of the frame slot whose fence
+// was just waited on (see FrameFenceRing), Allocate() carves constants out of it
+// with a single atomic add, so any number of threads can write constants for
+// thousands of draws without locks, page requests or retired pages.  The offsets
+// come from a FrameSliceRing, which runs without a device.
+//
+// Constants written in frame N stay valid until the slot comes around again.
+//
+
+#pragma once
+
+#include "FrameFenceRing.h"
+#include "FrameSliceRing.h"
+
+class GraphicsCore;
+
+struct ConstantAllocation
+{
+    void* CpuAddress = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS GpuAddress = 0;
+
+    bool IsValid() const { return CpuAddress != nullptr; }
+};
+
+class FrameConstantRing
+{
+public:
+    static const size_t kSliceSize = 1024 * 1024;
+    static const size_t kAlignment = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT;
+
+    FrameConstantRing(GraphicsCore& core);
+    ~FrameConstantRing();
+
+    FrameConstantRing(const FrameConstantRing&) = delete;
+    FrameConstantRing& operator=(const FrameConstantRing&) = delete;
+
+    void Create();
+    void Destroy();
+
+    // The GPU must be done with the previous frame that used FrameIndex
+    void BeginFrame(uint32_t FrameIndex);
+
+    // Returns an invalid allocation when the slice of the frame is exhausted
+    ConstantAllocation Allocate(size_t SizeInBytes);
+
+    // Copies the data into the ring and returns its GPU address, or 0 when the slice is exhausted
+    D3D12_GPU_VIRTUAL_ADDRESS Upload(const void* Data, size_t SizeInBytes);
+
+    size_t GetBytesUsed() const { return m_Slices.GetBytesUsed(); }
+
+private:
+    GraphicsCore& m_Core;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_pResource;
+    uint8_t* m_CpuBase;
+    D3D12_GPU_VIRTUAL_ADDRESS m_GpuBase;
+
+    FrameSliceRing m_Slices;
+};
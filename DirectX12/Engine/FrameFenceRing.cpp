@@ -0,0 +1,51 @@
+#include "pchDirectX.h"
+#include "FrameFenceRing.h"
+
+#include <algorithm>
+
+FrameFenceRing::FrameFenceRing(uint32_t NumFramesInFlight) :
+    m_NumFramesInFlight(1),
+    m_FrameIndex(0),
+    m_FrameNumber(0),
+    m_LastSubmittedFence(0)
+{
+    SetNumFramesInFlight(NumFramesInFlight);
+}
+
+void FrameFenceRing::SetNumFramesInFlight(uint32_t NumFramesInFlight)
+{
+    ASSERT(NumFramesInFlight >= 1 && NumFramesInFlight <= MAX_FRAMES_IN_FLIGHT,
+        "Frames in flight must be between 1 and %u", MAX_FRAMES_IN_FLIGHT);
+
+    m_NumFramesInFlight = std::clamp(NumFramesInFlight, 1u, MAX_FRAMES_IN_FLIGHT);
+
+    Reset();
+}
+
+uint64_t FrameFenceRing::BeginFrame()
+{
+    // The very first frame starts on slot 0, later frames move on by one.
+    if (m_FrameNumber > 0)
+        m_FrameIndex = (m_FrameIndex + 1) % m_NumFramesInFlight;
+
+    ++m_FrameNumber;
+
+    return m_FenceValues[m_FrameIndex];
+}
+
+void FrameFenceRing::EndFrame(uint64_t FenceValue)
+{
+    ASSERT(FenceValue >= m_FenceValues[m_FrameIndex], "Fence values of a frame slot must not go backwards");
+
+    m_FenceValues[m_FrameIndex] = FenceValue;
+    m_LastSubmittedFence = std::max(m_LastSubmittedFence, FenceValue);
+}
+
+void FrameFenceRing::Reset()
+{
+    for (uint32_t i = 0; i < MAX_FRAMES_IN_FLIGHT; ++i)
+        m_FenceValues[i] = 0;
+
+    m_FrameIndex = 0;
+    m_FrameNumber = 0;
+}
@@ -0,0 +1,51 @@
+//
+// FrameFenceRing keeps one fence value per frame in flight.  The CPU may
+// record frame N while the GPU is still working on frames N-1 .. N-k; it only
+// has to block when it wants to reuse the slot (and the per-frame resources
+// that belong to it) of a frame that has not yet retired.
+//
+// The class only does the bookkeeping; it knows nothing about D3D12.  The
+// caller waits for the value returned by BeginFrame() and hands the fence of
+// the submitted frame to EndFrame().  That keeps the policy usable without a
+// device.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+class FrameFenceRing
+{
+public:
+    static constexpr uint32_t MAX_FRAMES_IN_FLIGHT = 3;
+
+    explicit FrameFenceRing(uint32_t NumFramesInFlight = 2);
+
+    // Changes the depth of the ring.  All slots are forgotten, so the caller
+    // has to make sure the GPU is idle (Resize() does so anyway).
+    void SetNumFramesInFlight(uint32_t NumFramesInFlight);
+    uint32_t GetNumFramesInFlight() const { return m_NumFramesInFlight; }
+
+    // Advances to the next slot and returns the fence value that has to be
+    // complete before the slot may be reused.  0 means "nothing to wait for".
+    uint64_t BeginFrame();
+
+    // Stores the fence value signaled by the submission of the current frame.
+    void EndFrame(uint64_t FenceValue);
+
+    // Forgets all outstanding fences, e.g. after the GPU was idled.
+    void Reset();
+
+    uint32_t GetFrameIndex() const { return m_FrameIndex; }
+    uint64_t GetFrameNumber() const { return m_FrameNumber; }
+
+    // Highest fence value handed to EndFrame()
+    uint64_t GetLastSubmittedFence() const { return m_LastSubmittedFence; }
+
+private:
+    uint64_t m_FenceValues[MAX_FRAMES_IN_FLIGHT];
+    uint32_t m_NumFramesInFlight;
+    uint32_t m_FrameIndex;
+    uint64_t m_FrameNumber;
+    uint64_t m_LastSubmittedFence;
+};
@@ -0,0 +1,42 @@
+#include "pchDirectX.h"
+#include "FrameSliceRing.h"
+
+FrameSliceRing::FrameSliceRing() :
+    m_SliceSize(0),
+    m_NumSlices(0),
+    m_Alignment(1),
+    m_SliceBegin(0),
+    m_Offset(0)
+{
+}
+
+void FrameSliceRing::Reset(size_t SliceSize, uint32_t NumSlices, size_t Alignment)
+{
+    ASSERT(Alignment > 0 && SliceSize % Alignment == 0);
+
+    m_SliceSize = SliceSize;
+    m_NumSlices = NumSlices;
+    m_Alignment = Alignment;
+    m_SliceBegin = 0;
+    m_Offset.store(0, std::memory_order_relaxed);
+}
+
+void FrameSliceRing::BeginFrame(uint32_t FrameIndex)
+{
+    ASSERT(FrameIndex < m_NumSlices);
+
+    m_SliceBegin = FrameIndex * m_SliceSize;
+    m_Offset.store(0, std::memory_order_relaxed);
+}
+
+bool FrameSliceRing::Allocate(size_t SizeInBytes, size_t& Offset)
+{
+    const size_t AlignedSize = (SizeInBytes + m_Alignment - 1) / m_Alignment * m_Alignment;
+    const size_t SliceOffset = m_Offset.fetch_add(AlignedSize, std::memory_order_relaxed);
+
+    if (SliceOffset + AlignedSize > m_SliceSize)
+        return false;
+
+    Offset = m_SliceBegin + SliceOffset;
+    return true;
+}
@@ -0,0 +1,45 @@
+//
+// FrameSliceRing does the bookkeeping of the FrameConstantRing: the buffer is
+// split into one slice per frame in flight, BeginFrame() selects the slice of
+// the frame slot and Allocate() bumps an offset through it with a single atomic
+// add, so any number of threads may allocate at once.
+//
+// The class knows nothing about D3D12.  A slice is only safe to reuse once the
+// fence of the frame that used it last completed; the caller waits for the value
+// FrameFenceRing::BeginFrame() returns before it calls BeginFrame() here.
+//
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+
+class FrameSliceRing
+{
+public:
+    FrameSliceRing();
+
+    // All slices are free again, the GPU must be done with them
+    void Reset(size_t SliceSize, uint32_t NumSlices, size_t Alignment);
+
+    // Starts allocating from the beginning of the slice of FrameIndex
+    void BeginFrame(uint32_t FrameIndex);
+
+    // Stores the offset of SizeInBytes in the buffer in Offset.  Returns false when
+    // the slice of the frame is exhausted.  May be called from any thread.
+    bool Allocate(size_t SizeInBytes, size_t& Offset);
+
+    // Bytes requested in the current frame, failed requests included
+    size_t GetBytesUsed() const { return m_Offset.load(std::memory_order_relaxed); }
+
+    size_t GetSize() const { return m_SliceSize * m_NumSlices; }
+
+private:
+    size_t m_SliceSize;
+    uint32_t m_NumSlices;
+    size_t m_Alignment;
+
+    size_t m_SliceBegin;
+    std::atomic<size_t> m_Offset;
+};
@@ -82,6 +82,21 @@ void GpuBuffer::CreatePlaced(const std::wstring& name, ID3D12Heap* pBackingHeap,
 
 }
 
+void GpuBuffer::Destroy()
+{
+    GpuResource::Destroy();
+
+    this->m_core.FreeDescriptor(this->m_UAV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+    this->m_core.FreeDescriptor(this->m_SRV, D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV);
+
+    this->m_BufferSize = 0;
+    this->m_ElementCount = 0;
+    this->m_ElementSize = 0;
+    this->m_ResourceFlags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
+    this->m_UAV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+    this->m_SRV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
+}
+
 //void GpuBuffer::Create(const std::wstring& name, uint32_t NumElements, uint32_t ElementSize,
 //    EsramAllocator&, const void* initialData)
 //{
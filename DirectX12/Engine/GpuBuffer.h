@@ -39,17 +39,8 @@ public:
     void CreatePlaced(const std::wstring& name, ID3D12Heap* pBackingHeap, uint32_t HeapOffset, uint32_t NumElements, uint32_t ElementSize,
         const void* initialData = nullptr);
 
-    void Destroy() override
-    {
-        GpuResource::Destroy();
-
-        this->m_BufferSize = 0;
-        this->m_ElementCount = 0;
-        this->m_ElementSize = 0;
-        this->m_ResourceFlags = D3D12_RESOURCE_FLAG_ALLOW_UNORDERED_ACCESS;
-        this->m_UAV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
-        this->m_SRV.ptr = D3D12_GPU_VIRTUAL_ADDRESS_UNKNOWN;
-    }
+    // Releases the resource and gives the views back to the descriptor allocator
+    void Destroy() override;
 
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetUAV(void) const { return this->m_UAV; }
     const D3D12_CPU_DESCRIPTOR_HANDLE& GetSRV(void) const { return this->m_SRV; }
@@ -0,0 +1,174 @@
+#include "pchDirectX.h"
+#include "GpuHeapAllocator.h"
+#include "GraphicsCore.h"
+#include "CommandListManager.h"
+
+GpuHeapAllocator::GpuHeapAllocator(GraphicsCore& core, D3D12_HEAP_TYPE HeapType, D3D12_HEAP_FLAGS HeapFlags) :
+    m_Core(core),
+    m_HeapType(HeapType),
+    m_HeapFlags(HeapFlags)
+{
+}
+
+GpuHeapAllocator::~GpuHeapAllocator()
+{
+    Destroy();
+}
+
+uint32_t GpuHeapAllocator::CreateHeap(uint64_t HeapSize)
+{
+    CD3DX12_HEAP_DESC HeapDesc(HeapSize, m_HeapType, 0, m_HeapFlags);
+
+    Microsoft::WRL::ComPtr<ID3D12Heap> D3DHeap;
+    ASSERT_SUCCEEDED(m_Core.m_pDevice->CreateHeap(&HeapDesc, MY_IID_PPV_ARGS(D3DHeap.GetAddressOf())));
+    D3DHeap->SetName(L"GpuHeapAllocator Heap");
+
+    m_Core.m_MemoryStatistics.OnAllocate(kMemoryBufferHeaps, HeapSize);
+
+    Heap NewHeap = { D3DHeap, new BuddyAllocator(HeapSize, kMinBlockSize) };
+
+    // Reuse the slot of a released heap, so the indices of live allocations stay valid
+    for (uint32_t i = 0; i < m_Heaps.size(); ++i)
+    {
+        if (m_Heaps[i].Allocator == nullptr)
+        {
+            m_Heaps[i] = NewHeap;
+            return i;
+        }
+    }
+
+    m_Heaps.push_back(NewHeap);
+    return static_cast<uint32_t>(m_Heaps.size() - 1);
+}
+
+void GpuHeapAllocator::ReleaseCompletedFrees()
+{
+    CommandListManager& CommandManager = *m_Core.m_pCommandManager;
+
+    for (uint32_t i = 0; i < m_Heaps.size(); ++i)
+    {
+        Heap& heap = m_Heaps[i];
+        if (heap.Allocator == nullptr)
+            continue;
+
+        if (heap.Allocator->ReleaseCompleted([&CommandManager](uint64_t FenceValue) { return CommandManager.IsFenceComplete(FenceValue); }) == 0)
+            continue;
+
+        // Keep the first heap around, others go when they are empty
+        if (i > 0 && heap.Allocator->IsEmpty())
+        {
+            m_Core.m_MemoryStatistics.OnFree(kMemoryBufferHeaps, heap.Allocator->GetTotalSize());
+            delete heap.Allocator;
+            heap.Allocator = nullptr;
+            heap.D3DHeap = nullptr;
+        }
+    }
+}
+
+GpuHeapAllocation GpuHeapAllocator::Allocate(uint64_t Size, uint64_t Alignment)
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    ReleaseCompletedFrees();
+
+    GpuHeapAllocation Allocation;
+
+    if (Size <= kHeapSize && Alignment <= kHeapSize)
+    {
+        for (uint32_t i = 0; i < m_Heaps.size() && !Allocation.IsValid(); ++i)
+        {
+            Heap& heap = m_Heaps[i];
+            if (heap.Allocator == nullptr || heap.Allocator->GetTotalSize() != kHeapSize)
+                continue;
+
+            const uint64_t Offset = heap.Allocator->Allocate(Size, Alignment);
+            if (Offset != BuddyAllocator::kInvalidOffset)
+            {
+                Allocation.Heap = heap.D3DHeap.Get();
+                Allocation.Offset = Offset;
+                Allocation.HeapIndex = i;
+            }
+        }
+    }
+
+    if (!Allocation.IsValid())
+    {
+        // A fresh shared heap, or a dedicated one for buffers that do not fit into a shared heap
+        uint64_t HeapSize = kHeapSize;
+        while (HeapSize < Size || HeapSize < Alignment)
+            HeapSize <<= 1;
+
+        const uint32_t HeapIndex = CreateHeap(HeapSize);
+        Heap& heap = m_Heaps[HeapIndex];
+
+        Allocation.Heap = heap.D3DHeap.Get();
+        Allocation.Offset = heap.Allocator->Allocate(Size, Alignment);
+        Allocation.HeapIndex = HeapIndex;
+        ASSERT(Allocation.Offset != BuddyAllocator::kInvalidOffset);
+    }
+
+    Allocation.Size = m_Heaps[Allocation.HeapIndex].Allocator->GetAllocationSize(Allocation.Offset);
+    return Allocation;
+}
+
+void GpuHeapAllocator::Free(const GpuHeapAllocation& Allocation, uint64_t FenceValue)
+{
+    if (!Allocation.IsValid())
+        return;
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    ASSERT(Allocation.HeapIndex < m_Heaps.size() && m_Heaps[Allocation.HeapIndex].D3DHeap.Get() == Allocation.Heap);
+    m_Heaps[Allocation.HeapIndex].Allocator->FreeAfterFence(Allocation.Offset, FenceValue);
+}
+
+BuddyAllocator::Statistics GpuHeapAllocator::GetStatistics()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    BuddyAllocator::Statistics Total;
+    for (const Heap& heap : m_Heaps)
+    {
+        if (heap.Allocator == nullptr)
+            continue;
+
+        const BuddyAllocator::Statistics Stats = heap.Allocator->GetStatistics();
+        Total.TotalSize += Stats.TotalSize;
+        Total.AllocatedBytes += Stats.AllocatedBytes;
+        Total.RequestedBytes += Stats.RequestedBytes;
+        Total.FreeBytes += Stats.FreeBytes;
+        Total.PendingFreeBytes += Stats.PendingFreeBytes;
+        Total.NumAllocations += Stats.NumAllocations;
+        Total.NumFreeBlocks += Stats.NumFreeBlocks;
+        if (Stats.LargestFreeBlock > Total.LargestFreeBlock)
+            Total.LargestFreeBlock = Stats.LargestFreeBlock;
+    }
+    return Total;
+}
+
+uint32_t GpuHeapAllocator::GetNumHeaps()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    uint32_t NumHeaps = 0;
+    for (const Heap& heap : m_Heaps)
+    {
+        if (heap.Allocator != nullptr)
+            ++NumHeaps;
+    }
+    return NumHeaps;
+}
+
+void GpuHeapAllocator::Destroy()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    for (Heap& heap : m_Heaps)
+    {
+        if (heap.Allocator != nullptr)
+            m_Core.m_MemoryStatistics.OnFree(kMemoryBufferHeaps, heap.Allocator->GetTotalSize());
+        delete heap.Allocator;
+    }
+
+    m_Heaps.clear();
+}
@@ -0,0 +1,68 @@
+//
+// Places buffers in large shared ID3D12Heaps instead of one heap per buffer.
+// Every heap is split by a BuddyAllocator; buffers larger than a heap get a heap
+// of their own.  Freed blocks become reusable once the GPU passed the fence given
+// to Free.  Empty heaps beyond the first one are released.
+//
+
+#pragma once
+
+#include "BuddyAllocator.h"
+#include <mutex>
+#include <vector>
+
+class GraphicsCore;
+
+struct GpuHeapAllocation
+{
+    ID3D12Heap* Heap = nullptr;
+    uint64_t Offset = 0;
+    uint64_t Size = 0;
+    uint32_t HeapIndex = UINT32_MAX;
+
+    bool IsValid() const { return Heap != nullptr; }
+};
+
+class GpuHeapAllocator
+{
+public:
+    static const uint64_t kHeapSize = 64 * 1024 * 1024;
+    static const uint64_t kMinBlockSize = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+
+    GpuHeapAllocator(GraphicsCore& core, D3D12_HEAP_TYPE HeapType, D3D12_HEAP_FLAGS HeapFlags);
+    ~GpuHeapAllocator();
+
+    GpuHeapAllocator(const GpuHeapAllocator&) = delete;
+    GpuHeapAllocator& operator=(const GpuHeapAllocator&) = delete;
+
+    // Reserves Size bytes at a multiple of Alignment in one of the heaps
+    GpuHeapAllocation Allocate(uint64_t Size, uint64_t Alignment = kMinBlockSize);
+
+    // The block is reused after the GPU completed FenceValue (encoded as by CommandListManager)
+    void Free(const GpuHeapAllocation& Allocation, uint64_t FenceValue);
+
+    // Statistics of all heaps added up, LargestFreeBlock is the largest of any heap
+    BuddyAllocator::Statistics GetStatistics();
+    uint32_t GetNumHeaps();
+
+    // Releases all heaps.  Requires the GPU to be idle and all allocations to be freed.
+    void Destroy();
+
+private:
+    struct Heap
+    {
+        Microsoft::WRL::ComPtr<ID3D12Heap> D3DHeap;
+        BuddyAllocator* Allocator;
+    };
+
+    // Both require m_Mutex to be held
+    void ReleaseCompletedFrees();
+    uint32_t CreateHeap(uint64_t HeapSize);
+
+    GraphicsCore& m_Core;
+    D3D12_HEAP_TYPE m_HeapType;
+    D3D12_HEAP_FLAGS m_HeapFlags;
+
+    std::vector<Heap> m_Heaps;
+    std::mutex m_Mutex;
+};
@@ -59,6 +59,9 @@ public:
 
     D3D12_GPU_VIRTUAL_ADDRESS GetGpuVirtualAddress() const { return this->m_GpuVirtualAddress; }
 
+    // State the resource is in once the barriers recorded so far executed
+    D3D12_RESOURCE_STATES GetUsageState() const { return this->m_UsageState; }
+
 protected:
 
     Microsoft::WRL::ComPtr<ID3D12Resource> m_pResource;
@@ -16,6 +16,14 @@
 #include "GpuTimeManager.h"
 #include "ColorBuffer.h"
 #include "CommandContext.h"
+#include "JobSystem.h"
+#include "TaskScheduler.h"
+#include "GpuHeapAllocator.h"
+#include "FrameConstantRing.h"
+#include "BindlessDescriptorHeap.h"
+#include "PipelineStateCache.h"
+#include "PipelineLibrary.h"
+#include "UploadManager.h"
 
 #if defined(NTDDI_WIN10_RS2) && (NTDDI_VERSION >= NTDDI_WIN10_RS2)
 #include <dxgi1_6.h>
@@ -52,6 +60,17 @@ using namespace Microsoft::WRL;
 
 GraphicsCore* GraphicsCore::s_pCore = nullptr;
 
+// Compiled pipelines are kept per user, the folder of the executable may not be writable
+static std::filesystem::path GetPipelineLibraryPath()
+{
+    wchar_t LocalAppData[MAX_PATH];
+    const DWORD Length = GetEnvironmentVariableW(L"LOCALAPPDATA", LocalAppData, MAX_PATH);
+
+    std::error_code Error;
+    std::filesystem::path Folder = (Length > 0 && Length < MAX_PATH) ? std::filesystem::path(LocalAppData) : std::filesystem::temp_directory_path(Error);
+    return Folder / L"Intel630Bug" / L"PipelineLibrary.bin";
+}
+
 GraphicsCore* GraphicsCore::Reserve(HWND g_hWnd)
 {
     if(s_pCore == nullptr)
@@ -81,8 +100,17 @@ GraphicsCore::GraphicsCore(HWND g_hWnd) :
     m_pCommandManager(new CommandListManager(*this)),
     m_pDynamicDescriptorHeapStatics(new DynamicDescriptorHeapStatics(*this)),
     m_pLinearAllocatorStatics(new LinearAllocatorStatics(*this)),
+    m_pJobSystem(new JobSystem()),
+    m_pTaskScheduler(new TaskScheduler()),
+    m_pBufferHeapAllocator(new GpuHeapAllocator(*this, D3D12_HEAP_TYPE_DEFAULT, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS)),
+    m_pFrameConstants(new FrameConstantRing(*this)),
+    m_pBindlessHeap(new BindlessDescriptorHeap(*this)),
+    m_pUploadManager(new UploadManager(*this)),
+    m_pPipelineStateCache(new PipelineStateCache()),
+    m_pPipelineLibrary(new PipelineLibrary()),
     m_pDisplayPlanes(new ColorBuffer[3 /*SWAP_CHAIN_BUFFER_COUNT*/]{ {*this, DXGI_FORMAT_UNKNOWN}, {*this, DXGI_FORMAT_UNKNOWN}, {*this, DXGI_FORMAT_UNKNOWN} }),
     m_CurrentBufferIndex(0),
+    m_FrameFences(2),
     m_GenerateMipsRS(*this),
     m_pGenerateMipsLinearPSOs(new ComputePSO[4]{ *this, *this, *this, *this }),
     m_pGenerateMipsGammaPSOs( new ComputePSO[4]{ *this, *this, *this, *this }),
@@ -102,6 +130,12 @@ GraphicsCore::GraphicsCore(HWND g_hWnd) :
     this->Initialize(g_hWnd);
 }
 
+void GraphicsCore::FreeDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE Handle, D3D12_DESCRIPTOR_HEAP_TYPE Type, UINT Count)
+{
+    const uint64_t FenceValue = this->m_pCommandManager->GetGraphicsQueue().GetNextFenceValue();
+    this->m_pDescriptorAllocators[Type].Free(Handle, Count, FenceValue);
+}
+
 GraphicsCore::~GraphicsCore()
 {
     delete this->m_pGpuTimeManager;
@@ -111,6 +145,14 @@ GraphicsCore::~GraphicsCore()
     delete this->m_pCommandManager;
     delete this->m_pDynamicDescriptorHeapStatics;
     delete this->m_pLinearAllocatorStatics;
+    delete this->m_pJobSystem;
+    delete this->m_pTaskScheduler;
+    delete this->m_pBufferHeapAllocator;
+    delete this->m_pFrameConstants;
+    delete this->m_pBindlessHeap;
+    delete this->m_pUploadManager;
+    delete this->m_pPipelineStateCache;
+    delete this->m_pPipelineLibrary;
     delete[] this->m_pDisplayPlanes;
     delete[] m_pGenerateMipsLinearPSOs;
     delete[] m_pGenerateMipsGammaPSOs;
@@ -157,6 +199,20 @@ void GraphicsCore::Resize(uint32_t width, uint32_t height)
     m_CurrentBufferIndex = 0;
 
     m_pCommandManager->IdleGPU();
+
+    m_FrameFences.Reset();
+}
+
+void GraphicsCore::SetNumFramesInFlight(uint32_t numFramesInFlight)
+{
+    numFramesInFlight = std::min(numFramesInFlight, SWAP_CHAIN_BUFFER_COUNT);
+
+    if (numFramesInFlight == m_FrameFences.GetNumFramesInFlight())
+        return;
+
+    m_pCommandManager->IdleGPU();
+
+    m_FrameFences.SetNumFramesInFlight(numFramesInFlight);
 }
 
 // D3D12_AUTO_BREADCRUMB_OP Enum To Strings
@@ -469,6 +525,9 @@ void GraphicsCore::Initialize(HWND g_hWnd)
     {
     }
 
+    // Before the first PSO is finalized
+    this->m_pPipelineLibrary->Create(this->m_pDevice, this->m_RecommendedAdapter.Get(), GetPipelineLibraryPath());
+
     // Common state was moved to GraphicsCommon.*
     this->InitializeCommonState();
 
@@ -501,6 +560,10 @@ void GraphicsCore::Initialize(HWND g_hWnd)
     this->m_GpuTimerIndexRendering = this->m_pGpuTimeManager->NewTimer();
     this->m_GpuTimerIndexTexture = this->m_pGpuTimeManager->NewTimer();
     this->m_GpuTimerPipelineQueryIndex = this->m_pGpuTimeManager->NewPipelineQuery();
+
+    this->m_pFrameConstants->Create();
+    this->m_pBindlessHeap->Create();
+    this->m_pUploadManager->Create();
 }
 
 void GraphicsCore::Shutdown(void)
@@ -508,6 +571,9 @@ void GraphicsCore::Shutdown(void)
     this->m_pGpuTimeManager->Shutdown();
     m_pCommandManager->IdleGPU();
 
+    // Deferred deletes may still give memory back to the allocators destroyed below
+    m_pCommandManager->RunCompletedCallbacks();
+
 #if WINAPI_FAMILY_PARTITION(WINAPI_PARTITION_DESKTOP)
     if (m_pSwapChain1 != nullptr)
     {
@@ -517,6 +583,10 @@ void GraphicsCore::Shutdown(void)
 
     this->m_pDynamicDescriptorHeapStatics->Destroy();
     this->m_pLinearAllocatorStatics->DestroyAll();
+    this->m_pBufferHeapAllocator->Destroy();
+    this->m_pFrameConstants->Destroy();
+    this->m_pBindlessHeap->Destroy();
+    this->m_pUploadManager->Destroy();
     m_pContextManager->DestroyAllContexts();
 
     m_pCommandManager->Shutdown();
@@ -527,12 +597,18 @@ void GraphicsCore::Shutdown(void)
     m_pSwapChain1 = nullptr;
 
     // PSO::DestroyAll();
-    this->m_GraphicsPSOHashMap.clear();
-    this->m_ComputePSOHashMap.clear();
+    this->m_pPipelineStateCache->WaitForJobs(*this->m_pJobSystem);
+    this->m_pPipelineLibrary->Save();
+    this->m_pPipelineLibrary->Destroy();
+    this->m_pPipelineStateCache->Clear();
 
     //RootSignature::DestroyAll();
     this->m_RootSignatureHashMap.clear();
 
+    // Gives the descriptors back before the allocators are reset
+    for (UINT i = 0; i < SWAP_CHAIN_BUFFER_COUNT; ++i)
+        m_pDisplayPlanes[i].Destroy();
+
     this->m_pDescriptorAllocatorStatics->DestroyAll();
 
     for (size_t i = 0; i < D3D12_DESCRIPTOR_HEAP_TYPE_NUM_TYPES; i++)
@@ -542,9 +618,6 @@ void GraphicsCore::Shutdown(void)
 
     this->DestroyCommonState();
 
-    for (UINT i = 0; i < SWAP_CHAIN_BUFFER_COUNT; ++i)
-        m_pDisplayPlanes[i].Destroy();
-
 #if defined(_DEBUG)
     ID3D12DebugDevice* debugInterface;
     if (SUCCEEDED(m_pDevice->QueryInterface(&debugInterface)))
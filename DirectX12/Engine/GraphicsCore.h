@@ -24,6 +24,8 @@
 #include "GraphicsCommon.h"
 #include "DynamicDescriptorHeap.h"
 #include "CommandSignature.h"
+#include "FrameFenceRing.h"
+#include "MemoryStatistics.h"
 #include "pchDirectX.h"
 
 class ColorBuffer;
@@ -35,6 +37,14 @@ class LinearAllocatorStatics;
 class ContextManager;
 class CommandListManager;
 class GpuTimeManager;
+class JobSystem;
+class TaskScheduler;
+class GpuHeapAllocator;
+class FrameConstantRing;
+class BindlessDescriptorHeap;
+class PipelineStateCache;
+class PipelineLibrary;
+class UploadManager;
 
 using Microsoft::WRL::ComPtr;
 
@@ -68,6 +78,10 @@ public:
 
     int GetMultiSampleQuality();
 
+    // Number of frames the CPU may record ahead of the GPU, at most SWAP_CHAIN_BUFFER_COUNT.
+    // Idles the GPU, so do not call it every frame.
+    void SetNumFramesInFlight(uint32_t numFramesInFlight);
+
     const unsigned int SWAP_CHAIN_BUFFER_COUNT = 3;
 
     // device
@@ -78,12 +92,32 @@ public:
     CommandListManager* m_pCommandManager = nullptr;
     DynamicDescriptorHeapStatics* m_pDynamicDescriptorHeapStatics = nullptr;
     LinearAllocatorStatics* m_pLinearAllocatorStatics = nullptr;
+    JobSystem* m_pJobSystem = nullptr;
+    TaskScheduler* m_pTaskScheduler = nullptr;
+
+    // Placed buffers (vertex buffers) share the heaps of this allocator
+    GpuHeapAllocator* m_pBufferHeapAllocator = nullptr;
+
+    // Constants of the frames in flight, one slice per slot of m_FrameFences
+    FrameConstantRing* m_pFrameConstants = nullptr;
+
+    // Shader-visible views with stable indices, bound once instead of copied per draw
+    BindlessDescriptorHeap* m_pBindlessHeap = nullptr;
+
+    // Buffer data uploaded on the copy queue, consumers wait for its tokens on the GPU
+    UploadManager* m_pUploadManager = nullptr;
     
     // Swap Chain Buffers
     IDXGISwapChain1* m_pSwapChain1 = nullptr;
     ColorBuffer* m_pDisplayPlanes;
     UINT m_CurrentBufferIndex;
 
+    // One fence per frame in flight
+    FrameFenceRing m_FrameFences;
+
+    // Bytes held by the allocators, per category
+    MemoryStatistics m_MemoryStatistics;
+
     // root signature and pso for mip map calculation
     RootSignature m_GenerateMipsRS;
     ComputePSO* m_pGenerateMipsLinearPSOs;
@@ -102,12 +136,15 @@ public:
         return m_pDescriptorAllocators[Type].Allocate(Count);
     }
 
+    // The descriptors are reused once the GPU finished the work submitted so far
+    void FreeDescriptor(D3D12_CPU_DESCRIPTOR_HANDLE Handle, D3D12_DESCRIPTOR_HEAP_TYPE Type, UINT Count = 1);
+
     uint32_t m_DisplayWidth;
     uint32_t m_DisplayHeight;
 
-    // PSO Statics
-    std::map< size_t, ComPtr<ID3D12PipelineState> > m_GraphicsPSOHashMap;
-    std::map< size_t, ComPtr<ID3D12PipelineState> > m_ComputePSOHashMap;
+    // PSO Statics, shared by all PSOs with the same description
+    PipelineStateCache* m_pPipelineStateCache = nullptr;
+    PipelineLibrary* m_pPipelineLibrary = nullptr;
     std::mutex m_HashMapMutex;
 
     // root signature statics
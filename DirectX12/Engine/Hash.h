@@ -12,49 +12,90 @@
 
 #pragma once
 
-#include "Math/Common.h"
+#include <stdint.h>
+#include <string.h>
 
-// This requires SSE4.2 which is present on Intel Nehalem (Nov. 2008)
-// and AMD Bulldozer (Oct. 2011) processors.  I could put a runtime
-// check for this, but I'm just going to assume people playing with
-// DirectX 12 on Windows 10 have fairly recent machines.
-#ifdef _M_X64
-#define ENABLE_SSE_CRC32 1
-#else
-#define ENABLE_SSE_CRC32 0
-#endif
-
-#if ENABLE_SSE_CRC32
-#pragma intrinsic(_mm_crc32_u32)
-#pragma intrinsic(_mm_crc32_u64)
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_ARM64))
+#include <intrin.h>
 #endif
 
 namespace Utility
 {
+    namespace HashDetail
+    {
+        static const uint64_t kSecret0 = 0xA0761D6478BD642FULL;
+        static const uint64_t kSecret1 = 0xE7037ED1A0B428DBULL;
+        static const uint64_t kSecret2 = 0x8EBC6AF09C88C6E3ULL;
+
+        // Full 64 x 64 -> 128 bit multiply, folded back to 64 bits.  Every input bit
+        // reaches every output bit, one multiply mixes as much as several rounds of
+        // shifts and xors.
+        inline uint64_t Mix(uint64_t A, uint64_t B)
+        {
+#if defined(_MSC_VER) && defined(_M_X64)
+            uint64_t High;
+            const uint64_t Low = _umul128(A, B, &High);
+            return Low ^ High;
+#elif defined(_MSC_VER) && defined(_M_ARM64)
+            return (A * B) ^ __umulh(A, B);
+#elif defined(__SIZEOF_INT128__)
+            const unsigned __int128 Product = static_cast<unsigned __int128>(A) * B;
+            return static_cast<uint64_t>(Product) ^ static_cast<uint64_t>(Product >> 64);
+#else
+            // 32-bit targets, assembled from four 32 x 32 -> 64 bit multiplies
+            const uint64_t LoLo = (A & 0xFFFFFFFF) * (B & 0xFFFFFFFF);
+            const uint64_t HiLo = (A >> 32) * (B & 0xFFFFFFFF);
+            const uint64_t LoHi = (A & 0xFFFFFFFF) * (B >> 32);
+            const uint64_t HiHi = (A >> 32) * (B >> 32);
+            const uint64_t Cross = (LoLo >> 32) + (HiLo & 0xFFFFFFFF) + LoHi;
+            const uint64_t Low = (Cross << 32) | (LoLo & 0xFFFFFFFF);
+            const uint64_t High = HiHi + (HiLo >> 32) + (Cross >> 32);
+            return Low ^ High;
+#endif
+        }
+
+        inline uint64_t Read64(const uint32_t* Words)
+        {
+            uint64_t Value;
+            memcpy(&Value, Words, sizeof(Value));
+            return Value;
+        }
+    }
+
+    // 64-bit hash of a word range in the spirit of wyhash.  Ranges hashed here are
+    // state descriptions of a few hundred bytes, too short for the SIMD accumulators
+    // of xxh3 to pay off; two independent lanes keep both multipliers busy instead.
+    // Hash seeds the result, so ranges can be hashed one after the other.
     inline size_t HashRange(const uint32_t* const Begin, const uint32_t* const End, size_t Hash)
     {
-#if ENABLE_SSE_CRC32
-        const uint64_t* Iter64 = (const uint64_t*)Math::AlignUp(Begin, 8);
-        const uint64_t* const End64 = (const uint64_t* const)Math::AlignDown(End, 8);
+        using namespace HashDetail;
 
-        // If not 64-bit aligned, start with a single u32
-        if ((uint32_t*)Iter64 > Begin)
-            Hash = _mm_crc32_u32((uint32_t)Hash, *Begin);
+        const size_t NumWords = static_cast<size_t>(End - Begin);
+        const uint32_t* Iter = Begin;
+        uint64_t Seed = static_cast<uint64_t>(Hash) ^ kSecret0;
 
-        // Iterate over consecutive u64 values
-        while (Iter64 < End64)
-            Hash = _mm_crc32_u64((uint64_t)Hash, *Iter64++);
+        if (NumWords >= 8)
+        {
+            uint64_t Lane0 = Seed;
+            uint64_t Lane1 = Seed ^ kSecret2;
+            for (; End - Iter >= 8; Iter += 8)
+            {
+                Lane0 = Mix(Read64(Iter + 0) ^ kSecret1, Read64(Iter + 2) ^ Lane0);
+                Lane1 = Mix(Read64(Iter + 4) ^ kSecret1, Read64(Iter + 6) ^ Lane1);
+            }
+            Seed = Lane0 ^ Lane1;
+        }
 
-        // If there is a 32-bit remainder, accumulate that
-        if ((uint32_t*)Iter64 < End)
-            Hash = _mm_crc32_u32((uint32_t)Hash, *(uint32_t*)Iter64);
-#else
-        // An inexpensive hash for CPUs lacking SSE4.2
-        for (const uint32_t* Iter = Begin; Iter < End; ++Iter)
-            Hash = 16777619U * Hash ^ *Iter;
-#endif
+        for (; End - Iter >= 4; Iter += 4)
+            Seed = Mix(Read64(Iter) ^ kSecret1, Read64(Iter + 2) ^ Seed);
+
+        // The last one to three words, the length below tells apart ranges that only differ in trailing zeros
+        uint64_t Tail[2] = { 0, 0 };
+        if (Iter < End)
+            memcpy(Tail, Iter, static_cast<size_t>(End - Iter) * sizeof(uint32_t));
+        Seed = Mix(Tail[0] ^ kSecret1, Tail[1] ^ Seed);
 
-        return Hash;
+        return static_cast<size_t>(Mix(Seed ^ kSecret1, static_cast<uint64_t>(NumWords) ^ kSecret2));
     }
 
     template <typename T> inline size_t HashState( const T* StateDesc, size_t Count = 1, size_t Hash = 2166136261U )
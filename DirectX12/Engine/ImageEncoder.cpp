@@ -0,0 +1,593 @@
+#include "pchDirectX.h"
+#include "ImageEncoder.h"
+
+#include <algorithm>
+#include <string.h>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__SSE2__)
+#include <emmintrin.h>
+#define IMAGE_ENCODER_SSE2 1
+#endif
+
+namespace
+{
+    // Conversion of one pixel, also the tail of the SSE2 loops.  Pixels are little endian words.
+    inline uint32_t SwapRedBlue(uint32_t Pixel)
+    {
+        return (Pixel & 0xFF00FF00) | ((Pixel >> 16) & 0xFF) | ((Pixel & 0xFF) << 16);
+    }
+
+    inline uint32_t Unpack1010102(uint32_t Pixel)
+    {
+        // 10 bit channels keep their upper 8 bits, the 2 bit alpha is repeated to 8 bits
+        const uint32_t Alpha = (Pixel >> 6) & 0x03000000;
+        return ((Pixel >> 2) & 0xFF) | ((Pixel >> 4) & 0xFF00) | ((Pixel >> 6) & 0xFF0000) |
+            Alpha | (Alpha << 2) | (Alpha << 4) | (Alpha << 6);
+    }
+
+    void ConvertRowBgra(const uint32_t* Source, uint32_t* Dest, uint32_t Width)
+    {
+        uint32_t x = 0;
+
+#ifdef IMAGE_ENCODER_SSE2
+        const __m128i GreenAlpha = _mm_set1_epi32(static_cast<int>(0xFF00FF00));
+        const __m128i Low = _mm_set1_epi32(0xFF);
+
+        for (; x + 4 <= Width; x += 4)
+        {
+            const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + x));
+            const __m128i Red = _mm_and_si128(_mm_srli_epi32(Pixels, 16), Low);
+            const __m128i Blue = _mm_slli_epi32(_mm_and_si128(Pixels, Low), 16);
+            const __m128i Result = _mm_or_si128(_mm_and_si128(Pixels, GreenAlpha), _mm_or_si128(Red, Blue));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + x), Result);
+        }
+#endif
+
+        for (; x < Width; ++x)
+            Dest[x] = SwapRedBlue(Source[x]);
+    }
+
+    void ConvertRow1010102(const uint32_t* Source, uint32_t* Dest, uint32_t Width)
+    {
+        uint32_t x = 0;
+
+#ifdef IMAGE_ENCODER_SSE2
+        const __m128i RedMask = _mm_set1_epi32(0xFF);
+        const __m128i GreenMask = _mm_set1_epi32(0xFF00);
+        const __m128i BlueMask = _mm_set1_epi32(0xFF0000);
+        const __m128i AlphaMask = _mm_set1_epi32(0x03000000);
+
+        for (; x + 4 <= Width; x += 4)
+        {
+            const __m128i Pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(Source + x));
+            const __m128i Red = _mm_and_si128(_mm_srli_epi32(Pixels, 2), RedMask);
+            const __m128i Green = _mm_and_si128(_mm_srli_epi32(Pixels, 4), GreenMask);
+            const __m128i Blue = _mm_and_si128(_mm_srli_epi32(Pixels, 6), BlueMask);
+            __m128i Alpha = _mm_and_si128(_mm_srli_epi32(Pixels, 6), AlphaMask);
+            Alpha = _mm_or_si128(Alpha, _mm_slli_epi32(Alpha, 2));
+            Alpha = _mm_or_si128(Alpha, _mm_slli_epi32(Alpha, 4));
+            const __m128i Result = _mm_or_si128(_mm_or_si128(Red, Green), _mm_or_si128(Blue, Alpha));
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(Dest + x), Result);
+        }
+#endif
+
+        for (; x < Width; ++x)
+            Dest[x] = Unpack1010102(Source[x]);
+    }
+
+    inline void PutBigEndian(std::vector<uint8_t>& Out, uint32_t Value)
+    {
+        Out.push_back(static_cast<uint8_t>(Value >> 24));
+        Out.push_back(static_cast<uint8_t>(Value >> 16));
+        Out.push_back(static_cast<uint8_t>(Value >> 8));
+        Out.push_back(static_cast<uint8_t>(Value));
+    }
+
+    inline void PutLittleEndian(std::vector<uint8_t>& Out, uint32_t Value)
+    {
+        Out.push_back(static_cast<uint8_t>(Value));
+        Out.push_back(static_cast<uint8_t>(Value >> 8));
+        Out.push_back(static_cast<uint8_t>(Value >> 16));
+        Out.push_back(static_cast<uint8_t>(Value >> 24));
+    }
+
+    //
+    // Deflate with the fixed Huffman codes of RFC 1951
+    //
+
+    const uint16_t kLengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+    const uint8_t kLengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+    const uint16_t kDistanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+    const uint8_t kDistanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+    const uint32_t kWindowSize = 32768;
+    const uint32_t kMinMatch = 3;
+    const uint32_t kMaxMatch = 258;
+    const uint32_t kMaxChain = 8;
+    const uint32_t kHashBits = 15;
+
+    inline uint32_t ReverseBits(uint32_t Code, uint32_t Length)
+    {
+        uint32_t Result = 0;
+        for (uint32_t i = 0; i < Length; ++i)
+        {
+            Result = (Result << 1) | (Code & 1);
+            Code >>= 1;
+        }
+        return Result;
+    }
+
+    struct FixedCodes
+    {
+        uint16_t Literal[288];
+        uint8_t LiteralLength[288];
+        uint16_t Distance[30];
+        uint8_t LengthSymbol[kMaxMatch + 1];
+
+        FixedCodes()
+        {
+            for (uint32_t Symbol = 0; Symbol < 288; ++Symbol)
+            {
+                uint32_t Code, Length;
+                if (Symbol < 144)      { Code = 0x30 + Symbol;          Length = 8; }
+                else if (Symbol < 256) { Code = 0x190 + Symbol - 144;   Length = 9; }
+                else if (Symbol < 280) { Code = Symbol - 256;           Length = 7; }
+                else                   { Code = 0xC0 + Symbol - 280;    Length = 8; }
+
+                // Huffman codes go out starting with their most significant bit
+                Literal[Symbol] = static_cast<uint16_t>(ReverseBits(Code, Length));
+                LiteralLength[Symbol] = static_cast<uint8_t>(Length);
+            }
+
+            for (uint32_t Symbol = 0; Symbol < 30; ++Symbol)
+                Distance[Symbol] = static_cast<uint16_t>(ReverseBits(Symbol, 5));
+
+            for (uint32_t Length = kMinMatch, Symbol = 0; Length <= kMaxMatch; ++Length)
+            {
+                while (Symbol + 1 < 29 && kLengthBase[Symbol + 1] <= Length)
+                    ++Symbol;
+                LengthSymbol[Length] = static_cast<uint8_t>(Symbol);
+            }
+        }
+    };
+
+    const FixedCodes& GetFixedCodes()
+    {
+        static const FixedCodes Codes;
+        return Codes;
+    }
+
+    class BitWriter
+    {
+    public:
+        explicit BitWriter(std::vector<uint8_t>& Out) : m_Out(Out), m_Bits(0), m_NumBits(0) {}
+
+        void Put(uint32_t Value, uint32_t NumBits)
+        {
+            m_Bits |= static_cast<uint64_t>(Value) << m_NumBits;
+            m_NumBits += NumBits;
+            while (m_NumBits >= 8)
+            {
+                m_Out.push_back(static_cast<uint8_t>(m_Bits));
+                m_Bits >>= 8;
+                m_NumBits -= 8;
+            }
+        }
+
+        // Pads the last byte with zeros
+        void Finish()
+        {
+            if (m_NumBits > 0)
+                m_Out.push_back(static_cast<uint8_t>(m_Bits));
+            m_Bits = 0;
+            m_NumBits = 0;
+        }
+
+    private:
+        std::vector<uint8_t>& m_Out;
+        uint64_t m_Bits;
+        uint32_t m_NumBits;
+    };
+
+    inline uint32_t Hash3(const uint8_t* Data)
+    {
+        const uint32_t Value = Data[0] | (Data[1] << 8) | (Data[2] << 16);
+        return (Value * 2654435761u) >> (32 - kHashBits);
+    }
+
+    void Deflate(const uint8_t* Data, size_t Size, std::vector<uint8_t>& Out)
+    {
+        const FixedCodes& Codes = GetFixedCodes();
+        BitWriter Writer(Out);
+
+        // One final block with fixed codes
+        Writer.Put(1, 1);
+        Writer.Put(1, 2);
+
+        std::vector<int32_t> Head(size_t(1) << kHashBits, -1);
+        std::vector<int32_t> Previous(kWindowSize, -1);
+
+        auto Insert = [&](size_t Position)
+        {
+            const uint32_t Hash = Hash3(Data + Position);
+            Previous[Position & (kWindowSize - 1)] = Head[Hash];
+            Head[Hash] = static_cast<int32_t>(Position);
+        };
+
+        size_t Position = 0;
+        while (Position < Size)
+        {
+            uint32_t BestLength = 0;
+            uint32_t BestDistance = 0;
+
+            if (Position + kMinMatch <= Size)
+            {
+                const uint32_t MaxLength = static_cast<uint32_t>(std::min<size_t>(kMaxMatch, Size - Position));
+                int32_t Candidate = Head[Hash3(Data + Position)];
+
+                for (uint32_t Chain = 0; Chain < kMaxChain && Candidate >= 0; ++Chain)
+                {
+                    const size_t Distance = Position - static_cast<size_t>(Candidate);
+                    if (Distance > kWindowSize)
+                        break;
+
+                    uint32_t Length = 0;
+                    while (Length < MaxLength && Data[Candidate + Length] == Data[Position + Length])
+                        ++Length;
+
+                    if (Length > BestLength)
+                    {
+                        BestLength = Length;
+                        BestDistance = static_cast<uint32_t>(Distance);
+                        if (Length == MaxLength)
+                            break;
+                    }
+
+                    const int32_t Next = Previous[Candidate & (kWindowSize - 1)];
+                    if (Next >= Candidate)
+                        break;
+                    Candidate = Next;
+                }
+            }
+
+            if (BestLength >= kMinMatch)
+            {
+                const uint32_t LengthSymbol = Codes.LengthSymbol[BestLength];
+                Writer.Put(Codes.Literal[257 + LengthSymbol], Codes.LiteralLength[257 + LengthSymbol]);
+                Writer.Put(BestLength - kLengthBase[LengthSymbol], kLengthExtra[LengthSymbol]);
+
+                const uint32_t DistanceSymbol = static_cast<uint32_t>(
+                    std::upper_bound(kDistanceBase, kDistanceBase + 30, BestDistance) - kDistanceBase - 1);
+                Writer.Put(Codes.Distance[DistanceSymbol], 5);
+                Writer.Put(BestDistance - kDistanceBase[DistanceSymbol], kDistanceExtra[DistanceSymbol]);
+
+                for (uint32_t i = 0; i < BestLength; ++i, ++Position)
+                {
+                    if (Position + kMinMatch <= Size)
+                        Insert(Position);
+                }
+            }
+            else
+            {
+                Writer.Put(Codes.Literal[Data[Position]], Codes.LiteralLength[Data[Position]]);
+                if (Position + kMinMatch <= Size)
+                    Insert(Position);
+                ++Position;
+            }
+        }
+
+        Writer.Put(Codes.Literal[256], Codes.LiteralLength[256]);
+        Writer.Finish();
+    }
+
+    uint32_t Adler32(const uint8_t* Data, size_t Size)
+    {
+        uint32_t A = 1;
+        uint32_t B = 0;
+
+        while (Size > 0)
+        {
+            // The largest block whose sums cannot overflow
+            const size_t Block = std::min<size_t>(Size, 5552);
+            for (size_t i = 0; i < Block; ++i)
+            {
+                A += Data[i];
+                B += A;
+            }
+            A %= 65521;
+            B %= 65521;
+            Data += Block;
+            Size -= Block;
+        }
+
+        return (B << 16) | A;
+    }
+
+    uint32_t Crc32(const uint8_t* Data, size_t Size, uint32_t Crc = 0)
+    {
+        struct Table
+        {
+            uint32_t Entries[256];
+
+            Table()
+            {
+                for (uint32_t i = 0; i < 256; ++i)
+                {
+                    uint32_t Value = i;
+                    for (int Bit = 0; Bit < 8; ++Bit)
+                        Value = (Value & 1) ? 0xEDB88320u ^ (Value >> 1) : Value >> 1;
+                    Entries[i] = Value;
+                }
+            }
+        };
+        static const Table CrcTable;
+
+        Crc = ~Crc;
+        for (size_t i = 0; i < Size; ++i)
+            Crc = CrcTable.Entries[(Crc ^ Data[i]) & 0xFF] ^ (Crc >> 8);
+        return ~Crc;
+    }
+
+    void PutPngChunk(std::vector<uint8_t>& Out, const char* Type, const uint8_t* Data, size_t Size)
+    {
+        PutBigEndian(Out, static_cast<uint32_t>(Size));
+        const size_t TypeOffset = Out.size();
+        Out.insert(Out.end(), Type, Type + 4);
+        Out.insert(Out.end(), Data, Data + Size);
+        PutBigEndian(Out, Crc32(Out.data() + TypeOffset, Size + 4));
+    }
+
+    inline uint8_t Paeth(uint8_t Left, uint8_t Up, uint8_t UpLeft)
+    {
+        const int Estimate = Left + Up - UpLeft;
+        const int DistanceLeft = abs(Estimate - Left);
+        const int DistanceUp = abs(Estimate - Up);
+        const int DistanceUpLeft = abs(Estimate - UpLeft);
+
+        if (DistanceLeft <= DistanceUp && DistanceLeft <= DistanceUpLeft)
+            return Left;
+        return DistanceUp <= DistanceUpLeft ? Up : UpLeft;
+    }
+
+    // Filters one row with the filter of the smallest sum of absolute differences
+    void FilterRow(const uint8_t* Row, const uint8_t* PreviousRow, size_t RowSize, uint8_t* Candidates, uint8_t* Dest)
+    {
+        const size_t kBytesPerPixel = 4;
+        uint64_t BestSum = UINT64_MAX;
+        uint32_t BestFilter = 0;
+
+        for (uint32_t Filter = 0; Filter < 4; ++Filter)
+        {
+            uint8_t* Filtered = Candidates + Filter * RowSize;
+            uint64_t Sum = 0;
+
+            for (size_t i = 0; i < RowSize; ++i)
+            {
+                const uint8_t Left = i >= kBytesPerPixel ? Row[i - kBytesPerPixel] : 0;
+                const uint8_t Up = PreviousRow != nullptr ? PreviousRow[i] : 0;
+                const uint8_t UpLeft = (PreviousRow != nullptr && i >= kBytesPerPixel) ? PreviousRow[i - kBytesPerPixel] : 0;
+
+                uint8_t Predicted = 0;
+                switch (Filter)
+                {
+                case 1: Predicted = Left; break;
+                case 2: Predicted = Up; break;
+                case 3: Predicted = Paeth(Left, Up, UpLeft); break;
+                default: break;
+                }
+
+                Filtered[i] = static_cast<uint8_t>(Row[i] - Predicted);
+                Sum += abs(static_cast<int8_t>(Filtered[i]));
+            }
+
+            if (Sum < BestSum)
+            {
+                BestSum = Sum;
+                BestFilter = Filter;
+            }
+        }
+
+        // Filter types 0, 1, 2 and 4 of the PNG specification
+        Dest[0] = static_cast<uint8_t>(BestFilter == 3 ? 4 : BestFilter);
+        memcpy(Dest + 1, Candidates + BestFilter * RowSize, RowSize);
+    }
+}
+
+bool ImageEncoder::IsFormatSupported(DXGI_FORMAT Format)
+{
+    switch (Format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool ImageEncoder::ConvertToRGBA8(const void* Source, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format, uint8_t* Dest)
+{
+    if (!IsFormatSupported(Format))
+        return false;
+
+    ASSERT(RowPitch >= Width * 4);
+
+    // sRGB data is stored as it is, PNG and QOI files are sRGB anyway
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        const uint32_t* SourceRow = reinterpret_cast<const uint32_t*>(static_cast<const uint8_t*>(Source) + size_t(y) * RowPitch);
+        uint32_t* DestRow = reinterpret_cast<uint32_t*>(Dest + size_t(y) * Width * 4);
+
+        switch (Format)
+        {
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+            ConvertRowBgra(SourceRow, DestRow, Width);
+            break;
+        case DXGI_FORMAT_R10G10B10A2_UNORM:
+            ConvertRow1010102(SourceRow, DestRow, Width);
+            break;
+        default:
+            memcpy(DestRow, SourceRow, size_t(Width) * 4);
+            break;
+        }
+    }
+
+    return true;
+}
+
+void ImageEncoder::Encode(ImageFileFormat FileFormat, const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out)
+{
+    switch (FileFormat)
+    {
+    case kImageFilePng: EncodePng(Rgba, Width, Height, Out); break;
+    case kImageFileQoi: EncodeQoi(Rgba, Width, Height, Out); break;
+    default:            EncodeRaw(Rgba, Width, Height, Out); break;
+    }
+}
+
+void ImageEncoder::EncodePng(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out)
+{
+    static const uint8_t Signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    Out.insert(Out.end(), Signature, Signature + 8);
+
+    // 8 bits per channel, RGBA, deflate, adaptive filtering, no interlacing
+    std::vector<uint8_t> Header;
+    PutBigEndian(Header, Width);
+    PutBigEndian(Header, Height);
+    const uint8_t HeaderTail[5] = { 8, 6, 0, 0, 0 };
+    Header.insert(Header.end(), HeaderTail, HeaderTail + 5);
+    PutPngChunk(Out, "IHDR", Header.data(), Header.size());
+
+    const size_t RowSize = size_t(Width) * 4;
+    std::vector<uint8_t> Filtered((RowSize + 1) * Height);
+    std::vector<uint8_t> Candidates(RowSize * 4);
+
+    for (uint32_t y = 0; y < Height; ++y)
+    {
+        const uint8_t* Row = Rgba + y * RowSize;
+        FilterRow(Row, y > 0 ? Row - RowSize : nullptr, RowSize, Candidates.data(), Filtered.data() + y * (RowSize + 1));
+    }
+
+    // zlib stream: deflate with a 32K window, no preset dictionary, Adler-32 at the end
+    std::vector<uint8_t> Compressed;
+    Compressed.reserve(Filtered.size() / 2);
+    Compressed.push_back(0x78);
+    Compressed.push_back(0x01);
+    Deflate(Filtered.data(), Filtered.size(), Compressed);
+    PutBigEndian(Compressed, Adler32(Filtered.data(), Filtered.size()));
+
+    PutPngChunk(Out, "IDAT", Compressed.data(), Compressed.size());
+    PutPngChunk(Out, "IEND", nullptr, 0);
+}
+
+void ImageEncoder::EncodeQoi(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out)
+{
+    const uint8_t kOpIndex = 0x00;
+    const uint8_t kOpDiff = 0x40;
+    const uint8_t kOpLuma = 0x80;
+    const uint8_t kOpRun = 0xC0;
+    const uint8_t kOpRgb = 0xFE;
+    const uint8_t kOpRgba = 0xFF;
+
+    const uint8_t Magic[4] = { 'q', 'o', 'i', 'f' };
+    Out.insert(Out.end(), Magic, Magic + 4);
+    PutBigEndian(Out, Width);
+    PutBigEndian(Out, Height);
+    Out.push_back(4);       // channels
+    Out.push_back(0);       // sRGB with linear alpha
+
+    uint8_t Index[64][4] = {};
+    uint8_t Previous[4] = { 0, 0, 0, 255 };
+    uint32_t Run = 0;
+
+    const size_t NumPixels = size_t(Width) * Height;
+    for (size_t i = 0; i < NumPixels; ++i)
+    {
+        const uint8_t* Pixel = Rgba + i * 4;
+
+        if (memcmp(Pixel, Previous, 4) == 0)
+        {
+            ++Run;
+            if (Run == 62 || i + 1 == NumPixels)
+            {
+                Out.push_back(static_cast<uint8_t>(kOpRun | (Run - 1)));
+                Run = 0;
+            }
+            continue;
+        }
+
+        if (Run > 0)
+        {
+            Out.push_back(static_cast<uint8_t>(kOpRun | (Run - 1)));
+            Run = 0;
+        }
+
+        const uint32_t Hash = (Pixel[0] * 3 + Pixel[1] * 5 + Pixel[2] * 7 + Pixel[3] * 11) % 64;
+        if (memcmp(Index[Hash], Pixel, 4) == 0)
+        {
+            Out.push_back(static_cast<uint8_t>(kOpIndex | Hash));
+        }
+        else
+        {
+            memcpy(Index[Hash], Pixel, 4);
+
+            if (Pixel[3] == Previous[3])
+            {
+                const int8_t Red = static_cast<int8_t>(Pixel[0] - Previous[0]);
+                const int8_t Green = static_cast<int8_t>(Pixel[1] - Previous[1]);
+                const int8_t Blue = static_cast<int8_t>(Pixel[2] - Previous[2]);
+                const int RedGreen = Red - Green;
+                const int BlueGreen = Blue - Green;
+
+                if (Red >= -2 && Red <= 1 && Green >= -2 && Green <= 1 && Blue >= -2 && Blue <= 1)
+                {
+                    Out.push_back(static_cast<uint8_t>(kOpDiff | ((Red + 2) << 4) | ((Green + 2) << 2) | (Blue + 2)));
+                }
+                else if (RedGreen >= -8 && RedGreen <= 7 && Green >= -32 && Green <= 31 && BlueGreen >= -8 && BlueGreen <= 7)
+                {
+                    Out.push_back(static_cast<uint8_t>(kOpLuma | (Green + 32)));
+                    Out.push_back(static_cast<uint8_t>(((RedGreen + 8) << 4) | (BlueGreen + 8)));
+                }
+                else
+                {
+                    Out.push_back(kOpRgb);
+                    Out.insert(Out.end(), Pixel, Pixel + 3);
+                }
+            }
+            else
+            {
+                Out.push_back(kOpRgba);
+                Out.insert(Out.end(), Pixel, Pixel + 4);
+            }
+        }
+
+        memcpy(Previous, Pixel, 4);
+    }
+
+    const uint8_t Padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+    Out.insert(Out.end(), Padding, Padding + 8);
+}
+
+void ImageEncoder::EncodeRaw(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out)
+{
+    // { DXGI_FORMAT, Pitch (in pixels), Width (in pixels), Height } as written by PixelBuffer::ExportToFile
+    PutLittleEndian(Out, DXGI_FORMAT_R8G8B8A8_UNORM);
+    PutLittleEndian(Out, Width);
+    PutLittleEndian(Out, Width);
+    PutLittleEndian(Out, Height);
+    Out.insert(Out.end(), Rgba, Rgba + size_t(Width) * Height * 4);
+}
+
+const wchar_t* ImageEncoder::GetExtension(ImageFileFormat FileFormat)
+{
+    switch (FileFormat)
+    {
+    case kImageFilePng: return L".png";
+    case kImageFileQoi: return L".qoi";
+    default:            return L".raw";
+    }
+}
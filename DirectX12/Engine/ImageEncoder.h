@@ -0,0 +1,41 @@
+//
+// Turns read back pixels into image files.  ConvertToRGBA8() brings BGRA8,
+// RGBA8 (also sRGB) and R10G10B10A2 rows into tightly packed RGBA8 with SSE2,
+// the encoders write that as PNG, QOI or raw data.
+//
+// PNG is compressed with fixed Huffman codes and a greedy LZ77 match search,
+// fast rather than small; QOI is both faster and usually smaller for rendered
+// frames.  Raw files carry the 16 byte header of PixelBuffer::ExportToFile.
+//
+// Knows nothing about D3D12 besides DXGI_FORMAT and can be run without a device.
+//
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+enum ImageFileFormat
+{
+    kImageFilePng,
+    kImageFileQoi,
+    kImageFileRaw
+};
+
+class ImageEncoder
+{
+public:
+    static bool IsFormatSupported(DXGI_FORMAT Format);
+
+    // Converts Height rows of Width pixels, RowPitch bytes apart, into Width * Height * 4 bytes at Dest
+    static bool ConvertToRGBA8(const void* Source, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format, uint8_t* Dest);
+
+    // Appends the file for tightly packed RGBA8 pixels to Out
+    static void Encode(ImageFileFormat FileFormat, const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out);
+
+    static void EncodePng(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out);
+    static void EncodeQoi(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out);
+    static void EncodeRaw(const uint8_t* Rgba, uint32_t Width, uint32_t Height, std::vector<uint8_t>& Out);
+
+    static const wchar_t* GetExtension(ImageFileFormat FileFormat);
+};
@@ -0,0 +1,176 @@
+#include "pchDirectX.h"
+#include "ImageExporter.h"
+#include "ReadbackRing.h"
+
+#include <filesystem>
+#include <fstream>
+#include <memory>
+
+ImageExporter::ImageExporter(uint32_t NumWorkers, size_t MaxQueuedBytes) :
+    m_Workers(NumWorkers),
+    m_MaxQueuedBytes(MaxQueuedBytes),
+    m_QueuedBytes(0),
+    m_FreeBytes(0)
+{
+}
+
+ImageExporter::~ImageExporter()
+{
+    Flush();
+}
+
+bool ImageExporter::TryExport(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+    const std::wstring& Path, ImageFileFormat FileFormat)
+{
+    return Queue(Pixels, RowPitch, Width, Height, Format, Path, FileFormat, false);
+}
+
+bool ImageExporter::TryExport(const CapturedFrame& Frame, const std::wstring& Path, ImageFileFormat FileFormat)
+{
+    return Queue(Frame.Data, Frame.RowPitch, Frame.Width, Frame.Height, Frame.Format, Path, FileFormat, false);
+}
+
+bool ImageExporter::Export(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+    const std::wstring& Path, ImageFileFormat FileFormat)
+{
+    return Queue(Pixels, RowPitch, Width, Height, Format, Path, FileFormat, true);
+}
+
+bool ImageExporter::Queue(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+    const std::wstring& Path, ImageFileFormat FileFormat, bool WaitForRoom)
+{
+    if (!ImageEncoder::IsFormatSupported(Format))
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+        ++m_Statistics.NumFailed;
+        return false;
+    }
+
+    // Held by the job, std::function has to be copyable
+    auto Buffer = std::make_shared<std::vector<uint8_t> >();
+    if (!AcquireBuffer(size_t(Width) * Height * 4, WaitForRoom, *Buffer))
+        return false;
+
+    ImageEncoder::ConvertToRGBA8(Pixels, RowPitch, Width, Height, Format, Buffer->data());
+
+    m_Workers.Submit([this, Buffer, Width, Height, Path, FileFormat]()
+    {
+        Write(*Buffer, Width, Height, Path, FileFormat);
+    },
+    &m_PendingImages);
+
+    return true;
+}
+
+bool ImageExporter::AcquireBuffer(size_t Size, bool WaitForRoom, std::vector<uint8_t>& Buffer)
+{
+    std::unique_lock<std::mutex> Lock(m_Mutex);
+
+    // An image larger than the whole budget still goes through once the queue is empty
+    while (m_QueuedBytes > 0 && m_QueuedBytes + Size > m_MaxQueuedBytes)
+    {
+        if (!WaitForRoom)
+        {
+            ++m_Statistics.NumRefused;
+            return false;
+        }
+
+        m_RoomCondition.wait(Lock);
+    }
+
+    m_QueuedBytes += Size;
+
+    for (size_t i = 0; i < m_FreeBuffers.size(); ++i)
+    {
+        if (m_FreeBuffers[i].capacity() >= Size)
+        {
+            Buffer = std::move(m_FreeBuffers[i]);
+            m_FreeBuffers.erase(m_FreeBuffers.begin() + i);
+            m_FreeBytes -= Buffer.capacity();
+            break;
+        }
+    }
+
+    // Free buffers only stay while they fit into the budget next to the queued images
+    std::vector<std::vector<uint8_t> > Dropped;
+    while (!m_FreeBuffers.empty() && m_QueuedBytes + m_FreeBytes > m_MaxQueuedBytes)
+    {
+        m_FreeBytes -= m_FreeBuffers.back().capacity();
+        Dropped.push_back(std::move(m_FreeBuffers.back()));
+        m_FreeBuffers.pop_back();
+    }
+
+    Lock.unlock();
+
+    Buffer.resize(Size);
+    return true;
+}
+
+void ImageExporter::ReleaseBuffer(std::vector<uint8_t>&& Buffer)
+{
+    std::vector<uint8_t> Dropped;
+
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+        m_QueuedBytes -= Buffer.size();
+
+        if (m_QueuedBytes + m_FreeBytes + Buffer.capacity() <= m_MaxQueuedBytes)
+        {
+            m_FreeBytes += Buffer.capacity();
+            m_FreeBuffers.push_back(std::move(Buffer));
+        }
+        else
+        {
+            Dropped = std::move(Buffer);
+        }
+    }
+
+    m_RoomCondition.notify_all();
+}
+
+void ImageExporter::Write(std::vector<uint8_t>& Pixels, uint32_t Width, uint32_t Height, const std::wstring& Path, ImageFileFormat FileFormat)
+{
+    std::vector<uint8_t> File;
+    ImageEncoder::Encode(FileFormat, Pixels.data(), Width, Height, File);
+
+    // Room for the next image before the disk is touched
+    ReleaseBuffer(std::move(Pixels));
+
+    const std::filesystem::path FilePath(Path);
+    std::error_code Error;
+    if (FilePath.has_parent_path())
+        std::filesystem::create_directories(FilePath.parent_path(), Error);
+
+    std::ofstream Out(FilePath, std::ios::out | std::ios::binary);
+    Out.write(reinterpret_cast<const char*>(File.data()), File.size());
+    Out.close();
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+    if (Out.good())
+    {
+        ++m_Statistics.NumWritten;
+        m_Statistics.NumBytesWritten += File.size();
+    }
+    else
+    {
+        ++m_Statistics.NumFailed;
+    }
+}
+
+void ImageExporter::Flush()
+{
+    m_Workers.Wait(m_PendingImages);
+}
+
+size_t ImageExporter::GetQueuedBytes()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+    return m_QueuedBytes;
+}
+
+ImageExporter::Statistics ImageExporter::GetStatistics()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+    return m_Statistics;
+}
@@ -0,0 +1,82 @@
+//
+// Writes images in the background.  Export() converts the pixels to RGBA8 on
+// the calling thread, which is about as fast as copying them out of a readback
+// buffer that is only valid during the call, and queues encoding and writing
+// on a worker pool of its own, so exports never delay the jobs of a frame.
+// One image is one job, images per second grow with the number of workers.
+//
+// The converted pixels of all queued images stay below a byte budget.  When it
+// is used up TryExport() refuses the image and Export() waits for room, so a
+// render loop can drop frames while a batch render is throttled instead.
+//
+
+#pragma once
+
+#include "ImageEncoder.h"
+#include "JobSystem.h"
+
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <vector>
+
+struct CapturedFrame;
+
+class ImageExporter
+{
+public:
+    static const size_t kDefaultMaxQueuedBytes = 256 * 1024 * 1024;
+
+    struct Statistics
+    {
+        uint64_t NumWritten = 0;
+        uint64_t NumFailed = 0;         // unsupported format or file not written
+        uint64_t NumRefused = 0;        // TryExport() with a full queue
+        uint64_t NumBytesWritten = 0;
+    };
+
+    // NumWorkers == 0 uses one worker per hardware thread besides the calling one
+    explicit ImageExporter(uint32_t NumWorkers = 0, size_t MaxQueuedBytes = kDefaultMaxQueuedBytes);
+    ~ImageExporter();
+
+    ImageExporter(const ImageExporter&) = delete;
+    ImageExporter& operator=(const ImageExporter&) = delete;
+
+    // Returns false without queuing anything when the budget is used up
+    bool TryExport(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+        const std::wstring& Path, ImageFileFormat FileFormat);
+    bool TryExport(const CapturedFrame& Frame, const std::wstring& Path, ImageFileFormat FileFormat);
+
+    // Waits for room in the queue, returns false only for unsupported formats
+    bool Export(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+        const std::wstring& Path, ImageFileFormat FileFormat);
+
+    // Waits until every queued image is written, helps encoding meanwhile
+    void Flush();
+
+    uint32_t GetNumWorkers() const { return m_Workers.GetNumWorkers(); }
+    size_t GetQueuedBytes();
+    Statistics GetStatistics();
+
+private:
+    bool Queue(const void* Pixels, uint32_t RowPitch, uint32_t Width, uint32_t Height, DXGI_FORMAT Format,
+        const std::wstring& Path, ImageFileFormat FileFormat, bool WaitForRoom);
+
+    // Pixel buffers are recycled while they fit into the budget
+    bool AcquireBuffer(size_t Size, bool WaitForRoom, std::vector<uint8_t>& Buffer);
+    void ReleaseBuffer(std::vector<uint8_t>&& Buffer);
+
+    void Write(std::vector<uint8_t>& Pixels, uint32_t Width, uint32_t Height, const std::wstring& Path, ImageFileFormat FileFormat);
+
+    JobSystem m_Workers;
+    JobCounter m_PendingImages;
+
+    std::mutex m_Mutex;
+    std::condition_variable m_RoomCondition;
+    size_t m_MaxQueuedBytes;
+    size_t m_QueuedBytes;
+    size_t m_FreeBytes;
+    std::vector<std::vector<uint8_t> > m_FreeBuffers;
+
+    Statistics m_Statistics;
+};
@@ -0,0 +1,115 @@
+#include "pchDirectX.h"
+#include "JobSystem.h"
+
+JobSystem::JobSystem(uint32_t NumWorkers) :
+    m_Shutdown(false)
+{
+    if (NumWorkers == 0)
+    {
+        const uint32_t NumHardwareThreads = std::thread::hardware_concurrency();
+        NumWorkers = NumHardwareThreads > 1 ? NumHardwareThreads - 1 : 1;
+    }
+
+    m_Workers.reserve(NumWorkers);
+    for (uint32_t i = 0; i < NumWorkers; ++i)
+    {
+        m_Workers.emplace_back(&JobSystem::WorkerLoop, this);
+    }
+}
+
+JobSystem::~JobSystem()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+        m_Shutdown = true;
+    }
+    m_WakeCondition.notify_all();
+
+    for (auto& Worker : m_Workers)
+    {
+        Worker.join();
+    }
+}
+
+void JobSystem::Submit(std::function<void()> Job, JobCounter* Counter)
+{
+    if (Counter != nullptr)
+        Counter->m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+        m_Queue.push({ std::move(Job), Counter });
+    }
+    m_WakeCondition.notify_one();
+}
+
+void JobSystem::Wait(JobCounter& Counter)
+{
+    while (!Counter.IsDone())
+    {
+        if (!TryRunOne())
+            std::this_thread::yield();
+    }
+}
+
+void JobSystem::Dispatch(uint32_t Count, const std::function<void(uint32_t)>& Job)
+{
+    if (Count == 0)
+        return;
+
+    JobCounter Counter;
+
+    // The calling thread takes index 0 itself
+    for (uint32_t i = 1; i < Count; ++i)
+    {
+        Submit([&Job, i]() { Job(i); }, &Counter);
+    }
+
+    Job(0);
+
+    Wait(Counter);
+}
+
+bool JobSystem::TryRunOne()
+{
+    Entry entry;
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+        if (m_Queue.empty())
+            return false;
+
+        entry = std::move(m_Queue.front());
+        m_Queue.pop();
+    }
+
+    Run(entry);
+    return true;
+}
+
+void JobSystem::Run(Entry& entry)
+{
+    entry.Job();
+
+    if (entry.Counter != nullptr)
+        entry.Counter->m_Pending.fetch_sub(1, std::memory_order_release);
+}
+
+void JobSystem::WorkerLoop()
+{
+    for (;;)
+    {
+        Entry entry;
+        {
+            std::unique_lock<std::mutex> Lock(m_Mutex);
+            m_WakeCondition.wait(Lock, [this]() { return m_Shutdown || !m_Queue.empty(); });
+
+            if (m_Queue.empty())
+                return;
+
+            entry = std::move(m_Queue.front());
+            m_Queue.pop();
+        }
+
+        Run(entry);
+    }
+}
@@ -0,0 +1,69 @@
+//
+// A small pool of worker threads fed from one mutex protected queue.  Good enough
+// for a handful of coarse jobs per frame, e.g. recording one command list per
+// worker.  A thread that waits for a group of jobs helps running queued jobs
+// instead of sleeping.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// Counts the outstanding jobs of one group
+class JobCounter
+{
+    friend class JobSystem;
+
+public:
+    JobCounter() : m_Pending(0) {}
+
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    std::atomic<uint32_t> m_Pending;
+};
+
+class JobSystem
+{
+public:
+    // NumWorkers == 0 uses one worker per hardware thread besides the calling one
+    explicit JobSystem(uint32_t NumWorkers = 0);
+    ~JobSystem();
+
+    JobSystem(const JobSystem&) = delete;
+    JobSystem& operator=(const JobSystem&) = delete;
+
+    uint32_t GetNumWorkers() const { return static_cast<uint32_t>(m_Workers.size()); }
+
+    void Submit(std::function<void()> Job, JobCounter* Counter = nullptr);
+
+    // Runs queued jobs on the calling thread until all jobs of Counter are done
+    void Wait(JobCounter& Counter);
+
+    // Calls Job(i) for every i in [0, Count) on the workers and the calling thread and returns when all calls are done
+    void Dispatch(uint32_t Count, const std::function<void(uint32_t)>& Job);
+
+private:
+    struct Entry
+    {
+        std::function<void()> Job;
+        JobCounter* Counter;
+    };
+
+    bool TryRunOne();
+    void Run(Entry& entry);
+    void WorkerLoop();
+
+    std::vector<std::thread> m_Workers;
+
+    std::queue<Entry> m_Queue;
+    std::mutex m_Mutex;
+    std::condition_variable m_WakeCondition;
+    bool m_Shutdown;
+};
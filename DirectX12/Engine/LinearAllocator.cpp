@@ -16,66 +16,244 @@
 #include "LinearAllocator.h"
 #include "GraphicsCore.h"
 #include "CommandListManager.h"
+#include <algorithm>
 #include <thread>
 
 using namespace std;
 
+namespace
+{
+    // Answers fence queries of one batch against one snapshot of each queue's timeline
+    class FenceBatch
+    {
+    public:
+        FenceBatch(CommandListManager& CommandManager) : m_CommandManager(CommandManager), m_QueriedMask(0)
+        {
+        }
+
+        bool IsFenceComplete(uint64_t FenceValue)
+        {
+            const uint32_t Type = static_cast<uint32_t>(FenceValue >> 56);
+            ASSERT(Type < kNumQueueTypes);
+
+            if ((m_QueriedMask & (1u << Type)) == 0)
+            {
+                m_CompletedValue[Type] = m_CommandManager.GetQueue(D3D12_COMMAND_LIST_TYPE(Type)).GetTimeline().GetCompletedValue();
+                m_QueriedMask |= 1u << Type;
+            }
+
+            return FenceValue <= m_CompletedValue[Type];
+        }
+
+    private:
+        static const uint32_t kNumQueueTypes = D3D12_COMMAND_LIST_TYPE_COPY + 1;
+
+        CommandListManager& m_CommandManager;
+        uint64_t m_CompletedValue[kNumQueueTypes];
+        uint32_t m_QueriedMask;
+    };
+
+    struct ThreadPageCache
+    {
+        LinearAllocatorPageManager* Manager;
+        uint64_t Generation;
+        uint32_t NumPages;
+        LinearAllocationPage* Pages[LinearAllocatorPageManager::kThreadCacheSize];
+
+        // The thread exits, its pages go back to the manager
+        ~ThreadPageCache()
+        {
+            LinearAllocatorPageManager::ReturnCachedPages(Manager, Generation, Pages, NumPages);
+        }
+    };
+
+    thread_local ThreadPageCache t_PageCaches[kNumAllocatorTypes] = {};
+
+    std::atomic<uint64_t> s_NextCacheGeneration(1);
+
+    // Managers that are alive, so a thread cache can tell whether its manager still exists
+    std::mutex& GetManagerListMutex()
+    {
+        static std::mutex s_Mutex;
+        return s_Mutex;
+    }
+
+    std::vector<LinearAllocatorPageManager*>& GetManagerList()
+    {
+        static std::vector<LinearAllocatorPageManager*> s_Managers;
+        return s_Managers;
+    }
+}
+
 LinearAllocatorPageManager::LinearAllocatorPageManager(GraphicsCore& core, LinearAllocatorType allocatorType)
-: m_core(core)
+: m_core(core),
+  m_LargePageCache(allocatorType == kGpuExclusive ? kGpuAllocatorPageSize : kCpuAllocatorPageSize, kMaxCachedLargePageBytes),
+  m_CacheGeneration(s_NextCacheGeneration.fetch_add(1))
 {
     m_AllocationType = allocatorType;
     ASSERT(m_AllocationType < kNumAllocatorTypes);
+
+    lock_guard<mutex> LockGuard(GetManagerListMutex());
+    GetManagerList().push_back(this);
+}
+
+LinearAllocatorPageManager::~LinearAllocatorPageManager()
+{
+    lock_guard<mutex> LockGuard(GetManagerListMutex());
+    std::vector<LinearAllocatorPageManager*>& Managers = GetManagerList();
+    Managers.erase(std::find(Managers.begin(), Managers.end(), this));
+}
+
+void LinearAllocatorPageManager::ReturnCachedPages( LinearAllocatorPageManager* Manager, uint64_t Generation,
+    LinearAllocationPage* const* Pages, uint32_t NumPages )
+{
+    if (NumPages == 0)
+        return;
+
+    // The list lock keeps the manager alive while its pages are put back
+    lock_guard<mutex> ListGuard(GetManagerListMutex());
+    const std::vector<LinearAllocatorPageManager*>& Managers = GetManagerList();
+    if (std::find(Managers.begin(), Managers.end(), Manager) == Managers.end())
+        return;
+
+    lock_guard<mutex> LockGuard(Manager->m_Mutex);
+    if (Manager->m_CacheGeneration.load(std::memory_order_relaxed) != Generation)
+        return;
+
+    Manager->m_AvailablePages.insert(Manager->m_AvailablePages.end(), Pages, Pages + NumPages);
 }
 
 LinearAllocationPage* LinearAllocatorPageManager::RequestPage()
 {
-    lock_guard<mutex> LockGuard(m_Mutex);
+    ThreadPageCache& Cache = t_PageCaches[m_AllocationType];
+    const uint64_t Generation = m_CacheGeneration.load(std::memory_order_acquire);
 
-    while (!m_RetiredPages.empty() && this->m_core.m_pCommandManager->
-        IsFenceComplete(m_RetiredPages.front().first))
+    // Pages of a destroyed manager are gone, pages of another manager go back to its pool
+    if (Cache.Manager != this || Cache.Generation != Generation)
     {
-        m_AvailablePages.push(m_RetiredPages.front().second);
-        m_RetiredPages.pop();
+        if (Cache.Manager != this)
+            ReturnCachedPages(Cache.Manager, Cache.Generation, Cache.Pages, Cache.NumPages);
+
+        Cache.Manager = this;
+        Cache.Generation = Generation;
+        Cache.NumPages = 0;
     }
 
-    LinearAllocationPage* PagePtr = nullptr;
+    if (Cache.NumPages > 0)
+        return Cache.Pages[--Cache.NumPages];
 
-    if (!m_AvailablePages.empty())
-    {
-        PagePtr = m_AvailablePages.front();
-        m_AvailablePages.pop();
-    }
-    else
+    lock_guard<mutex> LockGuard(m_Mutex);
+
+    CollectRetiredPages();
+
+    const size_t NumRefill = std::min<size_t>(kThreadCacheSize, (m_AvailablePages.size() + 1) / 2);
+    while (Cache.NumPages < NumRefill)
     {
-        PagePtr = CreateNewPage();
-        m_PagePool.emplace_back(PagePtr);
+        Cache.Pages[Cache.NumPages++] = m_AvailablePages.back();
+        m_AvailablePages.pop_back();
     }
 
+    if (Cache.NumPages > 0)
+        return Cache.Pages[--Cache.NumPages];
+
+    LinearAllocationPage* PagePtr = CreateNewPage();
+    m_PagePool.emplace_back(PagePtr);
     return PagePtr;
 }
 
-void LinearAllocatorPageManager::DiscardPages( uint64_t FenceValue, const vector<LinearAllocationPage*>& UsedPages )
+void LinearAllocatorPageManager::CollectRetiredPages()
+{
+    FenceBatch Fences(*this->m_core.m_pCommandManager);
+    m_RetiredPages.Collect([&Fences](uint64_t FenceValue) { return Fences.IsFenceComplete(FenceValue); }, m_AvailablePages);
+}
+
+void LinearAllocatorPageManager::RecycleCompletedLargePages()
+{
+    FenceBatch Fences(*this->m_core.m_pCommandManager);
+    m_FreedLargePages.Collect([&Fences](uint64_t FenceValue) { return Fences.IsFenceComplete(FenceValue); }, m_CompletedLargePages);
+
+    for (LinearAllocationPage* Page : m_CompletedLargePages)
+        m_LargePageCache.Release(Page, static_cast<size_t>(Page->GetResource()->GetDesc().Width), m_EvictedPages);
+    m_CompletedLargePages.clear();
+
+    for (LinearAllocationPage* Page : m_EvictedPages)
+        DeleteLargePage(Page);
+    m_EvictedPages.clear();
+}
+
+LinearAllocationPage* LinearAllocatorPageManager::RequestLargePage( size_t SizeInBytes )
 {
     lock_guard<mutex> LockGuard(m_Mutex);
-    for (auto iter = UsedPages.begin(); iter != UsedPages.end(); ++iter)
-        m_RetiredPages.push(make_pair(FenceValue, *iter));
+
+    RecycleCompletedLargePages();
+
+    const size_t ClassSize = m_LargePageCache.GetClassSize(SizeInBytes);
+
+    LinearAllocationPage* Page = m_LargePageCache.Acquire(ClassSize);
+    if (Page == nullptr)
+        return CreateNewPage(ClassSize);
+
+    Page->Map();
+    return Page;
 }
 
-void LinearAllocatorPageManager::FreeLargePages( uint64_t FenceValue, const vector<LinearAllocationPage*>& LargePages )
+SizeClassCache<LinearAllocationPage>::Statistics LinearAllocatorPageManager::GetLargePageStatistics()
 {
     lock_guard<mutex> LockGuard(m_Mutex);
+    return m_LargePageCache.GetStatistics();
+}
 
-    while (!m_DeletionQueue.empty() && this->m_core.m_pCommandManager->IsFenceComplete(m_DeletionQueue.front().first))
-    {
-        delete m_DeletionQueue.front().second;
-        m_DeletionQueue.pop();
-    }
+void LinearAllocatorPageManager::DiscardPages( uint64_t FenceValue, const vector<LinearAllocationPage*>& UsedPages )
+{
+    m_RetiredPages.Push(FenceValue, UsedPages.data(), UsedPages.size());
+}
 
+void LinearAllocatorPageManager::FreeLargePages( uint64_t FenceValue, const vector<LinearAllocationPage*>& LargePages )
+{
     for (auto iter = LargePages.begin(); iter != LargePages.end(); ++iter)
-    {
         (*iter)->Unmap();
-        m_DeletionQueue.push(make_pair(FenceValue, *iter));
-    }
+
+    m_FreedLargePages.Push(FenceValue, LargePages.data(), LargePages.size());
+
+    // Whoever holds the lock is about to look at the fences anyway, the next call catches up
+    unique_lock<mutex> Lock(m_Mutex, try_to_lock);
+    if (Lock.owns_lock())
+        RecycleCompletedLargePages();
+}
+
+MemoryCategory LinearAllocatorPageManager::GetPageCategory() const
+{
+    return m_AllocationType == kGpuExclusive ? kMemoryLinearAllocatorGpuPages : kMemoryLinearAllocatorCpuPages;
+}
+
+void LinearAllocatorPageManager::DeleteLargePage( LinearAllocationPage* Page )
+{
+    this->m_core.m_MemoryStatistics.OnFree(kMemoryLinearAllocatorLargePages, Page->GetResource()->GetDesc().Width);
+    delete Page;
+}
+
+void LinearAllocatorPageManager::Destroy()
+{
+    lock_guard<mutex> LockGuard(m_Mutex);
+
+    // Invalidates the pages held by the thread caches
+    m_CacheGeneration.store(s_NextCacheGeneration.fetch_add(1), std::memory_order_release);
+
+    m_FreedLargePages.TakeAll(m_EvictedPages);
+    m_LargePageCache.Clear(m_EvictedPages);
+
+    for (LinearAllocationPage* Page : m_EvictedPages)
+        DeleteLargePage(Page);
+    m_EvictedPages.clear();
+
+    const uint64_t PageSize = m_AllocationType == kGpuExclusive ? kGpuAllocatorPageSize : kCpuAllocatorPageSize;
+    for (size_t i = 0; i < m_PagePool.size(); ++i)
+        this->m_core.m_MemoryStatistics.OnFree(GetPageCategory(), PageSize);
+
+    // The pool owns the small pages, the list only has to forget them
+    m_RetiredPages.TakeAll(m_AvailablePages);
+    m_AvailablePages.clear();
+    m_PagePool.clear();
 }
 
 LinearAllocationPage* LinearAllocatorPageManager::CreateNewPage( size_t PageSize  )
@@ -120,6 +298,8 @@ LinearAllocationPage* LinearAllocatorPageManager::CreateNewPage( size_t PageSize
 
     pBuffer->SetName(L"LinearAllocator Page");
 
+    this->m_core.m_MemoryStatistics.OnAllocate(PageSize == 0 ? GetPageCategory() : kMemoryLinearAllocatorLargePages, ResourceDesc.Width);
+
     return new LinearAllocationPage(this->m_core, pBuffer, DefaultUsage);
 }
 
@@ -141,7 +321,7 @@ void LinearAllocator::CleanupUsedPages( uint64_t FenceID )
 
 DynAlloc LinearAllocator::AllocateLargePage(size_t SizeInBytes)
 {
-    LinearAllocationPage* OneOff = this->m_LinearAllocatorStatics.m_PageManager[m_AllocationType].CreateNewPage(SizeInBytes);
+    LinearAllocationPage* OneOff = this->m_LinearAllocatorStatics.m_PageManager[m_AllocationType].RequestLargePage(SizeInBytes);
     m_LargePageList.push_back(OneOff);
 
     DynAlloc ret(*OneOff, 0, SizeInBytes);
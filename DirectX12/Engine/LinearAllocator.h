@@ -16,6 +16,19 @@
 // context-local memory page.  Requesting a new page is done in a thread-safe manner by guarding accesses
 // with a mutex lock.
 //
+// Every thread keeps a few available pages in a cache of its own, and retired pages are pushed onto a
+// lock-free list, so the mutex is only taken to refill a thread cache and to check the fences of the
+// retired pages, which is done once for a whole batch.  A thread cache gives its pages back to the
+// manager when the thread switches to another manager and when the thread exits.
+//
+// Large pages are recycled through power-of-two size classes (see SizeClassCache) instead of being
+// created and destroyed for every allocation that exceeds the page size.  Freed large pages go to a
+// lock-free list like the retired pages, but RequestLargePage takes the mutex: the size class cache
+// is not thread-safe and a page of the requested class has to be found or created under one lock.
+// Large allocations are rare, only data beyond the page size, so the lock is not contended.
+// FreeLargePages only tries the lock; when another thread holds it the freed pages stay on the list
+// until the next RequestLargePage or FreeLargePages, which recycle them before anything else.
+//
 // When a command context is finished, it will receive a fence ID that indicates when it's safe to reclaim
 // used resources.  The CleanupUsedPages() method must be invoked at this time so that the used pages can be
 // scheduled for reuse after the fence has cleared.
@@ -23,6 +36,10 @@
 #pragma once
 
 #include "GpuResource.h"
+#include "RetiredPageList.h"
+#include "SizeClassCache.h"
+#include "MemoryStatistics.h"
+#include <atomic>
 #include <vector>
 #include <queue>
 #include <mutex>
@@ -83,6 +100,10 @@ public:
 
     void* m_CpuVirtualAddress;
     D3D12_GPU_VIRTUAL_ADDRESS m_GpuVirtualAddress;
+
+    // Link and fence while the page is on one of the RetiredPageLists of the page manager
+    LinearAllocationPage* m_NextRetired = nullptr;
+    uint64_t m_RetiredFence = 0;
 };
 
 enum LinearAllocatorType
@@ -101,50 +122,71 @@ enum
     kCpuAllocatorPageSize = 0x200000    // 2MB
 };
 
+// Upper limit of the large pages kept for reuse, per allocator type
+const size_t kMaxCachedLargePageBytes = 64 * 1024 * 1024;
+
 class LinearAllocatorPageManager
 {
 public:
 
+    // Available pages a thread keeps for itself.  A refill takes at most half of the available
+    // pages, so one thread does not take all of them from the others.
+    static const uint32_t kThreadCacheSize = 4;
+
     LinearAllocatorPageManager(GraphicsCore &core, LinearAllocatorType);
+    ~LinearAllocatorPageManager();
+
+    LinearAllocatorPageManager(const LinearAllocatorPageManager&) = delete;
+    LinearAllocatorPageManager& operator=(const LinearAllocatorPageManager&) = delete;
+
     LinearAllocationPage* RequestPage( void );
     LinearAllocationPage* CreateNewPage( size_t PageSize = 0 );
 
     // Discarded pages will get recycled.  This is for fixed size pages.
     void DiscardPages( uint64_t FenceID, const std::vector<LinearAllocationPage*>& Pages );
 
-    // Freed pages will be destroyed once their fence has passed.  This is for single-use,
-    // "large" pages.
+    // Returns a mapped page of at least SizeInBytes.  This is for single-use, "large" pages.
+    LinearAllocationPage* RequestLargePage( size_t SizeInBytes );
+
+    // Freed pages will be recycled for later large pages once their fence has passed, or
+    // destroyed if the cache is full.
     void FreeLargePages( uint64_t FenceID, const std::vector<LinearAllocationPage*>& Pages );
 
-    void Destroy( void )
-    {
-        m_PagePool.clear();
+    SizeClassCache<LinearAllocationPage>::Statistics GetLargePageStatistics( void );
 
-        while (!m_RetiredPages.empty())
-        {
-            m_RetiredPages.pop();
-        }
+    // Requires the GPU to be idle
+    void Destroy( void );
 
-        while (!m_DeletionQueue.empty())
-        {
-            m_DeletionQueue.pop();
-        }
-
-        while (!m_AvailablePages.empty())
-        {
-            m_AvailablePages.pop();
-        }
-    }
+    // Puts the pages of a thread cache back to the available pages of Manager, unless the manager
+    // is gone or was destroyed after the cache got the pages (Generation is outdated)
+    static void ReturnCachedPages( LinearAllocatorPageManager* Manager, uint64_t Generation,
+        LinearAllocationPage* const* Pages, uint32_t NumPages );
 
 private:
+    // Both require m_Mutex to be held
+    void CollectRetiredPages( void );
+    void RecycleCompletedLargePages( void );
+
+    MemoryCategory GetPageCategory( void ) const;
+    void DeleteLargePage( LinearAllocationPage* Page );
+
     LinearAllocatorType m_AllocationType;
     GraphicsCore& m_core;
 
+    // Guarded by m_Mutex
     std::vector<std::unique_ptr<LinearAllocationPage> > m_PagePool;
-    std::queue<std::pair<uint64_t, LinearAllocationPage*> > m_RetiredPages;
-    std::queue<std::pair<uint64_t, LinearAllocationPage*> > m_DeletionQueue;
-    std::queue<LinearAllocationPage*> m_AvailablePages;
+    std::vector<LinearAllocationPage*> m_AvailablePages;
+    SizeClassCache<LinearAllocationPage> m_LargePageCache;
+    std::vector<LinearAllocationPage*> m_CompletedLargePages;
+    std::vector<LinearAllocationPage*> m_EvictedPages;
     std::mutex m_Mutex;
+
+    // Filled by DiscardPages and FreeLargePages without the lock, collected under m_Mutex
+    RetiredPageList<LinearAllocationPage> m_RetiredPages;
+    RetiredPageList<LinearAllocationPage> m_FreedLargePages;
+
+    // Identifies the pages of this manager in the thread caches, changed by Destroy
+    std::atomic<uint64_t> m_CacheGeneration;
 };
 
 class LinearAllocatorStatics
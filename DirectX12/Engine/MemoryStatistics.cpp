@@ -0,0 +1,117 @@
+#include "pchDirectX.h"
+#include "MemoryStatistics.h"
+
+#include <stdio.h>
+
+namespace
+{
+    template <typename T>
+    void UpdatePeak(std::atomic<T>& Peak, T Value)
+    {
+        T Current = Peak.load(std::memory_order_relaxed);
+        while (Value > Current && !Peak.compare_exchange_weak(Current, Value, std::memory_order_relaxed))
+        {
+        }
+    }
+}
+
+MemoryStatistics::MemoryStatistics()
+{
+    for (auto& Counter : m_Counters)
+    {
+        Counter.LiveBytes.store(0, std::memory_order_relaxed);
+        Counter.PeakBytes.store(0, std::memory_order_relaxed);
+        Counter.LiveObjects.store(0, std::memory_order_relaxed);
+        Counter.PeakObjects.store(0, std::memory_order_relaxed);
+        Counter.TotalAllocations.store(0, std::memory_order_relaxed);
+    }
+}
+
+void MemoryStatistics::OnAllocate(MemoryCategory Category, uint64_t Bytes)
+{
+    ASSERT(Category < kNumMemoryCategories);
+    Counters& Counter = m_Counters[Category];
+
+    UpdatePeak(Counter.PeakBytes, Counter.LiveBytes.fetch_add(Bytes, std::memory_order_relaxed) + Bytes);
+    UpdatePeak(Counter.PeakObjects, Counter.LiveObjects.fetch_add(1, std::memory_order_relaxed) + 1);
+    Counter.TotalAllocations.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryStatistics::OnFree(MemoryCategory Category, uint64_t Bytes)
+{
+    ASSERT(Category < kNumMemoryCategories);
+    Counters& Counter = m_Counters[Category];
+
+    Counter.LiveBytes.fetch_sub(Bytes, std::memory_order_relaxed);
+    Counter.LiveObjects.fetch_sub(1, std::memory_order_relaxed);
+}
+
+MemoryStatistics::Snapshot MemoryStatistics::GetSnapshot(uint64_t FrameNumber) const
+{
+    Snapshot Result;
+    Result.FrameNumber = FrameNumber;
+    Result.TotalLiveBytes = 0;
+    Result.TotalPeakBytes = 0;
+
+    for (uint32_t i = 0; i < kNumMemoryCategories; ++i)
+    {
+        const Counters& Counter = m_Counters[i];
+        CategorySnapshot& Category = Result.Categories[i];
+
+        Category.LiveBytes = Counter.LiveBytes.load(std::memory_order_relaxed);
+        Category.PeakBytes = Counter.PeakBytes.load(std::memory_order_relaxed);
+        Category.LiveObjects = Counter.LiveObjects.load(std::memory_order_relaxed);
+        Category.PeakObjects = Counter.PeakObjects.load(std::memory_order_relaxed);
+        Category.TotalAllocations = Counter.TotalAllocations.load(std::memory_order_relaxed);
+
+        // The totals come from the categories, so reporting touches no shared line
+        Result.TotalLiveBytes += Category.LiveBytes;
+        Result.TotalPeakBytes += Category.PeakBytes;
+    }
+
+    return Result;
+}
+
+const char* MemoryStatistics::GetCategoryName(MemoryCategory Category)
+{
+    switch (Category)
+    {
+    case kMemoryLinearAllocatorGpuPages:    return "LinearAllocatorGpuPages";
+    case kMemoryLinearAllocatorCpuPages:    return "LinearAllocatorCpuPages";
+    case kMemoryLinearAllocatorLargePages:  return "LinearAllocatorLargePages";
+    case kMemoryDynamicDescriptorHeaps:     return "DynamicDescriptorHeaps";
+    case kMemoryDescriptorAllocatorHeaps:   return "DescriptorAllocatorHeaps";
+    case kMemoryBufferHeaps:                return "BufferHeaps";
+    case kMemoryFrameConstantRing:          return "FrameConstantRing";
+    case kMemoryBindlessDescriptorHeap:     return "BindlessDescriptorHeap";
+    case kMemoryUploadRing:                 return "UploadRing";
+    case kMemoryReadbackRing:               return "ReadbackRing";
+    default:                                return "Unknown";
+    }
+}
+
+std::string MemoryStatistics::Snapshot::ToJson() const
+{
+    char Buffer[256];
+    std::string Json;
+
+    snprintf(Buffer, sizeof(Buffer), "{\"frame\":%llu,\"liveBytes\":%llu,\"peakBytes\":%llu,\"categories\":{",
+        (unsigned long long)FrameNumber, (unsigned long long)TotalLiveBytes, (unsigned long long)TotalPeakBytes);
+    Json += Buffer;
+
+    for (uint32_t i = 0; i < kNumMemoryCategories; ++i)
+    {
+        const CategorySnapshot& Category = Categories[i];
+
+        snprintf(Buffer, sizeof(Buffer),
+            "%s\"%s\":{\"liveBytes\":%llu,\"peakBytes\":%llu,\"liveObjects\":%u,\"peakObjects\":%u,\"totalAllocations\":%llu}",
+            i == 0 ? "" : ",",
+            GetCategoryName(static_cast<MemoryCategory>(i)),
+            (unsigned long long)Category.LiveBytes, (unsigned long long)Category.PeakBytes,
+            Category.LiveObjects, Category.PeakObjects, (unsigned long long)Category.TotalAllocations);
+        Json += Buffer;
+    }
+
+    Json += "}}";
+    return Json;
+}
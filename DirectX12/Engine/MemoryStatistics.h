@@ -0,0 +1,76 @@
+//
+// Central accounting of the GPU memory the engine holds, per category.  The
+// allocators report every heap, page or resource they create and release; the
+// counters are lock-free atomics so reporting is cheap on any thread.
+// GetSnapshot() reads all counters at once, e.g. to dump them every N frames.
+//
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <stdint.h>
+
+enum MemoryCategory
+{
+    kMemoryLinearAllocatorGpuPages,     // DEFAULT heap pages of LinearAllocator
+    kMemoryLinearAllocatorCpuPages,     // UPLOAD heap pages of LinearAllocator
+    kMemoryLinearAllocatorLargePages,   // single-use and recycled large pages
+    kMemoryDynamicDescriptorHeaps,      // shader-visible heaps of DynamicDescriptorHeap
+    kMemoryDescriptorAllocatorHeaps,    // CPU descriptor heaps of DescriptorAllocator
+    kMemoryBufferHeaps,                 // heaps of the GpuHeapAllocator (vertex buffers)
+    kMemoryFrameConstantRing,           // persistently mapped per-frame constants
+    kMemoryBindlessDescriptorHeap,      // persistent shader-visible descriptor heap
+    kMemoryUploadRing,                  // staging ring of the UploadManager
+    kMemoryReadbackRing,                // slot buffers of ReadbackRing (frame capture)
+
+    kNumMemoryCategories
+};
+
+class MemoryStatistics
+{
+public:
+    struct CategorySnapshot
+    {
+        uint64_t LiveBytes;
+        uint64_t PeakBytes;
+        uint32_t LiveObjects;           // pages or heaps
+        uint32_t PeakObjects;
+        uint64_t TotalAllocations;      // since startup
+    };
+
+    struct Snapshot
+    {
+        uint64_t FrameNumber;
+        uint64_t TotalLiveBytes;        // sum over the categories
+        uint64_t TotalPeakBytes;        // sum of the category peaks, the categories may have peaked at different times
+        CategorySnapshot Categories[kNumMemoryCategories];
+
+        std::string ToJson() const;
+    };
+
+    MemoryStatistics();
+
+    MemoryStatistics(const MemoryStatistics&) = delete;
+    MemoryStatistics& operator=(const MemoryStatistics&) = delete;
+
+    void OnAllocate(MemoryCategory Category, uint64_t Bytes);
+    void OnFree(MemoryCategory Category, uint64_t Bytes);
+
+    Snapshot GetSnapshot(uint64_t FrameNumber = 0) const;
+
+    static const char* GetCategoryName(MemoryCategory Category);
+
+private:
+    // One cache line per category, allocators of different categories do not share lines
+    struct alignas(64) Counters
+    {
+        std::atomic<uint64_t> LiveBytes;
+        std::atomic<uint64_t> PeakBytes;
+        std::atomic<uint32_t> LiveObjects;
+        std::atomic<uint32_t> PeakObjects;
+        std::atomic<uint64_t> TotalAllocations;
+    };
+
+    Counters m_Counters[kNumMemoryCategories];
+};
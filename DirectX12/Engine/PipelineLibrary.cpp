@@ -0,0 +1,164 @@
+#include "pchDirectX.h"
+#include "PipelineLibrary.h"
+
+PipelineLibrary::PipelineLibrary() :
+    m_Dirty(false),
+    m_NumLoaded(0),
+    m_NumStored(0)
+{
+}
+
+PipelineLibrary::~PipelineLibrary()
+{
+    Destroy();
+}
+
+void PipelineLibrary::Create(ID3D12Device4* pDevice, IDXGIAdapter1* pAdapter, const std::filesystem::path& Path)
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    ASSERT(m_pLibrary == nullptr);
+    m_Path = Path;
+
+    if (pAdapter != nullptr)
+    {
+        DXGI_ADAPTER_DESC1 Desc;
+        if (SUCCEEDED(pAdapter->GetDesc1(&Desc)))
+        {
+            m_Identity.VendorId = Desc.VendorId;
+            m_Identity.DeviceId = Desc.DeviceId;
+            m_Identity.SubSysId = Desc.SubSysId;
+            m_Identity.Revision = Desc.Revision;
+        }
+
+        // The user mode driver version, as shown in the device manager
+        LARGE_INTEGER DriverVersion;
+        if (SUCCEEDED(pAdapter->CheckInterfaceSupport(__uuidof(IDXGIDevice), &DriverVersion)))
+            m_Identity.DriverVersion = static_cast<uint64_t>(DriverVersion.QuadPart);
+    }
+
+    const PipelineLibraryFile::Result Result = PipelineLibraryFile::Read(m_Path, m_Identity, m_Blob);
+    if (Result == PipelineLibraryFile::kCorrupt)
+        Utility::Print("WARNING:  Pipeline library file is damaged, pipelines are compiled again\n");
+    else if (Result == PipelineLibraryFile::kStale)
+        Utility::Print("Pipeline library file is for another adapter or driver, pipelines are compiled again\n");
+
+    // The runtime checks the blob itself as well, a blob it refuses is replaced by an empty library
+    HRESULT hr = E_FAIL;
+    if (Result == PipelineLibraryFile::kLoaded)
+        hr = pDevice->CreatePipelineLibrary(m_Blob.data(), m_Blob.size(), MY_IID_PPV_ARGS(m_pLibrary.GetAddressOf()));
+
+    if (FAILED(hr))
+    {
+        m_Blob.clear();
+        m_pLibrary = nullptr;
+        hr = pDevice->CreatePipelineLibrary(nullptr, 0, MY_IID_PPV_ARGS(m_pLibrary.GetAddressOf()));
+    }
+
+    if (FAILED(hr))
+    {
+        Utility::Print("WARNING:  Pipeline libraries are not supported, pipelines are not cached on disk\n");
+        m_pLibrary = nullptr;
+    }
+    else
+    {
+        m_pLibrary->SetName(L"PipelineLibrary");
+    }
+
+    m_Dirty = false;
+}
+
+void PipelineLibrary::Save()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    if (m_pLibrary == nullptr || !m_Dirty)
+        return;
+
+    std::vector<uint8_t> Data(m_pLibrary->GetSerializedSize());
+    if (FAILED(m_pLibrary->Serialize(Data.data(), Data.size())))
+    {
+        Utility::Print("WARNING:  Failed to serialize the pipeline library\n");
+        return;
+    }
+
+    if (PipelineLibraryFile::Write(m_Path, m_Identity, Data.data(), Data.size()))
+        m_Dirty = false;
+    else
+        Utility::Printf(L"WARNING:  Failed to write the pipeline library %s\n", m_Path.c_str());
+}
+
+void PipelineLibrary::Destroy()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    m_pLibrary = nullptr;
+    m_Blob.clear();
+    m_Dirty = false;
+}
+
+// Loads need no lock, the pipeline library is free-threaded.  The mutex only
+// keeps Serialize away from concurrent stores.
+
+bool PipelineLibrary::LoadGraphicsPipeline(size_t Hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& PipelineState)
+{
+    if (m_pLibrary == nullptr)
+        return false;
+
+    wchar_t Name[17];
+    GetName(Hash, Name);
+
+    // Fails for unknown names as well as for names whose description changed
+    if (FAILED(m_pLibrary->LoadGraphicsPipeline(Name, &Desc, MY_IID_PPV_ARGS(PipelineState.ReleaseAndGetAddressOf()))))
+        return false;
+
+    m_NumLoaded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool PipelineLibrary::LoadComputePipeline(size_t Hash, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& PipelineState)
+{
+    if (m_pLibrary == nullptr)
+        return false;
+
+    wchar_t Name[17];
+    GetName(Hash, Name);
+
+    if (FAILED(m_pLibrary->LoadComputePipeline(Name, &Desc, MY_IID_PPV_ARGS(PipelineState.ReleaseAndGetAddressOf()))))
+        return false;
+
+    m_NumLoaded.fetch_add(1, std::memory_order_relaxed);
+    return true;
+}
+
+void PipelineLibrary::StorePipeline(size_t Hash, ID3D12PipelineState* pPipelineState)
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    if (m_pLibrary == nullptr)
+        return;
+
+    wchar_t Name[17];
+    GetName(Hash, Name);
+
+    // The name covers the whole description, it is only taken already when two
+    // descriptions collide.  The second one is then compiled in every run.
+    if (SUCCEEDED(m_pLibrary->StorePipeline(Name, pPipelineState)))
+    {
+        m_Dirty = true;
+        m_NumStored.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+PipelineLibrary::Statistics PipelineLibrary::GetStatistics() const
+{
+    Statistics Stats;
+    Stats.NumLoaded = m_NumLoaded.load(std::memory_order_relaxed);
+    Stats.NumStored = m_NumStored.load(std::memory_order_relaxed);
+    return Stats;
+}
+
+void PipelineLibrary::GetName(size_t Hash, wchar_t (&Name)[17])
+{
+    swprintf_s(Name, L"%016llX", static_cast<unsigned long long>(Hash));
+}
@@ -0,0 +1,67 @@
+//
+// Compiled pipeline states kept on disk between runs in an ID3D12PipelineLibrary.
+// Pipelines are named by the hash of their PipelineStateKey, which holds the
+// shaders by content and is the same in every run.  A pipeline of the library
+// whose description no longer matches is reported as a miss by the runtime and
+// compiled again.
+//
+// When the library cannot be created (no file, another adapter or driver, or
+// no driver support) every load misses and only the compile time is lost.
+//
+
+#pragma once
+
+#include "PipelineLibraryFile.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <vector>
+
+class PipelineLibrary
+{
+public:
+    struct Statistics
+    {
+        uint32_t NumLoaded = 0;
+        uint32_t NumStored = 0;
+    };
+
+    PipelineLibrary();
+    ~PipelineLibrary();
+
+    PipelineLibrary(const PipelineLibrary&) = delete;
+    PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+    // Loads the file at Path if it was written for this adapter and driver
+    void Create(ID3D12Device4* pDevice, IDXGIAdapter1* pAdapter, const std::filesystem::path& Path);
+
+    // Writes the library back if pipelines were stored since it was loaded
+    void Save();
+
+    void Destroy();
+
+    // Return false on a miss, the caller compiles the pipeline and stores it
+    bool LoadGraphicsPipeline(size_t Hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& PipelineState);
+    bool LoadComputePipeline(size_t Hash, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc, Microsoft::WRL::ComPtr<ID3D12PipelineState>& PipelineState);
+
+    void StorePipeline(size_t Hash, ID3D12PipelineState* pPipelineState);
+
+    Statistics GetStatistics() const;
+
+private:
+    static void GetName(size_t Hash, wchar_t (&Name)[17]);
+
+    std::mutex m_Mutex;
+    Microsoft::WRL::ComPtr<ID3D12PipelineLibrary> m_pLibrary;
+
+    // The library reads from the blob it was created with as long as it lives
+    std::vector<uint8_t> m_Blob;
+
+    std::filesystem::path m_Path;
+    PipelineLibraryIdentity m_Identity;
+    bool m_Dirty;
+
+    std::atomic<uint32_t> m_NumLoaded;
+    std::atomic<uint32_t> m_NumStored;
+};
@@ -0,0 +1,84 @@
+#include "pchDirectX.h"
+#include "PipelineLibraryFile.h"
+
+#include <fstream>
+#include <system_error>
+
+PipelineLibraryFile::Result PipelineLibraryFile::Read(const std::filesystem::path& Path, const PipelineLibraryIdentity& Identity, std::vector<uint8_t>& Blob)
+{
+    std::ifstream InFile(Path, std::ios::in | std::ios::binary);
+    if (!InFile)
+        return kMissing;
+
+    Header FileHeader;
+    if (!InFile.read(reinterpret_cast<char*>(&FileHeader), sizeof(FileHeader)) || FileHeader.Magic != kMagic)
+        return kCorrupt;
+
+    if (FileHeader.Version != kVersion || !(FileHeader.Identity == Identity))
+        return kStale;
+
+    // The blob has to fill the rest of the file exactly
+    InFile.seekg(0, std::ios::end);
+    const uint64_t FileSize = static_cast<uint64_t>(InFile.tellg());
+    if (FileSize != sizeof(FileHeader) + FileHeader.BlobSize)
+        return kCorrupt;
+
+    std::vector<uint8_t> Data(static_cast<size_t>(FileHeader.BlobSize));
+    InFile.seekg(sizeof(FileHeader), std::ios::beg);
+    if (!InFile.read(reinterpret_cast<char*>(Data.data()), Data.size()) ||
+        Checksum(Data.data(), Data.size()) != FileHeader.BlobChecksum)
+    {
+        return kCorrupt;
+    }
+
+    Blob.swap(Data);
+    return kLoaded;
+}
+
+bool PipelineLibraryFile::Write(const std::filesystem::path& Path, const PipelineLibraryIdentity& Identity, const void* Blob, size_t Size)
+{
+    std::error_code Error;
+    if (Path.has_parent_path())
+        std::filesystem::create_directories(Path.parent_path(), Error);
+
+    Header FileHeader = {};
+    FileHeader.Magic = kMagic;
+    FileHeader.Version = kVersion;
+    FileHeader.Identity = Identity;
+    FileHeader.BlobSize = Size;
+    FileHeader.BlobChecksum = Checksum(Blob, Size);
+
+    std::filesystem::path TempPath = Path;
+    TempPath += L".tmp";
+    {
+        std::ofstream OutFile(TempPath, std::ios::out | std::ios::binary | std::ios::trunc);
+        OutFile.write(reinterpret_cast<const char*>(&FileHeader), sizeof(FileHeader));
+        OutFile.write(static_cast<const char*>(Blob), Size);
+        OutFile.close();
+
+        if (!OutFile)
+        {
+            std::filesystem::remove(TempPath, Error);
+            return false;
+        }
+    }
+
+    std::filesystem::rename(TempPath, Path, Error);
+    if (Error)
+    {
+        std::filesystem::remove(TempPath, Error);
+        return false;
+    }
+
+    return true;
+}
+
+uint64_t PipelineLibraryFile::Checksum(const void* Data, size_t Size)
+{
+    // FNV-1a, enough to notice a damaged file
+    const uint8_t* Bytes = static_cast<const uint8_t*>(Data);
+    uint64_t Hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < Size; ++i)
+        Hash = (Hash ^ Bytes[i]) * 1099511628211ULL;
+    return Hash;
+}
@@ -0,0 +1,65 @@
+//
+// The file behind the pipeline library: a small header followed by the blob of
+// ID3D12PipelineLibrary::Serialize.  The header names the adapter and driver the
+// blob was written with, so a blob of another GPU or driver is never handed to
+// the runtime, and carries the size and a checksum of the blob, so a file that
+// was truncated or damaged is detected before it is loaded.
+//
+// Knows nothing about D3D12 and can be exercised without a device.
+//
+
+#pragma once
+
+#include <filesystem>
+#include <vector>
+#include <stdint.h>
+
+struct PipelineLibraryIdentity
+{
+    uint32_t VendorId = 0;
+    uint32_t DeviceId = 0;
+    uint32_t SubSysId = 0;
+    uint32_t Revision = 0;
+    uint64_t DriverVersion = 0;
+
+    bool operator==(const PipelineLibraryIdentity& Other) const
+    {
+        return VendorId == Other.VendorId && DeviceId == Other.DeviceId && SubSysId == Other.SubSysId &&
+            Revision == Other.Revision && DriverVersion == Other.DriverVersion;
+    }
+};
+
+class PipelineLibraryFile
+{
+public:
+    // Raise whenever the layout of the file or the naming of the pipelines changes
+    static const uint32_t kVersion = 2;
+
+    enum Result
+    {
+        kLoaded,
+        kMissing,
+        kCorrupt,       // unknown format, wrong size or checksum
+        kStale          // written by an older version, another adapter or another driver
+    };
+
+    // Blob is only filled for kLoaded
+    static Result Read(const std::filesystem::path& Path, const PipelineLibraryIdentity& Identity, std::vector<uint8_t>& Blob);
+
+    // Writes a temporary file next to Path and renames it, a crash while writing leaves the old file intact
+    static bool Write(const std::filesystem::path& Path, const PipelineLibraryIdentity& Identity, const void* Blob, size_t Size);
+
+    static uint64_t Checksum(const void* Data, size_t Size);
+
+private:
+    static const uint32_t kMagic = 0x42494C50;     // "PLIB"
+
+    struct Header
+    {
+        uint32_t Magic;
+        uint32_t Version;
+        PipelineLibraryIdentity Identity;
+        uint64_t BlobSize;
+        uint64_t BlobChecksum;
+    };
+};
@@ -14,10 +14,10 @@
 #include "GraphicsCore.h"
 #include "PipelineState.h"
 #include "RootSignature.h"
-#include "Hash.h"
-#include <map>
-#include <thread>
-#include <mutex>
+#include "PipelineStateCache.h"
+#include "PipelineLibrary.h"
+#include "JobSystem.h"
+#include <string.h>
 
 using Math::IsAligned;
 using Microsoft::WRL::ComPtr;
@@ -119,82 +119,160 @@ void GraphicsPSO::SetInputLayout( UINT NumElements, const D3D12_INPUT_ELEMENT_DE
         m_InputLayouts = nullptr;
 }
 
-void GraphicsPSO::Finalize(ID3D12Device4*& device)
+// Shaders go into the key by content, their addresses change from run to run.
+// The length is part of the description, so the bytes need no terminator.
+static void AppendShader(PipelineStateKey& Key, D3D12_SHADER_BYTECODE& Shader)
 {
-    // Make sure the root signature is finalized first
-    m_PSODesc.pRootSignature = m_RootSignature->GetSignature();
-    ASSERT(m_PSODesc.pRootSignature != nullptr);
-
-    m_PSODesc.InputLayout.pInputElementDescs = nullptr;
-    size_t HashCode = Utility::HashState(&m_PSODesc);
-    HashCode = Utility::HashState(m_InputLayouts.get(), m_PSODesc.InputLayout.NumElements, HashCode);
-    m_PSODesc.InputLayout.pInputElementDescs = m_InputLayouts.get();
+    Key.Append(Shader.pShaderBytecode, Shader.BytecodeLength);
+    Shader.pShaderBytecode = nullptr;
+}
 
-    ID3D12PipelineState** PSORef = nullptr;
-    bool firstCompile = false;
+static PipelineStateCache::PipelineStatePtr CreateGraphicsPipeline(GraphicsCore& core, ID3D12Device4* device, size_t Hash, const D3D12_GRAPHICS_PIPELINE_STATE_DESC& Desc)
+{
+    PipelineStateCache::PipelineStatePtr PipelineState;
+    if (!core.m_pPipelineLibrary->LoadGraphicsPipeline(Hash, Desc, PipelineState))
     {
-        lock_guard<mutex> CS(m_core.m_HashMapMutex);
-        auto iter = m_core.m_GraphicsPSOHashMap.find(HashCode);
+        ASSERT_SUCCEEDED(device->CreateGraphicsPipelineState(&Desc, MY_IID_PPV_ARGS(PipelineState.GetAddressOf())));
+        core.m_pPipelineLibrary->StorePipeline(Hash, PipelineState.Get());
+    }
+    return PipelineState;
+}
 
-        // Reserve space so the next inquiry will find that someone got here first.
-        if (iter == m_core.m_GraphicsPSOHashMap.end())
-        {
-            firstCompile = true;
-            PSORef = m_core.m_GraphicsPSOHashMap[HashCode].GetAddressOf();
-        }
-        else
-            PSORef = iter->second.GetAddressOf();
+static PipelineStateCache::PipelineStatePtr CreateComputePipeline(GraphicsCore& core, ID3D12Device4* device, size_t Hash, const D3D12_COMPUTE_PIPELINE_STATE_DESC& Desc)
+{
+    PipelineStateCache::PipelineStatePtr PipelineState;
+    if (!core.m_pPipelineLibrary->LoadComputePipeline(Hash, Desc, PipelineState))
+    {
+        ASSERT_SUCCEEDED(device->CreateComputePipelineState(&Desc, MY_IID_PPV_ARGS(PipelineState.GetAddressOf())));
+        core.m_pPipelineLibrary->StorePipeline(Hash, PipelineState.Get());
     }
+    return PipelineState;
+}
 
-    if (firstCompile)
+bool PSO::IsReady(void)
+{
+    if (m_PSO == nullptr && m_PendingPSO.valid() &&
+        m_PendingPSO.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
     {
-        auto hr = device->CreateGraphicsPipelineState(&m_PSODesc, MY_IID_PPV_ARGS(&m_PSO));
-        ASSERT_SUCCEEDED( hr );
-        m_core.m_GraphicsPSOHashMap[HashCode].Attach(m_PSO);
+        m_PSO = m_PendingPSO.get().Get();
+        m_PendingPSO = PipelineStateCache::PipelineStateFuture();
     }
-    else
+
+    return m_PSO != nullptr;
+}
+
+void PSO::Wait(void)
+{
+    if (m_PendingPSO.valid())
     {
-        while (*PSORef == nullptr)
-            this_thread::yield();
-        m_PSO = *PSORef;
+        m_PSO = m_PendingPSO.get().Get();
+        m_PendingPSO = PipelineStateCache::PipelineStateFuture();
     }
 }
 
-void ComputePSO::Finalize(ID3D12Device4*& device)
+PipelineStateKey GraphicsPSO::MakeKey()
 {
     // Make sure the root signature is finalized first
     m_PSODesc.pRootSignature = m_RootSignature->GetSignature();
     ASSERT(m_PSODesc.pRootSignature != nullptr);
+    ASSERT(m_PSODesc.StreamOutput.NumEntries == 0 && m_PSODesc.CachedPSO.CachedBlobSizeInBytes == 0);
+    m_PSODesc.InputLayout.pInputElementDescs = m_InputLayouts.get();
 
-    size_t HashCode = Utility::HashState(&m_PSODesc);
+    // The key holds the whole description by value and no pointers, so it is the
+    // same in every run and also names the PSO in the pipeline library
+    PipelineStateKey Key(PipelineStateKey::kGraphics);
+    const size_t RootSignatureHash = m_RootSignature->GetHashCode();
+    Key.Append(&RootSignatureHash, sizeof(RootSignatureHash));
 
-    ID3D12PipelineState** PSORef = nullptr;
-    bool firstCompile = false;
-    {
-        lock_guard<mutex> CS(m_core.m_HashMapMutex);
-        auto iter = m_core.m_ComputePSOHashMap.find(HashCode);
+    D3D12_GRAPHICS_PIPELINE_STATE_DESC KeyDesc = m_PSODesc;
+    KeyDesc.pRootSignature = nullptr;
+    AppendShader(Key, KeyDesc.VS);
+    AppendShader(Key, KeyDesc.PS);
+    AppendShader(Key, KeyDesc.DS);
+    AppendShader(Key, KeyDesc.HS);
+    AppendShader(Key, KeyDesc.GS);
+    KeyDesc.InputLayout.pInputElementDescs = nullptr;
+    Key.Append(&KeyDesc, sizeof(KeyDesc));
 
-        // Reserve space so the next inquiry will find that someone got here first.
-        if (iter == m_core.m_ComputePSOHashMap.end())
-        {
-            firstCompile = true;
-            PSORef = m_core.m_ComputePSOHashMap[HashCode].GetAddressOf();
-        }
-        else
-            PSORef = iter->second.GetAddressOf();
+    for (UINT i = 0; i < m_PSODesc.InputLayout.NumElements; ++i)
+    {
+        D3D12_INPUT_ELEMENT_DESC Element = m_InputLayouts.get()[i];
+        const char* SemanticName = Element.SemanticName;
+        Element.SemanticName = nullptr;
+        Key.Append(&Element, sizeof(Element));
+        Key.Append(SemanticName, strlen(SemanticName) + 1);
     }
 
-    if (firstCompile)
+    return Key;
+}
+
+void GraphicsPSO::Finalize(ID3D12Device4*& device)
+{
+    const PipelineStateKey Key = MakeKey();
+
+    m_PendingPSO = PipelineStateCache::PipelineStateFuture();
+    m_PSO = m_core.m_pPipelineStateCache->GetOrCreate(Key, [&]()
     {
-        ASSERT_SUCCEEDED(device->CreateComputePipelineState(&m_PSODesc, MY_IID_PPV_ARGS(&m_PSO)) );
-        m_core.m_ComputePSOHashMap[HashCode].Attach(m_PSO);
-    }
-    else
+        return CreateGraphicsPipeline(m_core, device, Key.GetHash(), m_PSODesc);
+    });
+}
+
+void GraphicsPSO::FinalizeAsync(ID3D12Device4*& device)
+{
+    const PipelineStateKey Key = MakeKey();
+
+    // The job works on copies, this PSO may be changed or go away before it runs.
+    // The input layout is kept alive with the description that points at it.
+    m_PSO = nullptr;
+    m_PendingPSO = m_core.m_pPipelineStateCache->GetOrCreateAsync(Key,
+        [&core = m_core, pDevice = device, Hash = Key.GetHash(), Desc = m_PSODesc, InputLayouts = m_InputLayouts]()
+        {
+            return CreateGraphicsPipeline(core, pDevice, Hash, Desc);
+        },
+        *m_core.m_pJobSystem);
+}
+
+PipelineStateKey ComputePSO::MakeKey()
+{
+    // Make sure the root signature is finalized first
+    m_PSODesc.pRootSignature = m_RootSignature->GetSignature();
+    ASSERT(m_PSODesc.pRootSignature != nullptr);
+    ASSERT(m_PSODesc.CachedPSO.CachedBlobSizeInBytes == 0);
+
+    PipelineStateKey Key(PipelineStateKey::kCompute);
+    const size_t RootSignatureHash = m_RootSignature->GetHashCode();
+    Key.Append(&RootSignatureHash, sizeof(RootSignatureHash));
+
+    D3D12_COMPUTE_PIPELINE_STATE_DESC KeyDesc = m_PSODesc;
+    KeyDesc.pRootSignature = nullptr;
+    AppendShader(Key, KeyDesc.CS);
+    Key.Append(&KeyDesc, sizeof(KeyDesc));
+
+    return Key;
+}
+
+void ComputePSO::Finalize(ID3D12Device4*& device)
+{
+    const PipelineStateKey Key = MakeKey();
+
+    m_PendingPSO = PipelineStateCache::PipelineStateFuture();
+    m_PSO = m_core.m_pPipelineStateCache->GetOrCreate(Key, [&]()
     {
-        while (*PSORef == nullptr)
-            this_thread::yield();
-        m_PSO = *PSORef;
-    }
+        return CreateComputePipeline(m_core, device, Key.GetHash(), m_PSODesc);
+    });
+}
+
+void ComputePSO::FinalizeAsync(ID3D12Device4*& device)
+{
+    const PipelineStateKey Key = MakeKey();
+
+    m_PSO = nullptr;
+    m_PendingPSO = m_core.m_pPipelineStateCache->GetOrCreateAsync(Key,
+        [&core = m_core, pDevice = device, Hash = Key.GetHash(), Desc = m_PSODesc]()
+        {
+            return CreateComputePipeline(core, pDevice, Hash, Desc);
+        },
+        *m_core.m_pJobSystem);
 }
 
 ComputePSO::ComputePSO(GraphicsCore& core) : PSO(core)
@@ -14,6 +14,7 @@
 #pragma once
 
 #include "pch.h"
+#include "PipelineStateCache.h"
 
 class CommandContext;
 class RootSignature;
@@ -38,12 +39,19 @@ public:
 
     ID3D12PipelineState* GetPipelineStateObject( void ) const { return m_PSO; }
 
+    // After FinalizeAsync the PSO object stays null until the compile finished and
+    // IsReady() or Wait() picked it up.  Call them from the thread that binds the PSO.
+    bool IsReady( void );
+    void Wait( void );
+
 protected:
     GraphicsCore& m_core;
 
     const RootSignature* m_RootSignature;
 
     ID3D12PipelineState* m_PSO;
+
+    PipelineStateCache::PipelineStateFuture m_PendingPSO;
 };
 
 class GraphicsPSO : public PSO
@@ -83,8 +91,13 @@ public:
     // Perform validation and compute a hash value for fast state block comparisons
     void Finalize(ID3D12Device4*& device);
 
+    // Compiles on the job system, see IsReady()
+    void FinalizeAsync(ID3D12Device4*& device);
+
 private:
 
+    PipelineStateKey MakeKey();
+
     D3D12_GRAPHICS_PIPELINE_STATE_DESC m_PSODesc;
     std::shared_ptr<const D3D12_INPUT_ELEMENT_DESC> m_InputLayouts;
 };
@@ -101,8 +114,11 @@ public:
     void SetComputeShader( const D3D12_SHADER_BYTECODE& Binary ) { m_PSODesc.CS = Binary; }
 
     void Finalize(ID3D12Device4*& device);
+    void FinalizeAsync(ID3D12Device4*& device);
 
 private:
 
+    PipelineStateKey MakeKey();
+
     D3D12_COMPUTE_PIPELINE_STATE_DESC m_PSODesc;
 };
@@ -0,0 +1,27 @@
+//
+// Pipeline state objects shared by all PSOs with the same description.  Entries
+// are keyed by the full description, flattened into a PipelineStateKey; colliding
+// descriptions get PSOs of their own.  The first thread asking for a description
+// compiles it, the others block until it is done.  The bookkeeping is
+// ShardedFutureCache, this only hands out the raw PSO pointers.
+//
+
+#pragma once
+
+#include "PipelineStateKey.h"
+#include "ShardedFutureCache.h"
+
+class PipelineStateCache : public ShardedFutureCache<PipelineStateKey, Microsoft::WRL::ComPtr<ID3D12PipelineState>>
+{
+public:
+    typedef Microsoft::WRL::ComPtr<ID3D12PipelineState> PipelineStatePtr;
+    typedef ShardedFutureCache<PipelineStateKey, PipelineStatePtr> Base;
+    typedef Base::ValueFuture PipelineStateFuture;
+
+    // Returns the PSO of the description, calling Create if no thread did so before.
+    // The cache keeps a reference, the PSO lives as long as the entry.
+    ID3D12PipelineState* GetOrCreate(const PipelineStateKey& Key, const std::function<PipelineStatePtr()>& Create)
+    {
+        return Base::GetOrCreate(Key, Create).Get();
+    }
+};
@@ -0,0 +1,20 @@
+#include "pchDirectX.h"
+#include "PipelineStateKey.h"
+#include "Hash.h"
+
+#include <string.h>
+
+PipelineStateKey::PipelineStateKey(Type KeyType) :
+    m_Words(1, KeyType),
+    m_Hash(Utility::HashRange(m_Words.data(), m_Words.data() + 1, 2166136261U))
+{
+}
+
+void PipelineStateKey::Append(const void* Data, size_t Size)
+{
+    const size_t First = m_Words.size();
+    m_Words.resize(First + (Size + 3) / 4, 0);
+    memcpy(m_Words.data() + First, Data, Size);
+
+    m_Hash = Utility::HashRange(m_Words.data() + First, m_Words.data() + m_Words.size(), m_Hash);
+}
@@ -0,0 +1,36 @@
+//
+// The full description of a pipeline state, flattened into words.  Two keys are
+// equal only if every word is; the hash just picks where to look.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+class PipelineStateKey
+{
+public:
+    enum Type : uint32_t
+    {
+        kGraphics,
+        kCompute
+    };
+
+    explicit PipelineStateKey(Type KeyType);
+
+    // Appends the bytes of Data, padded to whole words
+    void Append(const void* Data, size_t Size);
+
+    size_t GetHash() const { return m_Hash; }
+
+    bool operator==(const PipelineStateKey& Other) const
+    {
+        return m_Hash == Other.m_Hash && m_Words == Other.m_Words;
+    }
+
+private:
+    std::vector<uint32_t> m_Words;
+    size_t m_Hash;
+};
@@ -16,6 +16,7 @@
 #include "GraphicsCore.h"
 #include "CommandContext.h"
 #include "ReadbackBuffer.h"
+#include "ImageExporter.h"
 #include <fstream>
 
 DXGI_FORMAT PixelBuffer::GetBaseFormat( DXGI_FORMAT defaultFormat )
@@ -421,3 +422,22 @@ void PixelBuffer::ExportToFile( const std::wstring& FilePath )
     // No values were written to the buffer, so use a null range when unmapping.
     TempBuffer.Unmap();
 }
+
+void PixelBuffer::ExportToFile( const std::wstring& FilePath, ImageExporter& Exporter, ImageFileFormat FileFormat )
+{
+    ReadbackBuffer TempBuffer(this->m_core);
+
+    const UINT bytesPerPixelOfInputBitmap = static_cast<const UINT>(PixelBuffer::BytesPerPixel(m_Format));
+
+    auto rowPitchOfSource = (m_Width * bytesPerPixelOfInputBitmap + D3D12_TEXTURE_DATA_PITCH_ALIGNMENT - 1) / D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+    rowPitchOfSource = rowPitchOfSource * D3D12_TEXTURE_DATA_PITCH_ALIGNMENT;
+
+    TempBuffer.Create(L"Temporary Readback Buffer", rowPitchOfSource / bytesPerPixelOfInputBitmap * m_Height, bytesPerPixelOfInputBitmap);
+
+    CommandContext::ReadbackTexture2D(this->m_core, TempBuffer, *this);
+
+    // The pixels are converted before Export() returns, only waits when the exporter is full
+    void* Memory = TempBuffer.Map();
+    Exporter.Export(Memory, rowPitchOfSource, m_Width, m_Height, m_Format, FilePath, FileFormat);
+    TempBuffer.Unmap();
+}
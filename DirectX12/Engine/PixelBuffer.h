@@ -14,6 +14,9 @@
 #pragma once
 
 #include "GpuResource.h"
+#include "ImageEncoder.h"
+
+class ImageExporter;
 
 //class EsramAllocator;
 
@@ -35,6 +38,9 @@ public:
     // Note that data is preceded by a 16-byte header:  { DXGI_FORMAT, Pitch (in pixels), Width (in pixels), Height }
     void ExportToFile( const std::wstring& FilePath );
 
+    // Reads the texture back and leaves converting, encoding and writing to the exporter
+    void ExportToFile( const std::wstring& FilePath, ImageExporter& Exporter, ImageFileFormat FileFormat );
+
     static size_t BytesPerPixel(DXGI_FORMAT Format);
 
 protected:
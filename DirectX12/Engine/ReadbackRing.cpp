@@ -0,0 +1,157 @@
+#include "pchDirectX.h"
+#include "ReadbackRing.h"
+#include "GraphicsCore.h"
+#include "CommandContext.h"
+#include "CommandListManager.h"
+#include "PixelBuffer.h"
+
+ReadbackRing::ReadbackRing(GraphicsCore& core) :
+    m_Core(core),
+    m_NextCapture(0),
+    m_NextDelivery(0)
+{
+}
+
+ReadbackRing::~ReadbackRing()
+{
+    Destroy();
+}
+
+void ReadbackRing::Create(uint32_t NumSlots)
+{
+    ASSERT(m_Slots.empty());
+    ASSERT(NumSlots > 0);
+
+    // The buffers are created by the first capture that uses a slot
+    m_Slots.resize(NumSlots);
+    m_NextCapture = 0;
+    m_NextDelivery = 0;
+}
+
+void ReadbackRing::Destroy()
+{
+    for (Slot& Target : m_Slots)
+    {
+        if (Target.Buffer != nullptr)
+            m_Core.m_MemoryStatistics.OnFree(kMemoryReadbackRing, Target.BufferSize);
+    }
+
+    m_Slots.clear();
+    m_NextCapture = 0;
+    m_NextDelivery = 0;
+}
+
+bool ReadbackRing::Capture(CommandContext& Context, PixelBuffer& Source, uint64_t FrameNumber)
+{
+    ASSERT(!m_Slots.empty(), "Create() first");
+    ASSERT(Source.GetUsageState() == D3D12_RESOURCE_STATE_COPY_SOURCE, "The source has to be in COPY_SOURCE");
+
+    Slot& Target = m_Slots[m_NextCapture];
+    if (Target.State != kFree)
+    {
+        ++m_Statistics.NumDropped;
+        return false;
+    }
+
+    const D3D12_RESOURCE_DESC SourceDesc = Source.GetResource()->GetDesc();
+    UINT64 TotalBytes = 0;
+    m_Core.m_pDevice->GetCopyableFootprints(&SourceDesc, 0, 1, 0, &Target.Footprint, &Target.Height, nullptr, &TotalBytes);
+
+    // The slot is free, so the GPU no longer uses its old buffer
+    if (Target.BufferSize < TotalBytes)
+    {
+        if (Target.Buffer != nullptr)
+            m_Core.m_MemoryStatistics.OnFree(kMemoryReadbackRing, Target.BufferSize);
+
+        Target.Buffer = std::make_unique<ReadbackBuffer>(m_Core);
+        Target.Buffer->Create(L"ReadbackRing", static_cast<uint32_t>(TotalBytes), 1);
+        Target.BufferSize = static_cast<size_t>(TotalBytes);
+
+        m_Core.m_MemoryStatistics.OnAllocate(kMemoryReadbackRing, Target.BufferSize);
+    }
+
+    Context.FlushResourceBarriers();
+
+    const CD3DX12_TEXTURE_COPY_LOCATION Dest(Target.Buffer->GetResource(), Target.Footprint);
+    const CD3DX12_TEXTURE_COPY_LOCATION Src(Source.GetResource(), 0);
+    Context.GetCommandList()->CopyTextureRegion(&Dest, 0, 0, 0, &Src, nullptr);
+
+    Target.State = kRecorded;
+    Target.FrameNumber = FrameNumber;
+    m_NextCapture = (m_NextCapture + 1) % m_Slots.size();
+
+    ++m_Statistics.NumCaptured;
+    return true;
+}
+
+void ReadbackRing::Submitted(uint64_t FenceValue)
+{
+    for (Slot& Target : m_Slots)
+    {
+        if (Target.State == kRecorded)
+        {
+            Target.State = kInFlight;
+            Target.FenceValue = FenceValue;
+        }
+    }
+}
+
+void ReadbackRing::Deliver(Slot& Target, const FrameCallback& OnFrame)
+{
+    const uint8_t* Memory = static_cast<const uint8_t*>(Target.Buffer->Map());
+
+    CapturedFrame Frame;
+    Frame.FrameNumber = Target.FrameNumber;
+    Frame.Width = static_cast<uint32_t>(Target.Footprint.Footprint.Width);
+    Frame.Height = Target.Height;
+    Frame.Format = Target.Footprint.Footprint.Format;
+    Frame.RowPitch = Target.Footprint.Footprint.RowPitch;
+    Frame.Data = Memory + Target.Footprint.Offset;
+
+    if (OnFrame)
+        OnFrame(Frame);
+
+    Target.Buffer->Unmap();
+    Target.State = kFree;
+
+    ++m_Statistics.NumDelivered;
+}
+
+uint32_t ReadbackRing::Poll(const FrameCallback& OnFrame)
+{
+    uint32_t NumDelivered = 0;
+
+    for (uint32_t i = 0; i < m_Slots.size(); ++i)
+    {
+        Slot& Target = m_Slots[m_NextDelivery];
+        if (Target.State != kInFlight || !m_Core.m_pCommandManager->IsFenceComplete(Target.FenceValue))
+            break;
+
+        Deliver(Target, OnFrame);
+        m_NextDelivery = (m_NextDelivery + 1) % m_Slots.size();
+        ++NumDelivered;
+    }
+
+    return NumDelivered;
+}
+
+uint32_t ReadbackRing::Flush(const FrameCallback& OnFrame)
+{
+    uint32_t NumDelivered = 0;
+
+    for (uint32_t i = 0; i < m_Slots.size(); ++i)
+    {
+        Slot& Target = m_Slots[m_NextDelivery];
+        ASSERT(Target.State != kRecorded, "Submitted() was not called for a captured frame");
+        if (Target.State != kInFlight)
+            break;
+
+        m_Core.m_pCommandManager->WaitForFence(Target.FenceValue);
+
+        Deliver(Target, OnFrame);
+        m_NextDelivery = (m_NextDelivery + 1) % m_Slots.size();
+        ++NumDelivered;
+    }
+
+    return NumDelivered;
+}
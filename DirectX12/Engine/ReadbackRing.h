@@ -0,0 +1,107 @@
+//
+// Reads rendered frames back without stalling the render loop.  Capture()
+// records the copy of a texture into the next slot of a ring of readback
+// buffers, inside the context of the frame; Submitted() hands over the fence of
+// the submission.  Poll() delivers the frames the GPU is done with, in capture
+// order, and never waits, so frame k is read while frames k+1 .. k+N render.
+//
+// When every slot is still in flight or not yet delivered the frame is
+// dropped and counted instead of waiting.  The slot buffers grow with the
+// captured texture, a resize needs no flush.
+//
+// Not thread safe, call it from the thread that records the frames.
+//
+
+#pragma once
+
+#include "FrameFenceRing.h"
+#include "ReadbackBuffer.h"
+
+#include <functional>
+#include <memory>
+#include <vector>
+
+class GraphicsCore;
+class CommandContext;
+class PixelBuffer;
+
+struct CapturedFrame
+{
+    uint64_t FrameNumber;
+    uint32_t Width;
+    uint32_t Height;
+    DXGI_FORMAT Format;
+    uint32_t RowPitch;          // bytes from one row to the next, rows are padded
+    const void* Data;           // valid during the callback only
+};
+
+class ReadbackRing
+{
+public:
+    using FrameCallback = std::function<void(const CapturedFrame&)>;
+
+    static const uint32_t kDefaultNumSlots = FrameFenceRing::MAX_FRAMES_IN_FLIGHT + 1;
+
+    struct Statistics
+    {
+        uint64_t NumCaptured = 0;
+        uint64_t NumDelivered = 0;
+        uint64_t NumDropped = 0;
+    };
+
+    ReadbackRing(GraphicsCore& core);
+    ~ReadbackRing();
+
+    ReadbackRing(const ReadbackRing&) = delete;
+    ReadbackRing& operator=(const ReadbackRing&) = delete;
+
+    void Create(uint32_t NumSlots = kDefaultNumSlots);
+
+    // Frames not delivered yet are lost, the GPU must be done with them
+    void Destroy();
+
+    bool IsCreated() const { return !m_Slots.empty(); }
+
+    // Source must be in COPY_SOURCE.  Returns false when the frame was dropped.
+    bool Capture(CommandContext& Context, PixelBuffer& Source, uint64_t FrameNumber);
+
+    // Fence of the submission holding the copies recorded since the last call
+    void Submitted(uint64_t FenceValue);
+
+    // Hands the completed frames to OnFrame without waiting, returns their number
+    uint32_t Poll(const FrameCallback& OnFrame);
+
+    // Waits for all submitted frames and hands them to OnFrame
+    uint32_t Flush(const FrameCallback& OnFrame);
+
+    const Statistics& GetStatistics() const { return m_Statistics; }
+
+private:
+    enum SlotState
+    {
+        kFree,
+        kRecorded,          // copy recorded, fence not known yet
+        kInFlight
+    };
+
+    struct Slot
+    {
+        std::unique_ptr<ReadbackBuffer> Buffer;
+        size_t BufferSize = 0;
+        SlotState State = kFree;
+        uint64_t FenceValue = 0;
+        uint64_t FrameNumber = 0;
+        uint32_t Height = 0;
+        D3D12_PLACED_SUBRESOURCE_FOOTPRINT Footprint = {};
+    };
+
+    void Deliver(Slot& Target, const FrameCallback& OnFrame);
+
+    GraphicsCore& m_Core;
+
+    std::vector<Slot> m_Slots;
+    uint32_t m_NextCapture;
+    uint32_t m_NextDelivery;
+
+    Statistics m_Statistics;
+};
@@ -0,0 +1,150 @@
+#include "pchDirectX.h"
+#include "ResourceStateTracker.h"
+
+#include <algorithm>
+
+ResourceStateTracker::ResourceStateTracker(uint32_t ReadOnlyStates) :
+    m_ReadOnlyStates(ReadOnlyStates),
+    m_EndCommandList(0)
+{
+}
+
+void ResourceStateTracker::Reset()
+{
+    m_Resources.clear();
+    m_PassCommandLists.clear();
+    m_Uses.clear();
+    m_PlannedBarriers.clear();
+    m_Barriers.clear();
+    m_BoundaryStart.clear();
+    m_BoundaryFill.clear();
+}
+
+uint32_t ResourceStateTracker::AddResource(uint32_t InitialState, uint32_t FinalState)
+{
+    m_Resources.push_back({ InitialState, FinalState, InitialState });
+    return static_cast<uint32_t>(m_Resources.size() - 1);
+}
+
+void ResourceStateTracker::AddPass(uint32_t CommandList)
+{
+    m_PassCommandLists.push_back(CommandList);
+}
+
+void ResourceStateTracker::Use(uint32_t Resource, uint32_t State)
+{
+    ASSERT(Resource < m_Resources.size());
+    ASSERT(!m_PassCommandLists.empty(), "Use() before the first AddPass()");
+
+    m_Uses.push_back({ Resource, GetNumPasses() - 1, State });
+}
+
+uint32_t ResourceStateTracker::GetCommandList(uint32_t Boundary) const
+{
+    return Boundary < GetNumPasses() ? m_PassCommandLists[Boundary] : m_EndCommandList;
+}
+
+void ResourceStateTracker::AddTransition(uint32_t Resource, uint32_t Before, uint32_t After, int32_t LastPass, uint32_t NextPass)
+{
+    const uint32_t BeginBoundary = static_cast<uint32_t>(LastPass + 1);
+
+    if (BeginBoundary < NextPass && GetCommandList(BeginBoundary) == GetCommandList(NextPass))
+    {
+        m_PlannedBarriers.push_back({ BeginBoundary, { Resource, Before, After, kBeginOnly } });
+        m_PlannedBarriers.push_back({ NextPass, { Resource, Before, After, kEndOnly } });
+    }
+    else
+    {
+        m_PlannedBarriers.push_back({ NextPass, { Resource, Before, After, kFull } });
+    }
+}
+
+void ResourceStateTracker::Plan(uint32_t EndCommandList)
+{
+    m_EndCommandList = EndCommandList;
+    m_PlannedBarriers.clear();
+
+    // The uses of each resource in pass order
+    std::sort(m_Uses.begin(), m_Uses.end(), [](const ResourceUse& A, const ResourceUse& B)
+    {
+        return A.Resource != B.Resource ? A.Resource < B.Resource : A.Pass < B.Pass;
+    });
+
+    size_t UseIndex = 0;
+    for (uint32_t ResourceIndex = 0; ResourceIndex < m_Resources.size(); ++ResourceIndex)
+    {
+        TrackedResource& Res = m_Resources[ResourceIndex];
+        uint32_t State = Res.InitialState;
+        int32_t LastPass = -1;
+
+        while (UseIndex < m_Uses.size() && m_Uses[UseIndex].Resource == ResourceIndex)
+        {
+            const uint32_t FirstPass = m_Uses[UseIndex].Pass;
+            uint32_t Target = m_Uses[UseIndex].State;
+            uint32_t GroupLastPass = FirstPass;
+            ++UseIndex;
+
+            // Gather the following uses into one state: all reads, or all uses of the same pass
+            while (UseIndex < m_Uses.size() && m_Uses[UseIndex].Resource == ResourceIndex)
+            {
+                const ResourceUse& Next = m_Uses[UseIndex];
+                if (IsReadOnly(Target) && IsReadOnly(Next.State))
+                    Target |= Next.State;
+                else if (Next.Pass == GroupLastPass)
+                {
+                    ASSERT(Next.State == Target, "A pass uses a resource in two states");
+                }
+                else
+                    break;
+
+                GroupLastPass = Next.Pass;
+                ++UseIndex;
+            }
+
+            // A combined read state covers every read it contains
+            const bool Covered = Target == State || (IsReadOnly(State) && IsReadOnly(Target) && (State & Target) == Target);
+            if (!Covered)
+            {
+                AddTransition(ResourceIndex, State, Target, LastPass, FirstPass);
+                State = Target;
+            }
+
+            LastPass = static_cast<int32_t>(GroupLastPass);
+        }
+
+        if (Res.FinalState != kKeepState && Res.FinalState != State)
+        {
+            AddTransition(ResourceIndex, State, Res.FinalState, LastPass, GetNumPasses());
+            State = Res.FinalState;
+        }
+
+        Res.PlannedState = State;
+    }
+
+    // Bucket the barriers by boundary, keeping the resource order within a boundary
+    const uint32_t NumBoundaries = GetNumPasses() + 1;
+    m_BoundaryStart.assign(NumBoundaries + 1, 0);
+    for (const PlannedBarrier& Planned : m_PlannedBarriers)
+        ++m_BoundaryStart[Planned.Boundary + 1];
+    for (uint32_t i = 0; i < NumBoundaries; ++i)
+        m_BoundaryStart[i + 1] += m_BoundaryStart[i];
+
+    m_Barriers.resize(m_PlannedBarriers.size());
+    m_BoundaryFill.assign(m_BoundaryStart.begin(), m_BoundaryStart.end() - 1);
+    for (const PlannedBarrier& Planned : m_PlannedBarriers)
+        m_Barriers[m_BoundaryFill[Planned.Boundary]++] = Planned.Desc;
+}
+
+const ResourceStateTracker::Barrier* ResourceStateTracker::GetBarriers(uint32_t Boundary, uint32_t& NumBarriers) const
+{
+    ASSERT(Boundary + 1 < m_BoundaryStart.size(), "Plan() first");
+
+    NumBarriers = m_BoundaryStart[Boundary + 1] - m_BoundaryStart[Boundary];
+    return m_Barriers.data() + m_BoundaryStart[Boundary];
+}
+
+uint32_t ResourceStateTracker::GetFinalState(uint32_t Resource) const
+{
+    ASSERT(Resource < m_Resources.size());
+    return m_Resources[Resource].PlannedState;
+}
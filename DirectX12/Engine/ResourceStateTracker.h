@@ -0,0 +1,109 @@
+//
+// Plans the resource transitions of a frame ahead of recording.  The passes of
+// the frame declare the state they need each resource in; Plan() derives the
+// barriers at every pass boundary, so all transitions of a boundary go out in a
+// single ResourceBarrier call.
+//
+// A transition whose resource is idle for one or more passes is split: the
+// BEGIN_ONLY half goes right after the last pass using the old state, the
+// END_ONLY half right before the first pass using the new one, and the GPU can
+// do the transition in between.  Split barriers never cross command lists.
+//
+// Consecutive passes that only read a resource get one combined read state.
+//
+// Resources and states are plain numbers, the tracker knows nothing about D3D12
+// and can be driven without a device.
+//
+
+#pragma once
+
+#include <vector>
+#include <stdint.h>
+
+class ResourceStateTracker
+{
+public:
+    // As the final state: leave the resource in the state of its last use
+    static const uint32_t kKeepState = UINT32_MAX;
+
+    enum BarrierType : uint32_t
+    {
+        kFull,
+        kBeginOnly,
+        kEndOnly
+    };
+
+    struct Barrier
+    {
+        uint32_t Resource;
+        uint32_t StateBefore;
+        uint32_t StateAfter;
+        BarrierType Type;
+    };
+
+    // ReadOnlyStates holds the state bits that may be combined with each other
+    explicit ResourceStateTracker(uint32_t ReadOnlyStates = 0);
+
+    // Forgets the resources and passes of the last frame, keeps the memory
+    void Reset();
+
+    // Returns the index of the resource, counting from 0
+    uint32_t AddResource(uint32_t InitialState, uint32_t FinalState = kKeepState);
+
+    // Passes with the same CommandList are recorded into the same command list
+    void AddPass(uint32_t CommandList);
+
+    // The last added pass uses Resource in State
+    void Use(uint32_t Resource, uint32_t State);
+
+    // EndCommandList records the barriers after the last pass
+    void Plan(uint32_t EndCommandList);
+
+    uint32_t GetNumPasses() const { return static_cast<uint32_t>(m_PassCommandLists.size()); }
+
+    // Barriers before pass Boundary; Boundary == GetNumPasses() is the end of the frame
+    const Barrier* GetBarriers(uint32_t Boundary, uint32_t& NumBarriers) const;
+
+    // State of the resource after the frame
+    uint32_t GetFinalState(uint32_t Resource) const;
+
+private:
+    struct TrackedResource
+    {
+        uint32_t InitialState;
+        uint32_t FinalState;
+        uint32_t PlannedState;
+    };
+
+    struct ResourceUse
+    {
+        uint32_t Resource;
+        uint32_t Pass;
+        uint32_t State;
+    };
+
+    struct PlannedBarrier
+    {
+        uint32_t Boundary;
+        Barrier Desc;
+    };
+
+    bool IsReadOnly(uint32_t State) const { return State != 0 && (State & ~m_ReadOnlyStates) == 0; }
+
+    uint32_t GetCommandList(uint32_t Boundary) const;
+
+    // Transition between the last use in LastPass (-1 for none) and the next one in NextPass
+    void AddTransition(uint32_t Resource, uint32_t Before, uint32_t After, int32_t LastPass, uint32_t NextPass);
+
+    uint32_t m_ReadOnlyStates;
+    uint32_t m_EndCommandList;
+
+    std::vector<TrackedResource> m_Resources;
+    std::vector<uint32_t> m_PassCommandLists;
+    std::vector<ResourceUse> m_Uses;
+
+    std::vector<PlannedBarrier> m_PlannedBarriers;
+    std::vector<Barrier> m_Barriers;
+    std::vector<uint32_t> m_BoundaryStart;      // first barrier of each boundary in m_Barriers, one extra at the end
+    std::vector<uint32_t> m_BoundaryFill;
+};
@@ -0,0 +1,84 @@
+//
+// Pages handed back with the fence value of the work that used them, kept until
+// that value completed.  Any thread pushes a batch of pages with a single
+// compare-exchange; one thread at a time, the owner holding its lock, collects
+// the pages whose fence completed.  The pages are linked through their own
+// m_NextRetired and m_RetiredFence, so retiring does not allocate.
+//
+// The list knows nothing about D3D, the caller tells which fence values completed.
+//
+
+#pragma once
+
+#include <atomic>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+template <typename T>
+class RetiredPageList
+{
+public:
+    RetiredPageList() : m_Head(nullptr) {}
+
+    RetiredPageList(const RetiredPageList&) = delete;
+    RetiredPageList& operator=(const RetiredPageList&) = delete;
+
+    // Lock-free, from any thread
+    void Push(uint64_t FenceValue, T* const* Pages, size_t NumPages)
+    {
+        if (NumPages == 0)
+            return;
+
+        // Link the pages into a chain and push the chain with a single exchange
+        for (size_t i = 0; i < NumPages; ++i)
+        {
+            Pages[i]->m_RetiredFence = FenceValue;
+            Pages[i]->m_NextRetired = i + 1 < NumPages ? Pages[i + 1] : nullptr;
+        }
+
+        T* First = Pages[0];
+        T* Last = Pages[NumPages - 1];
+
+        T* OldHead = m_Head.load(std::memory_order_relaxed);
+        do
+        {
+            Last->m_NextRetired = OldHead;
+        }
+        while (!m_Head.compare_exchange_weak(OldHead, First, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    // Appends the pages whose fence completed to Completed and keeps the others for the next
+    // call.  IsFenceComplete(uint64_t) is asked once per page.  Only one thread at a time.
+    template <typename IsFenceCompleteFn>
+    void Collect(IsFenceCompleteFn&& IsFenceComplete, std::vector<T*>& Completed)
+    {
+        for (T* Page = m_Head.exchange(nullptr, std::memory_order_acquire); Page != nullptr; Page = Page->m_NextRetired)
+            m_Pending.push_back(Page);
+
+        size_t NumPending = 0;
+        for (T* Page : m_Pending)
+        {
+            if (IsFenceComplete(Page->m_RetiredFence))
+                Completed.push_back(Page);
+            else
+                m_Pending[NumPending++] = Page;
+        }
+        m_Pending.resize(NumPending);
+    }
+
+    // Every page regardless of its fence, when the GPU is idle
+    void TakeAll(std::vector<T*>& Pages)
+    {
+        Collect([](uint64_t) { return true; }, Pages);
+    }
+
+    // Pages found not completed by the last Collect()
+    size_t GetNumPending() const { return m_Pending.size(); }
+
+private:
+    std::atomic<T*> m_Head;
+
+    // Owned by the collecting thread
+    std::vector<T*> m_Pending;
+};
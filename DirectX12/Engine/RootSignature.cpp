@@ -107,6 +107,8 @@ void RootSignature::Finalize(ID3D12Device4*& device, const std::wstring& name, D
         {
             ASSERT(RootParam.DescriptorTable.pDescriptorRanges != nullptr);
 
+            // The struct itself holds a pointer, hash what it points to and the visibility instead
+            HashCode = Utility::HashState( &RootParam.ShaderVisibility, 1, HashCode );
             HashCode = Utility::HashState( RootParam.DescriptorTable.pDescriptorRanges,
                 RootParam.DescriptorTable.NumDescriptorRanges, HashCode );
 
@@ -161,5 +163,6 @@ void RootSignature::Finalize(ID3D12Device4*& device, const std::wstring& name, D
         m_Signature = *RSRef;
     }
 
+    m_HashCode = HashCode;
     m_Finalized = TRUE;
 }
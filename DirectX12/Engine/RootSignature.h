@@ -14,6 +14,7 @@
 #pragma once
 
 #include "pch.h"
+#include <cstring>
 
 class DescriptorCache;
 class GraphicsCore;
@@ -25,6 +26,8 @@ public:
 
     RootParameter() 
     {
+        // RootSignature::Finalize hashes the whole struct, padding and unused union bytes included
+        std::memset(&m_RootParam, 0, sizeof(m_RootParam));
         m_RootParam.ParameterType = (D3D12_ROOT_PARAMETER_TYPE)0xFFFFFFFF;
     }
 
@@ -43,8 +46,7 @@ public:
 
     void InitAsConstants( UINT Register, UINT NumDwords, D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL )
     {
-        m_RootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS;
-        m_RootParam.ShaderVisibility = Visibility;
+        InitParameter(D3D12_ROOT_PARAMETER_TYPE_32BIT_CONSTANTS, Visibility);
         m_RootParam.Constants.Num32BitValues = NumDwords;
         m_RootParam.Constants.ShaderRegister = Register;
         m_RootParam.Constants.RegisterSpace = 0;
@@ -52,24 +54,21 @@ public:
 
     void InitAsConstantBuffer( UINT Register, D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL )
     {
-        m_RootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_CBV;
-        m_RootParam.ShaderVisibility = Visibility;
+        InitParameter(D3D12_ROOT_PARAMETER_TYPE_CBV, Visibility);
         m_RootParam.Descriptor.ShaderRegister = Register;
         m_RootParam.Descriptor.RegisterSpace = 0;
     }
 
     void InitAsBufferSRV( UINT Register, D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL )
     {
-        m_RootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_SRV;
-        m_RootParam.ShaderVisibility = Visibility;
+        InitParameter(D3D12_ROOT_PARAMETER_TYPE_SRV, Visibility);
         m_RootParam.Descriptor.ShaderRegister = Register;
         m_RootParam.Descriptor.RegisterSpace = 0;
     }
 
     void InitAsBufferUAV( UINT Register, D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL )
     {
-        m_RootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_UAV;
-        m_RootParam.ShaderVisibility = Visibility;
+        InitParameter(D3D12_ROOT_PARAMETER_TYPE_UAV, Visibility);
         m_RootParam.Descriptor.ShaderRegister = Register;
         m_RootParam.Descriptor.RegisterSpace = 0;
     }
@@ -82,8 +81,7 @@ public:
 
     void InitAsDescriptorTable( UINT RangeCount, D3D12_SHADER_VISIBILITY Visibility = D3D12_SHADER_VISIBILITY_ALL )
     {
-        m_RootParam.ParameterType = D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE;
-        m_RootParam.ShaderVisibility = Visibility;
+        InitParameter(D3D12_ROOT_PARAMETER_TYPE_DESCRIPTOR_TABLE, Visibility);
         m_RootParam.DescriptorTable.NumDescriptorRanges = RangeCount;
         m_RootParam.DescriptorTable.pDescriptorRanges = new D3D12_DESCRIPTOR_RANGE[RangeCount];
     }
@@ -103,6 +101,15 @@ public:
 
 protected:
 
+    // Starts over with all bytes zeroed, so equal parameters hash equally
+    void InitParameter( D3D12_ROOT_PARAMETER_TYPE Type, D3D12_SHADER_VISIBILITY Visibility )
+    {
+        Clear();
+        std::memset(&m_RootParam, 0, sizeof(m_RootParam));
+        m_RootParam.ParameterType = Type;
+        m_RootParam.ShaderVisibility = Visibility;
+    }
+
     D3D12_ROOT_PARAMETER m_RootParam;
 };
 
@@ -117,7 +124,7 @@ class RootSignature
 
 public:
 
-    RootSignature(GraphicsCore& core, UINT NumRootParams = 0, UINT NumStaticSamplers = 0 ) : m_core(core), m_NumParameters(NumRootParams)
+    RootSignature(GraphicsCore& core, UINT NumRootParams = 0, UINT NumStaticSamplers = 0 ) : m_core(core), m_NumParameters(NumRootParams), m_HashCode(0)
     {
         Reset(NumRootParams, NumStaticSamplers);
     }
@@ -163,6 +170,9 @@ public:
 
     ID3D12RootSignature* GetSignature() const { return m_Signature; }
 
+    // Hash of the description, the same in every run unlike the signature pointer
+    size_t GetHashCode() const { return m_HashCode; }
+
 protected:
     GraphicsCore& m_core;
     BOOL m_Finalized;
@@ -175,4 +185,5 @@ protected:
     std::unique_ptr<RootParameter[]> m_ParamArray;
     std::unique_ptr<D3D12_STATIC_SAMPLER_DESC[]> m_SamplerArray;
     ID3D12RootSignature* m_Signature;
+    size_t m_HashCode;
 };
@@ -0,0 +1,171 @@
+//
+// Values created once per key and shared by everyone asking for the key again.
+// Entries are keyed by the full key, compared with ==; the hash only selects the
+// shard and bucket, so colliding keys get values of their own.  The first thread
+// asking for a key creates the value, the others block on a shared future until
+// it is done.
+//
+// GetOrCreateAsync() leaves the creation to a job and returns the future at once.
+//
+// The cache knows nothing about D3D: KeyT needs GetHash() and ==, ValueT is
+// whatever Create returns.  PipelineStateCache keeps PSOs in it.
+//
+
+#pragma once
+
+#include "JobSystem.h"
+
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <stdint.h>
+
+template <typename KeyT, typename ValueT>
+class ShardedFutureCache
+{
+public:
+    typedef std::shared_future<ValueT> ValueFuture;
+
+    static const uint32_t kNumShards = 16;
+
+    struct Statistics
+    {
+        uint64_t NumEntries = 0;
+        uint64_t NumCreated = 0;
+        uint64_t NumHits = 0;
+        uint64_t NumWaits = 0;      // hits on a value that was still being created
+    };
+
+    ShardedFutureCache() :
+        m_NumCreated(0),
+        m_NumHits(0),
+        m_NumWaits(0)
+    {
+    }
+
+    ShardedFutureCache(const ShardedFutureCache&) = delete;
+    ShardedFutureCache& operator=(const ShardedFutureCache&) = delete;
+
+    // Returns the value of the key, calling Create if no thread did so before.  The
+    // value lives as long as the entry, until Clear().
+    const ValueT& GetOrCreate(const KeyT& Key, const std::function<ValueT()>& Create)
+    {
+        std::promise<ValueT> Promise;
+        ValueFuture Future;
+
+        if (FindOrInsert(Key, Promise, Future))
+        {
+            // Create outside of the shard lock, other keys of the shard stay available
+            m_NumCreated.fetch_add(1, std::memory_order_relaxed);
+            Promise.set_value(Create());
+        }
+        else
+        {
+            m_NumHits.fetch_add(1, std::memory_order_relaxed);
+            if (Future.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                m_NumWaits.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return Future.get();
+    }
+
+    // Same, but Create runs as a job of Jobs and the call does not block.  Create
+    // must not refer to anything that may go away before the job ran.
+    ValueFuture GetOrCreateAsync(const KeyT& Key, std::function<ValueT()> Create, JobSystem& Jobs)
+    {
+        // Jobs have to be copyable, the promise is shared with the job
+        auto Promise = std::make_shared<std::promise<ValueT>>();
+        ValueFuture Future;
+
+        if (FindOrInsert(Key, *Promise, Future))
+        {
+            m_NumCreated.fetch_add(1, std::memory_order_relaxed);
+            Jobs.Submit([Promise, Create = std::move(Create)]() { Promise->set_value(Create()); }, &m_PendingJobs);
+        }
+        else
+        {
+            m_NumHits.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        return Future;
+    }
+
+    // Blocks until all jobs of GetOrCreateAsync() finished
+    void WaitForJobs(JobSystem& Jobs)
+    {
+        Jobs.Wait(m_PendingJobs);
+    }
+
+    Statistics GetStatistics()
+    {
+        Statistics Stats;
+        Stats.NumCreated = m_NumCreated.load(std::memory_order_relaxed);
+        Stats.NumHits = m_NumHits.load(std::memory_order_relaxed);
+        Stats.NumWaits = m_NumWaits.load(std::memory_order_relaxed);
+
+        for (Shard& shard : m_Shards)
+        {
+            std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+            Stats.NumEntries += shard.Entries.size();
+        }
+
+        return Stats;
+    }
+
+    void Clear()
+    {
+        for (Shard& shard : m_Shards)
+        {
+            std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+            shard.Entries.clear();
+        }
+    }
+
+private:
+    struct Entry
+    {
+        KeyT Key;
+        ValueFuture Future;
+    };
+
+    struct alignas(64) Shard
+    {
+        std::mutex Mutex;
+        std::unordered_multimap<size_t, Entry> Entries;
+    };
+
+    // Looks the key up and inserts it with the future of Promise if it is missing.
+    // Returns true when the caller inserted the entry and has to fulfill Promise.
+    bool FindOrInsert(const KeyT& Key, std::promise<ValueT>& Promise, ValueFuture& Future)
+    {
+        Shard& shard = m_Shards[Key.GetHash() % kNumShards];
+
+        std::lock_guard<std::mutex> LockGuard(shard.Mutex);
+
+        const auto Range = shard.Entries.equal_range(Key.GetHash());
+        for (auto Iter = Range.first; Iter != Range.second; ++Iter)
+        {
+            if (Iter->second.Key == Key)
+            {
+                Future = Iter->second.Future;
+                return false;
+            }
+        }
+
+        // Reserve the entry so the next inquiry finds that someone got here first
+        Future = Promise.get_future().share();
+        shard.Entries.emplace(Key.GetHash(), Entry{ Key, Future });
+        return true;
+    }
+
+    Shard m_Shards[kNumShards];
+
+    JobCounter m_PendingJobs;
+
+    std::atomic<uint64_t> m_NumCreated;
+    std::atomic<uint64_t> m_NumHits;
+    std::atomic<uint64_t> m_NumWaits;
+};
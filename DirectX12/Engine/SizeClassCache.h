@@ -0,0 +1,129 @@
+//
+// Keeps released objects (e.g. buffers) in power-of-two size classes for reuse.
+// An object of class C serves any request with RoundUp(request) == C.  The cache
+// holds at most MaxCachedBytes; releasing more evicts objects of the largest
+// classes first and hands them back to the caller for destruction.
+//
+// The policy knows nothing about D3D and is not thread-safe; callers lock.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+template <typename T>
+class SizeClassCache
+{
+public:
+    struct Statistics
+    {
+        uint64_t Hits = 0;
+        uint64_t Misses = 0;
+        uint64_t Evictions = 0;
+        size_t CachedBytes = 0;
+        size_t CachedObjects = 0;
+    };
+
+    SizeClassCache(size_t MinClassSize, size_t MaxCachedBytes) :
+        m_MinClassSize(RoundUpToPowerOfTwo(MinClassSize)),
+        m_MaxCachedBytes(MaxCachedBytes)
+    {
+    }
+
+    // Size of the objects that serve a request of SizeInBytes
+    size_t GetClassSize(size_t SizeInBytes) const
+    {
+        return SizeInBytes <= m_MinClassSize ? m_MinClassSize : RoundUpToPowerOfTwo(SizeInBytes);
+    }
+
+    // Returns a cached object of ClassSize or nullptr; on a miss create one of ClassSize bytes
+    T* Acquire(size_t ClassSize)
+    {
+        std::vector<T*>& Bucket = m_Buckets[GetClassIndex(ClassSize)];
+        if (Bucket.empty())
+        {
+            ++m_Stats.Misses;
+            return nullptr;
+        }
+
+        T* Object = Bucket.back();
+        Bucket.pop_back();
+
+        ++m_Stats.Hits;
+        m_Stats.CachedBytes -= ClassSize;
+        --m_Stats.CachedObjects;
+        return Object;
+    }
+
+    // Caches Object, which has ClassSize bytes.  Objects that do not fit anymore are appended to Evicted.
+    void Release(T* Object, size_t ClassSize, std::vector<T*>& Evicted)
+    {
+        if (ClassSize > m_MaxCachedBytes)
+        {
+            ++m_Stats.Evictions;
+            Evicted.push_back(Object);
+            return;
+        }
+
+        for (uint32_t Index = kNumClasses; m_Stats.CachedBytes + ClassSize > m_MaxCachedBytes && Index-- > 0; )
+        {
+            std::vector<T*>& Bucket = m_Buckets[Index];
+            const size_t Size = size_t(1) << Index;
+
+            while (!Bucket.empty() && m_Stats.CachedBytes + ClassSize > m_MaxCachedBytes)
+            {
+                Evicted.push_back(Bucket.back());
+                Bucket.pop_back();
+
+                ++m_Stats.Evictions;
+                m_Stats.CachedBytes -= Size;
+                --m_Stats.CachedObjects;
+            }
+        }
+
+        m_Buckets[GetClassIndex(ClassSize)].push_back(Object);
+        m_Stats.CachedBytes += ClassSize;
+        ++m_Stats.CachedObjects;
+    }
+
+    // Hands all cached objects to the caller
+    void Clear(std::vector<T*>& Evicted)
+    {
+        for (auto& Bucket : m_Buckets)
+        {
+            Evicted.insert(Evicted.end(), Bucket.begin(), Bucket.end());
+            Bucket.clear();
+        }
+
+        m_Stats.CachedBytes = 0;
+        m_Stats.CachedObjects = 0;
+    }
+
+    const Statistics& GetStatistics() const { return m_Stats; }
+
+    static size_t RoundUpToPowerOfTwo(size_t Value)
+    {
+        size_t Result = 1;
+        while (Result < Value)
+            Result <<= 1;
+        return Result;
+    }
+
+private:
+    static const uint32_t kNumClasses = sizeof(size_t) * 8;
+
+    static uint32_t GetClassIndex(size_t ClassSize)
+    {
+        uint32_t Index = 0;
+        while ((size_t(1) << Index) < ClassSize)
+            ++Index;
+        return Index;
+    }
+
+    size_t m_MinClassSize;
+    size_t m_MaxCachedBytes;
+    std::vector<T*> m_Buckets[kNumClasses];
+    Statistics m_Stats;
+};
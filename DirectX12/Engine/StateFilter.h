@@ -0,0 +1,164 @@
+//
+// StateFilter keeps a shadow copy of the state a CommandContext last set on its
+// command list and decides which calls reach the command list.  Every Set...()
+// returns true when the call has to be issued, false when that state is bound
+// already, and counts the call as issued or filtered.
+//
+// The class only compares values, it never calls D3D12.  The rules for when a
+// binding is lost (a reset command list, new descriptor heaps, a new root
+// signature) live here as well, so they can be checked without a device.
+//
+
+#pragma once
+
+#include <d3d12.h>
+#include <stdint.h>
+#include <string.h>
+
+// Counts how many state changes reached the command list and how many were dropped
+// because the context already had that state bound.
+struct StateFilterStats
+{
+    enum Category
+    {
+        kRootSignature,
+        kPipelineState,
+        kPrimitiveTopology,
+        kVertexBuffers,
+        kViewport,
+        kScissor,
+        kDescriptorTable,
+        kNumCategories
+    };
+
+    uint64_t Issued[kNumCategories] = {};
+    uint64_t Filtered[kNumCategories] = {};
+
+    void Accumulate(const StateFilterStats& Other)
+    {
+        for (int i = 0; i < kNumCategories; ++i)
+        {
+            Issued[i] += Other.Issued[i];
+            Filtered[i] += Other.Filtered[i];
+        }
+    }
+
+    void Clear()
+    {
+        *this = StateFilterStats();
+    }
+};
+
+class StateFilter
+{
+public:
+    static const uint32_t kMaxDescriptorTables = 16;
+
+    StateFilter() { Invalidate(); }
+
+    // Forgets the shadowed input assembler, rasterizer and descriptor table state.
+    // Required whenever the command list is reset, that resets the GPU side too.
+    void Invalidate()
+    {
+        m_CurPrimitiveTopology = D3D_PRIMITIVE_TOPOLOGY_UNDEFINED;
+        m_ValidVertexBufferMask = 0;
+        m_ValidGraphicsTableMask = 0;
+        m_IsViewportValid = false;
+        m_IsScissorValid = false;
+    }
+
+    // Root signatures and pipeline states are compared by the context, which
+    // restores them after a reset; only the counting and the side effects are here
+    void Count(StateFilterStats::Category Category, bool Filtered)
+    {
+        if (Filtered)
+            ++m_Stats.Filtered[Category];
+        else
+            ++m_Stats.Issued[Category];
+    }
+
+    // A new graphics root signature unbinds all descriptor tables
+    void OnGraphicsRootSignatureChanged() { m_ValidGraphicsTableMask = 0; }
+
+    // So does SetDescriptorHeaps
+    void OnDescriptorHeapsBound() { m_ValidGraphicsTableMask = 0; }
+
+    // Bindings made around the filter, e.g. dynamic data at a new address each time
+    void OnVertexBufferChanged(UINT Slot) { m_ValidVertexBufferMask &= ~(1u << Slot); }
+    void OnDescriptorTableChanged(UINT RootIndex) { m_ValidGraphicsTableMask &= ~(1u << RootIndex); }
+
+    bool SetPrimitiveTopology(D3D12_PRIMITIVE_TOPOLOGY Topology)
+    {
+        const bool Filtered = Topology == m_CurPrimitiveTopology;
+        Count(StateFilterStats::kPrimitiveTopology, Filtered);
+        m_CurPrimitiveTopology = Topology;
+        return !Filtered;
+    }
+
+    // Filtered only when every slot of the range is bound to the same view
+    bool SetVertexBuffers(UINT StartSlot, UINT Count, const D3D12_VERTEX_BUFFER_VIEW Views[])
+    {
+        bool Filtered = true;
+        for (UINT i = 0; i < Count && Filtered; ++i)
+        {
+            const UINT Slot = StartSlot + i;
+            Filtered = (m_ValidVertexBufferMask & (1u << Slot)) != 0 &&
+                memcmp(&m_CurVertexBuffers[Slot], &Views[i], sizeof(D3D12_VERTEX_BUFFER_VIEW)) == 0;
+        }
+
+        this->Count(StateFilterStats::kVertexBuffers, Filtered);
+        if (Filtered)
+            return false;
+
+        for (UINT i = 0; i < Count; ++i)
+        {
+            m_CurVertexBuffers[StartSlot + i] = Views[i];
+            m_ValidVertexBufferMask |= 1u << (StartSlot + i);
+        }
+        return true;
+    }
+
+    bool SetViewport(const D3D12_VIEWPORT& Viewport)
+    {
+        const bool Filtered = m_IsViewportValid && memcmp(&m_CurViewport, &Viewport, sizeof(Viewport)) == 0;
+        Count(StateFilterStats::kViewport, Filtered);
+        m_CurViewport = Viewport;
+        m_IsViewportValid = true;
+        return !Filtered;
+    }
+
+    bool SetScissor(const D3D12_RECT& Rect)
+    {
+        const bool Filtered = m_IsScissorValid && memcmp(&m_CurScissor, &Rect, sizeof(Rect)) == 0;
+        Count(StateFilterStats::kScissor, Filtered);
+        m_CurScissor = Rect;
+        m_IsScissorValid = true;
+        return !Filtered;
+    }
+
+    bool SetGraphicsDescriptorTable(UINT RootIndex, D3D12_GPU_DESCRIPTOR_HANDLE FirstHandle)
+    {
+        const bool Filtered = (m_ValidGraphicsTableMask & (1u << RootIndex)) != 0 &&
+            m_CurGraphicsDescriptorTables[RootIndex].ptr == FirstHandle.ptr;
+        Count(StateFilterStats::kDescriptorTable, Filtered);
+        m_CurGraphicsDescriptorTables[RootIndex] = FirstHandle;
+        m_ValidGraphicsTableMask |= 1u << RootIndex;
+        return !Filtered;
+    }
+
+    const StateFilterStats& GetStats() const { return m_Stats; }
+    void ClearStats() { m_Stats.Clear(); }
+
+private:
+    D3D12_PRIMITIVE_TOPOLOGY m_CurPrimitiveTopology;
+    D3D12_VERTEX_BUFFER_VIEW m_CurVertexBuffers[D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT];
+    uint32_t m_ValidVertexBufferMask;
+    D3D12_GPU_DESCRIPTOR_HANDLE m_CurGraphicsDescriptorTables[kMaxDescriptorTables];
+    uint32_t m_ValidGraphicsTableMask;
+    D3D12_VIEWPORT m_CurViewport;
+    D3D12_RECT m_CurScissor;
+    bool m_IsViewportValid;
+    bool m_IsScissorValid;
+
+    StateFilterStats m_Stats;
+};
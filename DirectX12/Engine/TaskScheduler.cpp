@@ -0,0 +1,336 @@
+#include "pchDirectX.h"
+#include "TaskScheduler.h"
+
+#include <chrono>
+
+namespace
+{
+    // Identity of the calling thread, set once by every worker
+    thread_local const TaskScheduler* t_Scheduler = nullptr;
+    thread_local uint32_t t_WorkerIndex = 0;
+}
+
+// Chase-Lev deque with the memory orders of Le, Pop, Cohen and Zappa Nardelli,
+// "Correct and Efficient Work-Stealing for Weak Memory Models" (2013)
+
+TaskScheduler::WorkStealingDeque::WorkStealingDeque() :
+    m_Top(0),
+    m_Bottom(0)
+{
+    for (auto& Slot : m_Buffer)
+        Slot.store(nullptr, std::memory_order_relaxed);
+}
+
+bool TaskScheduler::WorkStealingDeque::Push(Task* task)
+{
+    const int64_t Bottom = m_Bottom.load(std::memory_order_relaxed);
+    const int64_t Top = m_Top.load(std::memory_order_acquire);
+
+    if (Bottom - Top >= kCapacity)
+        return false;
+
+    m_Buffer[Bottom & (kCapacity - 1)].store(task, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+    return true;
+}
+
+TaskScheduler::Task* TaskScheduler::WorkStealingDeque::Pop()
+{
+    const int64_t Bottom = m_Bottom.load(std::memory_order_relaxed) - 1;
+    m_Bottom.store(Bottom, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t Top = m_Top.load(std::memory_order_relaxed);
+
+    if (Top > Bottom)
+    {
+        // Empty
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+        return nullptr;
+    }
+
+    Task* task = m_Buffer[Bottom & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (Top == Bottom)
+    {
+        // Last element, race against the thieves for it
+        if (!m_Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+            task = nullptr;
+        m_Bottom.store(Bottom + 1, std::memory_order_relaxed);
+    }
+    return task;
+}
+
+TaskScheduler::Task* TaskScheduler::WorkStealingDeque::Steal()
+{
+    int64_t Top = m_Top.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    const int64_t Bottom = m_Bottom.load(std::memory_order_acquire);
+
+    if (Top >= Bottom)
+        return nullptr;
+
+    Task* task = m_Buffer[Top & (kCapacity - 1)].load(std::memory_order_relaxed);
+    if (!m_Top.compare_exchange_strong(Top, Top + 1, std::memory_order_seq_cst, std::memory_order_relaxed))
+        return nullptr;
+
+    return task;
+}
+
+TaskScheduler::TaskScheduler(uint32_t NumWorkers) :
+    m_SharedQueueHead(0),
+    m_SharedQueueSize(0),
+    m_WorkGeneration(0),
+    m_NumSleeping(0),
+    m_Shutdown(false)
+{
+    if (NumWorkers == 0)
+    {
+        const uint32_t NumHardwareThreads = std::thread::hardware_concurrency();
+        NumWorkers = NumHardwareThreads > 1 ? NumHardwareThreads - 1 : 1;
+    }
+    m_NumWorkers = NumWorkers;
+
+    for (uint32_t i = 0; i < m_NumWorkers; ++i)
+        m_Deques.push_back(new WorkStealingDeque());
+
+    for (uint32_t i = 0; i <= m_NumWorkers; ++i)
+    {
+        TaskPool* Pool = new TaskPool();
+        for (auto& task : Pool->Tasks)
+            task.InUse.store(false, std::memory_order_relaxed);
+        Pool->Next.store(0, std::memory_order_relaxed);
+        m_Pools.push_back(Pool);
+    }
+
+    m_Workers.reserve(m_NumWorkers);
+    for (uint32_t i = 0; i < m_NumWorkers; ++i)
+        m_Workers.emplace_back(&TaskScheduler::WorkerLoop, this, i);
+}
+
+TaskScheduler::~TaskScheduler()
+{
+    m_Shutdown.store(true, std::memory_order_release);
+    {
+        std::lock_guard<std::mutex> LockGuard(m_SleepMutex);
+        m_SleepCondition.notify_all();
+    }
+
+    for (auto& Worker : m_Workers)
+        Worker.join();
+
+    for (auto Deque : m_Deques)
+        delete Deque;
+
+    for (auto Pool : m_Pools)
+        delete Pool;
+}
+
+uint32_t TaskScheduler::GetThreadIndex() const
+{
+    return t_Scheduler == this ? t_WorkerIndex : m_NumWorkers;
+}
+
+void TaskScheduler::Submit(TaskFunction Function, const void* Context, uint32_t Begin, uint32_t End, uint32_t Grain,
+    TaskCounter& Counter, const TaskCounter* Dependency)
+{
+    const uint32_t ThreadIndex = GetThreadIndex();
+
+    // Count before the task becomes visible, so the counter cannot reach zero early
+    Counter.m_Pending.fetch_add(1, std::memory_order_relaxed);
+
+    Task* task = AllocateTask(ThreadIndex);
+    task->Function = Function;
+    task->Context = Context;
+    task->Begin = Begin;
+    task->End = End;
+    task->Grain = Grain;
+    task->Counter = &Counter;
+    task->Dependency = Dependency;
+
+    Push(ThreadIndex, task);
+    WakeWorkers();
+}
+
+TaskScheduler::Task* TaskScheduler::AllocateTask(uint32_t ThreadIndex)
+{
+    TaskPool& Pool = *m_Pools[ThreadIndex];
+
+    for (uint32_t Attempt = 1; ; ++Attempt)
+    {
+        const uint32_t Index = Pool.Next.fetch_add(1, std::memory_order_relaxed) & (TaskPool::kNumTasks - 1);
+        Task& task = Pool.Tasks[Index];
+
+        if (!task.InUse.exchange(true, std::memory_order_acquire))
+            return &task;
+
+        // The whole pool is in flight, make progress before trying again
+        if ((Attempt & (TaskPool::kNumTasks - 1)) == 0 && !TryRunOne(ThreadIndex))
+            std::this_thread::yield();
+    }
+}
+
+void TaskScheduler::PushShared(Task* task)
+{
+    std::lock_guard<std::mutex> LockGuard(m_SharedQueueMutex);
+
+    // The overflow list is only used while the ring is full, so the order stays first in first out
+    const uint32_t Size = m_SharedQueueSize.load(std::memory_order_relaxed);
+    const uint32_t RingSize = Size - static_cast<uint32_t>(m_SharedOverflow.size());
+    if (RingSize < kSharedQueueCapacity)
+        m_SharedQueue[(m_SharedQueueHead + RingSize) % kSharedQueueCapacity] = task;
+    else
+        m_SharedOverflow.push_back(task);
+
+    m_SharedQueueSize.store(Size + 1, std::memory_order_release);
+}
+
+TaskScheduler::Task* TaskScheduler::PopShared()
+{
+    if (m_SharedQueueSize.load(std::memory_order_acquire) == 0)
+        return nullptr;
+
+    std::lock_guard<std::mutex> LockGuard(m_SharedQueueMutex);
+
+    const uint32_t Size = m_SharedQueueSize.load(std::memory_order_relaxed);
+    if (Size == 0)
+        return nullptr;
+
+    Task* task = m_SharedQueue[m_SharedQueueHead];
+    m_SharedQueueHead = (m_SharedQueueHead + 1) % kSharedQueueCapacity;
+
+    // Refill the freed slot at the end of the ring from the overflow list
+    if (!m_SharedOverflow.empty())
+    {
+        m_SharedQueue[(m_SharedQueueHead + kSharedQueueCapacity - 1) % kSharedQueueCapacity] = m_SharedOverflow.front();
+        m_SharedOverflow.pop_front();
+    }
+
+    m_SharedQueueSize.store(Size - 1, std::memory_order_relaxed);
+    return task;
+}
+
+void TaskScheduler::Push(uint32_t ThreadIndex, Task* task)
+{
+    if (ThreadIndex < m_NumWorkers && m_Deques[ThreadIndex]->Push(task))
+        return;
+
+    PushShared(task);
+}
+
+TaskScheduler::Task* TaskScheduler::FindWork(uint32_t ThreadIndex)
+{
+    Task* task = nullptr;
+
+    if (ThreadIndex < m_NumWorkers)
+    {
+        task = m_Deques[ThreadIndex]->Pop();
+        if (task != nullptr)
+            return task;
+    }
+
+    task = PopShared();
+    if (task != nullptr)
+        return task;
+
+    // Steal, starting with the next worker so thieves spread out
+    for (uint32_t i = 1; i <= m_NumWorkers; ++i)
+    {
+        const uint32_t Victim = (ThreadIndex + i) % (m_NumWorkers + 1);
+        if (Victim == m_NumWorkers)
+            continue;
+
+        task = m_Deques[Victim]->Steal();
+        if (task != nullptr)
+            return task;
+    }
+
+    return nullptr;
+}
+
+bool TaskScheduler::TryRunOne(uint32_t ThreadIndex)
+{
+    Task* task = FindWork(ThreadIndex);
+    if (task == nullptr)
+        return false;
+
+    return Execute(task);
+}
+
+bool TaskScheduler::Execute(Task* task)
+{
+    if (task->Dependency != nullptr && !task->Dependency->IsDone())
+    {
+        // Park it until the dependency is done
+        PushShared(task);
+        return false;
+    }
+
+    const TaskFunction Function = task->Function;
+    const void* Context = task->Context;
+    const uint32_t Begin = task->Begin;
+    uint32_t End = task->End;
+    const uint32_t Grain = task->Grain;
+    TaskCounter& Counter = *task->Counter;
+
+    task->InUse.store(false, std::memory_order_release);
+
+    // Hand the upper halves to the thieves, keep the lowest piece
+    while (End - Begin > Grain)
+    {
+        const uint32_t Middle = Begin + (End - Begin) / 2;
+        Submit(Function, Context, Middle, End, Grain, Counter, nullptr);
+        End = Middle;
+    }
+
+    Function(Context, Begin, End);
+
+    Counter.m_Pending.fetch_sub(1, std::memory_order_release);
+    return true;
+}
+
+void TaskScheduler::Wait(TaskCounter& Counter)
+{
+    const uint32_t ThreadIndex = GetThreadIndex();
+
+    while (!Counter.IsDone())
+    {
+        if (!TryRunOne(ThreadIndex))
+            std::this_thread::yield();
+    }
+}
+
+void TaskScheduler::WakeWorkers()
+{
+    m_WorkGeneration.fetch_add(1, std::memory_order_seq_cst);
+
+    if (m_NumSleeping.load(std::memory_order_seq_cst) > 0)
+    {
+        std::lock_guard<std::mutex> LockGuard(m_SleepMutex);
+        m_SleepCondition.notify_one();
+    }
+}
+
+void TaskScheduler::WorkerLoop(uint32_t WorkerIndex)
+{
+    t_Scheduler = this;
+    t_WorkerIndex = WorkerIndex;
+
+    while (!m_Shutdown.load(std::memory_order_acquire))
+    {
+        const uint64_t Generation = m_WorkGeneration.load(std::memory_order_seq_cst);
+
+        if (TryRunOne(WorkerIndex))
+            continue;
+
+        // Nothing found: sleep until somebody submits after we looked.  The timeout
+        // also picks up parked tasks whose dependency got done.
+        std::unique_lock<std::mutex> Lock(m_SleepMutex);
+        m_NumSleeping.fetch_add(1, std::memory_order_seq_cst);
+        m_SleepCondition.wait_for(Lock, std::chrono::milliseconds(1), [this, Generation]()
+        {
+            return m_Shutdown.load(std::memory_order_acquire) ||
+                m_WorkGeneration.load(std::memory_order_seq_cst) != Generation;
+        });
+        m_NumSleeping.fetch_sub(1, std::memory_order_seq_cst);
+    }
+}
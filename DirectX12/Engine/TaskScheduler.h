@@ -0,0 +1,181 @@
+//
+// Work-stealing task scheduler for fine grained CPU work (data generation,
+// culling, command recording).
+//
+// Every worker owns a Chase-Lev deque: it pushes and pops its own tasks at the
+// bottom without locking, idle workers steal from the top of the others.
+// Threads that are not workers of the scheduler hand their tasks to a small
+// shared queue.  Tasks come from fixed per-thread pools, so spawning does not
+// allocate; only when more tasks wait in the shared queue than its ring holds,
+// the rest goes to a locked overflow list.  The callable passed to Spawn/ParallelFor is referenced, not
+// copied: it has to stay alive until the counter was waited on, so Spawn does not take temporaries.
+//
+// For a few long running or blocking jobs use the JobSystem instead.
+//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <stdint.h>
+
+class TaskScheduler;
+
+// Counts the outstanding tasks of one group, also used to express dependencies
+class TaskCounter
+{
+    friend class TaskScheduler;
+
+public:
+    TaskCounter() : m_Pending(0) {}
+
+    TaskCounter(const TaskCounter&) = delete;
+    TaskCounter& operator=(const TaskCounter&) = delete;
+
+    bool IsDone() const { return m_Pending.load(std::memory_order_acquire) == 0; }
+
+private:
+    std::atomic<uint32_t> m_Pending;
+};
+
+class TaskScheduler
+{
+public:
+    // NumWorkers == 0 uses one worker per hardware thread besides the calling one
+    explicit TaskScheduler(uint32_t NumWorkers = 0);
+    ~TaskScheduler();
+
+    TaskScheduler(const TaskScheduler&) = delete;
+    TaskScheduler& operator=(const TaskScheduler&) = delete;
+
+    uint32_t GetNumWorkers() const { return m_NumWorkers; }
+
+    // Runs Fn() on some thread.  If Dependency is given, the task does not start before it is done;
+    // the tasks of the dependency have to be spawned first.
+    template <typename F>
+    void Spawn(const F& Fn, TaskCounter& Counter, const TaskCounter* Dependency = nullptr)
+    {
+        Submit(&InvokeSingle<F>, &Fn, 0, 1, 1, Counter, Dependency);
+    }
+
+    // Fn is referenced until the task ran, a temporary would be gone by then.  Keep the
+    // callable in a named variable that outlives the wait on the counter.
+    template <typename F>
+    void Spawn(const F&& Fn, TaskCounter& Counter, const TaskCounter* Dependency = nullptr) = delete;
+
+    // Calls Fn(RangeBegin, RangeEnd) for sub ranges of [Begin, End) of at most Grain elements
+    // and returns when all of them are done.  Ranges are split in halves, so idle workers
+    // steal large pieces first.
+    template <typename F>
+    void ParallelFor(uint32_t Begin, uint32_t End, uint32_t Grain, const F& Fn)
+    {
+        if (Begin >= End)
+            return;
+
+        TaskCounter Counter;
+        Submit(&InvokeRange<F>, &Fn, Begin, End, Grain > 0 ? Grain : 1, Counter, nullptr);
+        Wait(Counter);
+    }
+
+    // Executes tasks on the calling thread until the counter is done
+    void Wait(TaskCounter& Counter);
+
+private:
+    typedef void (*TaskFunction)(const void* Context, uint32_t Begin, uint32_t End);
+
+    struct Task
+    {
+        TaskFunction Function;
+        const void* Context;
+        uint32_t Begin;
+        uint32_t End;
+        uint32_t Grain;
+        TaskCounter* Counter;
+        const TaskCounter* Dependency;
+        std::atomic<bool> InUse;
+    };
+
+    // Fixed size Chase-Lev deque.  Push and Pop only by the owning worker, Steal by anybody.
+    class WorkStealingDeque
+    {
+    public:
+        static const int64_t kCapacity = 4096;
+
+        WorkStealingDeque();
+
+        bool Push(Task* task);
+        Task* Pop();
+        Task* Steal();
+
+    private:
+        std::atomic<int64_t> m_Top;
+        std::atomic<int64_t> m_Bottom;
+        std::atomic<Task*> m_Buffer[kCapacity];
+    };
+
+    struct TaskPool
+    {
+        static const uint32_t kNumTasks = 4096;
+
+        Task Tasks[kNumTasks];
+        std::atomic<uint32_t> Next;
+    };
+
+    template <typename F>
+    static void InvokeSingle(const void* Context, uint32_t, uint32_t)
+    {
+        (*static_cast<const F*>(Context))();
+    }
+
+    template <typename F>
+    static void InvokeRange(const void* Context, uint32_t Begin, uint32_t End)
+    {
+        (*static_cast<const F*>(Context))(Begin, End);
+    }
+
+    void Submit(TaskFunction Function, const void* Context, uint32_t Begin, uint32_t End, uint32_t Grain,
+        TaskCounter& Counter, const TaskCounter* Dependency);
+
+    // Index of the calling worker, or m_NumWorkers for threads outside the scheduler
+    uint32_t GetThreadIndex() const;
+
+    Task* AllocateTask(uint32_t ThreadIndex);
+    void Push(uint32_t ThreadIndex, Task* task);
+    Task* FindWork(uint32_t ThreadIndex);
+    bool TryRunOne(uint32_t ThreadIndex);
+    // Returns false if the task was parked because its dependency is not done yet
+    bool Execute(Task* task);
+
+    void WorkerLoop(uint32_t WorkerIndex);
+    void WakeWorkers();
+
+    uint32_t m_NumWorkers;
+    std::vector<std::thread> m_Workers;
+
+    // One deque per worker, one pool per worker plus one shared by outside threads
+    std::vector<WorkStealingDeque*> m_Deques;
+    std::vector<TaskPool*> m_Pools;
+
+    // Ring of tasks spawned by outside threads and of tasks waiting for a dependency.
+    // When the ring is full further tasks wait in the overflow list, pushing never fails.
+    static const uint32_t kSharedQueueCapacity = 4096;
+    void PushShared(Task* task);
+    Task* PopShared();
+
+    Task* m_SharedQueue[kSharedQueueCapacity];
+    uint32_t m_SharedQueueHead;
+    // Tasks in the ring and in the overflow list
+    std::atomic<uint32_t> m_SharedQueueSize;
+    std::deque<Task*> m_SharedOverflow;
+    std::mutex m_SharedQueueMutex;
+
+    std::atomic<uint64_t> m_WorkGeneration;
+    std::atomic<uint32_t> m_NumSleeping;
+    std::mutex m_SleepMutex;
+    std::condition_variable m_SleepCondition;
+    std::atomic<bool> m_Shutdown;
+};
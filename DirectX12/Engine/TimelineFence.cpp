@@ -0,0 +1,127 @@
+#include "pchDirectX.h"
+#include "TimelineFence.h"
+
+#include <algorithm>
+
+TimelineFence::TimelineFence(uint64_t InitialValue) :
+    m_LastCompletedValue(InitialValue),
+    m_NextSequence(0)
+{
+}
+
+void TimelineFence::UpdateCompletedValue(uint64_t CompletedValue)
+{
+    uint64_t Current = m_LastCompletedValue.load(std::memory_order_relaxed);
+    while (CompletedValue > Current &&
+        !m_LastCompletedValue.compare_exchange_weak(Current, CompletedValue, std::memory_order_release, std::memory_order_relaxed))
+    {
+    }
+}
+
+bool TimelineFence::IsComplete(uint64_t Value)
+{
+    if (Value <= m_LastCompletedValue.load(std::memory_order_acquire))
+        return true;
+
+    return Value <= GetCompletedValue();
+}
+
+uint64_t TimelineFence::GetCompletedValue()
+{
+    UpdateCompletedValue(QueryCompletedValue());
+    return m_LastCompletedValue.load(std::memory_order_acquire);
+}
+
+void TimelineFence::Wait(uint64_t Value)
+{
+    while (!IsComplete(Value))
+        WaitForValue(Value, kInfinite);
+}
+
+void TimelineFence::OnComplete(uint64_t Value, std::function<void()> Callback)
+{
+    std::lock_guard<std::mutex> LockGuard(m_CallbackMutex);
+
+    m_Callbacks.push_back({ Value, m_NextSequence++, std::move(Callback) });
+    std::push_heap(m_Callbacks.begin(), m_Callbacks.end());
+}
+
+uint32_t TimelineFence::RunCallbacksUpTo(uint64_t Value)
+{
+    // The vector of the last run is reused, so running callbacks does not allocate once it grew
+    std::vector<std::function<void()>> Ready;
+    {
+        std::lock_guard<std::mutex> LockGuard(m_CallbackMutex);
+
+        Ready.swap(m_SpareReady);
+        while (!m_Callbacks.empty() && m_Callbacks.front().Value <= Value)
+        {
+            std::pop_heap(m_Callbacks.begin(), m_Callbacks.end());
+            Ready.push_back(std::move(m_Callbacks.back().Function));
+            m_Callbacks.pop_back();
+        }
+    }
+
+    // Callbacks may register new callbacks or free resources that take other locks
+    for (auto& Function : Ready)
+        Function();
+
+    const uint32_t NumRun = static_cast<uint32_t>(Ready.size());
+    Ready.clear();
+
+    // A nested or concurrent run may have taken the spare meanwhile, keep the larger one
+    {
+        std::lock_guard<std::mutex> LockGuard(m_CallbackMutex);
+        if (Ready.capacity() > m_SpareReady.capacity())
+            Ready.swap(m_SpareReady);
+    }
+
+    return NumRun;
+}
+
+uint32_t TimelineFence::RunCompletedCallbacks()
+{
+    {
+        std::lock_guard<std::mutex> LockGuard(m_CallbackMutex);
+        if (m_Callbacks.empty())
+            return 0;
+    }
+
+    return RunCallbacksUpTo(GetCompletedValue());
+}
+
+uint32_t TimelineFence::RunAllCallbacks()
+{
+    return RunCallbacksUpTo(UINT64_MAX);
+}
+
+size_t TimelineFence::GetNumPendingCallbacks()
+{
+    std::lock_guard<std::mutex> LockGuard(m_CallbackMutex);
+    return m_Callbacks.size();
+}
+
+void TimelineFence::WaitAll(TimelineFence* const Fences[], const uint64_t Values[], uint32_t Count)
+{
+    // The slowest fence decides, waiting one after the other costs nothing extra
+    for (uint32_t i = 0; i < Count; ++i)
+        Fences[i]->Wait(Values[i]);
+}
+
+uint32_t TimelineFence::WaitAny(TimelineFence* const Fences[], const uint64_t Values[], uint32_t Count)
+{
+    ASSERT(Count > 0);
+
+    for (uint32_t Round = 0; ; ++Round)
+    {
+        for (uint32_t i = 0; i < Count; ++i)
+        {
+            if (Fences[i]->IsComplete(Values[i]))
+                return i;
+        }
+
+        // Block a short while on one fence, taking turns
+        const uint32_t Index = Round % Count;
+        Fences[Index]->WaitForValue(Values[Index], kWaitAnySliceMs);
+    }
+}
@@ -0,0 +1,96 @@
+//
+// A monotonically increasing fence value, as signaled by a command queue.  The
+// last value seen completed is cached in an atomic, so IsComplete() for values
+// that already passed needs neither a lock nor a query of the fence.
+//
+// Work that has to wait for a value, such as deferred frees, can be registered
+// with OnComplete() and runs from RunCompletedCallbacks().
+//
+// The fence itself is reached through two virtuals, so the class can be driven
+// by a mock without a device.
+//
+
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <vector>
+#include <stdint.h>
+
+class TimelineFence
+{
+public:
+    static const uint32_t kInfinite = UINT32_MAX;
+
+    explicit TimelineFence(uint64_t InitialValue = 0);
+    virtual ~TimelineFence() {}
+
+    TimelineFence(const TimelineFence&) = delete;
+    TimelineFence& operator=(const TimelineFence&) = delete;
+
+    // Only queries the fence when Value is beyond the cached completed value
+    bool IsComplete(uint64_t Value);
+
+    // Queries the fence and updates the cached value
+    uint64_t GetCompletedValue();
+
+    // The cached value, without querying the fence
+    uint64_t GetLastCompletedValue() const { return m_LastCompletedValue.load(std::memory_order_acquire); }
+
+    void Wait(uint64_t Value);
+
+    // Callback runs from RunCompletedCallbacks() once Value completed.  Callbacks
+    // of the same value run in the order they were registered.
+    void OnComplete(uint64_t Value, std::function<void()> Callback);
+
+    // Runs the callbacks of all completed values outside of any lock and returns their number
+    uint32_t RunCompletedCallbacks();
+
+    // Runs every callback regardless of its value.  Only when the GPU is idle, e.g. at shutdown.
+    uint32_t RunAllCallbacks();
+
+    size_t GetNumPendingCallbacks();
+
+    // Block until every fence reached its value
+    static void WaitAll(TimelineFence* const Fences[], const uint64_t Values[], uint32_t Count);
+
+    // Block until one of the fences reached its value and return its index
+    static uint32_t WaitAny(TimelineFence* const Fences[], const uint64_t Values[], uint32_t Count);
+
+protected:
+    virtual uint64_t QueryCompletedValue() = 0;
+
+    // Blocks until the fence reached Value or TimeoutMs passed.  May return early,
+    // callers check the value again.
+    virtual void WaitForValue(uint64_t Value, uint32_t TimeoutMs) = 0;
+
+private:
+    struct Callback
+    {
+        uint64_t Value;
+        uint64_t Sequence;
+        std::function<void()> Function;
+
+        // std heap functions build a max-heap, the earliest callback has to come out first
+        bool operator<(const Callback& Other) const
+        {
+            return Value != Other.Value ? Value > Other.Value : Sequence > Other.Sequence;
+        }
+    };
+
+    // Raises the cached value to CompletedValue unless it is already higher
+    void UpdateCompletedValue(uint64_t CompletedValue);
+
+    uint32_t RunCallbacksUpTo(uint64_t Value);
+
+    // Time a WaitAny blocks on one fence before it looks at the others again
+    static const uint32_t kWaitAnySliceMs = 1;
+
+    std::atomic<uint64_t> m_LastCompletedValue;
+
+    std::mutex m_CallbackMutex;
+    std::vector<Callback> m_Callbacks;
+    std::vector<std::function<void()>> m_SpareReady;    // emptied, for the next RunCallbacksUpTo()
+    uint64_t m_NextSequence;
+};
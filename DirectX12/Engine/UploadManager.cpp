@@ -0,0 +1,173 @@
+#include "pchDirectX.h"
+#include "UploadManager.h"
+#include "GraphicsCore.h"
+#include "CommandListManager.h"
+#include "GpuResource.h"
+
+#include <algorithm>
+
+UploadManager::UploadManager(GraphicsCore& core) :
+    m_Core(core),
+    m_CpuBase(nullptr),
+    m_RingSize(0),
+    m_CommandList(nullptr),
+    m_CurrentAllocator(nullptr),
+    m_LastToken(0)
+{
+}
+
+UploadManager::~UploadManager()
+{
+    Destroy();
+}
+
+void UploadManager::Create(size_t RingSize)
+{
+    ASSERT(m_pRing == nullptr);
+    ASSERT(RingSize >= 4 * kAlignment && RingSize % kAlignment == 0);
+
+    m_RingSize = RingSize;
+    m_Ring.Reset(m_RingSize, kAlignment);
+
+    const CD3DX12_HEAP_PROPERTIES HeapProps(D3D12_HEAP_TYPE_UPLOAD);
+    const CD3DX12_RESOURCE_DESC ResourceDesc = CD3DX12_RESOURCE_DESC::Buffer(m_RingSize);
+
+    ASSERT_SUCCEEDED(m_Core.m_pDevice->CreateCommittedResource(&HeapProps, D3D12_HEAP_FLAG_NONE,
+        &ResourceDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, MY_IID_PPV_ARGS(m_pRing.GetAddressOf())));
+    m_pRing->SetName(L"UploadManager");
+
+    // Upload heaps may stay mapped for their whole lifetime
+    ASSERT_SUCCEEDED(m_pRing->Map(0, nullptr, reinterpret_cast<void**>(&m_CpuBase)));
+
+    m_Core.m_pCommandManager->CreateNewCommandList(D3D12_COMMAND_LIST_TYPE_COPY, &m_CommandList, &m_CurrentAllocator, L"UploadManager");
+
+    m_Core.m_MemoryStatistics.OnAllocate(kMemoryUploadRing, m_RingSize);
+}
+
+void UploadManager::Destroy()
+{
+    if (m_pRing == nullptr)
+        return;
+
+    CommandQueue& Queue = m_Core.m_pCommandManager->GetCopyQueue();
+
+    {
+        std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+        // Copies nobody submitted still have to land before the ring goes away
+        const uint64_t Token = SubmitLocked();
+        if (Token != 0)
+            Queue.WaitForFence(Token);
+
+        if (m_CurrentAllocator != nullptr)
+        {
+            m_CommandList->Close();
+            Queue.DiscardAllocator(Queue.IncrementFence(), m_CurrentAllocator);
+            m_CurrentAllocator = nullptr;
+        }
+    }
+
+    m_CommandList->Release();
+    m_CommandList = nullptr;
+
+    m_Core.m_MemoryStatistics.OnFree(kMemoryUploadRing, m_RingSize);
+
+    m_pRing->Unmap(0, nullptr);
+    m_pRing = nullptr;
+    m_CpuBase = nullptr;
+    m_RingSize = 0;
+    m_Ring.Reset(0, kAlignment);
+    m_LastToken = 0;
+}
+
+size_t UploadManager::AllocateLocked(size_t NumBytes)
+{
+    TimelineFence& Fence = m_Core.m_pCommandManager->GetCopyQueue().GetTimeline();
+
+    // Allocate() refuses while the space it needs is held by copies not submitted yet
+    size_t Offset = 0;
+    while (!m_Ring.Allocate(NumBytes, Fence, Offset))
+        SubmitLocked();
+
+    return Offset;
+}
+
+void UploadManager::Upload(GpuResource& Dest, size_t DestOffset, const void* Data, size_t NumBytes)
+{
+    ASSERT(m_pRing != nullptr, "Create() first");
+    ASSERT(Dest.GetUsageState() == D3D12_RESOURCE_STATE_COMMON, "The copy queue only writes resources in the COMMON state");
+
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    CommandQueue& Queue = m_Core.m_pCommandManager->GetCopyQueue();
+    const size_t MaxPart = m_RingSize / 4;
+    const uint8_t* Source = static_cast<const uint8_t*>(Data);
+
+    m_Statistics.NumUploads += 1;
+    m_Statistics.NumBytes += NumBytes;
+
+    while (NumBytes > 0)
+    {
+        const size_t PartSize = std::min(NumBytes, MaxPart);
+        const size_t Offset = AllocateLocked(PartSize);
+
+        memcpy(m_CpuBase + Offset, Source, PartSize);
+
+        if (m_CurrentAllocator == nullptr)
+        {
+            m_CurrentAllocator = Queue.RequestAllocator();
+            m_CommandList->Reset(m_CurrentAllocator, nullptr);
+        }
+
+        m_CommandList->CopyBufferRegion(Dest.GetResource(), DestOffset, m_pRing.Get(), Offset, PartSize);
+
+        Source += PartSize;
+        DestOffset += PartSize;
+        NumBytes -= PartSize;
+
+        // The copy queue starts on this part while the next one is written
+        if (NumBytes > 0)
+            SubmitLocked();
+    }
+}
+
+uint64_t UploadManager::Submit()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+    return SubmitLocked();
+}
+
+uint64_t UploadManager::SubmitLocked()
+{
+    if (!m_Ring.HasOpenAllocations())
+        return m_LastToken;
+
+    CommandQueue& Queue = m_Core.m_pCommandManager->GetCopyQueue();
+
+    const uint64_t FenceValue = Queue.ExecuteCommandList(m_CommandList);
+    Queue.DiscardAllocator(FenceValue, m_CurrentAllocator);
+    m_CurrentAllocator = nullptr;
+
+    m_Ring.CloseBatch(FenceValue);
+    m_LastToken = FenceValue;
+
+    ++m_Statistics.NumSubmissions;
+    return FenceValue;
+}
+
+void UploadManager::WaitOnGpu(CommandQueue& Consumer, uint64_t Token)
+{
+    if (Token == 0)
+        return;
+
+    Consumer.StallForFence(m_Core.m_pCommandManager->GetCopyQueue(), Token);
+}
+
+UploadManager::Statistics UploadManager::GetStatistics()
+{
+    std::lock_guard<std::mutex> LockGuard(m_Mutex);
+
+    Statistics Result = m_Statistics;
+    Result.NumRingStalls = m_Ring.GetNumStalls();
+    return Result;
+}
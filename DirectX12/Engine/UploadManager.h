@@ -0,0 +1,82 @@
+//
+// Uploads buffer data on the copy queue without blocking the CPU.  Upload()
+// copies the data into a persistently mapped staging ring and records a copy
+// into the destination; Submit() sends all copies recorded since the last call
+// in one command list and returns the fence value of the copy queue as token.
+// Consumers wait for the token on the GPU with WaitOnGpu(), the CPU only waits
+// when the ring is full and the oldest batch still is in flight.
+//
+// Uploads larger than a quarter of the ring are split, so the GPU copies one
+// part while the CPU fills the next.  Where parts go in the ring and when
+// their space is free again is decided by UploadRing.  Destinations must be buffers in the
+// COMMON state: the copy queue promotes them to COPY_DEST and they decay back
+// to COMMON when the batch is done, so no barriers are needed on either queue.
+//
+
+#pragma once
+
+#include "UploadRing.h"
+
+#include <mutex>
+#include <stdint.h>
+
+class GraphicsCore;
+class GpuResource;
+class CommandQueue;
+
+class UploadManager
+{
+public:
+    static const size_t kDefaultRingSize = 64 * 1024 * 1024;
+    static const size_t kAlignment = 16;
+
+    struct Statistics
+    {
+        uint64_t NumUploads = 0;
+        uint64_t NumBytes = 0;
+        uint64_t NumSubmissions = 0;
+        uint64_t NumRingStalls = 0;     // waits of the CPU for a batch to free ring space
+    };
+
+    UploadManager(GraphicsCore& core);
+    ~UploadManager();
+
+    UploadManager(const UploadManager&) = delete;
+    UploadManager& operator=(const UploadManager&) = delete;
+
+    void Create(size_t RingSize = kDefaultRingSize);
+
+    // The copy queue must be idle
+    void Destroy();
+
+    // Data may be released when Upload() returns
+    void Upload(GpuResource& Dest, size_t DestOffset, const void* Data, size_t NumBytes);
+
+    // Returns the token of the batch, or the token of the last batch when nothing was recorded since
+    uint64_t Submit();
+
+    // Consumer waits on the GPU until the copies of Token are done, the CPU does not wait
+    void WaitOnGpu(CommandQueue& Consumer, uint64_t Token);
+
+    Statistics GetStatistics();
+
+private:
+    // Returns the ring offset of NumBytes, waits for batches in flight while the ring is full
+    size_t AllocateLocked(size_t NumBytes);
+    uint64_t SubmitLocked();
+
+    GraphicsCore& m_Core;
+    std::mutex m_Mutex;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> m_pRing;
+    uint8_t* m_CpuBase;
+    size_t m_RingSize;
+
+    UploadRing m_Ring;
+
+    ID3D12GraphicsCommandList* m_CommandList;
+    ID3D12CommandAllocator* m_CurrentAllocator;
+    uint64_t m_LastToken;
+
+    Statistics m_Statistics;
+};
@@ -0,0 +1,75 @@
+#include "pchDirectX.h"
+#include "UploadRing.h"
+#include "TimelineFence.h"
+
+UploadRing::UploadRing() :
+    m_Size(0),
+    m_Alignment(1),
+    m_Head(0),
+    m_Tail(0),
+    m_NumOpenAllocations(0),
+    m_NumStalls(0)
+{
+}
+
+void UploadRing::Reset(size_t Size, size_t Alignment)
+{
+    ASSERT(Alignment > 0 && Size % Alignment == 0);
+
+    m_Size = Size;
+    m_Alignment = Alignment;
+    m_Head = 0;
+    m_Tail = 0;
+    m_InFlight.clear();
+    m_NumOpenAllocations = 0;
+}
+
+bool UploadRing::Allocate(size_t NumBytes, TimelineFence& Fence, size_t& Offset)
+{
+    ASSERT(NumBytes <= m_Size);
+
+    // Batches the copy queue is done with give their space back without waiting
+    while (!m_InFlight.empty() && Fence.IsComplete(m_InFlight.front().FenceValue))
+    {
+        m_Tail = m_InFlight.front().End;
+        m_InFlight.pop_front();
+    }
+
+    uint64_t Begin = (m_Head + m_Alignment - 1) / m_Alignment * m_Alignment;
+    if (Begin % m_Size + NumBytes > m_Size)
+        Begin += m_Size - Begin % m_Size;
+
+    while (Begin + NumBytes > m_Tail + m_Size)
+    {
+        if (m_InFlight.empty())
+        {
+            if (m_NumOpenAllocations > 0)
+                return false;
+
+            // Nothing recorded or in flight, the whole ring is free
+            m_Tail = Begin;
+            break;
+        }
+
+        const Batch Oldest = m_InFlight.front();
+        Fence.Wait(Oldest.FenceValue);
+        m_Tail = Oldest.End;
+        m_InFlight.pop_front();
+
+        ++m_NumStalls;
+    }
+
+    m_Head = Begin + NumBytes;
+    ++m_NumOpenAllocations;
+
+    Offset = static_cast<size_t>(Begin % m_Size);
+    return true;
+}
+
+void UploadRing::CloseBatch(uint64_t FenceValue)
+{
+    ASSERT(m_InFlight.empty() || FenceValue > m_InFlight.back().FenceValue);
+
+    m_InFlight.push_back({ FenceValue, m_Head });
+    m_NumOpenAllocations = 0;
+}
@@ -0,0 +1,60 @@
+//
+// UploadRing does the bookkeeping of the UploadManager's staging ring: where
+// the next allocation goes and which submitted batches still hold space.
+// Positions count up since Reset(), the offset in the ring is the position
+// modulo its size.  An allocation never wraps around, the rest of the lap is
+// skipped instead.
+//
+// The class knows nothing about D3D12.  It only sees the fence values of the
+// batches and checks them on a TimelineFence, so the policy can be driven by a
+// mock fence without a device.
+//
+
+#pragma once
+
+#include "VectorQueue.h"
+#include <stddef.h>
+#include <stdint.h>
+
+class TimelineFence;
+
+class UploadRing
+{
+public:
+    UploadRing();
+
+    // Forgets all batches, the copy queue must be idle
+    void Reset(size_t Size, size_t Alignment);
+
+    // Stores the ring offset of NumBytes in Offset.  While the ring is full it
+    // waits on Fence for the oldest batch.  Returns false when the space is held
+    // by allocations not closed into a batch yet: the caller submits them with
+    // CloseBatch() and calls again.
+    bool Allocate(size_t NumBytes, TimelineFence& Fence, size_t& Offset);
+
+    // The allocations since the last call are free again once FenceValue completed
+    void CloseBatch(uint64_t FenceValue);
+
+    bool HasOpenAllocations() const { return m_NumOpenAllocations > 0; }
+    size_t GetNumBatchesInFlight() const { return m_InFlight.size(); }
+
+    // Waits for a batch to free ring space, counted since construction
+    uint64_t GetNumStalls() const { return m_NumStalls; }
+
+private:
+    struct Batch
+    {
+        uint64_t FenceValue;
+        uint64_t End;
+    };
+
+    size_t m_Size;
+    size_t m_Alignment;
+
+    uint64_t m_Head;
+    uint64_t m_Tail;
+    VectorQueue<Batch> m_InFlight;
+    uint32_t m_NumOpenAllocations;
+
+    uint64_t m_NumStalls;
+};
@@ -0,0 +1,67 @@
+//
+// A first-in first-out queue on a vector, for queues that cycle every frame.
+// std::deque frees a block whenever the front leaves it and allocates one
+// whenever the back enters a new one, so a queue of constant length keeps
+// allocating.  Here the front is an index; the consumed items are dropped in
+// place and the vector keeps its capacity.
+//
+// Only the part of the std::deque interface the engine uses, with the same
+// names, so it drops in where a deque held fenced items.
+//
+
+#pragma once
+
+#include <stddef.h>
+#include <vector>
+
+template <typename T>
+class VectorQueue
+{
+public:
+    typedef typename std::vector<T>::iterator iterator;
+
+    VectorQueue() : m_First(0) {}
+
+    bool empty() const { return m_First == m_Items.size(); }
+    size_t size() const { return m_Items.size() - m_First; }
+
+    T& front() { return m_Items[m_First]; }
+    const T& front() const { return m_Items[m_First]; }
+    T& back() { return m_Items.back(); }
+    const T& back() const { return m_Items.back(); }
+
+    iterator begin() { return m_Items.begin() + m_First; }
+    iterator end() { return m_Items.end(); }
+
+    void push_back(const T& Item) { m_Items.push_back(Item); }
+
+    // For queues kept sorted, Position is between begin() and end()
+    void insert(iterator Position, const T& Item) { m_Items.insert(Position, Item); }
+
+    void pop_front()
+    {
+        ++m_First;
+
+        // Drop the consumed items once they are half of the vector, every item moves at most once per lap
+        if (m_First == m_Items.size())
+        {
+            m_Items.clear();
+            m_First = 0;
+        }
+        else if (m_First > m_Items.size() / 2)
+        {
+            m_Items.erase(m_Items.begin(), m_Items.begin() + m_First);
+            m_First = 0;
+        }
+    }
+
+    void clear()
+    {
+        m_Items.clear();
+        m_First = 0;
+    }
+
+private:
+    std::vector<T> m_Items;
+    size_t m_First;
+};
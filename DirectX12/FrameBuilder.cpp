@@ -0,0 +1,258 @@
+#include "Engine/pchDirectX.h"
+#include "FrameBuilder.h"
+
+#include "Engine/GraphicsCore.h"
+#include "Engine/CommandListManager.h"
+#include "Engine/TaskScheduler.h"
+
+#include <chrono>
+
+// States that only read, consecutive passes reading a resource share one combined state
+static const uint32_t ReadOnlyStates =
+    D3D12_RESOURCE_STATE_GENERIC_READ | D3D12_RESOURCE_STATE_DEPTH_READ | D3D12_RESOURCE_STATE_RESOLVE_SOURCE;
+
+FrameBuilder::FrameBuilder(GraphicsCore& core, IPrepareGraphicsContext* iPrepareGraphicsContext) :
+    m_Core(core),
+    m_PrepareGraphicsContext(iPrepareGraphicsContext),
+    m_StateTracker(ReadOnlyStates)
+{
+}
+
+uint32_t FrameBuilder::AddResource(D3D12_RESOURCE_STATES finalState)
+{
+    this->m_Resources.push_back({ finalState, nullptr });
+    return static_cast<uint32_t>(this->m_Resources.size() - 1);
+}
+
+void FrameBuilder::BindResource(uint32_t resource, GpuResource& gpuResource)
+{
+    ASSERT(resource < this->m_Resources.size());
+    this->m_Resources[resource].gpuResource = &gpuResource;
+}
+
+void FrameBuilder::AddPass(const wchar_t* name, PassFunction execute, std::vector<ResourceUse> uses)
+{
+    this->m_Passes.push_back({ name, std::move(execute), nullptr, nullptr, std::move(uses) });
+}
+
+void FrameBuilder::AddParallelPass(const wchar_t* name, ItemCountFunction numItems, ItemFunction recordItem, std::vector<ResourceUse> uses)
+{
+    this->m_Passes.push_back({ name, nullptr, std::move(numItems), std::move(recordItem), std::move(uses) });
+}
+
+void FrameBuilder::ClearPasses()
+{
+    this->m_Passes.clear();
+    this->m_Resources.clear();
+}
+
+void FrameBuilder::BeginSerialContext(RenderContext& renderContext)
+{
+    this->m_PrepareGraphicsContext->CreateAndInitGraphicContext(L"Frame", renderContext);
+    this->m_FrameContexts.push_back(renderContext.graphicsContext);
+}
+
+void FrameBuilder::PlanBarriers()
+{
+    this->m_StateTracker.Reset();
+
+    for (const auto& resource : this->m_Resources)
+    {
+        ASSERT(resource.gpuResource != nullptr, "Resource of the frame is not bound");
+        this->m_StateTracker.AddResource(resource.gpuResource->GetUsageState(), resource.finalState);
+    }
+
+    // Barriers before a parallel pass go to the end of the serial context before it.
+    // Its chunks and the serial passes after it are recorded into other command lists.
+    uint32_t commandList = 0;
+    for (const auto& pass : this->m_Passes)
+    {
+        this->m_StateTracker.AddPass(commandList);
+
+        for (const auto& use : pass.uses)
+        {
+            this->m_StateTracker.Use(use.resource, use.state);
+        }
+
+        if (pass.recordItem)
+        {
+            commandList += 2;
+        }
+    }
+
+    this->m_StateTracker.Plan(commandList);
+}
+
+void FrameBuilder::RecordBarriers(uint32_t boundary, RenderContext& renderContext)
+{
+    uint32_t numBarriers = 0;
+    const ResourceStateTracker::Barrier* barriers = this->m_StateTracker.GetBarriers(boundary, numBarriers);
+    if (numBarriers == 0)
+    {
+        return;
+    }
+
+    if (renderContext.graphicsContext == nullptr)
+    {
+        this->BeginSerialContext(renderContext);
+    }
+
+    for (uint32_t i = 0; i < numBarriers; ++i)
+    {
+        const ResourceStateTracker::Barrier& barrier = barriers[i];
+
+        D3D12_RESOURCE_BARRIER_FLAGS flags = D3D12_RESOURCE_BARRIER_FLAG_NONE;
+        if (barrier.Type == ResourceStateTracker::kBeginOnly)
+        {
+            flags = D3D12_RESOURCE_BARRIER_FLAG_BEGIN_ONLY;
+        }
+        else if (barrier.Type == ResourceStateTracker::kEndOnly)
+        {
+            flags = D3D12_RESOURCE_BARRIER_FLAG_END_ONLY;
+        }
+
+        renderContext.graphicsContext->QueuePlannedTransition(
+            *this->m_Resources[barrier.Resource].gpuResource,
+            static_cast<D3D12_RESOURCE_STATES>(barrier.StateBefore),
+            static_cast<D3D12_RESOURCE_STATES>(barrier.StateAfter),
+            flags);
+    }
+
+    // One ResourceBarrier call for the whole boundary
+    renderContext.graphicsContext->FlushResourceBarriers();
+
+    this->m_NumBarriersLastFrame += numBarriers;
+    ++this->m_NumBarrierBatchesLastFrame;
+}
+
+void FrameBuilder::RecordParallelPass(const Pass& pass, RenderContext& renderContext)
+{
+    const uint32_t numItems = pass.numItems();
+    if (numItems == 0)
+    {
+        return;
+    }
+
+    // One context of the batch stays in reserve for the serial passes after this one
+    const uint32_t numFrameContexts = static_cast<uint32_t>(this->m_FrameContexts.size());
+    const uint32_t maxChunks = numFrameContexts + 1 < CommandContext::kMaxBatchedContexts ? CommandContext::kMaxBatchedContexts - numFrameContexts - 1 : 0;
+
+    if (maxChunks == 0)
+    {
+        // The batch is full, the items go into the frame context one after the other
+        if (renderContext.graphicsContext == nullptr)
+        {
+            this->BeginSerialContext(renderContext);
+        }
+
+        for (uint32_t item = 0; item < numItems; ++item)
+        {
+            pass.recordItem(renderContext, item);
+        }
+        return;
+    }
+
+    // One chunk per thread, the calling thread records a chunk as well
+    TaskScheduler& scheduler = *this->m_Core.m_pTaskScheduler;
+    uint32_t numChunks = std::min(numItems, scheduler.GetNumWorkers() + 1);
+    numChunks = std::min(numChunks, maxChunks);
+
+    this->m_ChunkContexts.assign(numChunks, renderContext);
+
+    const auto recordChunk = [this, &pass, numItems, numChunks](uint32_t chunk)
+    {
+        RenderContext& chunkContext = this->m_ChunkContexts[chunk];
+        chunkContext.graphicsContext = nullptr;
+        chunkContext.numDrawsCalled = 0;
+
+        this->m_PrepareGraphicsContext->CreateAndInitGraphicContext(pass.name, chunkContext);
+
+        const uint32_t firstItem = static_cast<uint32_t>(static_cast<uint64_t>(numItems) * chunk / numChunks);
+        const uint32_t endItem = static_cast<uint32_t>(static_cast<uint64_t>(numItems) * (chunk + 1) / numChunks);
+
+        for (uint32_t item = firstItem; item < endItem; ++item)
+        {
+            pass.recordItem(chunkContext, item);
+        }
+    };
+
+    scheduler.ParallelFor(0, numChunks, 1, [&recordChunk](uint32_t firstChunk, uint32_t endChunk)
+    {
+        for (uint32_t chunk = firstChunk; chunk < endChunk; ++chunk)
+        {
+            recordChunk(chunk);
+        }
+    });
+
+    // Keep the chunks in item order
+    for (auto& chunkContext : this->m_ChunkContexts)
+    {
+        this->m_FrameContexts.push_back(chunkContext.graphicsContext);
+        renderContext.numDrawsCalled += chunkContext.numDrawsCalled;
+    }
+
+    // Serial passes after this one continue in a new context
+    renderContext.graphicsContext = nullptr;
+}
+
+uint64_t FrameBuilder::Execute(RenderContext& renderContext, bool waitForCompletion)
+{
+    CommandQueue& graphicsQueue = this->m_Core.m_pCommandManager->GetGraphicsQueue();
+    const uint64_t submissionsBefore = graphicsQueue.GetNumSubmissions();
+    const auto recordingStart = std::chrono::steady_clock::now();
+
+    this->m_FrameContexts.clear();
+    renderContext.graphicsContext = nullptr;
+    renderContext.numDrawsCalled = 0;
+
+    this->m_NumBarriersLastFrame = 0;
+    this->m_NumBarrierBatchesLastFrame = 0;
+    this->PlanBarriers();
+
+    for (uint32_t passIndex = 0; passIndex < this->m_Passes.size(); ++passIndex)
+    {
+        const Pass& pass = this->m_Passes[passIndex];
+
+        this->RecordBarriers(passIndex, renderContext);
+
+        if (pass.recordItem)
+        {
+            this->RecordParallelPass(pass, renderContext);
+            continue;
+        }
+
+        if (renderContext.graphicsContext == nullptr)
+        {
+            this->BeginSerialContext(renderContext);
+        }
+
+        GraphicsContext* passContext = renderContext.graphicsContext;
+
+        pass.execute(renderContext);
+
+        ASSERT(renderContext.graphicsContext == passContext, "Pass \"%ls\" replaced the frame context", pass.name);
+    }
+
+    this->RecordBarriers(static_cast<uint32_t>(this->m_Passes.size()), renderContext);
+
+    if (this->m_FrameContexts.empty())
+    {
+        this->BeginSerialContext(renderContext);
+    }
+
+    this->m_RecordingSecondsLastFrame = std::chrono::duration<double>(std::chrono::steady_clock::now() - recordingStart).count();
+    this->m_NumDrawsLastFrame = static_cast<uint32_t>(renderContext.numDrawsCalled);
+
+    renderContext.lastFenceValue = CommandContext::FinishBatch(
+        this->m_Core,
+        this->m_FrameContexts.data(),
+        static_cast<UINT>(this->m_FrameContexts.size()),
+        waitForCompletion);
+
+    renderContext.graphicsContext = nullptr;
+
+    this->m_NumCommandListsLastFrame = this->m_FrameContexts.size();
+    this->m_NumSubmissionsLastFrame = graphicsQueue.GetNumSubmissions() - submissionsBefore;
+
+    return renderContext.lastFenceValue;
+}
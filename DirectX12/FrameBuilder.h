@@ -0,0 +1,111 @@
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include "DirectX12/Engine/CommandContext.h"
+#include "DirectX12/Engine/ResourceStateTracker.h"
+#include "DirectX12/IPreparePipelineState.h"
+
+class GraphicsCore;
+
+// Collects the passes of a frame and records them into graphics contexts that
+// are submitted together, in pass order, with one ExecuteCommandLists call.
+//
+// A serial pass only appends commands to renderContext.graphicsContext; it must
+// neither finish nor replace it.  A parallel pass splits its items into chunks
+// which worker threads record into contexts of their own.  Items must not
+// transition resources, since chunks are recorded concurrently.
+//
+// Instead of transitioning resources themselves, passes declare the states they
+// use them in.  The frame builder plans the barriers of the whole frame with a
+// ResourceStateTracker and records all barriers between two passes at once.
+class FrameBuilder
+{
+public:
+    using PassFunction = std::function<void(RenderContext&)>;
+    using ItemCountFunction = std::function<uint32_t()>;
+    using ItemFunction = std::function<void(RenderContext&, uint32_t itemIndex)>;
+
+    struct ResourceUse
+    {
+        uint32_t resource;
+        D3D12_RESOURCE_STATES state;
+    };
+
+    FrameBuilder(GraphicsCore& core, IPrepareGraphicsContext* iPrepareGraphicsContext);
+
+    // A resource the passes use.  The GpuResource behind it is bound per frame with
+    // BindResource(), e.g. the current back buffer.  After the frame it is left in
+    // finalState, or in the state of its last use without one.
+    uint32_t AddResource(D3D12_RESOURCE_STATES finalState = static_cast<D3D12_RESOURCE_STATES>(ResourceStateTracker::kKeepState));
+    void BindResource(uint32_t resource, GpuResource& gpuResource);
+
+    // Passes run in the order they were added.
+    void AddPass(const wchar_t* name, PassFunction execute, std::vector<ResourceUse> uses = {});
+    void AddParallelPass(const wchar_t* name, ItemCountFunction numItems, ItemFunction recordItem, std::vector<ResourceUse> uses = {});
+
+    // Removes the passes and the resources
+    void ClearPasses();
+
+    size_t GetNumPasses() const { return m_Passes.size(); }
+
+    // Records all passes and submits them.  Returns the fence of the submission.
+    uint64_t Execute(RenderContext& renderContext, bool waitForCompletion = false);
+
+    // Number of ExecuteCommandLists calls on the graphics queue during the last Execute()
+    uint64_t GetNumSubmissionsLastFrame() const { return m_NumSubmissionsLastFrame; }
+
+    // Number of command lists in the submission of the last Execute()
+    size_t GetNumCommandListsLastFrame() const { return m_NumCommandListsLastFrame; }
+
+    // Number of barriers and ResourceBarrier calls the passes got during the last Execute()
+    size_t GetNumBarriersLastFrame() const { return m_NumBarriersLastFrame; }
+    size_t GetNumBarrierBatchesLastFrame() const { return m_NumBarrierBatchesLastFrame; }
+
+    // Draws counted by the passes and the CPU time they took to record in the last Execute(),
+    // the barriers included, the submission not
+    uint32_t GetNumDrawsLastFrame() const { return m_NumDrawsLastFrame; }
+    double GetRecordingSecondsLastFrame() const { return m_RecordingSecondsLastFrame; }
+
+private:
+    struct Pass
+    {
+        const wchar_t* name;
+        PassFunction execute;
+        ItemCountFunction numItems;
+        ItemFunction recordItem;
+        std::vector<ResourceUse> uses;
+    };
+
+    struct Resource
+    {
+        D3D12_RESOURCE_STATES finalState;
+        GpuResource* gpuResource;
+    };
+
+    void BeginSerialContext(RenderContext& renderContext);
+    void RecordParallelPass(const Pass& pass, RenderContext& renderContext);
+
+    void PlanBarriers();
+    void RecordBarriers(uint32_t boundary, RenderContext& renderContext);
+
+    GraphicsCore& m_Core;
+    IPrepareGraphicsContext* m_PrepareGraphicsContext;
+
+    std::vector<Pass> m_Passes;
+    std::vector<Resource> m_Resources;
+
+    ResourceStateTracker m_StateTracker;
+
+    // Contexts of the frame in submission order, kept to avoid allocations per frame
+    std::vector<CommandContext*> m_FrameContexts;
+    std::vector<RenderContext> m_ChunkContexts;
+
+    uint64_t m_NumSubmissionsLastFrame = 0;
+    size_t m_NumCommandListsLastFrame = 0;
+    size_t m_NumBarriersLastFrame = 0;
+    size_t m_NumBarrierBatchesLastFrame = 0;
+    uint32_t m_NumDrawsLastFrame = 0;
+    double m_RecordingSecondsLastFrame = 0.0;
+};
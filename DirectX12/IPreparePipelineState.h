@@ -10,7 +10,7 @@ public:
 
 struct RenderContext
 {
-    int64_t lastFenceValue;
+    uint64_t lastFenceValue;
 
     GraphicsContext* graphicsContext;
     int numDrawsCalled;
@@ -20,13 +20,17 @@ struct RenderContext
 
     ColorBuffer* colorBuffer;
 
+    // Scene constants of this frame in the frame constant ring, 0 if they did not fit
+    D3D12_GPU_VIRTUAL_ADDRESS sceneConstants;
+
     RenderContext() :
       lastFenceValue(0),
       graphicsContext(nullptr),
       numDrawsCalled(0),
       viewPort(nullptr),
       scissorRect(nullptr),
-      colorBuffer(nullptr)
+      colorBuffer(nullptr),
+      sceneConstants(0)
     {
     }
 };
@@ -34,8 +38,9 @@ struct RenderContext
 class IPrepareGraphicsContext
 {
 public:
-    virtual void CreateGraphicContext(std::wstring id, RenderContext& renderContext) = 0;
+    // id is kept by the context, pass a string literal or another string that outlives the frame
+    virtual void CreateGraphicContext(const wchar_t* id, RenderContext& renderContext) = 0;
     virtual void InitGraphicContext(RenderContext& renderContext) = 0;
-    virtual void CreateAndInitGraphicContext(std::wstring id, RenderContext& renderContext) = 0;
+    virtual void CreateAndInitGraphicContext(const wchar_t* id, RenderContext& renderContext) = 0;
     virtual void FinishGraphicContext(RenderContext& renderContext, bool waitForCompletion = false) = 0;
 };
\ No newline at end of file
@@ -0,0 +1,107 @@
+// Culls the tiles of the fabric against the view, selects their tessellation factor and
+// writes the draws of the visible tiles without gaps, in tile order, for ExecuteIndirect.
+// TileCulling::CullTiles() on the CPU is the reference and writes the same arguments.
+
+struct TileData
+{
+#include "Shared/TileData.hlsli"
+};
+
+struct TileDrawArguments
+{
+#include "Shared/TileDrawArguments.hlsli"
+};
+
+cbuffer cbCullTiles : register(b0)
+{
+#include "Shared/TileCullConstants.hlsli"
+}
+
+StructuredBuffer<TileData> tiles : register(t0);
+RWStructuredBuffer<TileDrawArguments> drawArguments : register(u0);
+RWByteAddressBuffer drawCount : register(u1);
+
+#define GROUP_SIZE 64
+
+// Number of visible tiles up to and including a thread of the group
+groupshared uint gsVisibleTiles[GROUP_SIZE];
+groupshared uint gsNumDraws;
+
+bool CullTile(TileData tile, out TileDrawArguments draw)
+{
+    float2 corner0 = tile.minX * clipAxisX + tile.minY * clipAxisY + clipOrigin;
+    float2 corner1 = tile.maxX * clipAxisX + tile.minY * clipAxisY + clipOrigin;
+    float2 corner2 = tile.minX * clipAxisX + tile.maxY * clipAxisY + clipOrigin;
+    float2 corner3 = tile.maxX * clipAxisX + tile.maxY * clipAxisY + clipOrigin;
+
+    float2 low = min(min(corner0, corner1), min(corner2, corner3));
+    float2 high = max(max(corner0, corner1), max(corner2, corner3));
+
+    // As Trafos::GetTessellationFactor(), but with the scale this tile is projected at.
+    // Rounded up like the integer partitioning of the hull shader.
+    float clipPerUnit = (high.y - low.y) / max(tile.maxY - tile.minY, 1e-6f);
+    float tessellationFactor = clamp(ceil(clipPerUnit * windowHeightInPixels / 3.0f), minTessellationFactor, maxTessellationFactor);
+
+    draw.primitiveOffset = tile.firstPrimitive;
+    draw.tessellationFactor = tessellationFactor;
+    draw.vertexCountPerInstance = tile.numPrimitives * verticesPerPrimitive;
+    draw.instanceCount = 1;
+    draw.startVertexLocation = tile.firstPrimitive * verticesPerPrimitive;
+    draw.startInstanceLocation = 0;
+
+    low -= clipMargin;
+    high += clipMargin;
+
+    return tile.numPrimitives > 0 && low.x <= 1.0f && low.y <= 1.0f && high.x >= -1.0f && high.y >= -1.0f;
+}
+
+// One group keeps the draws in tile order, the fabric has few tiles
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint threadIndex : SV_GroupIndex)
+{
+    if (threadIndex == 0)
+    {
+        gsNumDraws = 0;
+    }
+
+    for (uint firstTile = 0; firstTile < numTiles; firstTile += GROUP_SIZE)
+    {
+        uint tileIndex = firstTile + threadIndex;
+
+        TileDrawArguments draw = (TileDrawArguments)0;
+        bool visible = false;
+        if (tileIndex < numTiles)
+        {
+            visible = CullTile(tiles[tileIndex], draw);
+        }
+
+        gsVisibleTiles[threadIndex] = visible ? 1 : 0;
+        GroupMemoryBarrierWithGroupSync();
+
+        // Inclusive prefix sum over the group
+        for (uint stride = 1; stride < GROUP_SIZE; stride *= 2)
+        {
+            uint before = threadIndex >= stride ? gsVisibleTiles[threadIndex - stride] : 0;
+            GroupMemoryBarrierWithGroupSync();
+            gsVisibleTiles[threadIndex] += before;
+            GroupMemoryBarrierWithGroupSync();
+        }
+
+        if (visible)
+        {
+            drawArguments[gsNumDraws + gsVisibleTiles[threadIndex] - 1] = draw;
+        }
+        GroupMemoryBarrierWithGroupSync();
+
+        if (threadIndex == GROUP_SIZE - 1)
+        {
+            gsNumDraws += gsVisibleTiles[threadIndex];
+        }
+        GroupMemoryBarrierWithGroupSync();
+    }
+
+    if (threadIndex == 0)
+    {
+        drawCount.Store(0, gsNumDraws);
+    }
+}
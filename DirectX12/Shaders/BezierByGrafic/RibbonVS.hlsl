@@ -0,0 +1,44 @@
+// Draws the points of TessellateCS as the geometry shader draws the output of the
+// domain shader: every segment is a quad, widened along the normal of the curve.
+// No vertex buffer, the vertices are pulled from the ribbon points by SV_VertexID.
+
+#include "Types.hlsli"
+
+struct RibbonPoint
+{
+#include "Shared/RibbonPoint.hlsli"
+};
+
+StructuredBuffer<RibbonPoint> ribbonPoints : register(t1);
+
+// Two triangles per segment, the GS strip p0L, p1L, p0R, p1R: the end of the segment and the side
+static const uint cornerEnd[6] = { 0, 1, 0, 0, 1, 1 };
+static const float cornerSide[6] = { 1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f };
+
+GS_TO_PS main(uint vertexID : SV_VertexID)
+{
+    // The draw constants carry the number of segments TessellateCS used
+    uint numSegments = (uint)cDrawTessellationFactor;
+
+    uint segment = vertexID / 6;
+    uint corner = vertexID - segment * 6;
+    uint patch = segment / numSegments;
+    uint segmentInPatch = segment - patch * numSegments;
+
+    RibbonPoint ribbonPoint = ribbonPoints[patch * (numSegments + 1) + segmentInPatch + cornerEnd[corner]];
+
+    // What VS.hlsl does with the control points, the curve is linear in them
+    float3 position = mul(cViewProjection, float4(ribbonPoint.position, 1.0f)).xyz;
+    float2 tangent = normalize(mul(cViewProjection, float4(ribbonPoint.derivative, 0.0f, 0.0f)).xy);
+
+    float4 normal = normalize(float4(-tangent.y, tangent.x, 0, 0));
+    float4 normalWidth = 1 * scaleVector * 0.25 / 2.0f * normal;
+
+    GS_TO_PS output;
+    output.position = float4(position + cornerSide[corner] * 1.5f * normalWidth.xyz, 1.0f);
+
+    // The color of GS.hlsl, from mustBe5 as TessellateCS wrote it
+    output.colorAndBrightness = float4(ribbonPoint.mustBe5 / 6.0f, 0.5, 0.0, 1.0);
+
+    return output;
+}
@@ -0,0 +1,15 @@
+#include "../../SharedBase.hlsli"
+
+// A point of a tessellated patch and the derivative of the curve there, in world space.
+// The domain shader evaluates the same in clip space.  The fabric lies in z = 0, the
+// derivative has no z.
+#ifdef __cplusplus
+float position[3];
+float derivative[2];
+#else
+float3 position;
+float2 derivative;
+#endif
+
+// Set to 5 like the hull shader constant function sets it, RibbonVS colors the ribbon with it
+uintType mustBe5;
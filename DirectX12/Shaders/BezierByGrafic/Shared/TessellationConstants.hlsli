@@ -0,0 +1,9 @@
+#include "../../SharedBase.hlsli"
+
+uintType numPatches;
+
+// Segments per patch, the integer partitioning of the hull shader gives ceil(cTessellationFactor)
+uintType numSegments;
+
+// 1.0f / numSegments, computed once on the CPU
+float segmentStep;
@@ -0,0 +1,22 @@
+#include "../../SharedBase.hlsli"
+
+// The fabric lies in z = 0, a world position x, y is at x * clipAxisX + y * clipAxisY + clipOrigin in clip space
+#ifdef __cplusplus
+float clipAxisX[2];
+float clipAxisY[2];
+float clipOrigin[2];
+#else
+float2 clipAxisX;
+float2 clipAxisY;
+float2 clipOrigin;
+#endif
+
+// Half the line width in clip space, lines reach that far out of the bounds of their curves
+float clipMargin;
+float windowHeightInPixels;
+
+float minTessellationFactor;
+float maxTessellationFactor;
+
+uintType numTiles;
+uintType verticesPerPrimitive;
@@ -0,0 +1,10 @@
+#include "../../SharedBase.hlsli"
+
+// Bounds of the control points of the tile in world space, the curves stay inside
+float minX;
+float minY;
+float maxX;
+float maxY;
+
+uintType firstPrimitive;
+uintType numPrimitives;
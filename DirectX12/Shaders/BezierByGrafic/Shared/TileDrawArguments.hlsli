@@ -0,0 +1,10 @@
+#include "../../SharedBase.hlsli"
+
+// One command of the tile command signature: the root constants of cbPerDraw, then D3D12_DRAW_ARGUMENTS
+uintType primitiveOffset;
+float tessellationFactor;
+
+uintType vertexCountPerInstance;
+uintType instanceCount;
+uintType startVertexLocation;
+uintType startInstanceLocation;
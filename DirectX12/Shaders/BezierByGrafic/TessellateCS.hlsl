@@ -0,0 +1,72 @@
+// Evaluates the Bezier patches at the points the hull and domain shader would generate
+// and writes them to a buffer that RibbonVS widens into lines.  Runs only when the
+// number of segments changes, the points are in world space.
+//
+// BezierTessellation::EvaluatePoint() is the CPU version and gives the same bits: every
+// operation is precise, so nothing is fused or reordered, and only additions, subtractions
+// and multiplications are used, which D3D rounds like IEEE.
+
+struct RibbonPoint
+{
+#include "Shared/RibbonPoint.hlsli"
+};
+
+cbuffer cbTessellate : register(b0)
+{
+#include "Shared/TessellationConstants.hlsli"
+}
+
+// Four control points per patch, laid out like the vertex buffer of the patches
+StructuredBuffer<float4> controlPoints : register(t0);
+RWStructuredBuffer<RibbonPoint> ribbonPoints : register(u0);
+
+#define GROUP_SIZE 64
+
+[numthreads(GROUP_SIZE, 1, 1)]
+void main(uint3 threadID : SV_DispatchThreadID)
+{
+    uint numPoints = numSegments + 1;
+    uint pointIndex = threadID.x;
+    if (pointIndex >= numPatches * numPoints)
+    {
+        return;
+    }
+
+    uint patch = pointIndex / numPoints;
+    uint pointInPatch = pointIndex - patch * numPoints;
+
+    // The last point is exactly the end of the patch
+    precise float t = pointInPatch == numSegments ? 1.0f : (float)pointInPatch * segmentStep;
+
+    // CubicBezierBasis() of DS.hlsl
+    precise float s = 1.0f - t;
+    precise float a0 = s * s;
+    precise float a1 = 2.0f * s * t;
+    precise float a2 = t * t;
+
+    precise float4 b;
+    b.x = s * a0;
+    b.y = t * a0 + s * a1;
+    b.z = t * a1 + s * a2;
+    b.w = t * a2;
+
+    precise float4 d;
+    d.x = -a0;
+    d.y = a0 - a1;
+    d.z = a1 - a2;
+    d.w = a2;
+
+    float3 p0 = controlPoints[patch * 4 + 0].xyz;
+    float3 p1 = controlPoints[patch * 4 + 1].xyz;
+    float3 p2 = controlPoints[patch * 4 + 2].xyz;
+    float3 p3 = controlPoints[patch * 4 + 3].xyz;
+
+    RibbonPoint ribbonPoint;
+    precise float3 position = b.x * p0 + b.y * p1 + b.z * p2 + b.w * p3;
+    precise float2 derivative = d.x * p0.xy + d.y * p1.xy + d.z * p2.xy + d.w * p3.xy;
+    ribbonPoint.position = position;
+    ribbonPoint.derivative = derivative;
+    ribbonPoint.mustBe5 = 5;
+
+    ribbonPoints[pointIndex] = ribbonPoint;
+}
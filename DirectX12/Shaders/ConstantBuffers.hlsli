@@ -7,3 +7,13 @@ cbuffer cbPerFrame : register(b0)
 {
 #include "SharedConstantBuffer.hlsli"
 }
+
+// Root constants of a single draw
+cbuffer cbPerDraw : register(b1)
+{
+    // SV_PrimitiveID restarts at 0 for every draw, this is the index of its first patch
+    uint cPrimitiveOffset;
+
+    // Tessellation factor of the draw's patches, the tile culling selects it per tile
+    float cDrawTessellationFactor;
+}
@@ -2,6 +2,9 @@
 
 #include "Engine/GpuBuffer.h"
 #include "Engine/GraphicsCore.h"
+#include "Engine/CommandListManager.h"
+#include "Engine/GpuHeapAllocator.h"
+#include "Engine/UploadManager.h"
 
 using Microsoft::WRL::ComPtr;
 
@@ -12,8 +15,11 @@ public:
     VertexBuffer(const VertexBuffer&) = delete;
     VertexBuffer(VertexBuffer&&) = delete;
 
+    // With an upload manager the vertices are only queued on the copy queue,
+    // Submit() them and let the render queue wait for the token before drawing.
     template<class T>
-    VertexBuffer(GraphicsCore& core, std::wstring name, const std::vector<T>& vertexInput) :
+    VertexBuffer(GraphicsCore& core, std::wstring name, const std::vector<T>& vertexInput, UploadManager* uploadManager = nullptr) :
+        core(core),
         buffer(core)
     {
         if (core.m_pDevice == nullptr)
@@ -40,25 +46,40 @@ public:
             possibleAllocInfo = core.m_pDevice->GetResourceAllocationInfo(0, 1, &vertexBufferDesc);
         }
 
-        const int vbCount = 1;
-        const UINT64 heapSize = vbCount * possibleAllocInfo.SizeInBytes;
-        CD3DX12_HEAP_DESC heapDesc(heapSize, D3D12_HEAP_TYPE_DEFAULT, 0, D3D12_HEAP_FLAG_ALLOW_ONLY_BUFFERS);
-
-        HRESULT hr = core.m_pDevice->CreateHeap(&heapDesc, IID_PPV_ARGS(&heap));
-        if (hr != 0)
+        // place the buffer in one of the shared heaps
+        this->allocation = core.m_pBufferHeapAllocator->Allocate(possibleAllocInfo.SizeInBytes, possibleAllocInfo.Alignment);
+        if (!this->allocation.IsValid())
         {
-            throw L"Create Heap failed";
+            throw L"Heap allocation failed";
         }
 
-        this->buffer.CreatePlaced(name.c_str(), heap.Get(), 0, numberOfVertices, sizeof(vertexInput[0]), &vertexInput[0]);
+        const void* initialData = uploadManager != nullptr ? nullptr : &vertexInput[0];
+        this->buffer.CreatePlaced(name.c_str(), this->allocation.Heap, static_cast<uint32_t>(this->allocation.Offset), numberOfVertices, sizeof(vertexInput[0]), initialData);
+
+        if (uploadManager != nullptr)
+        {
+            uploadManager->Upload(this->buffer, 0, vertexInput.data(), vertexBufferSize);
+        }
 
         this->view = buffer.VertexBufferView();
     }
 
     ~VertexBuffer()
     {
-        buffer.Destroy();
-        heap = nullptr; // Only used when the resources being drawn are placed resources.
+        // the GPU may still read the buffer and its memory in frames in flight,
+        // keep the resources alive until the same fence frees the heap block
+        const uint64_t fenceValue = this->core.m_pCommandManager->GetGraphicsQueue().IncrementFence();
+
+        ComPtr<ID3D12Resource> resource = this->buffer.GetResource();
+        ComPtr<ID3D12Resource> counterResource = this->buffer.GetCounterBuffer().GetResource();
+        this->core.m_pCommandManager->OnFenceComplete(fenceValue, [resource, counterResource]() mutable
+        {
+            resource.Reset();
+            counterResource.Reset();
+        });
+
+        this->buffer.Destroy();
+        this->core.m_pBufferHeapAllocator->Free(this->allocation, fenceValue);
     }
 
     D3D12_VERTEX_BUFFER_VIEW& GetView()
@@ -77,8 +98,9 @@ public:
     }
 
 private:
+    GraphicsCore& core;
     D3D12_VERTEX_BUFFER_VIEW view;
-    ComPtr<ID3D12Heap> heap;
+    GpuHeapAllocation allocation;
     StructuredBuffer buffer;
 };
 
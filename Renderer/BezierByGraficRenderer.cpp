@@ -2,13 +2,21 @@
 #include "DirectX12/Engine/pchDirectX.h"
 #include "DirectX12/CompiledShaders/AllShaders.h"
 #include "DirectX12/Engine/PipelineState.h"
+#include "DirectX12/Engine/RootSignature.h"
 #include "DirectX12/Engine/GpuBuffer.h"
+#include "DirectX12/Engine/TaskScheduler.h"
+#include "DirectX12/Engine/BindlessDescriptorHeap.h"
+#include "DirectX12/Engine/CommandListManager.h"
+#include "DirectX12/Engine/UploadManager.h"
 #include "DirectX12/VertexBuffer.h"
 #include "DirectX12/ConstantBuffer.h"
 #include <d3d12.h>
 
 #include "BezierByGraficRenderer.h"
+#include "TileCulling.h"
+#include "BezierTessellation.h"
 
+#include <cfloat>
 #include <iostream>
 
 struct Vertex
@@ -61,18 +69,72 @@ class PSO_Collection
     }
 };
 
+// one tile draw of the command signature: the draw constants, then D3D12_DRAW_ARGUMENTS
+static_assert(sizeof(TileDrawArguments) == 2 * sizeof(UINT) + sizeof(D3D12_DRAW_ARGUMENTS), "TileDrawArguments does not match the command signature");
+
+const int CullRootSignature_Constants_Index = 0;
+const int CullRootSignature_Tiles_Index = 1;
+const int CullRootSignature_DrawArguments_Index = 2;
+const int CullRootSignature_DrawCount_Index = 3;
+
+const int TessellateRootSignature_Constants_Index = 0;
+const int TessellateRootSignature_ControlPoints_Index = 1;
+const int TessellateRootSignature_RibbonPoints_Index = 2;
+
 class BezierByGraficRenderer::Impl
 {
 private:
     VertexBuffer* m_VertexBuffer = nullptr;
     StructuredBuffer* m_PrimitiveBuffer = nullptr;
 
+    // slot of the primitive buffer SRV in the bindless heap
+    uint32_t m_PrimitiveBufferSlot = BindlessDescriptorHeap::kInvalidIndex;
+
+    // bounds of the tiles and the draws of the visible ones, written by CullTilesCS
+    std::vector<TileData> m_Tiles;
+    StructuredBuffer* m_TileBuffer = nullptr;
+    IndirectArgsBuffer* m_TileDrawArguments = nullptr;
+    IndirectArgsBuffer* m_TileDrawCount = nullptr;
+
+    RootSignature m_CullRootSignature;
+    ComputePSO m_CullPSO;
+    CommandSignature m_TileDrawSignature;
+
+    // set by CullTiles() when it dispatched, RenderTilesIndirect() draws nothing otherwise
+    bool m_TilesCulled = false;
+
+    // with tiled draws the hull shader is TileHS, which reads the draw constants
+    bool m_TiledDraws = false;
+
+    // with the compute tessellation TessellateCS writes the points of every patch here
+    TessellationPath m_Tessellation = kTessellationHullShader;
+    RootSignature m_TessellateRootSignature;
+    ComputePSO m_TessellatePSO;
+    StructuredBuffer* m_RibbonPoints = nullptr;
+
+    // segments per patch in m_RibbonPoints, 0 until TessellateCS ran
+    uint32_t m_NumSegments = 0;
+
+    // rows of squares per tile
+    static const int RowsPerTile = 4;
+    static const int PrimitivesPerSquare = 4;
+    static const int VerticesPerPrimitive = 4;
+
+    // two triangles per segment of a ribbon, see RibbonVS.hlsl
+    static const int VerticesPerSegment = 6;
+    static const int TessellateGroupSize = 64;
+
+    // as in Trafos::GetTessellationFactor()
+    static constexpr float MinTessellationFactor = 3.0f;
+    static constexpr float MaxTessellationFactor = 64.0f;
+
 public:
 
     GraphicsCore& m_Core;
     IPrepareGraphicsContext* m_PrepareGraphicsContext;
 
     PSO_Collection m_PSO;
+    PSO_Collection m_RibbonPSO;
 
     std::shared_ptr<ConstantBuffer> m_ConstantBuffer;
 
@@ -80,18 +142,99 @@ public:
         GraphicsCore& core,
         IPrepareGraphicsContext* iPrepareGraphicsContext
         ) :
+        m_CullRootSignature(core),
+        m_CullPSO(core),
+        m_TileDrawSignature(2),
+        m_TessellateRootSignature(core),
+        m_TessellatePSO(core),
         m_Core(core),
         m_PrepareGraphicsContext(iPrepareGraphicsContext),
-        m_PSO(core)
+        m_PSO(core),
+        m_RibbonPSO(core)
     {
     }
 
     ~Impl()
     {
-        delete m_VertexBuffer;
-        delete m_PrimitiveBuffer;
+        this->ReleasePrimitiveBuffer();
+        this->ReleaseTileBuffers();
+        this->ReleaseRibbonPoints();
+        this->ReleaseVertexBuffer();
+    }
+
+    void ReleaseVertexBuffer()
+    {
+        if (this->m_VertexBuffer == nullptr)
+        {
+            return;
+        }
+
+        // frames in flight may still draw from it or tessellate it
+        const uint64_t fenceValue = this->m_Core.m_pCommandManager->GetGraphicsQueue().IncrementFence();
+
+        VertexBuffer* vertexBuffer = this->m_VertexBuffer;
+        this->m_Core.m_pCommandManager->OnFenceComplete(fenceValue, [vertexBuffer]() { delete vertexBuffer; });
+        this->m_VertexBuffer = nullptr;
     }
 
+    void ReleasePrimitiveBuffer()
+    {
+        if (this->m_PrimitiveBuffer == nullptr)
+        {
+            return;
+        }
+
+        // the GPU may still read the buffer and its descriptor in frames in flight
+        const uint64_t fenceValue = this->m_Core.m_pCommandManager->GetGraphicsQueue().IncrementFence();
+        this->m_Core.m_pBindlessHeap->Free(this->m_PrimitiveBufferSlot, fenceValue);
+        this->m_PrimitiveBufferSlot = BindlessDescriptorHeap::kInvalidIndex;
+
+        StructuredBuffer* primitiveBuffer = this->m_PrimitiveBuffer;
+        this->m_Core.m_pCommandManager->OnFenceComplete(fenceValue, [primitiveBuffer]() { delete primitiveBuffer; });
+        this->m_PrimitiveBuffer = nullptr;
+    }
+
+    void ReleaseTileBuffers()
+    {
+        if (this->m_TileBuffer == nullptr)
+        {
+            return;
+        }
+
+        // frames in flight may still cull with them or draw from them
+        const uint64_t fenceValue = this->m_Core.m_pCommandManager->GetGraphicsQueue().IncrementFence();
+
+        StructuredBuffer* tileBuffer = this->m_TileBuffer;
+        IndirectArgsBuffer* drawArguments = this->m_TileDrawArguments;
+        IndirectArgsBuffer* drawCount = this->m_TileDrawCount;
+        this->m_Core.m_pCommandManager->OnFenceComplete(fenceValue, [tileBuffer, drawArguments, drawCount]()
+        {
+            delete tileBuffer;
+            delete drawArguments;
+            delete drawCount;
+        });
+
+        this->m_TileBuffer = nullptr;
+        this->m_TileDrawArguments = nullptr;
+        this->m_TileDrawCount = nullptr;
+    }
+
+    void ReleaseRibbonPoints()
+    {
+        if (this->m_RibbonPoints == nullptr)
+        {
+            return;
+        }
+
+        // frames in flight may still draw from them
+        const uint64_t fenceValue = this->m_Core.m_pCommandManager->GetGraphicsQueue().IncrementFence();
+
+        StructuredBuffer* ribbonPoints = this->m_RibbonPoints;
+        this->m_Core.m_pCommandManager->OnFenceComplete(fenceValue, [ribbonPoints]() { delete ribbonPoints; });
+
+        this->m_RibbonPoints = nullptr;
+        this->m_NumSegments = 0;
+    }
 
     void InitPSOs(
         IPreparePipelineState* iPreparePipelineState, PSO_Collection& pso, bool zWriteEnable)
@@ -101,72 +244,243 @@ public:
 
     void Init(
 	    IPreparePipelineState* iPreparePipelineState,
-	    std::shared_ptr<ConstantBuffer> sp_ConstantBuffer
+	    std::shared_ptr<ConstantBuffer> sp_ConstantBuffer,
+        bool asyncPipelineStates,
+        TessellationPath tessellation,
+        bool tiledDraws
     )
     {
-        InitPSOs(iPreparePipelineState, m_PSO, true);
-
+        this->m_Tessellation = tessellation;
+        this->m_TiledDraws = tiledDraws;
         this->m_ConstantBuffer = sp_ConstantBuffer;
 
-        this->CompletePipelineStates(m_PSO);
+        // only the pipeline states of the selected path are compiled
+        if (this->m_Tessellation == kTessellationComputeShader)
+        {
+            InitPSOs(iPreparePipelineState, m_RibbonPSO, true);
+            this->CompleteRibbonPipelineState(m_RibbonPSO, asyncPipelineStates);
+            this->InitTessellation(asyncPipelineStates);
+        }
+        else
+        {
+            InitPSOs(iPreparePipelineState, m_PSO, true);
+            this->CompletePipelineStates(m_PSO, asyncPipelineStates);
+        }
+
+        if (this->m_TiledDraws)
+        {
+            this->InitTileCulling(asyncPipelineStates);
+        }
+    }
+
+    void InitTessellation(bool asyncPipelineStates)
+    {
+        this->m_TessellateRootSignature.Reset(3, 0);
+        this->m_TessellateRootSignature[TessellateRootSignature_Constants_Index].InitAsConstants(0, sizeof(TessellationConstants) / 4);
+        this->m_TessellateRootSignature[TessellateRootSignature_ControlPoints_Index].InitAsBufferSRV(0);
+        this->m_TessellateRootSignature[TessellateRootSignature_RibbonPoints_Index].InitAsBufferUAV(0);
+        this->m_TessellateRootSignature.Finalize(this->m_Core.m_pDevice, L"TessellateRootSignature");
+
+        this->m_TessellatePSO.SetRootSignature(this->m_TessellateRootSignature);
+        this->m_TessellatePSO.SetComputeShader(c_pTessellateCS, c_sTessellateCS);
+
+        if (asyncPipelineStates)
+        {
+            this->m_TessellatePSO.FinalizeAsync(this->m_Core.m_pDevice);
+        }
+        else
+        {
+            this->m_TessellatePSO.Finalize(this->m_Core.m_pDevice);
+        }
+    }
+
+    void InitTileCulling(bool asyncPipelineStates)
+    {
+        this->m_CullRootSignature.Reset(4, 0);
+        this->m_CullRootSignature[CullRootSignature_Constants_Index].InitAsConstants(0, sizeof(TileCullConstants) / 4);
+        this->m_CullRootSignature[CullRootSignature_Tiles_Index].InitAsBufferSRV(0);
+        this->m_CullRootSignature[CullRootSignature_DrawArguments_Index].InitAsBufferUAV(0);
+        this->m_CullRootSignature[CullRootSignature_DrawCount_Index].InitAsBufferUAV(1);
+        this->m_CullRootSignature.Finalize(this->m_Core.m_pDevice, L"CullTilesRootSignature");
+
+        this->m_CullPSO.SetRootSignature(this->m_CullRootSignature);
+        this->m_CullPSO.SetComputeShader(c_pCullTilesCS, c_sCullTilesCS);
+
+        if (asyncPipelineStates)
+        {
+            this->m_CullPSO.FinalizeAsync(this->m_Core.m_pDevice);
+        }
+        else
+        {
+            this->m_CullPSO.Finalize(this->m_Core.m_pDevice);
+        }
+
+        // The constants go to the root signature of the draws, see TileDrawArguments.hlsli
+        this->m_TileDrawSignature[0].Constant(RootSignature_DrawConstants_Index, 0, 2);
+        this->m_TileDrawSignature[1].Draw();
+        this->m_TileDrawSignature.Finalize(this->m_Core.m_pDevice, &this->GetDrawPSO().GetRootSignature());
+    }
+
+    TessellationPath GetTessellationPath() const
+    {
+        return this->m_Tessellation;
+    }
+
+    GraphicsPSO& GetDrawPSO()
+    {
+        return this->m_Tessellation == kTessellationComputeShader ? this->m_RibbonPSO.m_PSO : this->m_PSO.m_PSO;
+    }
+
+    bool IsReady()
+    {
+        if (this->m_Tessellation == kTessellationComputeShader)
+        {
+            return this->m_RibbonPSO.m_PSO.IsReady() && this->m_TessellatePSO.IsReady();
+        }
+        return this->m_PSO.m_PSO.IsReady();
+    }
+
+    // the ribbons are drawn only once TessellateCS wrote their points
+    bool HasPointsToDraw() const
+    {
+        return this->m_Tessellation != kTessellationComputeShader || this->m_NumSegments > 0;
+    }
+
+    UINT GetVerticesPerPrimitive() const
+    {
+        return this->m_Tessellation == kTessellationComputeShader ? this->m_NumSegments * VerticesPerSegment : VerticesPerPrimitive;
+    }
+
+    // Read by TileHS and RibbonVS, HS.hlsl of the single draw takes nothing from them
+    bool UsesDrawConstants() const
+    {
+        return this->m_TiledDraws || this->m_Tessellation == kTessellationComputeShader;
+    }
+
+    // RibbonVS takes the number of segments the points were written with from the draw constants
+    float GetDrawTessellationFactor() const
+    {
+        return this->m_Tessellation == kTessellationComputeShader ? static_cast<float>(this->m_NumSegments) : this->m_ConstantBuffer->cTessellationFactor;
     }
 
     std::vector<Vertex> m_Vertexes;
     std::vector<PrimitiveData> m_PrimitiveFlags;
 
-    void CreateBezier(const Math::Vector3& p1, const Math::Vector3& p2)
+    // writes the primitive at primitiveIndex, so rows can be created in parallel
+    void CreateBezier(size_t primitiveIndex, const Math::Vector3& p1, const Math::Vector3& p2)
     {
         auto v = p2 - p1;
         auto leftNormal = Math::Vector3(v.y, -v.x, 0);
 
-        this->m_Vertexes.emplace_back(p1);
-        this->m_Vertexes.emplace_back(p1 + leftNormal);
-        this->m_Vertexes.emplace_back(p2 + leftNormal);
-        this->m_Vertexes.emplace_back(p2);
+        Vertex* vertex = &this->m_Vertexes[primitiveIndex * VerticesPerPrimitive];
+        vertex[0] = Vertex(p1);
+        vertex[1] = Vertex(p1 + leftNormal);
+        vertex[2] = Vertex(p2 + leftNormal);
+        vertex[3] = Vertex(p2);
+
+        this->m_PrimitiveFlags[primitiveIndex] = PrimitiveData();
+    }
+
+    // first primitive and number of primitives of a tile
+    std::pair<UINT, UINT> GetTilePrimitives(uint32_t tileIndex) const
+    {
+        const int numX = static_cast<int>(SizeX);
+        const int numY = static_cast<int>(SizeY);
+        const int primitivesPerRow = numX * PrimitivesPerSquare;
+
+        const int firstRow = static_cast<int>(tileIndex) * RowsPerTile;
+        const int numRows = std::clamp(numY - firstRow, 0, RowsPerTile);
 
-        this->m_PrimitiveFlags.emplace_back();
+        return std::make_pair(static_cast<UINT>(firstRow * primitivesPerRow), static_cast<UINT>(numRows * primitivesPerRow));
     }
 
-    void CreateSquare(float x, float y)
+    uint32_t GetNumTiles() const
+    {
+        if (this->m_VertexBuffer == nullptr)
+        {
+            return 0;
+        }
+
+        const int numY = static_cast<int>(SizeY);
+        return static_cast<uint32_t>((numY + RowsPerTile - 1) / RowsPerTile);
+    }
+
+    // bounds of the control points of every tile, the culling tests them against the view
+    void CreateTiles()
+    {
+        this->m_Tiles.resize(this->GetNumTiles());
+
+        for (uint32_t tileIndex = 0; tileIndex < this->m_Tiles.size(); ++tileIndex)
+        {
+            const auto [firstPrimitive, numPrimitives] = this->GetTilePrimitives(tileIndex);
+
+            TileData& tile = this->m_Tiles[tileIndex];
+            tile.firstPrimitive = firstPrimitive;
+            tile.numPrimitives = numPrimitives;
+            tile.minX = FLT_MAX;
+            tile.minY = FLT_MAX;
+            tile.maxX = -FLT_MAX;
+            tile.maxY = -FLT_MAX;
+
+            const size_t endVertex = static_cast<size_t>(firstPrimitive + numPrimitives) * VerticesPerPrimitive;
+            for (size_t vertexIndex = static_cast<size_t>(firstPrimitive) * VerticesPerPrimitive; vertexIndex < endVertex; ++vertexIndex)
+            {
+                const Vertex& vertex = this->m_Vertexes[vertexIndex];
+                tile.minX = std::min(tile.minX, vertex.PosX);
+                tile.minY = std::min(tile.minY, vertex.PosY);
+                tile.maxX = std::max(tile.maxX, vertex.PosX);
+                tile.maxY = std::max(tile.maxY, vertex.PosY);
+            }
+        }
+    }
+
+    void CreateSquare(size_t firstPrimitive, float x, float y)
     {
         Math::Vector3 p1(x, y, 0);
         Math::Vector3 p2(x + 1.0f, y, 0);
         Math::Vector3 p3(x + 1.0f, y + 1.0f, 0);
         Math::Vector3 p4(x, y + 1.0f, 0);
 
-        CreateBezier(p1, p2);
-        CreateBezier(p2, p3);
-        CreateBezier(p3, p4);
-        CreateBezier(p4, p1);
+        CreateBezier(firstPrimitive + 0, p1, p2);
+        CreateBezier(firstPrimitive + 1, p2, p3);
+        CreateBezier(firstPrimitive + 2, p3, p4);
+        CreateBezier(firstPrimitive + 3, p4, p1);
     }
 
-	void CreateData()
+	void CreateData(bool copyQueueUploads)
     {
         const int numX = static_cast<int>(SizeX);
         const int numY = static_cast<int>(SizeY);
-        const int numPrimitives = numX * numY * 4;
-        const int numVertices = numPrimitives * 4;
+        const int numPrimitives = numX * numY * PrimitivesPerSquare;
+        const int numVertices = numPrimitives * VerticesPerPrimitive;
 
-        this->m_Vertexes.reserve(numVertices);
-        this->m_PrimitiveFlags.reserve(numPrimitives);
+        this->m_Vertexes.resize(numVertices);
+        this->m_PrimitiveFlags.resize(numPrimitives);
 
-        for (int y = 0; y < numY; ++y)
+        // every row writes its own range of the arrays
+        this->m_Core.m_pTaskScheduler->ParallelFor(0, static_cast<uint32_t>(numY), 1, [this, numX](uint32_t firstRow, uint32_t endRow)
         {
-            for (int x = 0; x < numX; ++x)
+            for (int y = static_cast<int>(firstRow); y < static_cast<int>(endRow); ++y)
             {
-                CreateSquare(static_cast<float>(x), static_cast<float>(y));
+                for (int x = 0; x < numX; ++x)
+                {
+                    const size_t firstPrimitive = (static_cast<size_t>(y) * numX + x) * PrimitivesPerSquare;
+                    CreateSquare(firstPrimitive, static_cast<float>(x), static_cast<float>(y));
+                }
             }
-        }
+        });
 
         // clear old stuff
-        delete this->m_VertexBuffer;
-        this->m_VertexBuffer = nullptr;
+        this->ReleaseVertexBuffer();
+        this->ReleasePrimitiveBuffer();
+        this->ReleaseTileBuffers();
+        this->m_Tiles.clear();
 
-        delete this->m_PrimitiveBuffer;
-        this->m_PrimitiveBuffer = nullptr;
+        // Without the copy queue every buffer is uploaded on its own and waited for
+        UploadManager* uploads = copyQueueUploads ? this->m_Core.m_pUploadManager : nullptr;
 
         // create the vertex buffer
-        this->m_VertexBuffer = new VertexBuffer(this->m_Core, L"BezierByGraficVertexVertices", m_Vertexes);
+        this->m_VertexBuffer = new VertexBuffer(this->m_Core, L"BezierByGraficVertexVertices", m_Vertexes, uploads);
 
         this->m_PrimitiveBuffer = new StructuredBuffer(this->m_Core);
 
@@ -174,7 +488,54 @@ public:
             L"BezierByGraficPrimitiveFlags",
             static_cast<unsigned int>(m_PrimitiveFlags.size()),
             sizeof(m_PrimitiveFlags[0]),
-            m_PrimitiveFlags.data());
+            uploads != nullptr ? nullptr : m_PrimitiveFlags.data());
+
+        // only the GPU-driven tiles cull, the single draw and RenderTile() need no buffers for it
+        if (this->m_TiledDraws)
+        {
+            this->CreateTiles();
+
+            this->m_TileBuffer = new StructuredBuffer(this->m_Core);
+            this->m_TileBuffer->Create(
+                L"BezierByGraficTiles",
+                static_cast<unsigned int>(m_Tiles.size()),
+                sizeof(m_Tiles[0]),
+                uploads != nullptr ? nullptr : m_Tiles.data());
+
+            // written by CullTilesCS every frame
+            this->m_TileDrawArguments = new IndirectArgsBuffer(this->m_Core);
+            this->m_TileDrawArguments->Create(L"BezierByGraficTileDrawArguments", static_cast<unsigned int>(m_Tiles.size()), sizeof(TileDrawArguments));
+
+            this->m_TileDrawCount = new IndirectArgsBuffer(this->m_Core);
+            this->m_TileDrawCount->Create(L"BezierByGraficTileDrawCount", 1, sizeof(uint32_t));
+        }
+
+        // room for the highest tessellation factor, TessellateCS runs again for the new patches
+        this->ReleaseRibbonPoints();
+        if (this->m_Tessellation == kTessellationComputeShader)
+        {
+            this->m_RibbonPoints = new StructuredBuffer(this->m_Core);
+            this->m_RibbonPoints->Create(
+                L"BezierByGraficRibbonPoints",
+                static_cast<unsigned int>(m_PrimitiveFlags.size() * (BezierTessellation::MaxSegments + 1)),
+                sizeof(RibbonPoint));
+        }
+
+        if (uploads != nullptr)
+        {
+            uploads->Upload(*this->m_PrimitiveBuffer, 0, m_PrimitiveFlags.data(), m_PrimitiveFlags.size() * sizeof(m_PrimitiveFlags[0]));
+            if (this->m_TileBuffer != nullptr)
+            {
+                uploads->Upload(*this->m_TileBuffer, 0, m_Tiles.data(), m_Tiles.size() * sizeof(m_Tiles[0]));
+            }
+
+            // Frames submitted from now on wait for the copies on the GPU, the CPU goes on
+            const uint64_t uploadToken = uploads->Submit();
+            uploads->WaitOnGpu(this->m_Core.m_pCommandManager->GetGraphicsQueue(), uploadToken);
+        }
+
+        // written once, draws only point the table at it
+        this->m_PrimitiveBufferSlot = this->m_Core.m_pBindlessHeap->Register(this->m_PrimitiveBuffer->GetSRV());
     }
 
     static void PreparePipelineState(GraphicsPSO& pso)
@@ -189,49 +550,261 @@ public:
         pso.SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_PATCH);
     }
 
-    static void SetPipelineStateShader(GraphicsPSO& pso)
+    void SetPipelineStateShader(GraphicsPSO& pso) const
     {
         pso.SetVertexShader(c_pVS, c_sVS);
-    	pso.SetHullShader(c_pHS, c_sHS);
+        if (this->m_TiledDraws)
+        {
+            pso.SetHullShader(c_pTileHS, c_sTileHS);
+        }
+        else
+        {
+            pso.SetHullShader(c_pHS, c_sHS);
+        }
         pso.SetDomainShader(c_pDS, c_sDS);
         pso.SetGeometryShader(c_pGS, c_sGS);
     }
 
-    void CompletePipelineStates(PSO_Collection& pso)
+    // No input layout, RibbonVS reads the points by SV_VertexID
+    void CompleteRibbonPipelineState(PSO_Collection& pso, bool asyncPipelineStates)
+    {
+        pso.m_PSO.SetInputLayout(0, nullptr);
+        pso.m_PSO.SetPrimitiveTopologyType(D3D12_PRIMITIVE_TOPOLOGY_TYPE_TRIANGLE);
+        pso.m_PSO.SetVertexShader(c_pRibbonVS, c_sRibbonVS);
+        pso.m_PSO.SetPixelShader(c_pPS, c_sPS);
+
+        if (asyncPipelineStates)
+        {
+            pso.m_PSO.FinalizeAsync(this->m_Core.m_pDevice);
+        }
+        else
+        {
+            pso.m_PSO.Finalize(this->m_Core.m_pDevice);
+        }
+    }
+
+    void CompletePipelineStates(PSO_Collection& pso, bool asyncPipelineStates)
     {
         this->PreparePipelineState(pso.m_PSO);
         this->SetPipelineStateShader(pso.m_PSO);
         pso.m_PSO.SetPixelShader(c_pPS, c_sPS);
-        pso.m_PSO.Finalize(this->m_Core.m_pDevice);
+
+        // Until an async compile is done the renderer draws nothing, see IsReady()
+        if (asyncPipelineStates)
+        {
+            pso.m_PSO.FinalizeAsync(this->m_Core.m_pDevice);
+        }
+        else
+        {
+            pso.m_PSO.Finalize(this->m_Core.m_pDevice);
+        }
     }
 
     void PrepareContext(RenderContext& renderContext)
     {
-        renderContext.graphicsContext->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+        const BindlessDescriptorHeap& bindlessHeap = *this->m_Core.m_pBindlessHeap;
+        renderContext.graphicsContext->SetDescriptorHeap(D3D12_DESCRIPTOR_HEAP_TYPE_CBV_SRV_UAV, bindlessHeap.GetHeapPointer());
+        renderContext.graphicsContext->SetDescriptorTable(RootSignature_PrimitiveBuffer_Index, bindlessHeap.GetGpuHandle(this->m_PrimitiveBufferSlot));
 
-        renderContext.graphicsContext->SetDynamicDescriptor(RootSignature_PrimitiveBuffer_Index, 0, this->m_PrimitiveBuffer->GetSRV());
+        if (this->m_Tessellation == kTessellationComputeShader)
+        {
+            renderContext.graphicsContext->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST);
+            renderContext.graphicsContext->SetBufferSRV(RootSignature_RibbonPoints_Index, *this->m_RibbonPoints);
+        }
+        else
+        {
+            renderContext.graphicsContext->SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+            renderContext.graphicsContext->SetVertexBuffers(0, 1, &this->m_VertexBuffer->GetView());
+        }
 
-        renderContext.graphicsContext->SetVertexBuffers(0, 1, &this->m_VertexBuffer->GetView());
+        if (renderContext.sceneConstants != 0)
+        {
+            renderContext.graphicsContext->SetConstantBuffer(RootSignature_ConstantBuffer_Index, renderContext.sceneConstants);
+        }
+        else
+        {
+            renderContext.graphicsContext->SetDynamicConstantBufferView(RootSignature_ConstantBuffer_Index, sizeof(*this->m_ConstantBuffer), &*this->m_ConstantBuffer);
+        }
     }
         
-    uint64_t Render(RenderContext& renderContext)
+    // The single draw and every tile draw go through here
+    void DrawPrimitives(RenderContext& renderContext, UINT firstPrimitive, UINT numPrimitives)
     {
-        uint64_t fence = 0;
-        if (this->m_VertexBuffer == nullptr)
+        // Repeated state of consecutive tiles in one context is dropped by the context.
+        this->PrepareContext(renderContext);
+        renderContext.graphicsContext->SetPipelineState(this->GetDrawPSO());
+
+        // SV_PrimitiveID starts at 0 for each draw
+        const UINT verticesPerPrimitive = this->GetVerticesPerPrimitive();
+        if (this->UsesDrawConstants())
         {
-            return fence;
+            renderContext.graphicsContext->SetConstants(RootSignature_DrawConstants_Index, firstPrimitive, this->GetDrawTessellationFactor());
         }
+        renderContext.graphicsContext->Draw(numPrimitives * verticesPerPrimitive, firstPrimitive * verticesPerPrimitive);
+        ++renderContext.numDrawsCalled;
+    }
 
-        this->PrepareContext(renderContext);
+    void Render(RenderContext& renderContext)
+    {
+        if (this->m_VertexBuffer == nullptr || !this->HasPointsToDraw())
+        {
+            return;
+        }
+
+        ASSERT(!this->m_TiledDraws, "Init() without tiledDraws for the single draw");
+        this->DrawPrimitives(renderContext, 0, static_cast<UINT>(this->m_PrimitiveFlags.size()));
+    }
+
+    void RenderTile(RenderContext& renderContext, uint32_t tileIndex)
+    {
+        if (this->m_VertexBuffer == nullptr || !this->HasPointsToDraw())
+        {
+            return;
+        }
+
+        const auto [firstPrimitive, numPrimitives] = this->GetTilePrimitives(tileIndex);
+        if (numPrimitives == 0)
+        {
+            return;
+        }
+
+        ASSERT(this->m_TiledDraws, "Init() with tiledDraws for the tiles");
+        this->DrawPrimitives(renderContext, firstPrimitive, numPrimitives);
+    }
+
+    TileCullConstants GetTileCullConstants() const
+    {
+        const ConstantBuffer& scene = *this->m_ConstantBuffer;
+
+        // The vertex shader transforms with w = 1, the GS widens the lines by up to 1.5 * 0.25 / 2 * scaleVector
+        const Math::Vector4 clipOrigin = scene.cViewProjection * Math::Vector4(0.0f, 0.0f, 0.0f, 1.0f);
+        const Math::Vector4 clipAxisX = scene.cViewProjection * Math::Vector4(1.0f, 0.0f, 0.0f, 0.0f);
+        const Math::Vector4 clipAxisY = scene.cViewProjection * Math::Vector4(0.0f, 1.0f, 0.0f, 0.0f);
+        const float lineScale = std::max(std::abs(static_cast<float>(scene.scaleVector.GetX())), std::abs(static_cast<float>(scene.scaleVector.GetY())));
+
+        TileCullConstants constants;
+        constants.clipAxisX[0] = clipAxisX.GetX();
+        constants.clipAxisX[1] = clipAxisX.GetY();
+        constants.clipAxisY[0] = clipAxisY.GetX();
+        constants.clipAxisY[1] = clipAxisY.GetY();
+        constants.clipOrigin[0] = clipOrigin.GetX();
+        constants.clipOrigin[1] = clipOrigin.GetY();
+        constants.clipMargin = 1.5f * 0.25f / 2.0f * lineScale;
+        constants.windowHeightInPixels = static_cast<float>(scene.windowSizeYInPixels1);
+        constants.numTiles = static_cast<UINT>(this->m_Tiles.size());
+        constants.verticesPerPrimitive = this->GetVerticesPerPrimitive();
+
+        // The points of the compute tessellation have one number of segments for all tiles
+        if (this->m_Tessellation == kTessellationComputeShader)
+        {
+            constants.minTessellationFactor = static_cast<float>(this->m_NumSegments);
+            constants.maxTessellationFactor = static_cast<float>(this->m_NumSegments);
+        }
+        else
+        {
+            constants.minTessellationFactor = MinTessellationFactor;
+            constants.maxTessellationFactor = MaxTessellationFactor;
+        }
+        return constants;
+    }
+
+    void CullTiles(RenderContext& renderContext)
+    {
+        this->m_TilesCulled = false;
+        if (!this->m_TiledDraws || this->m_VertexBuffer == nullptr || !this->IsReady() || !this->m_CullPSO.IsReady() || !this->HasPointsToDraw())
+        {
+            return;
+        }
+
+        const TileCullConstants constants = this->GetTileCullConstants();
+
+        // Recorded into the frame's graphics context, the draws wait for it through the barriers of the frame
+        ComputeContext& computeContext = renderContext.graphicsContext->GetComputeContext();
+        computeContext.SetRootSignature(this->m_CullRootSignature);
+        computeContext.SetPipelineState(this->m_CullPSO);
+        computeContext.SetConstantArray(CullRootSignature_Constants_Index, sizeof(constants) / 4, &constants);
+        computeContext.SetBufferSRV(CullRootSignature_Tiles_Index, *this->m_TileBuffer);
+        computeContext.SetBufferUAV(CullRootSignature_DrawArguments_Index, *this->m_TileDrawArguments);
+        computeContext.SetBufferUAV(CullRootSignature_DrawCount_Index, *this->m_TileDrawCount);
+        computeContext.Dispatch(1, 1, 1);
+
+        this->m_TilesCulled = true;
+    }
+
+    void RenderTilesIndirect(RenderContext& renderContext)
+    {
+        if (!this->m_TilesCulled)
+        {
+            return;
+        }
+        this->m_TilesCulled = false;
 
-        this->m_PrepareGraphicsContext->FinishGraphicContext(renderContext);
-        this->m_PrepareGraphicsContext->CreateAndInitGraphicContext(L"Render", renderContext);
         this->PrepareContext(renderContext);
-        renderContext.graphicsContext->SetPipelineState(this->m_PSO.m_PSO);
-        renderContext.graphicsContext->SetDynamicConstantBufferView(RootSignature_ConstantBuffer_Index, sizeof(*this->m_ConstantBuffer), &*this->m_ConstantBuffer);
-        renderContext.graphicsContext->Draw(static_cast<UINT>(this->m_VertexBuffer->GetNumElements()), 0);
-        
-        return fence;
+        renderContext.graphicsContext->SetPipelineState(this->GetDrawPSO());
+
+        // As many draws as CullTilesCS wrote, the CPU does not know how many
+        renderContext.graphicsContext->ExecuteIndirect(this->m_TileDrawSignature, *this->m_TileDrawArguments, 0,
+            static_cast<uint32_t>(this->m_Tiles.size()), this->m_TileDrawCount, 0);
+        ++renderContext.numDrawsCalled;
+    }
+
+    void Tessellate(RenderContext& renderContext)
+    {
+        if (this->m_Tessellation != kTessellationComputeShader || this->m_VertexBuffer == nullptr || !this->IsReady())
+        {
+            return;
+        }
+
+        // The points are in world space, only a new number of segments changes them
+        const uint32_t numSegments = BezierTessellation::GetNumSegments(this->m_ConstantBuffer->cTessellationFactor);
+        if (numSegments == this->m_NumSegments)
+        {
+            return;
+        }
+
+        const uint32_t numPatches = static_cast<uint32_t>(this->m_PrimitiveFlags.size());
+        const TessellationConstants constants = BezierTessellation::MakeConstants(numPatches, numSegments);
+
+        // Recorded into the frame's graphics context like CullTiles()
+        ComputeContext& computeContext = renderContext.graphicsContext->GetComputeContext();
+        computeContext.SetRootSignature(this->m_TessellateRootSignature);
+        computeContext.SetPipelineState(this->m_TessellatePSO);
+        computeContext.SetConstantArray(TessellateRootSignature_Constants_Index, sizeof(constants) / 4, &constants);
+        computeContext.SetBufferSRV(TessellateRootSignature_ControlPoints_Index, this->m_VertexBuffer->GetInternalBuffer());
+        computeContext.SetBufferUAV(TessellateRootSignature_RibbonPoints_Index, *this->m_RibbonPoints);
+        computeContext.Dispatch1D(numPatches * (numSegments + 1), TessellateGroupSize);
+
+        this->m_NumSegments = numSegments;
+    }
+
+    GpuResource& GetControlPoints() const
+    {
+        ASSERT(this->m_VertexBuffer != nullptr, "CreateData() first");
+        return this->m_VertexBuffer->GetInternalBuffer();
+    }
+
+    GpuResource& GetRibbonPoints() const
+    {
+        ASSERT(this->m_RibbonPoints != nullptr, "CreateData() with the compute tessellation first");
+        return *this->m_RibbonPoints;
+    }
+
+    GpuResource& GetTileBuffer() const
+    {
+        ASSERT(this->m_TileBuffer != nullptr, "CreateData() first");
+        return *this->m_TileBuffer;
+    }
+
+    GpuResource& GetTileDrawArguments() const
+    {
+        ASSERT(this->m_TileDrawArguments != nullptr, "CreateData() first");
+        return *this->m_TileDrawArguments;
+    }
+
+    GpuResource& GetTileDrawCount() const
+    {
+        ASSERT(this->m_TileDrawCount != nullptr, "CreateData() first");
+        return *this->m_TileDrawCount;
     }
 };
 
@@ -247,23 +820,89 @@ BezierByGraficRenderer::~BezierByGraficRenderer()
     delete this->pImpl;
 }
 
-void BezierByGraficRenderer::CreateData()
+void BezierByGraficRenderer::CreateData(bool copyQueueUploads)
 {
-    this->pImpl->CreateData();
+    this->pImpl->CreateData(copyQueueUploads);
 }
 
 void BezierByGraficRenderer::Init(
 	IPreparePipelineState* iPreparePipelineState,
-	std::shared_ptr<ConstantBuffer> sp_ConstantBuffer)
+	std::shared_ptr<ConstantBuffer> sp_ConstantBuffer,
+    bool asyncPipelineStates,
+    TessellationPath tessellation,
+    bool tiledDraws)
 {
     this->pImpl->Init(
 	    iPreparePipelineState,
-	    sp_ConstantBuffer);
+	    sp_ConstantBuffer,
+        asyncPipelineStates,
+        tessellation,
+        tiledDraws);
+}
+
+TessellationPath BezierByGraficRenderer::GetTessellationPath() const
+{
+    return this->pImpl->GetTessellationPath();
+}
+
+bool BezierByGraficRenderer::IsReady()
+{
+    return this->pImpl->IsReady();
+}
+
+uint32_t BezierByGraficRenderer::GetNumTiles() const
+{
+    return this->pImpl->GetNumTiles();
+}
+
+void BezierByGraficRenderer::Render(RenderContext& renderContext)
+{
+    this->pImpl->Render(renderContext);
+}
+
+void BezierByGraficRenderer::RenderTile(RenderContext& renderContext, uint32_t tileIndex)
+{
+    this->pImpl->RenderTile(renderContext, tileIndex);
+}
+
+void BezierByGraficRenderer::CullTiles(RenderContext& renderContext)
+{
+    this->pImpl->CullTiles(renderContext);
+}
+
+void BezierByGraficRenderer::RenderTilesIndirect(RenderContext& renderContext)
+{
+    this->pImpl->RenderTilesIndirect(renderContext);
+}
+
+void BezierByGraficRenderer::Tessellate(RenderContext& renderContext)
+{
+    this->pImpl->Tessellate(renderContext);
+}
+
+GpuResource& BezierByGraficRenderer::GetControlPoints() const
+{
+    return this->pImpl->GetControlPoints();
+}
+
+GpuResource& BezierByGraficRenderer::GetRibbonPoints() const
+{
+    return this->pImpl->GetRibbonPoints();
+}
+
+GpuResource& BezierByGraficRenderer::GetTileBuffer() const
+{
+    return this->pImpl->GetTileBuffer();
+}
+
+GpuResource& BezierByGraficRenderer::GetTileDrawArguments() const
+{
+    return this->pImpl->GetTileDrawArguments();
 }
 
-uint64_t BezierByGraficRenderer::Render(RenderContext& renderContext)
+GpuResource& BezierByGraficRenderer::GetTileDrawCount() const
 {
-    return this->pImpl->Render(renderContext);
+    return this->pImpl->GetTileDrawCount();
 }
 
 std::shared_ptr<ConstantBuffer> BezierByGraficRenderer::GetConstantBuffer() const
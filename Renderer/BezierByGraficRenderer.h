@@ -3,6 +3,7 @@
 #include "DirectX12/ConstantBuffer.h"
 #include "DirectX12/Engine/CommandContext.h"
 #include "DirectX12/IPreparePipelineState.h"
+#include "TessellationSelection.h"
 
 class BezierByGraficRenderer 
 {
@@ -13,15 +14,56 @@ public:
 
     ~BezierByGraficRenderer();
 
-    void CreateData();
+    // With copyQueueUploads the buffers are uploaded on the copy queue, frames wait for them on the GPU
+    void CreateData(bool copyQueueUploads = false);
 
+    // With asyncPipelineStates the pipeline states are compiled in the background.
+    // Without tiledDraws Render() draws the fabric with one draw and the hull shader
+    // HS.hlsl; with it the fabric is drawn in tiles by RenderTile() or the GPU-driven
+    // tiles, and the hull shader is TileHS.hlsl.
     void Init(
         IPreparePipelineState*,
-        std::shared_ptr<ConstantBuffer>);
+        std::shared_ptr<ConstantBuffer>,
+        bool asyncPipelineStates = false,
+        TessellationPath tessellation = kTessellationHullShader,
+        bool tiledDraws = false);
+
+    TessellationPath GetTessellationPath() const;
+
+    // False while the pipeline states are still compiled, nothing is drawn until then.
+    // Call from the thread that records the frame, not from the tile workers.
+    bool IsReady();
 
     std::shared_ptr<ConstantBuffer> GetConstantBuffer() const;
 
-    uint64_t Render(RenderContext& renderContext);
+    // The whole fabric with one draw
+    void Render(RenderContext& renderContext);
+
+    // The fabric split into bands of rows, each drawn on its own.
+    // Tiles can be recorded concurrently into different contexts.
+    uint32_t GetNumTiles() const;
+    void RenderTile(RenderContext& renderContext, uint32_t tileIndex);
+
+    // GPU-driven tiles: CullTiles() dispatches a compute shader that culls the tiles
+    // against the view and writes the draws of the visible ones, RenderTilesIndirect()
+    // draws them with one ExecuteIndirect.  The caller transitions the tile buffers:
+    // the tiles to NON_PIXEL_SHADER_RESOURCE and the draw arguments and count to
+    // UNORDERED_ACCESS for CullTiles(), both to INDIRECT_ARGUMENT for the draws.
+    void CullTiles(RenderContext& renderContext);
+    void RenderTilesIndirect(RenderContext& renderContext);
+
+    GpuResource& GetTileBuffer() const;
+    GpuResource& GetTileDrawArguments() const;
+    GpuResource& GetTileDrawCount() const;
+
+    // Compute tessellation: Tessellate() dispatches TessellateCS when the number of
+    // segments changed, the draws read its points.  The caller transitions the control
+    // points to NON_PIXEL_SHADER_RESOURCE and the ribbon points to UNORDERED_ACCESS for
+    // Tessellate(), the ribbon points to NON_PIXEL_SHADER_RESOURCE for the draws.
+    void Tessellate(RenderContext& renderContext);
+
+    GpuResource& GetControlPoints() const;
+    GpuResource& GetRibbonPoints() const;
 
     bool GetIsEnable() const;
 
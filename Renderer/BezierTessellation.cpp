@@ -0,0 +1,72 @@
+#include "pch.h"
+#include "BezierTessellation.h"
+
+#include <algorithm>
+#include <cmath>
+
+uint32_t BezierTessellation::GetNumSegments(float tessellationFactor)
+{
+    return static_cast<uint32_t>(std::ceil(std::clamp(tessellationFactor, 1.0f, static_cast<float>(MaxSegments))));
+}
+
+TessellationConstants BezierTessellation::MakeConstants(uint32_t numPatches, uint32_t numSegments)
+{
+    TessellationConstants constants;
+    constants.numPatches = numPatches;
+    constants.numSegments = numSegments;
+    constants.segmentStep = 1.0f / static_cast<float>(numSegments);
+    return constants;
+}
+
+RibbonPoint BezierTessellation::EvaluatePoint(const TessellationConstants& constants, const float* controlPoints, uint32_t pointIndex)
+{
+    const uint32_t numPoints = constants.numSegments + 1;
+    const uint32_t patch = pointIndex / numPoints;
+    const uint32_t pointInPatch = pointIndex - patch * numPoints;
+
+    const float t = pointInPatch == constants.numSegments ? 1.0f : static_cast<float>(pointInPatch) * constants.segmentStep;
+
+    const float s = 1.0f - t;
+    const float a0 = s * s;
+    const float a1 = 2.0f * s * t;
+    const float a2 = t * t;
+
+    const float b[4] =
+    {
+        s * a0,
+        t * a0 + s * a1,
+        t * a1 + s * a2,
+        t * a2
+    };
+
+    const float d[4] =
+    {
+        -a0,
+        a0 - a1,
+        a1 - a2,
+        a2
+    };
+
+    const float* p = &controlPoints[static_cast<size_t>(patch) * 4 * 4];
+
+    RibbonPoint ribbonPoint;
+    for (int i = 0; i < 3; ++i)
+    {
+        ribbonPoint.position[i] = b[0] * p[0 * 4 + i] + b[1] * p[1 * 4 + i] + b[2] * p[2 * 4 + i] + b[3] * p[3 * 4 + i];
+    }
+    for (int i = 0; i < 2; ++i)
+    {
+        ribbonPoint.derivative[i] = d[0] * p[0 * 4 + i] + d[1] * p[1 * 4 + i] + d[2] * p[2 * 4 + i] + d[3] * p[3 * 4 + i];
+    }
+    ribbonPoint.mustBe5 = 5;
+    return ribbonPoint;
+}
+
+void BezierTessellation::Tessellate(const TessellationConstants& constants, const float* controlPoints, RibbonPoint* points)
+{
+    const uint32_t numPoints = constants.numPatches * (constants.numSegments + 1);
+    for (uint32_t pointIndex = 0; pointIndex < numPoints; ++pointIndex)
+    {
+        points[pointIndex] = EvaluatePoint(constants, controlPoints, pointIndex);
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// The compute tessellation of BezierByGraficRenderer on the CPU.  EvaluatePoint() does
+// what TessellateCS.hlsl does for one thread, operation by operation in the same order,
+// and gives the same bits as long as the compiler does not contract a * b + c into a
+// fused multiply-add (it does not with the default /fp:precise and SSE2).
+
+#include <stdint.h>
+
+#pragma pack(push, 1)
+struct RibbonPoint
+{
+#include "DirectX12/Shaders/BezierByGrafic/Shared/RibbonPoint.hlsli"
+};
+
+struct TessellationConstants
+{
+#include "DirectX12/Shaders/BezierByGrafic/Shared/TessellationConstants.hlsli"
+};
+#pragma pack(pop)
+
+class BezierTessellation
+{
+public:
+    // The highest tessellation factor of D3D
+    static const uint32_t MaxSegments = 64;
+
+    // Segments of a patch with this factor, integer partitioning rounds up
+    static uint32_t GetNumSegments(float tessellationFactor);
+
+    static TessellationConstants MakeConstants(uint32_t numPatches, uint32_t numSegments);
+
+    // controlPoints has four floats per control point, the fourth is ignored, and four control points per patch
+    static RibbonPoint EvaluatePoint(const TessellationConstants& constants, const float* controlPoints, uint32_t pointIndex);
+
+    // Writes numPatches * (numSegments + 1) points
+    static void Tessellate(const TessellationConstants& constants, const float* controlPoints, RibbonPoint* points);
+};
@@ -0,0 +1,44 @@
+#include "pch.h"
+#include "TessellationSelection.h"
+
+#include <string.h>
+
+bool TessellationSelection::ParseCommandLine(int argc, const char* const* argv, TessellationPath& path)
+{
+    const size_t optionLength = strlen(OverrideOption);
+
+    bool found = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (argv[i] == nullptr || strncmp(argv[i], OverrideOption, optionLength) != 0)
+        {
+            continue;
+        }
+
+        const char* value = argv[i] + optionLength;
+        if (strcmp(value, "hull") == 0)
+        {
+            path = kTessellationHullShader;
+            found = true;
+        }
+        else if (strcmp(value, "compute") == 0)
+        {
+            path = kTessellationComputeShader;
+            found = true;
+        }
+    }
+    return found;
+}
+
+TessellationPath TessellationSelection::SelectForAdapter(uint32_t vendorId, uint32_t deviceId, const TessellationAdapter* computeAdapters, size_t numComputeAdapters)
+{
+    for (size_t i = 0; i < numComputeAdapters; ++i)
+    {
+        const TessellationAdapter& adapter = computeAdapters[i];
+        if (adapter.vendorId == vendorId && (adapter.deviceId == 0 || adapter.deviceId == deviceId))
+        {
+            return kTessellationComputeShader;
+        }
+    }
+    return kTessellationHullShader;
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+// Which tessellation path an adapter uses.  The hull shader path is the default, the
+// one that shows the bug; an adapter takes the compute path only if it is on the opt-in
+// list, or if the command line asks for a path.  The functions only compare IDs and
+// strings, the caller reads them from DXGI and the process.
+
+#include <stddef.h>
+#include <stdint.h>
+
+// How the Bezier patches become lines: the hull, domain and geometry shader, or a
+// compute shader writing the points of the curves and a vertex shader widening them
+enum TessellationPath
+{
+    kTessellationHullShader,
+    kTessellationComputeShader
+};
+
+// PCI IDs as in DXGI_ADAPTER_DESC1, deviceId 0 matches every device of the vendor
+struct TessellationAdapter
+{
+    uint32_t vendorId;
+    uint32_t deviceId;
+};
+
+class TessellationSelection
+{
+public:
+    // The argument that overrides the adapter list
+    static constexpr const char* OverrideOption = "--tessellation=";
+
+    // Looks for --tessellation=hull or --tessellation=compute, the last one wins.
+    // False if neither is given; other values are ignored.
+    static bool ParseCommandLine(int argc, const char* const* argv, TessellationPath& path);
+
+    // The compute path for adapters on computeAdapters, the hull shader path for all others
+    static TessellationPath SelectForAdapter(uint32_t vendorId, uint32_t deviceId, const TessellationAdapter* computeAdapters, size_t numComputeAdapters);
+};
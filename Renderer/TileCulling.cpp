@@ -0,0 +1,53 @@
+#include "pch.h"
+#include "TileCulling.h"
+
+#include <algorithm>
+#include <cmath>
+
+bool TileCulling::CullTile(const TileCullConstants& constants, const TileData& tile, TileDrawArguments& draw)
+{
+    // One component of x * clipAxisX + y * clipAxisY + clipOrigin
+    const auto clip = [&constants](float x, float y, int component)
+    {
+        return x * constants.clipAxisX[component] + y * constants.clipAxisY[component] + constants.clipOrigin[component];
+    };
+
+    float lowX = std::min(std::min(clip(tile.minX, tile.minY, 0), clip(tile.maxX, tile.minY, 0)), std::min(clip(tile.minX, tile.maxY, 0), clip(tile.maxX, tile.maxY, 0)));
+    float lowY = std::min(std::min(clip(tile.minX, tile.minY, 1), clip(tile.maxX, tile.minY, 1)), std::min(clip(tile.minX, tile.maxY, 1), clip(tile.maxX, tile.maxY, 1)));
+    float highX = std::max(std::max(clip(tile.minX, tile.minY, 0), clip(tile.maxX, tile.minY, 0)), std::max(clip(tile.minX, tile.maxY, 0), clip(tile.maxX, tile.maxY, 0)));
+    float highY = std::max(std::max(clip(tile.minX, tile.minY, 1), clip(tile.maxX, tile.minY, 1)), std::max(clip(tile.minX, tile.maxY, 1), clip(tile.maxX, tile.maxY, 1)));
+
+    const float clipPerUnit = (highY - lowY) / std::max(tile.maxY - tile.minY, 1e-6f);
+    const float tessellationFactor = std::clamp(std::ceil(clipPerUnit * constants.windowHeightInPixels / 3.0f),
+        constants.minTessellationFactor, constants.maxTessellationFactor);
+
+    draw.primitiveOffset = tile.firstPrimitive;
+    draw.tessellationFactor = tessellationFactor;
+    draw.vertexCountPerInstance = tile.numPrimitives * constants.verticesPerPrimitive;
+    draw.instanceCount = 1;
+    draw.startVertexLocation = tile.firstPrimitive * constants.verticesPerPrimitive;
+    draw.startInstanceLocation = 0;
+
+    lowX -= constants.clipMargin;
+    lowY -= constants.clipMargin;
+    highX += constants.clipMargin;
+    highY += constants.clipMargin;
+
+    return tile.numPrimitives > 0 && lowX <= 1.0f && lowY <= 1.0f && highX >= -1.0f && highY >= -1.0f;
+}
+
+uint32_t TileCulling::CullTiles(const TileCullConstants& constants, const TileData* tiles, TileDrawArguments* draws)
+{
+    uint32_t numDraws = 0;
+
+    for (uint32_t tileIndex = 0; tileIndex < constants.numTiles; ++tileIndex)
+    {
+        TileDrawArguments draw;
+        if (CullTile(constants, tiles[tileIndex], draw))
+        {
+            draws[numDraws++] = draw;
+        }
+    }
+
+    return numDraws;
+}
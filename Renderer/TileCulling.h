@@ -0,0 +1,34 @@
+#pragma once
+
+// The tile culling of BezierByGraficRenderer on the CPU.  CullTiles() follows
+// CullTilesCS.hlsl step by step and writes the same draw arguments, so the culling,
+// the tessellation factors and the compaction can be checked without a device.
+
+#include <stdint.h>
+
+#pragma pack(push, 1)
+struct TileData
+{
+#include "DirectX12/Shaders/BezierByGrafic/Shared/TileData.hlsli"
+};
+
+struct TileDrawArguments
+{
+#include "DirectX12/Shaders/BezierByGrafic/Shared/TileDrawArguments.hlsli"
+};
+
+struct TileCullConstants
+{
+#include "DirectX12/Shaders/BezierByGrafic/Shared/TileCullConstants.hlsli"
+};
+#pragma pack(pop)
+
+class TileCulling
+{
+public:
+    // Writes the draws of the visible tiles to draws in tile order and returns their number.
+    // draws needs room for constants.numTiles draws.
+    static uint32_t CullTiles(const TileCullConstants& constants, const TileData* tiles, TileDrawArguments* draws);
+
+    static bool CullTile(const TileCullConstants& constants, const TileData& tile, TileDrawArguments& draw);
+};
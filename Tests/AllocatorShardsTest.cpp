@@ -0,0 +1,216 @@
+#include "Tests.h"
+#include "DirectX12/Engine/AllocatorShards.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Stands in for an ID3D12CommandAllocator, the pool only passes the pointers around
+    struct FakeAllocator
+    {
+        std::atomic<bool> recording{ false };
+        uint64_t fenceValue = 0;
+    };
+
+    void RaiseTo(std::atomic<uint64_t>& value, uint64_t newValue)
+    {
+        uint64_t oldValue = value.load();
+        while (oldValue < newValue && !value.compare_exchange_weak(oldValue, newValue))
+        {
+        }
+    }
+
+    struct Workload
+    {
+        uint32_t numThreads;
+        uint32_t maxAllocators;
+        uint64_t submissionsInFlight;    // how far the fence lags behind the submissions
+        uint32_t requestsPerThread;
+    };
+
+    struct WorkloadResult
+    {
+        CommandAllocatorStatistics stats;
+        uint32_t numRecordingTwice = 0;
+        uint32_t numReusedEarly = 0;
+        double seconds = 0.0;
+    };
+
+    // Threads request an allocator, record and discard it with the fence value of their submission, as
+    // CommandQueue does.  At the high-water mark they wait for the oldest pending fence.
+    WorkloadResult RunWorkload(const Workload& workload)
+    {
+        const uint32_t maxCreated = std::max(workload.maxAllocators, workload.numThreads) + workload.numThreads;
+        std::unique_ptr<FakeAllocator[]> allocators(new FakeAllocator[maxCreated]);
+        std::atomic<uint32_t> numCreated(0);
+
+        AllocatorShards<FakeAllocator> shards(workload.maxAllocators);
+        std::atomic<uint64_t> nextFenceValue(1);
+        std::atomic<uint64_t> completedValue(0);
+        std::atomic<uint32_t> numRecordingTwice(0);
+        std::atomic<uint32_t> numReusedEarly(0);
+
+        const double start = Tests::Now();
+        std::vector<std::thread> threads;
+        for (uint32_t thread = 0; thread < workload.numThreads; ++thread)
+        {
+            threads.emplace_back([&, thread]()
+            {
+                for (uint32_t request = 0; request < workload.requestsPerThread; ++request)
+                {
+                    FakeAllocator* allocator = nullptr;
+                    while (allocator == nullptr)
+                    {
+                        const uint64_t completed = completedValue.load();
+                        allocator = shards.Request(completed);
+                        if (allocator != nullptr)
+                        {
+                            numReusedEarly += allocator->fenceValue > completed;
+                        }
+                        else if (shards.Reserve())
+                        {
+                            const uint32_t index = numCreated.fetch_add(1);
+                            allocator = index < maxCreated ? &allocators[index] : nullptr;
+                            if (allocator == nullptr)
+                            {
+                                return;
+                            }
+                        }
+                        else
+                        {
+                            RaiseTo(completedValue, shards.GetOldestPendingFence());
+                        }
+                    }
+
+                    numRecordingTwice += allocator->recording.exchange(true);
+
+                    // Threads record lists of different lengths
+                    Tests::Spin((thread % 3) * 1e-7);
+
+                    allocator->recording.store(false);
+                    allocator->fenceValue = nextFenceValue.fetch_add(1);
+                    shards.Discard(allocator->fenceValue, allocator);
+
+                    const uint64_t submitted = allocator->fenceValue;
+                    if (submitted > workload.submissionsInFlight)
+                    {
+                        RaiseTo(completedValue, submitted - workload.submissionsInFlight);
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+
+        WorkloadResult result;
+        result.seconds = Tests::Now() - start;
+        result.stats = shards.GetStatistics();
+        result.numRecordingTwice = numRecordingTwice;
+        result.numReusedEarly = numReusedEarly;
+        return result;
+    }
+}
+
+void TestAllocatorShards()
+{
+    FakeAllocator allocators[8];
+
+    // Discarded out of order, handed out by fence value, only once the fence completed
+    AllocatorShards<FakeAllocator> shards(4);
+    shards.Discard(5, &allocators[0]);
+    shards.Discard(3, &allocators[1]);
+    shards.Discard(4, &allocators[2]);
+    CHECK(shards.GetOldestPendingFence() == 3);
+
+    CHECK(shards.Request(2) == nullptr);
+    CHECK(shards.Request(4) == &allocators[1]);
+    CHECK(shards.Request(4) == &allocators[2]);
+    CHECK(shards.Request(4) == nullptr);
+    CHECK(shards.GetOldestPendingFence() == 5);
+
+    // The front of this thread's shard is not done, the completed allocators of another thread's
+    // shard are taken, the lowest fence first
+    uint32_t otherShard = 0;
+    std::thread([&]()
+    {
+        otherShard = AllocatorShards<FakeAllocator>::GetThreadShardIndex();
+        shards.Discard(2, &allocators[3]);
+        shards.Discard(1, &allocators[4]);
+    }).join();
+    CHECK(otherShard != AllocatorShards<FakeAllocator>::GetThreadShardIndex());
+    CHECK(shards.GetOldestPendingFence() == 1);
+
+    CHECK(shards.Request(2) == &allocators[4]);
+    CHECK(shards.Request(2) == &allocators[3]);
+    CHECK(shards.Request(2) == nullptr);
+    CHECK(shards.Request(5) == &allocators[0]);
+    CHECK(shards.GetOldestPendingFence() == 0);
+
+    CommandAllocatorStatistics stats = shards.GetStatistics();
+    CHECK(stats.NumRequests == 8 && stats.NumReused == 3 && stats.NumStolen == 2);
+    CHECK(stats.NumPending == 0);
+
+    // Up to the high-water mark allocators are created.  Beyond it only while nothing is pending,
+    // otherwise the caller would wait forever.
+    for (uint32_t i = 0; i < 4; ++i)
+    {
+        CHECK(shards.Reserve());
+    }
+    CHECK(shards.Reserve());
+    shards.Discard(6, &allocators[5]);
+    CHECK(!shards.Reserve());
+
+    stats = shards.GetStatistics();
+    CHECK(stats.NumAllocators == 5 && stats.PeakAllocators == 5 && stats.NumCreated == 5);
+    CHECK(stats.NumCapStalls == 1 && stats.NumPending == 1);
+
+    shards.Clear();
+    CHECK(shards.GetNumAllocators() == 0 && shards.GetOldestPendingFence() == 0);
+    CHECK(shards.GetStatistics().PeakAllocators == 5);
+
+    // Threads with uneven lists and a lagging fence: an allocator is never recorded by two threads or
+    // reset before its fence, and the pool stays at its high-water mark
+    const Workload workloads[] =
+    {
+        { 4, 8, 16, 2000 },
+        { 4, 4, 2, 2000 },
+        { 3, 64, 4, 2000 },
+    };
+    for (const Workload& workload : workloads)
+    {
+        const WorkloadResult result = RunWorkload(workload);
+        CHECK(result.numRecordingTwice == 0);
+        CHECK(result.numReusedEarly == 0);
+        CHECK(result.stats.PeakAllocators <= workload.maxAllocators);
+        CHECK(result.stats.NumCreated == result.stats.NumAllocators);
+        CHECK(result.stats.NumPending == result.stats.NumAllocators);
+        CHECK(result.stats.NumReused + result.stats.NumStolen + result.stats.NumCreated == workload.numThreads * workload.requestsPerThread);
+    }
+}
+
+void BenchmarkAllocatorShards()
+{
+    // Mixed workloads: the pool size follows the submissions in flight up to the high-water mark
+    const uint32_t maxThreads = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+    const uint64_t inFlight[] = { 2, 16, 256 };
+
+    for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        for (uint64_t submissionsInFlight : inFlight)
+        {
+            const Workload workload = { numThreads, 64, submissionsInFlight, 50000 };
+            const WorkloadResult result = RunWorkload(workload);
+            const double numRequests = double(numThreads) * workload.requestsPerThread;
+            printf("    %u threads, %3llu in flight: %.1f ns per request, peak %u allocators, %llu stolen, %llu stalls\n",
+                numThreads, (unsigned long long)submissionsInFlight, result.seconds * 1e9 / numRequests, result.stats.PeakAllocators,
+                (unsigned long long)result.stats.NumStolen, (unsigned long long)result.stats.NumCapStalls);
+        }
+    }
+}
@@ -0,0 +1,173 @@
+#include "Tests.h"
+
+// The renderer gets UINT from the precompiled header of the app
+#include "pch.h"
+#include "Renderer/BezierTessellation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    uint64_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    }
+
+    bool SameBits(float a, float b)
+    {
+        return memcmp(&a, &b, sizeof(float)) == 0;
+    }
+
+    bool SameBits(const RibbonPoint& a, const RibbonPoint& b)
+    {
+        return memcmp(&a, &b, sizeof(RibbonPoint)) == 0;
+    }
+
+    // TessellateCS.hlsl line by line, every operation precise and in the order of the shader
+    RibbonPoint KernelPoint(const TessellationConstants& constants, const std::vector<float>& controlPoints, uint32_t pointIndex)
+    {
+        const uint32_t numPoints = constants.numSegments + 1;
+        const uint32_t patch = pointIndex / numPoints;
+        const uint32_t pointInPatch = pointIndex - patch * numPoints;
+
+        const float t = pointInPatch == constants.numSegments ? 1.0f : (float)pointInPatch * constants.segmentStep;
+
+        const float s = 1.0f - t;
+        const float a0 = s * s;
+        const float a1 = 2.0f * s * t;
+        const float a2 = t * t;
+
+        const float bx = s * a0;
+        const float by = t * a0 + s * a1;
+        const float bz = t * a1 + s * a2;
+        const float bw = t * a2;
+
+        const float dx = -a0;
+        const float dy = a0 - a1;
+        const float dz = a1 - a2;
+        const float dw = a2;
+
+        const float* p0 = &controlPoints[(patch * 4 + 0) * 4];
+        const float* p1 = &controlPoints[(patch * 4 + 1) * 4];
+        const float* p2 = &controlPoints[(patch * 4 + 2) * 4];
+        const float* p3 = &controlPoints[(patch * 4 + 3) * 4];
+
+        RibbonPoint ribbonPoint;
+        for (int i = 0; i < 3; ++i)
+        {
+            ribbonPoint.position[i] = bx * p0[i] + by * p1[i] + bz * p2[i] + bw * p3[i];
+        }
+        for (int i = 0; i < 2; ++i)
+        {
+            ribbonPoint.derivative[i] = dx * p0[i] + dy * p1[i] + dz * p2[i] + dw * p3[i];
+        }
+        ribbonPoint.mustBe5 = 5;
+        return ribbonPoint;
+    }
+}
+
+void TestBezierTessellation()
+{
+    // The stride of the structured buffers of TessellateCS and RibbonVS
+    CHECK(sizeof(RibbonPoint) == 24);
+
+    CHECK(BezierTessellation::GetNumSegments(1.0f) == 1);
+    CHECK(BezierTessellation::GetNumSegments(1.01f) == 2);
+    CHECK(BezierTessellation::GetNumSegments(7.0f) == 7);
+    CHECK(BezierTessellation::GetNumSegments(0.25f) == 1);
+    CHECK(BezierTessellation::GetNumSegments(1000.0f) == BezierTessellation::MaxSegments);
+
+    // Small integer control points and 4 segments: every product and sum is exact in float,
+    // so the points are known exactly.  The derivative is a third of the one of the curve.
+    const float exact[4][4] = { { 0, 0, 0, 1 }, { 4, 8, 0, 1 }, { 12, 8, 0, 1 }, { 16, 0, 0, 1 } };
+    std::vector<float> controlPoints(&exact[0][0], &exact[0][0] + 16);
+    TessellationConstants constants = BezierTessellation::MakeConstants(1, 4);
+    CHECK(constants.segmentStep == 0.25f);
+
+    std::vector<RibbonPoint> points(5);
+    BezierTessellation::Tessellate(constants, controlPoints.data(), points.data());
+
+    uint32_t numWrong = 0;
+    for (uint32_t i = 0; i < 5; ++i)
+    {
+        const double t = i / 4.0;
+        const double s = 1.0 - t;
+        const double b[4] = { s * s * s, 3 * s * s * t, 3 * s * t * t, t * t * t };
+        const double d[4] = { -s * s, s * s - 2 * s * t, 2 * s * t - t * t, t * t };
+        for (int axis = 0; axis < 2; ++axis)
+        {
+            double position = 0.0;
+            double derivative = 0.0;
+            for (int j = 0; j < 4; ++j)
+            {
+                position += b[j] * exact[j][axis];
+                derivative += d[j] * exact[j][axis];
+            }
+            numWrong += !SameBits(points[i].position[axis], static_cast<float>(position));
+            numWrong += !SameBits(points[i].derivative[axis], static_cast<float>(derivative));
+        }
+        numWrong += !SameBits(points[i].position[2], 0.0f) || points[i].mustBe5 != 5;
+    }
+    CHECK(numWrong == 0);
+    CHECK(points[2].position[0] == 8.0f && points[2].position[1] == 6.0f);
+
+    // Random patches with a step that is not exact: the same bits as the operations of the shader.
+    // The ends of every patch are its first and last control point, bit for bit.
+    const uint32_t numPatches = 50;
+    uint64_t random = 9;
+    controlPoints.resize(numPatches * 16);
+    for (float& value : controlPoints)
+    {
+        value = static_cast<float>(NextRandom(random) % 200001) / 1000.0f - 100.0f;
+    }
+
+    for (uint32_t numSegments : { 1u, 7u, 13u, BezierTessellation::MaxSegments })
+    {
+        constants = BezierTessellation::MakeConstants(numPatches, numSegments);
+        const uint32_t numPoints = numPatches * (numSegments + 1);
+
+        // One point more than needed, Tessellate must leave it alone
+        RibbonPoint guard = {};
+        guard.mustBe5 = 0xDEADBEEF;
+        points.assign(numPoints + 1, guard);
+        BezierTessellation::Tessellate(constants, controlPoints.data(), points.data());
+
+        uint32_t numDifferent = 0;
+        uint32_t numBadEnds = 0;
+        double maxError = 0.0;
+        for (uint32_t pointIndex = 0; pointIndex < numPoints; ++pointIndex)
+        {
+            numDifferent += !SameBits(points[pointIndex], KernelPoint(constants, controlPoints, pointIndex));
+            numDifferent += !SameBits(points[pointIndex], BezierTessellation::EvaluatePoint(constants, controlPoints.data(), pointIndex));
+
+            const uint32_t patch = pointIndex / (numSegments + 1);
+            const uint32_t pointInPatch = pointIndex % (numSegments + 1);
+            const float* p = &controlPoints[patch * 16];
+            if (pointInPatch == 0 || pointInPatch == numSegments)
+            {
+                const float* end = pointInPatch == 0 ? p : p + 12;
+                numBadEnds += !SameBits(points[pointIndex].position[0], end[0]) || !SameBits(points[pointIndex].position[1], end[1]) ||
+                    !SameBits(points[pointIndex].position[2], end[2]);
+            }
+
+            // Close to the curve in double precision
+            const double t = static_cast<double>(pointInPatch) / numSegments;
+            const double s = 1.0 - t;
+            const double b[4] = { s * s * s, 3 * s * s * t, 3 * s * t * t, t * t * t };
+            for (int axis = 0; axis < 3; ++axis)
+            {
+                const double position = b[0] * p[axis] + b[1] * p[4 + axis] + b[2] * p[8 + axis] + b[3] * p[12 + axis];
+                maxError = std::max(maxError, std::fabs(position - points[pointIndex].position[axis]));
+            }
+        }
+
+        CHECK(numDifferent == 0);
+        CHECK(numBadEnds == 0);
+        CHECK(maxError < 1e-4);
+        CHECK(points[numPoints].mustBe5 == 0xDEADBEEF);
+    }
+}
@@ -0,0 +1,180 @@
+#include "Tests.h"
+#include "DirectX12/Engine/BuddyAllocator.h"
+
+#include <iterator>
+#include <map>
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    const uint64_t kb = 1024;
+    const uint64_t mb = 1024 * kb;
+
+    uint32_t NextRandom(uint32_t& state)
+    {
+        state = state * 1664525u + 1013904223u;
+        return state >> 8;
+    }
+
+    // Random allocations and frees, the live blocks never overlap and stay aligned to their size
+    void CheckRandom(BuddyAllocator& allocator, uint32_t numSteps)
+    {
+        std::map<uint64_t, uint64_t> live;
+        uint32_t random = 7;
+        uint32_t numOverlaps = 0;
+        uint32_t numMisaligned = 0;
+
+        for (uint32_t step = 0; step < numSteps; ++step)
+        {
+            if (live.empty() || NextRandom(random) % 3 != 0)
+            {
+                const uint64_t size = 1 + NextRandom(random) % (4 * mb);
+                const uint64_t offset = allocator.Allocate(size);
+                if (offset == BuddyAllocator::kInvalidOffset)
+                {
+                    continue;
+                }
+
+                const uint64_t blockSize = allocator.GetAllocationSize(offset);
+                numMisaligned += blockSize < size || offset % blockSize != 0;
+
+                auto next = live.lower_bound(offset);
+                numOverlaps += next != live.end() && next->first < offset + blockSize;
+                numOverlaps += next != live.begin() && std::prev(next)->first + std::prev(next)->second > offset;
+                live[offset] = blockSize;
+            }
+            else
+            {
+                auto block = live.begin();
+                std::advance(block, NextRandom(random) % live.size());
+                allocator.Free(block->first);
+                live.erase(block);
+            }
+        }
+
+        CHECK(numOverlaps == 0);
+        CHECK(numMisaligned == 0);
+
+        uint64_t liveBytes = 0;
+        for (const auto& block : live)
+        {
+            liveBytes += block.second;
+            allocator.Free(block.first);
+        }
+        CHECK(liveBytes > 0);
+    }
+}
+
+void TestBuddyAllocator()
+{
+    BuddyAllocator allocator(64 * mb, 64 * kb);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetStatistics().LargestFreeBlock == 64 * mb);
+
+    // Sizes round up to a power of two of at least the minimum block size
+    const uint64_t a = allocator.Allocate(1);
+    const uint64_t b = allocator.Allocate(100 * kb);
+    CHECK(allocator.GetAllocationSize(a) == 64 * kb);
+    CHECK(allocator.GetAllocationSize(b) == 128 * kb);
+    CHECK(b % (128 * kb) == 0);
+
+    // A large alignment means a larger block
+    const uint64_t c = allocator.Allocate(64 * kb, 4 * mb);
+    CHECK(c % (4 * mb) == 0);
+
+    BuddyAllocator::Statistics stats = allocator.GetStatistics();
+    CHECK(stats.NumAllocations == 3);
+    CHECK(stats.RequestedBytes == 1 + 100 * kb + 64 * kb);
+    CHECK(stats.AllocatedBytes == 64 * kb + 128 * kb + 4 * mb);
+    CHECK(stats.FreeBytes == 64 * mb - stats.AllocatedBytes);
+    CHECK(stats.GetInternalFragmentation() > 0.0f);
+
+    // Invalid requests
+    CHECK(allocator.Allocate(0) == BuddyAllocator::kInvalidOffset);
+    CHECK(allocator.Allocate(64 * mb + 1) == BuddyAllocator::kInvalidOffset);
+    CHECK(allocator.Allocate(64 * mb) == BuddyAllocator::kInvalidOffset);
+
+    // Freeing everything merges the buddies back into one block
+    allocator.Free(b);
+    allocator.Free(a);
+    allocator.Free(c);
+    CHECK(allocator.IsEmpty());
+    stats = allocator.GetStatistics();
+    CHECK(stats.NumFreeBlocks == 1);
+    CHECK(stats.LargestFreeBlock == 64 * mb);
+    CHECK(stats.GetExternalFragmentation() == 0.0f);
+
+    // Deferred frees come back only once their fence completed
+    const uint64_t d = allocator.Allocate(32 * mb);
+    const uint64_t e = allocator.Allocate(32 * mb);
+    CHECK(allocator.Allocate(64 * kb) == BuddyAllocator::kInvalidOffset);
+    allocator.FreeAfterFence(d, 5);
+    allocator.FreeAfterFence(e, 7);
+    CHECK(allocator.GetStatistics().PendingFreeBytes == 64 * mb);
+    CHECK(!allocator.IsEmpty());
+
+    uint64_t completedFence = 4;
+    auto isComplete = [&completedFence](uint64_t fence) { return fence <= completedFence; };
+    CHECK(allocator.ReleaseCompleted(isComplete) == 0);
+    completedFence = 6;
+    CHECK(allocator.ReleaseCompleted(isComplete) == 1);
+    CHECK(allocator.GetStatistics().PendingFreeBytes == 32 * mb);
+    CHECK(allocator.Allocate(32 * mb) == d);
+    allocator.Free(d);
+    completedFence = 7;
+    CHECK(allocator.ReleaseCompleted(isComplete) == 1);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetStatistics().LargestFreeBlock == 64 * mb);
+
+    CheckRandom(allocator, 20000);
+    CHECK(allocator.IsEmpty());
+    CHECK(allocator.GetStatistics().NumFreeBlocks == 1);
+}
+
+void BenchmarkBuddyAllocator()
+{
+    // Vertex buffer sized blocks of 64 KB to 4 MB in a 64 MB heap, freed in random order
+    const uint32_t numOperations = 1000000;
+
+    BuddyAllocator allocator(64 * mb, 64 * kb);
+    std::vector<uint64_t> live;
+    uint32_t random = 11;
+    uint32_t numFailed = 0;
+    float externalFragmentation = 0.0f;
+    float internalFragmentation = 0.0f;
+
+    const double start = Tests::Now();
+    for (uint32_t i = 0; i < numOperations; ++i)
+    {
+        if (live.empty() || NextRandom(random) % 2 == 0)
+        {
+            const uint64_t offset = allocator.Allocate(64 * kb + NextRandom(random) % (4 * mb - 64 * kb));
+            if (offset == BuddyAllocator::kInvalidOffset)
+            {
+                ++numFailed;
+                continue;
+            }
+            live.push_back(offset);
+        }
+        else
+        {
+            const size_t index = NextRandom(random) % live.size();
+            allocator.Free(live[index]);
+            live[index] = live.back();
+            live.pop_back();
+        }
+
+        if (i % 1000 == 0)
+        {
+            const BuddyAllocator::Statistics stats = allocator.GetStatistics();
+            externalFragmentation += stats.GetExternalFragmentation();
+            internalFragmentation += stats.GetInternalFragmentation();
+        }
+    }
+    const double seconds = Tests::Now() - start;
+
+    const uint32_t numSamples = numOperations / 1000;
+    printf("    %.0f ns per operation, %u failed allocations, fragmentation %.2f external %.2f internal\n",
+        seconds * 1e9 / numOperations, numFailed, externalFragmentation / numSamples, internalFragmentation / numSamples);
+}
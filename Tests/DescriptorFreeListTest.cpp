@@ -0,0 +1,159 @@
+#include "Tests.h"
+
+// The engine gets the D3D12 types from its precompiled header
+#include <d3d12.h>
+#include "DirectX12/Engine/DescriptorFreeList.h"
+#include "DirectX12/Engine/TimelineFence.h"
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+    class MockFence : public TimelineFence
+    {
+    public:
+        uint64_t completedValue = 0;
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            return completedValue;
+        }
+
+        void WaitForValue(uint64_t value, uint32_t) override
+        {
+            completedValue = value;
+        }
+    };
+
+    D3D12_CPU_DESCRIPTOR_HANDLE MakeHandle(size_t ptr)
+    {
+        D3D12_CPU_DESCRIPTOR_HANDLE handle;
+        handle.ptr = ptr;
+        return handle;
+    }
+
+    // DescriptorAllocator::Allocate: a released range of the count, or new descriptors from the heap
+    class Allocator
+    {
+    public:
+        static const size_t kDescriptorSize = 32;
+
+        explicit Allocator(TimelineFence& fence) : m_Fence(fence) {}
+
+        D3D12_CPU_DESCRIPTOR_HANDLE Allocate(uint32_t count)
+        {
+            m_FreeList.ReleaseCompleted([this](uint64_t value) { return m_Fence.IsComplete(value); });
+
+            D3D12_CPU_DESCRIPTOR_HANDLE handle;
+            if (!m_FreeList.Acquire(count, handle))
+            {
+                handle = MakeHandle(m_NumCreated * kDescriptorSize);
+                m_NumCreated += count;
+            }
+            return handle;
+        }
+
+        void Free(D3D12_CPU_DESCRIPTOR_HANDLE handle, uint32_t count, uint64_t fenceValue)
+        {
+            m_FreeList.Retire(handle, count, fenceValue);
+        }
+
+        size_t GetNumCreated() const { return m_NumCreated; }
+        const DescriptorFreeList& GetFreeList() const { return m_FreeList; }
+
+    private:
+        TimelineFence& m_Fence;
+        DescriptorFreeList m_FreeList;
+        size_t m_NumCreated = 0;
+    };
+}
+
+void TestDescriptorFreeList()
+{
+    MockFence fence;
+    auto isComplete = [&fence](uint64_t value) { return fence.IsComplete(value); };
+
+    // A freed range comes back only after its fence, and only for the same count
+    DescriptorFreeList freeList;
+    D3D12_CPU_DESCRIPTOR_HANDLE handle = MakeHandle(0);
+    freeList.Retire(MakeHandle(0x100), 4, 5);
+    freeList.Retire(MakeHandle(0x200), 1, 6);
+    CHECK(freeList.GetNumRetired() == 2 && freeList.GetNumFree() == 0);
+
+    fence.completedValue = 4;
+    freeList.ReleaseCompleted(isComplete);
+    CHECK(!freeList.Acquire(4, handle));
+
+    fence.completedValue = 5;
+    freeList.ReleaseCompleted(isComplete);
+    CHECK(freeList.GetNumRetired() == 1 && freeList.GetNumFree() == 1);
+    CHECK(!freeList.Acquire(2, handle));
+    CHECK(!freeList.Acquire(1, handle));
+    CHECK(freeList.Acquire(4, handle) && handle.ptr == 0x100);
+    CHECK(!freeList.Acquire(4, handle));
+
+    // Ranges are released in the order they were retired, up to the first one not done
+    freeList.Retire(MakeHandle(0x300), 1, 9);
+    freeList.Retire(MakeHandle(0x400), 1, 7);
+    fence.completedValue = 7;
+    freeList.ReleaseCompleted(isComplete);
+    CHECK(freeList.GetNumFree() == 1 && freeList.GetNumRetired() == 2);
+    CHECK(freeList.Acquire(1, handle) && handle.ptr == 0x200);
+
+    fence.completedValue = 9;
+    freeList.ReleaseCompleted(isComplete);
+    CHECK(freeList.GetNumFree() == 2 && freeList.GetNumRetired() == 0);
+
+    freeList.Clear();
+    CHECK(freeList.GetNumFree() == 0 && !freeList.Acquire(1, handle));
+
+    // Resources of a few kinds recreated every frame, freed with the fence of the frame that
+    // used them last.  Once the frames in flight hold their ranges, the same descriptors
+    // circulate: no new descriptors and no heap allocations, however long it runs.
+    MockFence frameFence;
+    Allocator allocator(frameFence);
+    const uint32_t counts[] = { 1, 4, 1, 2, 8 };
+    const uint64_t framesInFlight = 3;
+    const uint32_t warmUpFrames = 100;
+    const uint32_t numFrames = 10000;
+
+    size_t numCreatedAfterWarmUp = 0;
+    uint64_t allocationsAfterWarmUp = 0;
+    size_t maxRetired = 0;
+    std::vector<D3D12_CPU_DESCRIPTOR_HANDLE> handles(sizeof(counts) / sizeof(counts[0]));
+
+    for (uint32_t frame = 1; frame <= warmUpFrames + numFrames; ++frame)
+    {
+        if (frame == warmUpFrames + 1)
+        {
+            numCreatedAfterWarmUp = allocator.GetNumCreated();
+            allocationsAfterWarmUp = Tests::GetNumAllocations();
+        }
+
+        frameFence.completedValue = frame > framesInFlight ? frame - framesInFlight : 0;
+
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            handles[i] = allocator.Allocate(counts[i]);
+        }
+        for (size_t i = 0; i < handles.size(); ++i)
+        {
+            allocator.Free(handles[i], counts[i], frame);
+        }
+        maxRetired = std::max(maxRetired, allocator.GetFreeList().GetNumRetired());
+    }
+
+    CHECK(allocator.GetNumCreated() == numCreatedAfterWarmUp);
+    CHECK(Tests::GetNumAllocations() == allocationsAfterWarmUp);
+    CHECK(maxRetired <= (framesInFlight + 1) * handles.size());
+
+    // Only the frames in flight hold descriptors of their own
+    size_t descriptorsPerFrame = 0;
+    for (uint32_t count : counts)
+    {
+        descriptorsPerFrame += count;
+    }
+    CHECK(numCreatedAfterWarmUp <= (framesInFlight + 1) * descriptorsPerFrame);
+}
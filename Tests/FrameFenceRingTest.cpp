@@ -0,0 +1,126 @@
+#include "Tests.h"
+#include "DirectX12/Engine/FrameFenceRing.h"
+
+#include <algorithm>
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    // A GPU that only finishes frames when it is told to, in submission order
+    struct SimulatedFence
+    {
+        uint64_t nextValue = 1;
+        uint64_t completedValue = 0;
+
+        uint64_t Submit() { return nextValue++; }
+        uint64_t GetNumInFlight() const { return nextValue - 1 - completedValue; }
+
+        // What CommandQueue::WaitForFence does, 0 means no wait
+        void WaitFor(uint64_t value) { completedValue = std::max(completedValue, value); }
+    };
+
+    void CheckOverlap(uint32_t numFramesInFlight)
+    {
+        FrameFenceRing ring(numFramesInFlight);
+        SimulatedFence fence;
+
+        for (uint32_t frame = 0; frame < 20; ++frame)
+        {
+            const uint64_t waitValue = ring.BeginFrame();
+            CHECK(ring.GetFrameIndex() == frame % numFramesInFlight);
+
+            // The slot is reused only after the frame that used it last, never an earlier one
+            CHECK(waitValue == (frame >= numFramesInFlight ? frame + 1 - numFramesInFlight : 0));
+            fence.WaitFor(waitValue);
+
+            // The CPU records while the previous frames are still on the GPU
+            CHECK(fence.GetNumInFlight() == std::min<uint64_t>(frame, numFramesInFlight - 1));
+
+            ring.EndFrame(fence.Submit());
+            CHECK(ring.GetLastSubmittedFence() == frame + 1);
+        }
+    }
+}
+
+void TestFrameFenceRing()
+{
+    for (uint32_t numFramesInFlight = 1; numFramesInFlight <= FrameFenceRing::MAX_FRAMES_IN_FLIGHT; ++numFramesInFlight)
+    {
+        CheckOverlap(numFramesInFlight);
+    }
+
+    // After Reset (the GPU was idled) nothing is waited for
+    FrameFenceRing ring(2);
+    ring.BeginFrame();
+    ring.EndFrame(5);
+    ring.BeginFrame();
+    ring.EndFrame(6);
+    ring.Reset();
+    CHECK(ring.BeginFrame() == 0);
+    CHECK(ring.GetFrameIndex() == 0);
+    CHECK(ring.GetFrameNumber() == 1);
+
+    ring.SetNumFramesInFlight(3);
+    CHECK(ring.GetNumFramesInFlight() == 3);
+    CHECK(ring.BeginFrame() == 0);
+}
+
+namespace
+{
+    // A GPU working through the submitted frames one after the other.  It only keeps
+    // the time each frame will be done, so it needs no thread of its own.
+    class SimulatedGpu
+    {
+    public:
+        explicit SimulatedGpu(double secondsPerFrame) :
+            m_SecondsPerFrame(secondsPerFrame)
+        {
+        }
+
+        uint64_t Submit()
+        {
+            const double startTime = std::max(Tests::Now(), m_CompletionTimes.empty() ? 0.0 : m_CompletionTimes.back());
+            m_CompletionTimes.push_back(startTime + m_SecondsPerFrame);
+            return m_CompletionTimes.size();
+        }
+
+        void WaitFor(uint64_t value)
+        {
+            if (value > 0)
+            {
+                Tests::Spin(m_CompletionTimes[value - 1] - Tests::Now());
+            }
+        }
+
+    private:
+        double m_SecondsPerFrame;
+        std::vector<double> m_CompletionTimes;
+    };
+}
+
+void BenchmarkFrameFenceRing()
+{
+    // 2 ms of recording and 2 ms of GPU work per frame: 250 frames per second one after the other, up to 500 overlapped
+    const double cpuSecondsPerFrame = 0.002;
+    const double gpuSecondsPerFrame = 0.002;
+    const uint32_t numFrames = 200;
+
+    for (uint32_t numFramesInFlight = 1; numFramesInFlight <= FrameFenceRing::MAX_FRAMES_IN_FLIGHT; ++numFramesInFlight)
+    {
+        FrameFenceRing ring(numFramesInFlight);
+        SimulatedGpu gpu(gpuSecondsPerFrame);
+
+        const double start = Tests::Now();
+        for (uint32_t frame = 0; frame < numFrames; ++frame)
+        {
+            gpu.WaitFor(ring.BeginFrame());
+            Tests::Spin(cpuSecondsPerFrame);
+            ring.EndFrame(gpu.Submit());
+        }
+        gpu.WaitFor(ring.GetLastSubmittedFence());
+        const double seconds = Tests::Now() - start;
+
+        printf("    %u frames in flight: %.0f frames per second\n", numFramesInFlight, numFrames / seconds);
+    }
+}
@@ -0,0 +1,154 @@
+#include "Tests.h"
+#include "DirectX12/Engine/FrameFenceRing.h"
+#include "DirectX12/Engine/FrameSliceRing.h"
+#include "DirectX12/Engine/TimelineFence.h"
+
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Completes frames only when the CPU waits for them, the worst case for reusing a slice
+    class MockFence : public TimelineFence
+    {
+    public:
+        uint64_t completedValue = 0;
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            return completedValue;
+        }
+
+        void WaitForValue(uint64_t value, uint32_t) override
+        {
+            completedValue = value;
+        }
+    };
+
+    struct SubmittedFrame
+    {
+        uint64_t fenceValue;
+        uint32_t frameNumber;
+        std::vector<size_t> offsets;
+    };
+}
+
+void TestFrameSliceRing()
+{
+    const size_t sliceSize = 4096;
+    const size_t alignment = 256;
+
+    // Allocations are aligned and stay in the slice of the frame
+    FrameSliceRing slices;
+    slices.Reset(sliceSize, FrameFenceRing::MAX_FRAMES_IN_FLIGHT, alignment);
+    CHECK(slices.GetSize() == sliceSize * FrameFenceRing::MAX_FRAMES_IN_FLIGHT);
+
+    size_t offset = 1;
+    slices.BeginFrame(1);
+    CHECK(slices.Allocate(100, offset) && offset == sliceSize);
+    CHECK(slices.Allocate(256, offset) && offset == sliceSize + 256);
+    CHECK(slices.Allocate(1, offset) && offset == sliceSize + 512);
+    CHECK(slices.GetBytesUsed() == 768);
+
+    // An exhausted slice fails until the next frame, it never reaches into the next slice
+    uint32_t numAllocated = 3;
+    while (slices.Allocate(alignment, offset))
+    {
+        CHECK(offset + alignment <= 2 * sliceSize);
+        ++numAllocated;
+    }
+    CHECK(numAllocated == sliceSize / alignment);
+    CHECK(!slices.Allocate(1, offset));
+
+    slices.BeginFrame(2);
+    CHECK(slices.GetBytesUsed() == 0);
+    CHECK(slices.Allocate(1, offset) && offset == 2 * sliceSize);
+
+    // Larger than a slice never fits
+    slices.BeginFrame(0);
+    CHECK(!slices.Allocate(sliceSize + 1, offset));
+
+    // Threads allocating at once each get their own constants
+    const uint32_t numThreads = 4;
+    const uint32_t perThread = static_cast<uint32_t>(sliceSize / alignment / numThreads);
+    std::vector<size_t> threadOffsets(numThreads * perThread, ~size_t(0));
+    std::atomic<uint32_t> numFailed(0);
+    slices.BeginFrame(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < numThreads; ++thread)
+    {
+        threads.emplace_back([&, thread]()
+        {
+            for (uint32_t i = 0; i < perThread; ++i)
+            {
+                numFailed += !slices.Allocate(alignment, threadOffsets[thread * perThread + i]);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    std::sort(threadOffsets.begin(), threadOffsets.end());
+    CHECK(numFailed == 0);
+    CHECK(std::adjacent_find(threadOffsets.begin(), threadOffsets.end()) == threadOffsets.end());
+    CHECK(threadOffsets.back() == sliceSize - alignment);
+
+    // The ring wraps through the slices with the frames in flight.  Every frame writes its number
+    // into its constants, the GPU reads them when the frame completes: nothing may have
+    // overwritten them, although the CPU records further frames meanwhile.
+    for (uint32_t numFramesInFlight = 1; numFramesInFlight <= FrameFenceRing::MAX_FRAMES_IN_FLIGHT; ++numFramesInFlight)
+    {
+        FrameFenceRing frameFences(numFramesInFlight);
+        MockFence fence;
+        slices.Reset(sliceSize, numFramesInFlight, alignment);
+        std::vector<uint32_t> buffer(slices.GetSize() / sizeof(uint32_t), 0);
+
+        std::deque<SubmittedFrame> inFlight;
+        uint64_t nextFenceValue = 1;
+        uint32_t numOverwritten = 0;
+        uint32_t numRead = 0;
+
+        for (uint32_t frame = 1; frame <= 50; ++frame)
+        {
+            fence.Wait(frameFences.BeginFrame());
+
+            // The GPU reads the constants of the frames that completed
+            while (!inFlight.empty() && fence.IsComplete(inFlight.front().fenceValue))
+            {
+                for (size_t constantOffset : inFlight.front().offsets)
+                {
+                    numOverwritten += buffer[constantOffset / sizeof(uint32_t)] != inFlight.front().frameNumber;
+                }
+                ++numRead;
+                inFlight.pop_front();
+            }
+
+            slices.BeginFrame(frameFences.GetFrameIndex());
+
+            SubmittedFrame submitted;
+            submitted.frameNumber = frame;
+            for (uint32_t draw = 0; draw < 1 + frame % 5; ++draw)
+            {
+                CHECK(slices.Allocate(64 + draw * 100, offset));
+                buffer[offset / sizeof(uint32_t)] = frame;
+                submitted.offsets.push_back(offset);
+            }
+
+            submitted.fenceValue = nextFenceValue++;
+            frameFences.EndFrame(submitted.fenceValue);
+            inFlight.push_back(submitted);
+
+            CHECK(inFlight.size() <= numFramesInFlight);
+        }
+
+        CHECK(numOverwritten == 0);
+        CHECK(numRead == 50 - numFramesInFlight);
+    }
+}
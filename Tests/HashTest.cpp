@@ -0,0 +1,154 @@
+#include "Tests.h"
+#include "DirectX12/Engine/Hash.h"
+
+#include <stdio.h>
+#include <unordered_set>
+#include <vector>
+
+namespace
+{
+    // The size of a graphics pipeline state description, the largest state hashed per draw
+    const size_t kNumWords = 656 / sizeof(uint32_t);
+
+    uint64_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state ^ (state >> 29);
+    }
+
+    size_t Hash(const std::vector<uint32_t>& words, size_t seed = 2166136261U)
+    {
+        return Utility::HashRange(words.data(), words.data() + words.size(), seed);
+    }
+
+    uint32_t CountBits(uint64_t value)
+    {
+        uint32_t count = 0;
+        for (; value != 0; value &= value - 1)
+        {
+            ++count;
+        }
+        return count;
+    }
+
+    // The fallback of 32-bit targets: the 128-bit product from four 32 x 32 bit multiplies
+    uint64_t MixFrom32BitProducts(uint64_t a, uint64_t b)
+    {
+        const uint64_t loLo = (a & 0xFFFFFFFF) * (b & 0xFFFFFFFF);
+        const uint64_t hiLo = (a >> 32) * (b & 0xFFFFFFFF);
+        const uint64_t loHi = (a & 0xFFFFFFFF) * (b >> 32);
+        const uint64_t hiHi = (a >> 32) * (b >> 32);
+        const uint64_t cross = (loLo >> 32) + (hiLo & 0xFFFFFFFF) + loHi;
+        const uint64_t low = (cross << 32) | (loLo & 0xFFFFFFFF);
+        const uint64_t high = hiHi + (hiLo >> 32) + (cross >> 32);
+        return low ^ high;
+    }
+}
+
+void TestHash()
+{
+    uint64_t random = 1;
+    std::vector<uint32_t> words(kNumWords);
+    for (uint32_t& word : words)
+    {
+        word = static_cast<uint32_t>(NextRandom(random));
+    }
+
+    const size_t hash = Hash(words);
+    CHECK(hash == Hash(words));
+    CHECK(Hash(words, 1) != Hash(words, 2));
+
+    // No collisions among nearby states: every word set to a few other values
+    std::unordered_set<size_t> hashes;
+    uint32_t numVariants = 0;
+    for (size_t word = 0; word < kNumWords; ++word)
+    {
+        const uint32_t original = words[word];
+        for (uint32_t value = 1; value <= 120; ++value)
+        {
+            words[word] = original + value;
+            hashes.insert(Hash(words));
+            ++numVariants;
+        }
+        words[word] = original;
+    }
+    hashes.insert(hash);
+    CHECK(hashes.size() == numVariants + 1);
+
+    // Flipping one input bit flips about half of the output bits
+    uint64_t flippedBits = 0;
+    for (size_t bit = 0; bit < kNumWords * 32; ++bit)
+    {
+        words[bit / 32] ^= 1u << (bit % 32);
+        flippedBits += CountBits(static_cast<uint64_t>(Hash(words) ^ hash));
+        words[bit / 32] ^= 1u << (bit % 32);
+    }
+    const double averageFlipped = static_cast<double>(flippedBits) / (kNumWords * 32);
+    CHECK(averageFlipped > 31.0 && averageFlipped < 33.0);
+
+    // Ranges that only differ in trailing zeros, and every tail length
+    std::vector<uint32_t> zeros;
+    std::unordered_set<size_t> zeroHashes;
+    for (uint32_t length = 0; length < 20; ++length)
+    {
+        zeroHashes.insert(Hash(zeros));
+        zeros.push_back(0);
+    }
+    CHECK(zeroHashes.size() == 20);
+
+    // Hashing in pieces chains through the seed, the order matters
+    const std::vector<uint32_t> first(words.begin(), words.begin() + 10);
+    const std::vector<uint32_t> second(words.begin() + 10, words.begin() + 20);
+    CHECK(Hash(second, Hash(first)) != Hash(first, Hash(second)));
+
+    // HashState hashes the words of a struct
+    struct State
+    {
+        uint32_t a;
+        float b;
+    };
+    const State state = { 7, 0.5f };
+    const State sameState = { 7, 0.5f };
+    const State otherState = { 7, 0.25f };
+    CHECK(Utility::HashState(&state) == Utility::HashState(&sameState));
+    CHECK(Utility::HashState(&state) != Utility::HashState(&otherState));
+
+    // The fallback multiply of 32-bit targets gives the same result
+    uint32_t numMismatches = 0;
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        const uint64_t a = NextRandom(random);
+        const uint64_t b = NextRandom(random);
+        numMismatches += Utility::HashDetail::Mix(a, b) != MixFrom32BitProducts(a, b);
+    }
+    numMismatches += Utility::HashDetail::Mix(UINT64_MAX, UINT64_MAX) != MixFrom32BitProducts(UINT64_MAX, UINT64_MAX);
+    CHECK(numMismatches == 0);
+}
+
+void BenchmarkHash()
+{
+    const uint32_t numHashes = 1000000;
+
+    std::vector<uint32_t> words(kNumWords);
+    uint64_t random = 3;
+    for (uint32_t& word : words)
+    {
+        word = static_cast<uint32_t>(NextRandom(random));
+    }
+
+    size_t hash = 0;
+    const double start = Tests::Now();
+    for (uint32_t i = 0; i < numHashes; ++i)
+    {
+        words[0] = i;
+        hash ^= Hash(words, hash);
+    }
+    const double seconds = Tests::Now() - start;
+
+    // Keeps the loop from being optimized away
+    volatile size_t sink = hash;
+    (void)sink;
+
+    printf("    %zu bytes: %.1f ns per hash, %.1f GB/s\n", kNumWords * sizeof(uint32_t),
+        seconds * 1e9 / numHashes, numHashes * kNumWords * sizeof(uint32_t) / seconds / 1e9);
+}
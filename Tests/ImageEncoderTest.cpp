@@ -0,0 +1,497 @@
+#include "Tests.h"
+
+// The engine gets DXGI_FORMAT from its precompiled header
+#include <dxgiformat.h>
+#include "DirectX12/Engine/ImageEncoder.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+namespace
+{
+    uint64_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    }
+
+    // Looks like a rendered frame: flat background, gradients and a noisy band
+    std::vector<uint8_t> MakeImage(uint32_t width, uint32_t height, uint64_t seed)
+    {
+        std::vector<uint8_t> rgba(size_t(width) * height * 4);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                uint8_t* pixel = &rgba[(size_t(y) * width + x) * 4];
+                if (y < height / 3)
+                {
+                    pixel[0] = 32; pixel[1] = 48; pixel[2] = 64; pixel[3] = 255;
+                }
+                else if (y < 2 * height / 3)
+                {
+                    pixel[0] = static_cast<uint8_t>(x * 255 / width);
+                    pixel[1] = static_cast<uint8_t>(y * 3);
+                    pixel[2] = static_cast<uint8_t>((x + y) / 2);
+                    pixel[3] = x % 17 == 0 ? 128 : 255;
+                }
+                else
+                {
+                    const uint64_t random = NextRandom(seed);
+                    pixel[0] = static_cast<uint8_t>(random);
+                    pixel[1] = static_cast<uint8_t>(random >> 8);
+                    pixel[2] = static_cast<uint8_t>(random >> 16);
+                    pixel[3] = static_cast<uint8_t>(random >> 24);
+                }
+            }
+        }
+        return rgba;
+    }
+
+    uint32_t ReadBigEndian(const uint8_t* data)
+    {
+        return (uint32_t(data[0]) << 24) | (uint32_t(data[1]) << 16) | (uint32_t(data[2]) << 8) | data[3];
+    }
+
+    uint32_t ReadLittleEndian(const uint8_t* data)
+    {
+        return data[0] | (uint32_t(data[1]) << 8) | (uint32_t(data[2]) << 16) | (uint32_t(data[3]) << 24);
+    }
+
+    bool DecodeQoi(const std::vector<uint8_t>& file, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba)
+    {
+        if (file.size() < 22 || memcmp(file.data(), "qoif", 4) != 0)
+            return false;
+
+        width = ReadBigEndian(&file[4]);
+        height = ReadBigEndian(&file[8]);
+        rgba.assign(size_t(width) * height * 4, 0);
+
+        uint8_t index[64][4] = {};
+        uint8_t pixel[4] = { 0, 0, 0, 255 };
+        size_t position = 14;
+        uint32_t run = 0;
+
+        for (size_t i = 0; i < size_t(width) * height; ++i)
+        {
+            if (run > 0)
+            {
+                --run;
+            }
+            else
+            {
+                if (position >= file.size() - 8)
+                    return false;
+
+                const uint8_t op = file[position++];
+                if (op == 0xFE)
+                {
+                    memcpy(pixel, &file[position], 3);
+                    position += 3;
+                }
+                else if (op == 0xFF)
+                {
+                    memcpy(pixel, &file[position], 4);
+                    position += 4;
+                }
+                else if ((op & 0xC0) == 0x00)
+                {
+                    memcpy(pixel, index[op], 4);
+                }
+                else if ((op & 0xC0) == 0x40)
+                {
+                    pixel[0] = static_cast<uint8_t>(pixel[0] + ((op >> 4) & 3) - 2);
+                    pixel[1] = static_cast<uint8_t>(pixel[1] + ((op >> 2) & 3) - 2);
+                    pixel[2] = static_cast<uint8_t>(pixel[2] + (op & 3) - 2);
+                }
+                else if ((op & 0xC0) == 0x80)
+                {
+                    const int green = (op & 0x3F) - 32;
+                    const uint8_t next = file[position++];
+                    pixel[0] = static_cast<uint8_t>(pixel[0] + green + (next >> 4) - 8);
+                    pixel[1] = static_cast<uint8_t>(pixel[1] + green);
+                    pixel[2] = static_cast<uint8_t>(pixel[2] + green + (next & 0xF) - 8);
+                }
+                else
+                {
+                    run = op & 0x3F;
+                }
+
+                memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+            }
+
+            memcpy(&rgba[i * 4], pixel, 4);
+        }
+
+        static const uint8_t padding[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+        return position + 8 == file.size() && memcmp(&file[position], padding, 8) == 0;
+    }
+
+    uint32_t Crc32(const uint8_t* data, size_t size)
+    {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < size; ++i)
+        {
+            crc ^= data[i];
+            for (int bit = 0; bit < 8; ++bit)
+            {
+                crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+            }
+        }
+        return ~crc;
+    }
+
+    class BitReader
+    {
+    public:
+        BitReader(const uint8_t* data, size_t size) : m_Data(data), m_Size(size), m_Position(0) {}
+
+        uint32_t Get(uint32_t numBits)
+        {
+            uint32_t value = 0;
+            for (uint32_t i = 0; i < numBits; ++i, ++m_Position)
+            {
+                if (m_Position / 8 < m_Size)
+                {
+                    value |= ((m_Data[m_Position / 8] >> (m_Position % 8)) & 1u) << i;
+                }
+            }
+            return value;
+        }
+
+        // Huffman codes start with their most significant bit
+        uint32_t GetCode(uint32_t numBits)
+        {
+            uint32_t code = 0;
+            for (uint32_t i = 0; i < numBits; ++i)
+            {
+                code = (code << 1) | Get(1);
+            }
+            return code;
+        }
+
+        bool IsPastEnd() const { return m_Position > m_Size * 8; }
+
+    private:
+        const uint8_t* m_Data;
+        size_t m_Size;
+        size_t m_Position;
+    };
+
+    // Inflates a stream of blocks with fixed Huffman codes, all the encoder writes
+    bool InflateFixed(const uint8_t* data, size_t size, std::vector<uint8_t>& out)
+    {
+        static const uint16_t lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        static const uint8_t lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        static const uint16_t distanceBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        static const uint8_t distanceExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+
+        BitReader reader(data, size);
+        uint32_t isFinal = 0;
+        while (isFinal == 0)
+        {
+            isFinal = reader.Get(1);
+            if (reader.Get(2) != 1)
+                return false;
+
+            for (;;)
+            {
+                // 7 bit codes 256-279, 8 bit codes 0-143 and 280-287, 9 bit codes 144-255
+                uint32_t symbol;
+                uint32_t code = reader.GetCode(7);
+                if (code <= 0x17)
+                {
+                    symbol = 256 + code;
+                }
+                else
+                {
+                    code = (code << 1) | reader.GetCode(1);
+                    if (code >= 0x30 && code <= 0xBF)
+                    {
+                        symbol = code - 0x30;
+                    }
+                    else if (code >= 0xC0 && code <= 0xC7)
+                    {
+                        symbol = 280 + code - 0xC0;
+                    }
+                    else
+                    {
+                        code = (code << 1) | reader.GetCode(1);
+                        symbol = 144 + code - 0x190;
+                    }
+                }
+
+                if (reader.IsPastEnd() || symbol > 285)
+                    return false;
+                if (symbol < 256)
+                {
+                    out.push_back(static_cast<uint8_t>(symbol));
+                    continue;
+                }
+                if (symbol == 256)
+                    break;
+
+                const uint32_t length = lengthBase[symbol - 257] + reader.Get(lengthExtra[symbol - 257]);
+                const uint32_t distanceSymbol = reader.GetCode(5);
+                if (distanceSymbol >= 30)
+                    return false;
+                const uint32_t distance = distanceBase[distanceSymbol] + reader.Get(distanceExtra[distanceSymbol]);
+                if (distance > out.size())
+                    return false;
+
+                for (uint32_t i = 0; i < length; ++i)
+                {
+                    out.push_back(out[out.size() - distance]);
+                }
+            }
+        }
+        return !reader.IsPastEnd();
+    }
+
+    uint8_t Paeth(int left, int up, int upLeft)
+    {
+        const int estimate = left + up - upLeft;
+        const int distanceLeft = abs(estimate - left);
+        const int distanceUp = abs(estimate - up);
+        const int distanceUpLeft = abs(estimate - upLeft);
+        if (distanceLeft <= distanceUp && distanceLeft <= distanceUpLeft)
+            return static_cast<uint8_t>(left);
+        return static_cast<uint8_t>(distanceUp <= distanceUpLeft ? up : upLeft);
+    }
+
+    // Checks every chunk CRC, the zlib header and Adler-32, then inflates and unfilters the pixels
+    bool DecodePng(const std::vector<uint8_t>& file, uint32_t& width, uint32_t& height, std::vector<uint8_t>& rgba)
+    {
+        static const uint8_t signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        if (file.size() < 8 || memcmp(file.data(), signature, 8) != 0)
+            return false;
+
+        std::vector<uint8_t> compressed;
+        bool hasHeader = false;
+        bool hasEnd = false;
+        size_t position = 8;
+        while (position + 12 <= file.size() && !hasEnd)
+        {
+            const uint32_t size = ReadBigEndian(&file[position]);
+            if (position + 12 + size > file.size())
+                return false;
+
+            const uint8_t* type = &file[position + 4];
+            const uint8_t* data = type + 4;
+            if (Crc32(type, size + 4) != ReadBigEndian(data + size))
+                return false;
+
+            if (memcmp(type, "IHDR", 4) == 0)
+            {
+                static const uint8_t rgba8[5] = { 8, 6, 0, 0, 0 };
+                width = ReadBigEndian(data);
+                height = ReadBigEndian(data + 4);
+                hasHeader = size == 13 && memcmp(data + 8, rgba8, 5) == 0;
+            }
+            else if (memcmp(type, "IDAT", 4) == 0)
+            {
+                compressed.insert(compressed.end(), data, data + size);
+            }
+            else if (memcmp(type, "IEND", 4) == 0)
+            {
+                hasEnd = size == 0;
+            }
+            position += 12 + size;
+        }
+        if (!hasHeader || !hasEnd || position != file.size() || compressed.size() < 6)
+            return false;
+
+        if ((compressed[0] & 0x0F) != 8 || (compressed[0] * 256 + compressed[1]) % 31 != 0 || (compressed[1] & 0x20) != 0)
+            return false;
+
+        std::vector<uint8_t> filtered;
+        if (!InflateFixed(compressed.data() + 2, compressed.size() - 6, filtered))
+            return false;
+
+        const size_t rowSize = size_t(width) * 4;
+        if (filtered.size() != (rowSize + 1) * height)
+            return false;
+
+        uint32_t a = 1;
+        uint32_t b = 0;
+        for (uint8_t value : filtered)
+        {
+            a = (a + value) % 65521;
+            b = (b + a) % 65521;
+        }
+        if (((b << 16) | a) != ReadBigEndian(&compressed[compressed.size() - 4]))
+            return false;
+
+        rgba.assign(rowSize * height, 0);
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            const uint8_t filter = filtered[y * (rowSize + 1)];
+            const uint8_t* source = &filtered[y * (rowSize + 1) + 1];
+            uint8_t* row = &rgba[y * rowSize];
+            const uint8_t* previousRow = y > 0 ? row - rowSize : nullptr;
+
+            for (size_t i = 0; i < rowSize; ++i)
+            {
+                const int left = i >= 4 ? row[i - 4] : 0;
+                const int up = previousRow != nullptr ? previousRow[i] : 0;
+                const int upLeft = previousRow != nullptr && i >= 4 ? previousRow[i - 4] : 0;
+
+                int predicted = 0;
+                switch (filter)
+                {
+                case 0: predicted = 0; break;
+                case 1: predicted = left; break;
+                case 2: predicted = up; break;
+                case 3: predicted = (left + up) / 2; break;
+                case 4: predicted = Paeth(left, up, upLeft); break;
+                default: return false;
+                }
+                row[i] = static_cast<uint8_t>(source[i] + predicted);
+            }
+        }
+        return true;
+    }
+
+    bool RoundTrips(ImageFileFormat fileFormat, const std::vector<uint8_t>& rgba, uint32_t width, uint32_t height)
+    {
+        std::vector<uint8_t> file;
+        ImageEncoder::Encode(fileFormat, rgba.data(), width, height, file);
+
+        uint32_t decodedWidth = 0;
+        uint32_t decodedHeight = 0;
+        std::vector<uint8_t> decoded;
+        const bool valid = fileFormat == kImageFilePng ?
+            DecodePng(file, decodedWidth, decodedHeight, decoded) :
+            DecodeQoi(file, decodedWidth, decodedHeight, decoded);
+
+        return valid && decodedWidth == width && decodedHeight == height && decoded == rgba;
+    }
+}
+
+void TestImageEncoder()
+{
+    // Both encoders give back the exact pixels, also for sizes that end in the middle of a run or a match
+    const uint32_t sizes[][2] = { { 1, 1 }, { 3, 5 }, { 64, 64 }, { 257, 31 }, { 640, 360 } };
+    for (const auto& size : sizes)
+    {
+        const std::vector<uint8_t> rgba = MakeImage(size[0], size[1], size[0] * 31 + size[1]);
+        CHECK(RoundTrips(kImageFileQoi, rgba, size[0], size[1]));
+        CHECK(RoundTrips(kImageFilePng, rgba, size[0], size[1]));
+    }
+
+    // Long runs: a flat image, and one pixel that equals the start value of QOI
+    std::vector<uint8_t> flat(200 * 100 * 4, 0);
+    for (size_t i = 3; i < flat.size(); i += 4)
+    {
+        flat[i] = 255;
+    }
+    CHECK(RoundTrips(kImageFileQoi, flat, 200, 100));
+    CHECK(RoundTrips(kImageFilePng, flat, 200, 100));
+
+    std::vector<uint8_t> file;
+    ImageEncoder::EncodeQoi(flat.data(), 200, 100, file);
+    CHECK(file.size() < 14 + 8 + 200 * 100 / 62 + 2);
+
+    // Raw files carry the header of PixelBuffer::ExportToFile
+    const std::vector<uint8_t> small = MakeImage(5, 3, 7);
+    file.clear();
+    ImageEncoder::EncodeRaw(small.data(), 5, 3, file);
+    CHECK(file.size() == 16 + small.size());
+    CHECK(ReadLittleEndian(&file[0]) == DXGI_FORMAT_R8G8B8A8_UNORM);
+    CHECK(ReadLittleEndian(&file[4]) == 5 && ReadLittleEndian(&file[8]) == 5 && ReadLittleEndian(&file[12]) == 3);
+    CHECK(memcmp(&file[16], small.data(), small.size()) == 0);
+
+    // Encode appends to what is there
+    file.assign(3, 0xAB);
+    ImageEncoder::Encode(kImageFileRaw, small.data(), 5, 3, file);
+    CHECK(file.size() == 3 + 16 + small.size() && file[0] == 0xAB);
+
+    // Conversion of rows with padding, the widths end in the middle of an SSE2 vector
+    const uint32_t width = 13;
+    const uint32_t height = 4;
+    const uint32_t rowPitch = 64;
+    std::vector<uint8_t> source(rowPitch * height);
+    uint64_t random = 5;
+    for (uint8_t& value : source)
+    {
+        value = static_cast<uint8_t>(NextRandom(random));
+    }
+
+    std::vector<uint8_t> converted(width * height * 4);
+    std::vector<uint8_t> expected(width * height * 4);
+    uint32_t numMismatches = 0;
+    const DXGI_FORMAT formats[] = { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, DXGI_FORMAT_B8G8R8A8_UNORM,
+        DXGI_FORMAT_B8G8R8A8_UNORM_SRGB, DXGI_FORMAT_R10G10B10A2_UNORM };
+    for (DXGI_FORMAT format : formats)
+    {
+        CHECK(ImageEncoder::IsFormatSupported(format));
+        CHECK(ImageEncoder::ConvertToRGBA8(source.data(), rowPitch, width, height, format, converted.data()));
+
+        for (uint32_t y = 0; y < height; ++y)
+        {
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint8_t* in = &source[y * rowPitch + x * 4];
+                uint8_t* out = &expected[(y * width + x) * 4];
+                if (format == DXGI_FORMAT_R10G10B10A2_UNORM)
+                {
+                    const uint32_t pixel = ReadLittleEndian(in);
+                    out[0] = static_cast<uint8_t>((pixel & 0x3FF) >> 2);
+                    out[1] = static_cast<uint8_t>(((pixel >> 10) & 0x3FF) >> 2);
+                    out[2] = static_cast<uint8_t>(((pixel >> 20) & 0x3FF) >> 2);
+                    out[3] = static_cast<uint8_t>((pixel >> 30) * 85);
+                }
+                else if (format == DXGI_FORMAT_B8G8R8A8_UNORM || format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB)
+                {
+                    out[0] = in[2]; out[1] = in[1]; out[2] = in[0]; out[3] = in[3];
+                }
+                else
+                {
+                    memcpy(out, in, 4);
+                }
+            }
+        }
+        numMismatches += converted != expected;
+    }
+    CHECK(numMismatches == 0);
+    CHECK(!ImageEncoder::IsFormatSupported(DXGI_FORMAT_UNKNOWN));
+    CHECK(!ImageEncoder::ConvertToRGBA8(source.data(), rowPitch, width, height, DXGI_FORMAT_UNKNOWN, converted.data()));
+}
+
+void BenchmarkImageEncoder()
+{
+    // One 1080p frame per format, converted from BGRA as read back from the swap chain
+    const uint32_t width = 1920;
+    const uint32_t height = 1080;
+    const std::vector<uint8_t> bgra = MakeImage(width, height, 11);
+    std::vector<uint8_t> rgba(bgra.size());
+    std::vector<uint8_t> file;
+    file.reserve(bgra.size() * 2);
+
+    const uint32_t numConversions = 50;
+    double start = Tests::Now();
+    for (uint32_t i = 0; i < numConversions; ++i)
+    {
+        ImageEncoder::ConvertToRGBA8(bgra.data(), width * 4, width, height, DXGI_FORMAT_B8G8R8A8_UNORM, rgba.data());
+    }
+    double seconds = (Tests::Now() - start) / numConversions;
+    printf("    convert BGRA: %.2f ms per frame, %.1f GB/s\n", seconds * 1e3, bgra.size() / seconds / 1e9);
+
+    const ImageFileFormat fileFormats[] = { kImageFileQoi, kImageFilePng, kImageFileRaw };
+    for (ImageFileFormat fileFormat : fileFormats)
+    {
+        const uint32_t numFrames = 5;
+        start = Tests::Now();
+        for (uint32_t i = 0; i < numFrames; ++i)
+        {
+            file.clear();
+            ImageEncoder::Encode(fileFormat, rgba.data(), width, height, file);
+        }
+        seconds = (Tests::Now() - start) / numFrames;
+
+        printf("    %ls: %.1f ms per frame, %.1f frames/s per thread, %.0f%% of the pixel size\n", ImageEncoder::GetExtension(fileFormat),
+            seconds * 1e3, 1.0 / seconds, 100.0 * file.size() / rgba.size());
+    }
+}
@@ -0,0 +1,103 @@
+#include "Tests.h"
+#include "DirectX12/Engine/MemoryStatistics.h"
+
+#include <stdio.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+void TestMemoryStatistics()
+{
+    MemoryStatistics statistics;
+
+    MemoryStatistics::Snapshot snapshot = statistics.GetSnapshot(1);
+    CHECK(snapshot.FrameNumber == 1);
+    CHECK(snapshot.TotalLiveBytes == 0);
+    CHECK(snapshot.TotalPeakBytes == 0);
+
+    statistics.OnAllocate(kMemoryBufferHeaps, 64);
+    statistics.OnAllocate(kMemoryBufferHeaps, 32);
+    statistics.OnFree(kMemoryBufferHeaps, 64);
+    statistics.OnAllocate(kMemoryUploadRing, 16);
+
+    snapshot = statistics.GetSnapshot(2);
+    const MemoryStatistics::CategorySnapshot& heaps = snapshot.Categories[kMemoryBufferHeaps];
+    CHECK(heaps.LiveBytes == 32);
+    CHECK(heaps.PeakBytes == 96);
+    CHECK(heaps.LiveObjects == 1);
+    CHECK(heaps.PeakObjects == 2);
+    CHECK(heaps.TotalAllocations == 2);
+    CHECK(snapshot.Categories[kMemoryUploadRing].LiveBytes == 16);
+    CHECK(snapshot.Categories[kMemoryReadbackRing].TotalAllocations == 0);
+
+    // The totals are the sums over the categories
+    CHECK(snapshot.TotalLiveBytes == 48);
+    CHECK(snapshot.TotalPeakBytes == 112);
+
+    const std::string json = snapshot.ToJson();
+    CHECK(json.find("{\"frame\":2,\"liveBytes\":48,\"peakBytes\":112,") == 0);
+    CHECK(json.find("\"BufferHeaps\":{\"liveBytes\":32,\"peakBytes\":96,\"liveObjects\":1,\"peakObjects\":2,\"totalAllocations\":2}") != std::string::npos);
+    CHECK(json.compare(json.size() - 2, 2, "}}") == 0);
+
+    // Threads reporting concurrently lose no update
+    const uint32_t numThreads = 4;
+    const uint32_t numIterations = 100000;
+    MemoryStatistics shared;
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < numThreads; ++i)
+    {
+        threads.emplace_back([&shared, i]()
+        {
+            const MemoryCategory category = i % 2 == 0 ? kMemoryBufferHeaps : kMemoryUploadRing;
+            for (uint32_t iteration = 0; iteration < numIterations; ++iteration)
+            {
+                shared.OnAllocate(category, 8);
+                shared.OnFree(category, 8);
+            }
+            shared.OnAllocate(category, 8);
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    snapshot = shared.GetSnapshot();
+    CHECK(snapshot.Categories[kMemoryBufferHeaps].LiveObjects == 2);
+    CHECK(snapshot.Categories[kMemoryBufferHeaps].TotalAllocations == 2 * (numIterations + 1));
+    CHECK(snapshot.TotalLiveBytes == numThreads * 8);
+    CHECK(snapshot.Categories[kMemoryUploadRing].PeakBytes <= 2 * 8);
+}
+
+void BenchmarkMemoryStatistics()
+{
+    // Every thread reports to a category of its own, as the allocators do
+    const uint32_t numIterations = 1000000;
+
+    for (uint32_t numThreads : { 1u, 4u })
+    {
+        MemoryStatistics statistics;
+        std::vector<std::thread> threads;
+
+        const double start = Tests::Now();
+        for (uint32_t i = 0; i < numThreads; ++i)
+        {
+            threads.emplace_back([&statistics, i]()
+            {
+                const MemoryCategory category = static_cast<MemoryCategory>(i);
+                for (uint32_t iteration = 0; iteration < numIterations; ++iteration)
+                {
+                    statistics.OnAllocate(category, 65536);
+                    statistics.OnFree(category, 65536);
+                }
+            });
+        }
+        for (std::thread& thread : threads)
+        {
+            thread.join();
+        }
+        const double seconds = Tests::Now() - start;
+
+        printf("    %u threads: %.1f ns per allocate and free\n", numThreads, seconds * 1e9 / (double(numIterations) * numThreads));
+    }
+}
@@ -0,0 +1,103 @@
+#include "Tests.h"
+#include "DirectX12/Engine/PipelineLibraryFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <system_error>
+#include <vector>
+
+namespace
+{
+    std::vector<uint8_t> ReadBytes(const std::filesystem::path& path)
+    {
+        std::ifstream file(path, std::ios::in | std::ios::binary);
+        return std::vector<uint8_t>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    void WriteBytes(const std::filesystem::path& path, const std::vector<uint8_t>& bytes)
+    {
+        std::ofstream file(path, std::ios::out | std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+    }
+}
+
+void TestPipelineLibraryFile()
+{
+    std::error_code error;
+    const std::filesystem::path folder = std::filesystem::temp_directory_path(error) / "Intel630BugTests";
+    std::filesystem::remove_all(folder, error);
+    const std::filesystem::path path = folder / "Pipelines" / "Library.bin";
+
+    PipelineLibraryIdentity identity;
+    identity.VendorId = 0x8086;
+    identity.DeviceId = 0x3E92;
+    identity.DriverVersion = 0x001A00000000157AULL;
+
+    std::vector<uint8_t> blob(10000);
+    for (size_t i = 0; i < blob.size(); ++i)
+    {
+        blob[i] = static_cast<uint8_t>(i * 7 + (i >> 8));
+    }
+
+    std::vector<uint8_t> loaded;
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kMissing);
+
+    // Round trip, the folder is created and no temporary file is left behind
+    CHECK(PipelineLibraryFile::Write(path, identity, blob.data(), blob.size()));
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kLoaded);
+    CHECK(loaded == blob);
+    CHECK(!std::filesystem::exists(std::filesystem::path(path) += ".tmp"));
+
+    // Another driver or adapter invalidates the file, and nothing is handed out
+    PipelineLibraryIdentity newDriver = identity;
+    newDriver.DriverVersion += 1;
+    loaded.clear();
+    CHECK(PipelineLibraryFile::Read(path, newDriver, loaded) == PipelineLibraryFile::kStale);
+    CHECK(loaded.empty());
+    PipelineLibraryIdentity otherAdapter = identity;
+    otherAdapter.DeviceId = 0x9BC5;
+    CHECK(PipelineLibraryFile::Read(path, otherAdapter, loaded) == PipelineLibraryFile::kStale);
+
+    // An older version of the file, the version follows the magic
+    const std::vector<uint8_t> good = ReadBytes(path);
+    std::vector<uint8_t> bytes = good;
+    bytes[4] = static_cast<uint8_t>(PipelineLibraryFile::kVersion - 1);
+    WriteBytes(path, bytes);
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kStale);
+
+    // Truncated, longer, damaged and foreign files
+    bytes = good;
+    bytes.resize(bytes.size() - 1);
+    WriteBytes(path, bytes);
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kCorrupt);
+
+    bytes = good;
+    bytes.push_back(0);
+    WriteBytes(path, bytes);
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kCorrupt);
+
+    bytes = good;
+    bytes[bytes.size() - 100] ^= 0x10;
+    WriteBytes(path, bytes);
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kCorrupt);
+
+    bytes = good;
+    bytes[0] ^= 0xFF;
+    WriteBytes(path, bytes);
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kCorrupt);
+
+    WriteBytes(path, std::vector<uint8_t>(3, 0));
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kCorrupt);
+    CHECK(loaded.empty());
+
+    // Writing replaces a broken file, an empty blob is fine
+    CHECK(PipelineLibraryFile::Write(path, identity, blob.data(), 0));
+    loaded = blob;
+    CHECK(PipelineLibraryFile::Read(path, identity, loaded) == PipelineLibraryFile::kLoaded);
+    CHECK(loaded.empty());
+
+    CHECK(PipelineLibraryFile::Checksum(blob.data(), blob.size()) != PipelineLibraryFile::Checksum(blob.data(), blob.size() - 1));
+
+    std::filesystem::remove_all(folder, error);
+}
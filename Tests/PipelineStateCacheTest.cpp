@@ -0,0 +1,233 @@
+#include "Tests.h"
+#include "DirectX12/Engine/PipelineStateKey.h"
+#include "DirectX12/Engine/ShardedFutureCache.h"
+
+#include <algorithm>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    // Every key has the same hash, only == tells them apart
+    struct CollidingKey
+    {
+        uint32_t id;
+
+        size_t GetHash() const { return 0x5EED; }
+        bool operator==(const CollidingKey& other) const { return id == other.id; }
+    };
+
+    // About the size of a D3D12_GRAPHICS_PIPELINE_STATE_DESC with its input layout
+    struct FakeDesc
+    {
+        uint32_t index;
+        uint32_t state[160];
+    };
+
+    PipelineStateKey MakeKey(const FakeDesc& desc)
+    {
+        PipelineStateKey key(PipelineStateKey::kGraphics);
+        key.Append(&desc, sizeof(desc));
+        return key;
+    }
+
+    // The cache before it was sharded: one mutex around a map keyed by the hash alone, threads
+    // finding a PSO still being compiled yield until it is there
+    class LockedMapCache
+    {
+    public:
+        uint64_t GetOrCreate(const PipelineStateKey& key, const std::function<uint64_t()>& create)
+        {
+            std::atomic<uint64_t>* value = nullptr;
+            bool firstCompile = false;
+            {
+                std::lock_guard<std::mutex> lock(m_Mutex);
+                std::unique_ptr<std::atomic<uint64_t>>& entry = m_Entries[key.GetHash()];
+                if (entry == nullptr)
+                {
+                    entry.reset(new std::atomic<uint64_t>(0));
+                    firstCompile = true;
+                }
+                value = entry.get();
+            }
+
+            if (firstCompile)
+            {
+                value->store(create());
+            }
+
+            while (value->load() == 0)
+            {
+                std::this_thread::yield();
+            }
+            return value->load();
+        }
+
+    private:
+        std::mutex m_Mutex;
+        std::map<size_t, std::unique_ptr<std::atomic<uint64_t>>> m_Entries;
+    };
+}
+
+void TestPipelineStateCache()
+{
+    // Keys are equal with the same description only, short appends are padded to whole words
+    FakeDesc desc = {};
+    desc.index = 1;
+    const PipelineStateKey key = MakeKey(desc);
+    CHECK(MakeKey(desc) == key && MakeKey(desc).GetHash() == key.GetHash());
+
+    desc.state[159] = 1;
+    CHECK(!(MakeKey(desc) == key));
+
+    PipelineStateKey compute(PipelineStateKey::kCompute);
+    compute.Append(&desc, sizeof(desc));
+    CHECK(!(compute == MakeKey(desc)));
+
+    PipelineStateKey threeBytes(PipelineStateKey::kCompute);
+    PipelineStateKey fourBytes(PipelineStateKey::kCompute);
+    threeBytes.Append("abc", 3);
+    fourBytes.Append("abc", 4);
+    CHECK(threeBytes == fourBytes);
+
+    // Keys with the same hash and different contents get entries of their own
+    ShardedFutureCache<CollidingKey, int> colliding;
+    uint32_t numCreated = 0;
+    CHECK(colliding.GetOrCreate({ 1 }, [&]() { ++numCreated; return 10; }) == 10);
+    CHECK(colliding.GetOrCreate({ 2 }, [&]() { ++numCreated; return 20; }) == 20);
+    CHECK(colliding.GetOrCreate({ 1 }, [&]() { ++numCreated; return -1; }) == 10);
+    CHECK(colliding.GetOrCreate({ 2 }, [&]() { ++numCreated; return -1; }) == 20);
+    CHECK(numCreated == 2);
+
+    ShardedFutureCache<CollidingKey, int>::Statistics stats = colliding.GetStatistics();
+    CHECK(stats.NumEntries == 2 && stats.NumCreated == 2 && stats.NumHits == 2 && stats.NumWaits == 0);
+
+    colliding.Clear();
+    CHECK(colliding.GetStatistics().NumEntries == 0);
+    CHECK(colliding.GetOrCreate({ 1 }, [&]() { ++numCreated; return 11; }) == 11);
+
+    // Threads asking for a description being compiled block until it is done and get the same PSO,
+    // it is compiled once
+    ShardedFutureCache<PipelineStateKey, uint64_t> cache;
+    std::atomic<bool> release(false);
+    std::atomic<uint32_t> numCompiled(0);
+    std::vector<uint64_t> results(4, 0);
+
+    std::vector<std::thread> threads;
+    threads.emplace_back([&]()
+    {
+        results[0] = cache.GetOrCreate(key, [&]()
+        {
+            ++numCompiled;
+            while (!release.load())
+            {
+                std::this_thread::yield();
+            }
+            return uint64_t(0xC0FFEE);
+        });
+    });
+    while (cache.GetStatistics().NumCreated == 0)
+    {
+        std::this_thread::yield();
+    }
+    for (size_t thread = 1; thread < results.size(); ++thread)
+    {
+        threads.emplace_back([&, thread]()
+        {
+            results[thread] = cache.GetOrCreate(key, [&]() { ++numCompiled; return uint64_t(1); });
+        });
+    }
+    while (cache.GetStatistics().NumHits < results.size() - 1)
+    {
+        std::this_thread::yield();
+    }
+    release.store(true);
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    CHECK(numCompiled == 1);
+    CHECK(std::count(results.begin(), results.end(), uint64_t(0xC0FFEE)) == 4);
+    CHECK(cache.GetStatistics().NumEntries == 1 && cache.GetStatistics().NumWaits <= 3);
+
+    // Compiled as a job, the description is found while the job is queued
+    JobSystem jobs(1);
+    const PipelineStateKey otherKey = MakeKey(desc);
+    ShardedFutureCache<PipelineStateKey, uint64_t>::ValueFuture future = cache.GetOrCreateAsync(otherKey, []() { return uint64_t(7); }, jobs);
+    ShardedFutureCache<PipelineStateKey, uint64_t>::ValueFuture again = cache.GetOrCreateAsync(otherKey, []() { return uint64_t(8); }, jobs);
+    cache.WaitForJobs(jobs);
+    CHECK(future.get() == 7 && again.get() == 7);
+    CHECK(cache.GetOrCreate(otherKey, []() { return uint64_t(9); }) == 7);
+    CHECK(cache.GetStatistics().NumCreated == 2);
+}
+
+void BenchmarkPipelineStateCache()
+{
+    // Threads finalize the same PSOs in different orders, as when the passes of a frame create
+    // their states at startup.  A compile takes 20 us.
+    const uint32_t numDescs = 512;
+    const double compileSeconds = 20e-6;
+    const uint32_t warmRounds = 20;
+
+    std::vector<PipelineStateKey> keys;
+    for (uint32_t i = 0; i < numDescs; ++i)
+    {
+        FakeDesc desc = {};
+        desc.index = i;
+        desc.state[i % 160] = i;
+        keys.push_back(MakeKey(desc));
+    }
+
+    auto create = [compileSeconds]() { Tests::Spin(compileSeconds); return uint64_t(1); };
+
+    const uint32_t maxThreads = std::min(8u, std::max(1u, std::thread::hardware_concurrency()));
+    for (uint32_t numThreads = 1; numThreads <= maxThreads; numThreads *= 2)
+    {
+        // Cold: every thread finalizes every description once, each is compiled by one of them.
+        // Warm: all hits.
+        double seconds[2][2] = {};
+        for (int sharded = 0; sharded < 2; ++sharded)
+        {
+            ShardedFutureCache<PipelineStateKey, uint64_t> shardedCache;
+            LockedMapCache lockedCache;
+
+            for (int warm = 0; warm < 2; ++warm)
+            {
+                const uint32_t numRounds = warm ? warmRounds : 1;
+                const double start = Tests::Now();
+                std::vector<std::thread> threads;
+                for (uint32_t thread = 0; thread < numThreads; ++thread)
+                {
+                    threads.emplace_back([&, thread]()
+                    {
+                        for (uint32_t round = 0; round < numRounds; ++round)
+                        {
+                            for (uint32_t i = 0; i < numDescs; ++i)
+                            {
+                                const PipelineStateKey& key = keys[(i + thread * numDescs / numThreads) % numDescs];
+                                if (sharded)
+                                    shardedCache.GetOrCreate(key, create);
+                                else
+                                    lockedCache.GetOrCreate(key, create);
+                            }
+                        }
+                    });
+                }
+                for (std::thread& thread : threads)
+                {
+                    thread.join();
+                }
+                seconds[sharded][warm] = (Tests::Now() - start) / (double(numRounds) * numDescs * numThreads);
+            }
+        }
+
+        printf("    %u threads: cold %.2f us per Finalize locked, %.2f us sharded; warm %.0f ns locked, %.0f ns sharded\n",
+            numThreads, seconds[0][0] * 1e6, seconds[1][0] * 1e6, seconds[0][1] * 1e9, seconds[1][1] * 1e9);
+    }
+}
@@ -0,0 +1,174 @@
+#include "Tests.h"
+#include "DirectX12/Engine/ResourceStateTracker.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    // The values of D3D12_RESOURCE_STATES, the tracker only sees numbers
+    const uint32_t kPresent = 0x0;
+    const uint32_t kRenderTarget = 0x4;
+    const uint32_t kUnorderedAccess = 0x8;
+    const uint32_t kNonPixelShaderResource = 0x40;
+    const uint32_t kPixelShaderResource = 0x80;
+    const uint32_t kIndirectArgument = 0x200;
+    const uint32_t kCopyDest = 0x400;
+    const uint32_t kCopySource = 0x800;
+
+    const uint32_t kReadOnlyStates = kNonPixelShaderResource | kPixelShaderResource | kIndirectArgument | kCopySource;
+
+    typedef ResourceStateTracker::Barrier Barrier;
+
+    std::vector<Barrier> GetBarriers(const ResourceStateTracker& tracker, uint32_t boundary)
+    {
+        uint32_t numBarriers = 0;
+        const Barrier* barriers = tracker.GetBarriers(boundary, numBarriers);
+        return std::vector<Barrier>(barriers, barriers + numBarriers);
+    }
+
+    bool IsBarrier(const Barrier& barrier, uint32_t resource, uint32_t before, uint32_t after, ResourceStateTracker::BarrierType type)
+    {
+        return barrier.Resource == resource && barrier.StateBefore == before && barrier.StateAfter == after && barrier.Type == type;
+    }
+}
+
+void TestResourceStateTracker()
+{
+    ResourceStateTracker tracker(kReadOnlyStates);
+
+    // The back buffer goes to render target and back to present at the end of the frame
+    const uint32_t backBuffer = tracker.AddResource(kPresent, kPresent);
+    tracker.AddPass(0);
+    tracker.Use(backBuffer, kRenderTarget);
+    tracker.Plan(0);
+
+    std::vector<Barrier> barriers = GetBarriers(tracker, 0);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], backBuffer, kPresent, kRenderTarget, ResourceStateTracker::kFull));
+    barriers = GetBarriers(tracker, 1);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], backBuffer, kRenderTarget, kPresent, ResourceStateTracker::kFull));
+    CHECK(tracker.GetFinalState(backBuffer) == kPresent);
+
+    // A resource idle for a pass gets a split barrier, unless the halves land in different command lists.
+    // Before its first use a resource is idle from the start of the frame.
+    tracker.Reset();
+    const uint32_t split = tracker.AddResource(kCopyDest);
+    const uint32_t notSplit = tracker.AddResource(kCopyDest);
+    tracker.AddPass(0);
+    tracker.Use(split, kUnorderedAccess);
+    tracker.AddPass(0);
+    tracker.AddPass(0);
+    tracker.Use(split, kNonPixelShaderResource);
+    tracker.Use(notSplit, kUnorderedAccess);
+    tracker.AddPass(1);
+    tracker.Use(notSplit, kPixelShaderResource);
+    tracker.Plan(1);
+
+    CHECK(tracker.GetNumPasses() == 4);
+    barriers = GetBarriers(tracker, 0);
+    CHECK(barriers.size() == 2);
+    CHECK(IsBarrier(barriers[0], split, kCopyDest, kUnorderedAccess, ResourceStateTracker::kFull));
+    CHECK(IsBarrier(barriers[1], notSplit, kCopyDest, kUnorderedAccess, ResourceStateTracker::kBeginOnly));
+    barriers = GetBarriers(tracker, 1);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], split, kUnorderedAccess, kNonPixelShaderResource, ResourceStateTracker::kBeginOnly));
+    barriers = GetBarriers(tracker, 2);
+    CHECK(barriers.size() == 2);
+    CHECK(IsBarrier(barriers[0], split, kUnorderedAccess, kNonPixelShaderResource, ResourceStateTracker::kEndOnly));
+    CHECK(IsBarrier(barriers[1], notSplit, kCopyDest, kUnorderedAccess, ResourceStateTracker::kEndOnly));
+    barriers = GetBarriers(tracker, 3);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], notSplit, kUnorderedAccess, kPixelShaderResource, ResourceStateTracker::kFull));
+    CHECK(GetBarriers(tracker, 4).empty());
+
+    // Without a final state the resource stays in the state of its last use
+    CHECK(tracker.GetFinalState(split) == kNonPixelShaderResource);
+    CHECK(tracker.GetFinalState(notSplit) == kPixelShaderResource);
+
+    // Consecutive reads share one combined state, a later read it covers needs no barrier
+    tracker.Reset();
+    const uint32_t tiles = tracker.AddResource(kCopyDest, ResourceStateTracker::kKeepState);
+    tracker.AddPass(0);
+    tracker.Use(tiles, kNonPixelShaderResource);
+    tracker.AddPass(0);
+    tracker.Use(tiles, kIndirectArgument);
+    tracker.AddPass(0);
+    tracker.Use(tiles, kNonPixelShaderResource);
+    tracker.AddPass(0);
+    tracker.Use(tiles, kUnorderedAccess);
+    tracker.Use(tiles, kUnorderedAccess);
+    tracker.Plan(0);
+
+    const uint32_t combined = kNonPixelShaderResource | kIndirectArgument;
+    barriers = GetBarriers(tracker, 0);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], tiles, kCopyDest, combined, ResourceStateTracker::kFull));
+    CHECK(GetBarriers(tracker, 1).empty());
+    CHECK(GetBarriers(tracker, 2).empty());
+    barriers = GetBarriers(tracker, 3);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], tiles, combined, kUnorderedAccess, ResourceStateTracker::kFull));
+    CHECK(GetBarriers(tracker, 4).empty());
+
+    // A resource already in the right state, and one that is never used, need nothing
+    tracker.Reset();
+    const uint32_t ready = tracker.AddResource(kRenderTarget, kRenderTarget);
+    const uint32_t unused = tracker.AddResource(kCopySource);
+    tracker.AddPass(0);
+    tracker.Use(ready, kRenderTarget);
+    tracker.Plan(0);
+    CHECK(GetBarriers(tracker, 0).empty());
+    CHECK(GetBarriers(tracker, 1).empty());
+    CHECK(tracker.GetFinalState(unused) == kCopySource);
+
+    // A final state after an idle stretch is split up to the end of the frame
+    tracker.Reset();
+    const uint32_t target = tracker.AddResource(kPresent, kPresent);
+    tracker.AddPass(0);
+    tracker.Use(target, kRenderTarget);
+    tracker.AddPass(0);
+    tracker.Plan(0);
+    barriers = GetBarriers(tracker, 1);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], target, kRenderTarget, kPresent, ResourceStateTracker::kBeginOnly));
+    barriers = GetBarriers(tracker, 2);
+    CHECK(barriers.size() == 1 && IsBarrier(barriers[0], target, kRenderTarget, kPresent, ResourceStateTracker::kEndOnly));
+}
+
+void BenchmarkResourceStateTracker()
+{
+    // A large frame: 64 passes in 8 command lists, 256 resources with 4 uses each
+    const uint32_t numPasses = 64;
+    const uint32_t numResources = 256;
+    const uint32_t numFrames = 1000;
+    const uint32_t states[] = { kRenderTarget, kUnorderedAccess, kNonPixelShaderResource, kPixelShaderResource, kCopySource };
+
+    ResourceStateTracker tracker(kReadOnlyStates);
+    uint32_t numBarriers = 0;
+
+    const double start = Tests::Now();
+    for (uint32_t frame = 0; frame < numFrames; ++frame)
+    {
+        tracker.Reset();
+        for (uint32_t resource = 0; resource < numResources; ++resource)
+        {
+            tracker.AddResource(kCopyDest, resource % 4 == 0 ? kPresent : ResourceStateTracker::kKeepState);
+        }
+        for (uint32_t pass = 0; pass < numPasses; ++pass)
+        {
+            tracker.AddPass(pass / 8);
+            for (uint32_t use = 0; use < numResources * 4 / numPasses; ++use)
+            {
+                const uint32_t resource = (pass * 37 + use * 11) % numResources;
+                tracker.Use(resource, states[(resource + pass / 4) % 5]);
+            }
+        }
+        tracker.Plan(numPasses / 8);
+
+        for (uint32_t boundary = 0; boundary <= numPasses; ++boundary)
+        {
+            uint32_t count = 0;
+            tracker.GetBarriers(boundary, count);
+            numBarriers += count;
+        }
+    }
+    const double seconds = Tests::Now() - start;
+
+    printf("    %u passes, %u resources: %.1f us per frame, %u barriers\n", numPasses, numResources,
+        seconds * 1e6 / numFrames, numBarriers / numFrames);
+}
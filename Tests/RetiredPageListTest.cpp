@@ -0,0 +1,274 @@
+#include "Tests.h"
+#include "DirectX12/Engine/RetiredPageList.h"
+#include "DirectX12/Engine/TimelineFence.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <stdio.h>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    struct Page
+    {
+        Page* m_NextRetired = nullptr;
+        uint64_t m_RetiredFence = 0;
+        std::atomic<uint32_t> numCollected{ 0 };
+    };
+
+    // Stands in for the timeline of a queue, the collecting thread moves it on
+    class MockFence : public TimelineFence
+    {
+    public:
+        std::atomic<uint64_t> completedValue{ 0 };
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            return completedValue.load(std::memory_order_acquire);
+        }
+
+        void WaitForValue(uint64_t value, uint32_t) override
+        {
+            completedValue.store(value, std::memory_order_release);
+        }
+    };
+
+    // The page manager of the linear allocator: available pages under a mutex, retired pages
+    // with their fence either on a RetiredPageList or, as before it, on a vector under the mutex
+    class PageManager
+    {
+    public:
+        PageManager(TimelineFence& fence, bool lockFree) : m_Fence(fence), m_LockFree(lockFree) {}
+
+        Page* RequestPage()
+        {
+            std::lock_guard<std::mutex> lock(m_Mutex);
+
+            if (m_LockFree)
+            {
+                m_Retired.Collect([this](uint64_t value) { return m_Fence.IsComplete(value); }, m_Available);
+            }
+            else
+            {
+                size_t numPending = 0;
+                for (Page* page : m_LockedRetired)
+                {
+                    if (m_Fence.IsComplete(page->m_RetiredFence))
+                        m_Available.push_back(page);
+                    else
+                        m_LockedRetired[numPending++] = page;
+                }
+                m_LockedRetired.resize(numPending);
+            }
+
+            if (m_Available.empty())
+            {
+                m_Pages.emplace_back(new Page());
+                return m_Pages.back().get();
+            }
+
+            Page* page = m_Available.back();
+            m_Available.pop_back();
+            return page;
+        }
+
+        void DiscardPages(uint64_t fenceValue, Page* const* pages, size_t numPages)
+        {
+            if (m_LockFree)
+            {
+                m_Retired.Push(fenceValue, pages, numPages);
+                return;
+            }
+
+            std::lock_guard<std::mutex> lock(m_Mutex);
+            for (size_t i = 0; i < numPages; ++i)
+            {
+                pages[i]->m_RetiredFence = fenceValue;
+                m_LockedRetired.push_back(pages[i]);
+            }
+        }
+
+        size_t GetNumPages() const { return m_Pages.size(); }
+
+    private:
+        TimelineFence& m_Fence;
+        const bool m_LockFree;
+
+        std::mutex m_Mutex;
+        std::vector<std::unique_ptr<Page> > m_Pages;
+        std::vector<Page*> m_Available;
+        std::vector<Page*> m_LockedRetired;
+        RetiredPageList<Page> m_Retired;
+    };
+}
+
+void TestRetiredPageList()
+{
+    MockFence fence;
+    auto isComplete = [&fence](uint64_t value) { return fence.IsComplete(value); };
+
+    Page pages[10];
+    Page* pointers[10];
+    for (int i = 0; i < 10; ++i)
+    {
+        pointers[i] = &pages[i];
+    }
+
+    RetiredPageList<Page> list;
+    std::vector<Page*> completed;
+
+    // Nothing pushed, nothing collected
+    list.Push(1, pointers, 0);
+    list.Collect(isComplete, completed);
+    CHECK(completed.empty() && list.GetNumPending() == 0);
+
+    // Three batches of three fences, only the completed ones come back
+    list.Push(1, pointers, 4);
+    list.Push(2, pointers + 4, 3);
+    list.Push(3, pointers + 7, 3);
+    CHECK(pages[5].m_RetiredFence == 2);
+
+    fence.completedValue = 1;
+    list.Collect(isComplete, completed);
+    std::sort(completed.begin(), completed.end());
+    CHECK(completed.size() == 4 && std::equal(completed.begin(), completed.end(), pointers));
+    CHECK(list.GetNumPending() == 6);
+
+    // Pages kept pending are collected with the pages pushed since
+    completed.clear();
+    list.Push(4, pointers, 4);
+    fence.completedValue = 3;
+    list.Collect(isComplete, completed);
+    CHECK(completed.size() == 6 && list.GetNumPending() == 4);
+
+    completed.clear();
+    list.TakeAll(completed);
+    std::sort(completed.begin(), completed.end());
+    CHECK(completed.size() == 4 && std::equal(completed.begin(), completed.end(), pointers));
+    CHECK(list.GetNumPending() == 0);
+
+    // Threads push while one collects under its lock, as the page manager does: every page
+    // comes back exactly once, and only after its fence
+    const uint32_t numThreads = 4;
+    const uint32_t batchesPerThread = 5000;
+    const uint32_t pagesPerBatch = 2;
+    std::unique_ptr<Page[]> threadPages(new Page[numThreads * batchesPerThread * pagesPerBatch]);
+
+    MockFence sharedFence;
+    RetiredPageList<Page> sharedList;
+    std::atomic<uint32_t> numDone(0);
+    std::atomic<uint32_t> numEarly(0);
+
+    std::vector<std::thread> threads;
+    for (uint32_t thread = 0; thread < numThreads; ++thread)
+    {
+        threads.emplace_back([&, thread]()
+        {
+            Page* first = &threadPages[thread * batchesPerThread * pagesPerBatch];
+            for (uint32_t batch = 0; batch < batchesPerThread; ++batch)
+            {
+                Page* batchPages[pagesPerBatch] = { first + batch * pagesPerBatch, first + batch * pagesPerBatch + 1 };
+                sharedList.Push(batch + 1, batchPages, pagesPerBatch);
+            }
+            numDone.fetch_add(1);
+        });
+    }
+
+    std::vector<Page*> collected;
+    uint64_t completedValue = 0;
+    bool lastRound = false;
+    while (!lastRound)
+    {
+        lastRound = numDone.load() == numThreads;
+        completedValue = lastRound ? batchesPerThread : std::min<uint64_t>(completedValue + 10, batchesPerThread);
+        sharedFence.completedValue = completedValue;
+
+        collected.clear();
+        sharedList.Collect([&sharedFence](uint64_t value) { return sharedFence.IsComplete(value); }, collected);
+        for (Page* page : collected)
+        {
+            page->numCollected.fetch_add(1);
+            numEarly += page->m_RetiredFence > completedValue;
+        }
+    }
+
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    uint32_t numWrong = 0;
+    for (uint32_t i = 0; i < numThreads * batchesPerThread * pagesPerBatch; ++i)
+    {
+        numWrong += threadPages[i].numCollected.load() != 1;
+    }
+    CHECK(numWrong == 0);
+    CHECK(numEarly == 0);
+    CHECK(sharedList.GetNumPending() == 0);
+}
+
+void BenchmarkRetiredPageList()
+{
+    // Every thread records contexts of two pages and retires them with the fence of its submission.
+    // The fence completes a few submissions behind, like a GPU with frames in flight.
+    const uint32_t contextsPerThread = 100000;
+    const uint32_t pagesPerContext = 2;
+    const uint64_t submissionsInFlight = 8;
+
+    const uint32_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    for (uint32_t numThreads = 1; numThreads <= std::min(8u, maxThreads); numThreads *= 2)
+    {
+        double seconds[2] = {};
+        size_t numPages[2] = {};
+        for (int lockFree = 0; lockFree < 2; ++lockFree)
+        {
+            class LaggingFence : public MockFence
+            {
+            public:
+                std::atomic<uint64_t> nextValue{ 1 };
+
+            protected:
+                uint64_t QueryCompletedValue() override
+                {
+                    const uint64_t submitted = nextValue.load(std::memory_order_acquire) - 1;
+                    return submitted > submissionsInFlight ? submitted - submissionsInFlight : 0;
+                }
+            };
+
+            LaggingFence fence;
+            PageManager manager(fence, lockFree != 0);
+
+            const double start = Tests::Now();
+            std::vector<std::thread> threads;
+            for (uint32_t thread = 0; thread < numThreads; ++thread)
+            {
+                threads.emplace_back([&]()
+                {
+                    for (uint32_t context = 0; context < contextsPerThread; ++context)
+                    {
+                        Page* pages[pagesPerContext];
+                        for (uint32_t i = 0; i < pagesPerContext; ++i)
+                        {
+                            pages[i] = manager.RequestPage();
+                        }
+                        manager.DiscardPages(fence.nextValue.fetch_add(1), pages, pagesPerContext);
+                    }
+                });
+            }
+            for (std::thread& thread : threads)
+            {
+                thread.join();
+            }
+            seconds[lockFree] = Tests::Now() - start;
+            numPages[lockFree] = manager.GetNumPages();
+        }
+
+        const double numRetired = double(contextsPerThread) * pagesPerContext * numThreads;
+        printf("    %u threads: %.1f ns per page locked, %.1f ns lock-free, %zu / %zu pages created\n", numThreads,
+            seconds[0] * 1e9 / numRetired, seconds[1] * 1e9 / numRetired, numPages[0], numPages[1]);
+    }
+}
@@ -0,0 +1,136 @@
+#include "Tests.h"
+#include "DirectX12/Engine/SizeClassCache.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    struct Page
+    {
+        size_t size;
+    };
+}
+
+void TestSizeClassCache()
+{
+    const size_t kb = 1024;
+
+    CHECK(SizeClassCache<Page>::RoundUpToPowerOfTwo(1) == 1);
+    CHECK(SizeClassCache<Page>::RoundUpToPowerOfTwo(64 * kb) == 64 * kb);
+    CHECK(SizeClassCache<Page>::RoundUpToPowerOfTwo(64 * kb + 1) == 128 * kb);
+
+    // Requests below the smallest class get the smallest class
+    SizeClassCache<Page> cache(64 * kb, 1024 * kb);
+    CHECK(cache.GetClassSize(1) == 64 * kb);
+    CHECK(cache.GetClassSize(100 * kb) == 128 * kb);
+    CHECK(cache.GetClassSize(128 * kb) == 128 * kb);
+
+    // A miss, then the released object serves the next request of its class only
+    std::vector<Page*> evicted;
+    Page a = { 128 * kb };
+    CHECK(cache.Acquire(128 * kb) == nullptr);
+    cache.Release(&a, 128 * kb, evicted);
+    CHECK(evicted.empty());
+    CHECK(cache.Acquire(256 * kb) == nullptr);
+    CHECK(cache.Acquire(cache.GetClassSize(100 * kb)) == &a);
+    CHECK(cache.GetStatistics().Hits == 1);
+    CHECK(cache.GetStatistics().Misses == 2);
+    CHECK(cache.GetStatistics().CachedBytes == 0);
+
+    // Filling the cache evicts the largest classes first
+    Page b = { 512 * kb };
+    Page c = { 256 * kb };
+    Page d = { 128 * kb };
+    Page e = { 256 * kb };
+    cache.Release(&b, 512 * kb, evicted);
+    cache.Release(&c, 256 * kb, evicted);
+    cache.Release(&d, 128 * kb, evicted);
+    CHECK(evicted.empty());
+    CHECK(cache.GetStatistics().CachedBytes == 896 * kb);
+    cache.Release(&e, 256 * kb, evicted);
+    CHECK(evicted.size() == 1 && evicted[0] == &b);
+    CHECK(cache.GetStatistics().CachedBytes == 640 * kb);
+    CHECK(cache.GetStatistics().CachedObjects == 3);
+    CHECK(cache.GetStatistics().Evictions == 1);
+
+    // An object larger than the whole cache is evicted right away
+    Page f = { 2048 * kb };
+    evicted.clear();
+    cache.Release(&f, 2048 * kb, evicted);
+    CHECK(evicted.size() == 1 && evicted[0] == &f);
+    CHECK(cache.GetStatistics().CachedBytes == 640 * kb);
+
+    // Clear hands back everything
+    evicted.clear();
+    cache.Clear(evicted);
+    CHECK(evicted.size() == 3);
+    CHECK(cache.GetStatistics().CachedBytes == 0);
+    CHECK(cache.GetStatistics().CachedObjects == 0);
+    CHECK(cache.Acquire(256 * kb) == nullptr);
+}
+
+void BenchmarkSizeClassCache()
+{
+    // Large pages of a frame are freed two frames later, like the linear allocator does with its fences
+    const size_t kb = 1024;
+    const uint32_t numFrames = 1000;
+    const uint32_t pagesPerFrame = 8;
+    const uint32_t framesInFlight = 2;
+
+    SizeClassCache<Page> cache(64 * kb, 64 * 1024 * kb);
+    std::vector<std::vector<Page*> > inFlight(framesInFlight + 1);
+    std::vector<Page*> evicted;
+    uint32_t numCreated = 0;
+    uint32_t random = 1;
+
+    for (uint32_t frame = 0; frame < numFrames; ++frame)
+    {
+        std::vector<Page*>& released = inFlight[(frame + 1) % inFlight.size()];
+        for (Page* page : released)
+        {
+            cache.Release(page, page->size, evicted);
+        }
+        released.clear();
+
+        for (Page* page : evicted)
+        {
+            delete page;
+        }
+        evicted.clear();
+
+        std::vector<Page*>& pages = inFlight[frame % inFlight.size()];
+        for (uint32_t i = 0; i < pagesPerFrame; ++i)
+        {
+            // Between 64 KB and 2 MB
+            random = random * 1664525u + 1013904223u;
+            const size_t classSize = cache.GetClassSize(64 * kb + (random >> 8) % (2048 * kb - 64 * kb));
+
+            Page* page = cache.Acquire(classSize);
+            if (page == nullptr)
+            {
+                page = new Page{ classSize };
+                ++numCreated;
+            }
+            pages.push_back(page);
+        }
+    }
+
+    for (std::vector<Page*>& pages : inFlight)
+    {
+        for (Page* page : pages)
+        {
+            delete page;
+        }
+    }
+    evicted.clear();
+    cache.Clear(evicted);
+    for (Page* page : evicted)
+    {
+        delete page;
+    }
+
+    const SizeClassCache<Page>::Statistics& stats = cache.GetStatistics();
+    printf("    %u large pages: %u created, hit rate %.1f%%, %llu evictions\n", numFrames * pagesPerFrame, numCreated,
+        100.0 * stats.Hits / (stats.Hits + stats.Misses), (unsigned long long)stats.Evictions);
+}
@@ -0,0 +1,131 @@
+#include "Tests.h"
+
+// The engine gets the D3D12 types from its precompiled header
+#include <d3d12.h>
+#include "DirectX12/Engine/StateFilter.h"
+
+namespace
+{
+    D3D12_VERTEX_BUFFER_VIEW MakeView(uint64_t location, UINT size, UINT stride)
+    {
+        D3D12_VERTEX_BUFFER_VIEW view;
+        view.BufferLocation = location;
+        view.SizeInBytes = size;
+        view.StrideInBytes = stride;
+        return view;
+    }
+
+    D3D12_GPU_DESCRIPTOR_HANDLE MakeHandle(uint64_t ptr)
+    {
+        D3D12_GPU_DESCRIPTOR_HANDLE handle;
+        handle.ptr = ptr;
+        return handle;
+    }
+}
+
+void TestStateFilter()
+{
+    StateFilter filter;
+
+    // The first call of each state is issued, the same state again is filtered
+    CHECK(filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST));
+    CHECK(!filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST));
+    CHECK(filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+
+    D3D12_VIEWPORT viewport = { 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+    CHECK(filter.SetViewport(viewport));
+    CHECK(!filter.SetViewport(viewport));
+    viewport.Height = 1200.0f;
+    CHECK(filter.SetViewport(viewport));
+
+    const D3D12_RECT scissor = { 0, 0, 1920, 1080 };
+    const D3D12_RECT otherScissor = { 0, 0, 1920, 1200 };
+    CHECK(filter.SetScissor(scissor));
+    CHECK(!filter.SetScissor(scissor));
+    CHECK(filter.SetScissor(otherScissor));
+
+    // Vertex buffers: a range is filtered only if every slot in it is bound to the same view
+    const D3D12_VERTEX_BUFFER_VIEW views[2] = { MakeView(0x10000, 4096, 16), MakeView(0x20000, 4096, 32) };
+    CHECK(filter.SetVertexBuffers(0, 1, views));
+    CHECK(!filter.SetVertexBuffers(0, 1, views));
+    CHECK(filter.SetVertexBuffers(0, 2, views));
+    CHECK(!filter.SetVertexBuffers(0, 2, views));
+    CHECK(!filter.SetVertexBuffers(1, 1, &views[1]));
+    const D3D12_VERTEX_BUFFER_VIEW smaller = MakeView(0x20000, 2048, 32);
+    CHECK(filter.SetVertexBuffers(1, 1, &smaller));
+    CHECK(filter.SetVertexBuffers(0, 2, views));
+
+    // A dynamic vertex buffer is bound around the filter, the slot has to be set again
+    filter.OnVertexBufferChanged(1);
+    CHECK(!filter.SetVertexBuffers(0, 1, views));
+    CHECK(filter.SetVertexBuffers(1, 1, &views[1]));
+
+    // Descriptor tables are per root index and are lost with new descriptor heaps or a new root signature
+    CHECK(filter.SetGraphicsDescriptorTable(3, MakeHandle(0x1000)));
+    CHECK(!filter.SetGraphicsDescriptorTable(3, MakeHandle(0x1000)));
+    CHECK(filter.SetGraphicsDescriptorTable(2, MakeHandle(0x1000)));
+    CHECK(filter.SetGraphicsDescriptorTable(3, MakeHandle(0x2000)));
+
+    filter.OnDescriptorHeapsBound();
+    CHECK(filter.SetGraphicsDescriptorTable(3, MakeHandle(0x2000)));
+    CHECK(filter.SetGraphicsDescriptorTable(2, MakeHandle(0x1000)));
+    CHECK(!filter.SetGraphicsDescriptorTable(2, MakeHandle(0x1000)));
+
+    filter.OnGraphicsRootSignatureChanged();
+    CHECK(filter.SetGraphicsDescriptorTable(2, MakeHandle(0x1000)));
+    CHECK(filter.SetGraphicsDescriptorTable(3, MakeHandle(0x2000)));
+
+    filter.OnDescriptorTableChanged(2);
+    CHECK(filter.SetGraphicsDescriptorTable(2, MakeHandle(0x1000)));
+    CHECK(!filter.SetGraphicsDescriptorTable(3, MakeHandle(0x2000)));
+
+    // The highest root index and vertex buffer slot have their own bit
+    const uint32_t lastTable = StateFilter::kMaxDescriptorTables - 1;
+    CHECK(filter.SetGraphicsDescriptorTable(lastTable, MakeHandle(0x3000)));
+    CHECK(!filter.SetGraphicsDescriptorTable(lastTable, MakeHandle(0x3000)));
+    const UINT lastSlot = D3D12_IA_VERTEX_INPUT_RESOURCE_SLOT_COUNT - 1;
+    CHECK(filter.SetVertexBuffers(lastSlot, 1, views));
+    CHECK(!filter.SetVertexBuffers(lastSlot, 1, views));
+    CHECK(!filter.SetVertexBuffers(0, 1, views));
+
+    // A reset command list has nothing bound
+    filter.Invalidate();
+    CHECK(filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_TRIANGLELIST));
+    CHECK(filter.SetViewport(viewport));
+    CHECK(filter.SetScissor(otherScissor));
+    CHECK(filter.SetVertexBuffers(0, 1, views));
+    CHECK(filter.SetGraphicsDescriptorTable(3, MakeHandle(0x2000)));
+
+    // Every call was counted in its category
+    const StateFilterStats& stats = filter.GetStats();
+    CHECK(stats.Issued[StateFilterStats::kPrimitiveTopology] == 3 && stats.Filtered[StateFilterStats::kPrimitiveTopology] == 1);
+    CHECK(stats.Issued[StateFilterStats::kViewport] == 3 && stats.Filtered[StateFilterStats::kViewport] == 1);
+    CHECK(stats.Issued[StateFilterStats::kScissor] == 3 && stats.Filtered[StateFilterStats::kScissor] == 1);
+    CHECK(stats.Issued[StateFilterStats::kVertexBuffers] == 7 && stats.Filtered[StateFilterStats::kVertexBuffers] == 6);
+    CHECK(stats.Issued[StateFilterStats::kDescriptorTable] == 10 && stats.Filtered[StateFilterStats::kDescriptorTable] == 4);
+
+    filter.Count(StateFilterStats::kPipelineState, true);
+    filter.Count(StateFilterStats::kPipelineState, false);
+    CHECK(stats.Issued[StateFilterStats::kPipelineState] == 1 && stats.Filtered[StateFilterStats::kPipelineState] == 1);
+
+    StateFilterStats totals;
+    totals.Accumulate(stats);
+    totals.Accumulate(stats);
+    CHECK(totals.Issued[StateFilterStats::kDescriptorTable] == 20 && totals.Filtered[StateFilterStats::kVertexBuffers] == 12);
+
+    filter.ClearStats();
+    CHECK(filter.GetStats().Issued[StateFilterStats::kDescriptorTable] == 0);
+
+    // The calls of the tiles in one context: only the first tile sets the state
+    filter.Invalidate();
+    for (uint32_t tile = 0; tile < 100; ++tile)
+    {
+        filter.SetGraphicsDescriptorTable(3, MakeHandle(0x1000));
+        filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+        filter.SetVertexBuffers(0, 1, views);
+    }
+    CHECK(filter.GetStats().Issued[StateFilterStats::kDescriptorTable] == 1);
+    CHECK(filter.GetStats().Issued[StateFilterStats::kPrimitiveTopology] == 1);
+    CHECK(filter.GetStats().Issued[StateFilterStats::kVertexBuffers] == 1);
+    CHECK(filter.GetStats().Filtered[StateFilterStats::kVertexBuffers] == 99);
+}
@@ -0,0 +1,188 @@
+#include "Tests.h"
+
+// The engine gets the D3D12 types from its precompiled header
+#include <d3d12.h>
+#include "DirectX12/Engine/AllocatorShards.h"
+#include "DirectX12/Engine/DescriptorFreeList.h"
+#include "DirectX12/Engine/FrameFenceRing.h"
+#include "DirectX12/Engine/FrameSliceRing.h"
+#include "DirectX12/Engine/RetiredPageList.h"
+#include "DirectX12/Engine/StateFilter.h"
+#include "DirectX12/Engine/TimelineFence.h"
+#include "DirectX12/Engine/UploadRing.h"
+
+#include <vector>
+
+namespace
+{
+    // Completes values only when the CPU waits for them
+    class MockFence : public TimelineFence
+    {
+    public:
+        uint64_t completedValue = 0;
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            return completedValue;
+        }
+
+        void WaitForValue(uint64_t value, uint32_t) override
+        {
+            completedValue = value;
+        }
+    };
+
+    struct FakeAllocator
+    {
+        uint32_t index;
+    };
+
+    struct Page
+    {
+        Page* m_NextRetired = nullptr;
+        uint64_t m_RetiredFence = 0;
+    };
+
+    D3D12_GPU_DESCRIPTOR_HANDLE MakeGpuHandle(uint64_t ptr)
+    {
+        D3D12_GPU_DESCRIPTOR_HANDLE handle;
+        handle.ptr = ptr;
+        return handle;
+    }
+}
+
+void TestSteadyStateFrame()
+{
+    // The bookkeeping a frame goes through without a device: waiting for the frame slot, fence
+    // callbacks, command allocators, constants, uploads, descriptors, linear allocator pages and
+    // the state filter of every context.  Once warmed up a frame must not allocate.
+    const uint32_t numContexts = 3;
+    const uint32_t warmUpFrames = 100;
+    const uint32_t numFrames = 1000;
+
+    MockFence graphicsFence;
+    MockFence computeFence;
+    MockFence copyFence;
+    uint64_t nextFenceValue = 1;
+    uint64_t nextCopyFenceValue = 1;
+
+    FrameFenceRing frames(2);
+    FrameSliceRing slices;
+    slices.Reset(64 * 1024, frames.GetNumFramesInFlight(), 256);
+    UploadRing uploads;
+    uploads.Reset(64 * 1024, 16);
+
+    FakeAllocator allocators[16];
+    uint32_t numAllocatorsCreated = 0;
+    AllocatorShards<FakeAllocator> allocatorShards(16);
+
+    DescriptorFreeList descriptors;
+    size_t numDescriptorsCreated = 0;
+
+    Page pages[32];
+    uint32_t numPagesCreated = 0;
+    RetiredPageList<Page> retiredPages;
+    std::vector<Page*> availablePages;
+    availablePages.reserve(32);
+
+    StateFilter filter;
+    const D3D12_VERTEX_BUFFER_VIEW view = { 0x10000, 4096, 16 };
+    const D3D12_VIEWPORT viewport = { 0.0f, 0.0f, 1920.0f, 1080.0f, 0.0f, 1.0f };
+    const D3D12_RECT scissor = { 0, 0, 1920, 1080 };
+
+    uint64_t numCallbacksRun = 0;
+    uint32_t numFailed = 0;
+    uint64_t allocationsAfterWarmUp = 0;
+
+    for (uint32_t frame = 0; frame < warmUpFrames + numFrames; ++frame)
+    {
+        if (frame == warmUpFrames)
+        {
+            allocationsAfterWarmUp = Tests::GetNumAllocations();
+        }
+
+        graphicsFence.Wait(frames.BeginFrame());
+        graphicsFence.RunCompletedCallbacks();
+        slices.BeginFrame(frames.GetFrameIndex());
+
+        const uint64_t completed = graphicsFence.GetCompletedValue();
+        retiredPages.Collect([&graphicsFence](uint64_t value) { return graphicsFence.IsComplete(value); }, availablePages);
+        descriptors.ReleaseCompleted([&graphicsFence](uint64_t value) { return graphicsFence.IsComplete(value); });
+
+        for (uint32_t context = 0; context < numContexts; ++context)
+        {
+            FakeAllocator* allocator = allocatorShards.Request(completed);
+            if (allocator == nullptr && allocatorShards.Reserve() && numAllocatorsCreated < 16)
+            {
+                allocator = &allocators[numAllocatorsCreated];
+                allocator->index = numAllocatorsCreated++;
+            }
+            numFailed += allocator == nullptr;
+
+            Page* page = nullptr;
+            if (!availablePages.empty())
+            {
+                page = availablePages.back();
+                availablePages.pop_back();
+            }
+            else if (numPagesCreated < 32)
+            {
+                page = &pages[numPagesCreated++];
+            }
+            numFailed += page == nullptr;
+
+            D3D12_CPU_DESCRIPTOR_HANDLE descriptor;
+            if (!descriptors.Acquire(2, descriptor))
+            {
+                descriptor.ptr = numDescriptorsCreated * 32;
+                numDescriptorsCreated += 2;
+            }
+
+            filter.Invalidate();
+            filter.SetPrimitiveTopology(D3D_PRIMITIVE_TOPOLOGY_4_CONTROL_POINT_PATCHLIST);
+            filter.SetViewport(viewport);
+            filter.SetScissor(scissor);
+            filter.SetVertexBuffers(0, 1, &view);
+            filter.SetGraphicsDescriptorTable(3, MakeGpuHandle(0x1000 + context));
+
+            size_t offset;
+            numFailed += !slices.Allocate(256, offset);
+            numFailed += !uploads.Allocate(1024, copyFence, offset);
+
+            const uint64_t fenceValue = nextFenceValue++;
+            if (allocator != nullptr)
+            {
+                allocatorShards.Discard(fenceValue, allocator);
+            }
+            if (page != nullptr)
+            {
+                retiredPages.Push(fenceValue, &page, 1);
+            }
+            descriptors.Retire(descriptor, 2, fenceValue);
+        }
+
+        // A resource released this frame, freed once the GPU is done with it
+        uint64_t* counter = &numCallbacksRun;
+        graphicsFence.OnComplete(nextFenceValue - 1, [counter]() { ++*counter; });
+
+        uploads.CloseBatch(nextCopyFenceValue);
+        copyFence.Wait(nextCopyFenceValue++);
+
+        // The frame waits for whichever queue it depends on is done first
+        TimelineFence* const timelines[] = { &graphicsFence, &computeFence, &copyFence };
+        const uint64_t values[] = { nextFenceValue - 1, computeFence.GetLastCompletedValue(), nextCopyFenceValue - 1 };
+        numFailed += TimelineFence::WaitAny(timelines, values, 3) == 0;
+
+        frames.EndFrame(nextFenceValue - 1);
+    }
+
+    CHECK(numFailed == 0);
+    CHECK(Tests::GetNumAllocations() == allocationsAfterWarmUp);
+
+    // The frames in flight hold what they use, nothing grows
+    CHECK(numCallbacksRun >= warmUpFrames + numFrames - frames.GetNumFramesInFlight());
+    CHECK(numAllocatorsCreated <= numContexts * (frames.GetNumFramesInFlight() + 1));
+    CHECK(numPagesCreated <= numContexts * (frames.GetNumFramesInFlight() + 1));
+    CHECK(numDescriptorsCreated <= 2 * numContexts * (frames.GetNumFramesInFlight() + 1));
+}
@@ -0,0 +1,256 @@
+#include "Tests.h"
+#include "DirectX12/Engine/JobSystem.h"
+#include "DirectX12/Engine/TaskScheduler.h"
+
+#include <atomic>
+#include <memory>
+#include <stdio.h>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace
+{
+    template <typename F, typename = void>
+    struct CanSpawn : std::false_type {};
+
+    template <typename F>
+    struct CanSpawn<F, decltype(std::declval<TaskScheduler&>().Spawn(std::declval<F>(), std::declval<TaskCounter&>()))> : std::true_type {};
+
+    struct EmptyTask
+    {
+        void operator()() const {}
+    };
+
+    // Spawn references the callable until the task ran, a temporary would be gone by then
+    static_assert(CanSpawn<const EmptyTask&>::value && CanSpawn<EmptyTask&>::value, "Spawn takes named callables");
+    static_assert(!CanSpawn<EmptyTask>::value, "Spawn must not take a temporary callable");
+
+    // Some work for one element, too small to be worth a job of the JobSystem on its own
+    uint32_t Work(uint32_t index)
+    {
+        uint32_t value = index;
+        for (uint32_t i = 0; i < 64; ++i)
+        {
+            value = value * 1664525u + 1013904223u;
+        }
+        return value;
+    }
+
+    void CheckParallelFor(TaskScheduler& scheduler, uint32_t count, uint32_t grain)
+    {
+        std::unique_ptr<std::atomic<uint32_t>[]> calls(new std::atomic<uint32_t>[count]);
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            calls[i].store(0, std::memory_order_relaxed);
+        }
+
+        std::atomic<uint32_t> tooLarge(0);
+        scheduler.ParallelFor(0, count, grain, [&](uint32_t begin, uint32_t end)
+        {
+            if (end - begin > grain)
+            {
+                tooLarge.fetch_add(1, std::memory_order_relaxed);
+            }
+            for (uint32_t i = begin; i < end; ++i)
+            {
+                calls[i].fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+
+        // Every element exactly once, in ranges of at most the grain size
+        uint32_t numWrong = 0;
+        for (uint32_t i = 0; i < count; ++i)
+        {
+            numWrong += calls[i].load(std::memory_order_relaxed) != 1;
+        }
+        CHECK(numWrong == 0);
+        CHECK(tooLarge.load() == 0);
+    }
+
+    void CheckDependency(TaskScheduler& scheduler)
+    {
+        std::atomic<uint32_t> firstDone(0);
+        std::atomic<uint32_t> startedEarly(0);
+
+        TaskCounter first;
+        TaskCounter second;
+        auto firstTask = [&]()
+        {
+            Tests::Spin(0.001);
+            firstDone.fetch_add(1, std::memory_order_relaxed);
+        };
+        auto secondTask = [&]()
+        {
+            if (firstDone.load(std::memory_order_relaxed) != 8)
+            {
+                startedEarly.fetch_add(1, std::memory_order_relaxed);
+            }
+        };
+
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            scheduler.Spawn(firstTask, first);
+        }
+        for (uint32_t i = 0; i < 8; ++i)
+        {
+            scheduler.Spawn(secondTask, second, &first);
+        }
+        scheduler.Wait(second);
+
+        CHECK(first.IsDone());
+        CHECK(startedEarly.load() == 0);
+    }
+
+    // More parked tasks than the shared ring holds: they go to the overflow list instead of spinning
+    void CheckSharedQueueOverflow()
+    {
+        const uint32_t numPerThread = 3000;
+
+        TaskScheduler scheduler(2);
+        std::atomic<bool> release(false);
+        std::atomic<uint32_t> numRun(0);
+        std::atomic<uint32_t> numEarly(0);
+
+        // Keeps one worker busy until released, everything else depends on it
+        TaskCounter gate;
+        auto gateTask = [&]()
+        {
+            while (!release.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+        };
+        auto dependentTask = [&]()
+        {
+            numEarly.fetch_add(release.load(std::memory_order_acquire) ? 0 : 1, std::memory_order_relaxed);
+            numRun.fetch_add(1, std::memory_order_relaxed);
+        };
+
+        TaskCounter dependents;
+        TaskCounter spawner;
+        auto markerTask = []() {};
+        auto spawnerTask = [&]()
+        {
+            // Runs on a worker, its tasks go to the worker's deque.  The worker pops the newest first,
+            // so waiting for the marker spawned before them parks all of them in the shared queue.
+            TaskCounter marker;
+            scheduler.Spawn(markerTask, marker);
+            for (uint32_t i = 0; i < numPerThread; ++i)
+            {
+                scheduler.Spawn(dependentTask, dependents, &gate);
+            }
+            scheduler.Wait(marker);
+        };
+
+        scheduler.Spawn(gateTask, gate);
+        for (uint32_t i = 0; i < numPerThread; ++i)
+        {
+            scheduler.Spawn(dependentTask, dependents, &gate);
+        }
+        scheduler.Spawn(spawnerTask, spawner);
+
+        // Not Wait: the calling thread must not pick up the gate task it is going to release
+        while (!spawner.IsDone())
+        {
+            std::this_thread::yield();
+        }
+
+        release.store(true, std::memory_order_release);
+        scheduler.Wait(dependents);
+
+        CHECK(numRun.load() == 2 * numPerThread);
+        CHECK(numEarly.load() == 0);
+    }
+}
+
+void TestTaskScheduler()
+{
+    TaskScheduler scheduler(3);
+    CHECK(scheduler.GetNumWorkers() == 3);
+
+    CheckParallelFor(scheduler, 1, 1);
+    CheckParallelFor(scheduler, 1000, 1);
+    CheckParallelFor(scheduler, 100000, 64);
+    CheckParallelFor(scheduler, 100000, 100000);
+
+    // An empty range calls nothing
+    bool called = false;
+    scheduler.ParallelFor(5, 5, 1, [&](uint32_t, uint32_t) { called = true; });
+    CHECK(!called);
+
+    CheckDependency(scheduler);
+
+    // Nested: the tasks of a worker go to its own deque
+    std::atomic<uint32_t> numInner(0);
+    scheduler.ParallelFor(0, 16, 1, [&](uint32_t, uint32_t)
+    {
+        scheduler.ParallelFor(0, 100, 1, [&](uint32_t begin, uint32_t end)
+        {
+            numInner.fetch_add(end - begin, std::memory_order_relaxed);
+        });
+    });
+    CHECK(numInner.load() == 1600);
+
+    // Spawning from the pools does not allocate, neither from outside nor from the workers
+    std::atomic<uint32_t> sum(0);
+    auto body = [&](uint32_t begin, uint32_t end)
+    {
+        for (uint32_t i = begin; i < end; ++i)
+        {
+            sum.fetch_add(Work(i) & 1, std::memory_order_relaxed);
+        }
+    };
+    scheduler.ParallelFor(0, 10000, 16, body);
+    const uint64_t allocationsBefore = Tests::GetNumAllocations();
+    for (uint32_t run = 0; run < 10; ++run)
+    {
+        scheduler.ParallelFor(0, 10000, 16, body);
+    }
+    CHECK(Tests::GetNumAllocations() == allocationsBefore);
+
+    CheckSharedQueueOverflow();
+}
+
+void BenchmarkTaskScheduler()
+{
+    const uint32_t numItems = 16384;
+    const uint32_t numRuns = 20;
+
+    TaskScheduler scheduler;
+    JobSystem jobSystem;
+    std::vector<uint32_t> results(numItems);
+
+    // One task per element, and one per 64 elements
+    for (uint32_t grain : { 1u, 64u })
+    {
+        double start = Tests::Now();
+        for (uint32_t run = 0; run < numRuns; ++run)
+        {
+            scheduler.ParallelFor(0, numItems, grain, [&](uint32_t begin, uint32_t end)
+            {
+                for (uint32_t i = begin; i < end; ++i)
+                {
+                    results[i] = Work(i);
+                }
+            });
+        }
+        const double schedulerSeconds = (Tests::Now() - start) / numRuns;
+
+        start = Tests::Now();
+        for (uint32_t run = 0; run < numRuns; ++run)
+        {
+            jobSystem.Dispatch(numItems / grain, [&](uint32_t job)
+            {
+                for (uint32_t i = job * grain; i < (job + 1) * grain; ++i)
+                {
+                    results[i] = Work(i);
+                }
+            });
+        }
+        const double jobSystemSeconds = (Tests::Now() - start) / numRuns;
+
+        printf("    %u elements per task: TaskScheduler %.3f ms, JobSystem %.3f ms\n", grain, schedulerSeconds * 1000.0, jobSystemSeconds * 1000.0);
+    }
+}
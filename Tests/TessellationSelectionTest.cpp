@@ -0,0 +1,35 @@
+#include "Tests.h"
+#include "Renderer/TessellationSelection.h"
+
+void TestTessellationSelection()
+{
+    // Without a list every adapter keeps the hull shader path
+    CHECK(TessellationSelection::SelectForAdapter(0x8086, 0x3E92, nullptr, 0) == kTessellationHullShader);
+
+    // Listed devices take the compute path, device ID 0 takes every device of the vendor
+    const TessellationAdapter adapters[] = { { 0x8086, 0x3E92 }, { 0x8086, 0x5917 }, { 0x1002, 0 } };
+    CHECK(TessellationSelection::SelectForAdapter(0x8086, 0x3E92, adapters, 3) == kTessellationComputeShader);
+    CHECK(TessellationSelection::SelectForAdapter(0x8086, 0x5917, adapters, 3) == kTessellationComputeShader);
+    CHECK(TessellationSelection::SelectForAdapter(0x8086, 0x9BC5, adapters, 3) == kTessellationHullShader);
+    CHECK(TessellationSelection::SelectForAdapter(0x10DE, 0x3E92, adapters, 3) == kTessellationHullShader);
+    CHECK(TessellationSelection::SelectForAdapter(0x1002, 0x73BF, adapters, 3) == kTessellationComputeShader);
+
+    // The command line overrides the list, the last valid option wins
+    TessellationPath path = kTessellationHullShader;
+    const char* none[] = { "Intel630Bug.exe", "--tessellation", "tessellation=compute" };
+    CHECK(!TessellationSelection::ParseCommandLine(3, none, path));
+    CHECK(!TessellationSelection::ParseCommandLine(0, nullptr, path));
+
+    const char* compute[] = { "Intel630Bug.exe", "--tessellation=compute" };
+    CHECK(TessellationSelection::ParseCommandLine(2, compute, path) && path == kTessellationComputeShader);
+
+    const char* hull[] = { "Intel630Bug.exe", "--tessellation=compute", "--tessellation=hull" };
+    CHECK(TessellationSelection::ParseCommandLine(3, hull, path) && path == kTessellationHullShader);
+
+    // An unknown value is ignored and leaves the path alone
+    path = kTessellationComputeShader;
+    const char* unknown[] = { "Intel630Bug.exe", "--tessellation=geometry" };
+    CHECK(!TessellationSelection::ParseCommandLine(2, unknown, path) && path == kTessellationComputeShader);
+    const char* unknownLast[] = { "Intel630Bug.exe", "--tessellation=hull", "--tessellation=domain" };
+    CHECK(TessellationSelection::ParseCommandLine(3, unknownLast, path) && path == kTessellationHullShader);
+}
@@ -0,0 +1,131 @@
+#include "Tests.h"
+
+#include <atomic>
+#include <chrono>
+#include <new>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int s_NumFailures = 0;
+
+// Counts every heap allocation of the process, so the checks can see what does not allocate
+static std::atomic<uint64_t> s_NumAllocations(0);
+
+void* operator new(size_t size)
+{
+    s_NumAllocations.fetch_add(1, std::memory_order_relaxed);
+    void* memory = malloc(size > 0 ? size : 1);
+    if (memory == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void operator delete(void* memory) noexcept
+{
+    free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+    free(memory);
+}
+
+uint64_t Tests::GetNumAllocations()
+{
+    return s_NumAllocations.load(std::memory_order_relaxed);
+}
+
+void Tests::Fail(const char* file, int line, const char* expression)
+{
+    printf("%s(%d): CHECK(%s) failed\n", file, line, expression);
+    ++s_NumFailures;
+}
+
+double Tests::Now()
+{
+    static const auto start = std::chrono::steady_clock::now();
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+void Tests::Spin(double seconds)
+{
+    const double end = Now() + seconds;
+    while (Now() < end)
+    {
+    }
+}
+
+struct TestEntry
+{
+    const char* name;
+    void (*test)();
+    void (*benchmark)();
+};
+
+static const TestEntry s_Tests[] =
+{
+    { "FrameFenceRing", TestFrameFenceRing, BenchmarkFrameFenceRing },
+    { "TaskScheduler", TestTaskScheduler, BenchmarkTaskScheduler },
+    { "SizeClassCache", TestSizeClassCache, BenchmarkSizeClassCache },
+    { "BuddyAllocator", TestBuddyAllocator, BenchmarkBuddyAllocator },
+    { "MemoryStatistics", TestMemoryStatistics, BenchmarkMemoryStatistics },
+    { "TimelineFence", TestTimelineFence, BenchmarkTimelineFence },
+    { "PipelineLibraryFile", TestPipelineLibraryFile, nullptr },
+    { "Hash", TestHash, BenchmarkHash },
+    { "ResourceStateTracker", TestResourceStateTracker, BenchmarkResourceStateTracker },
+    { "UploadRing", TestUploadRing, nullptr },
+    { "ImageEncoder", TestImageEncoder, BenchmarkImageEncoder },
+    { "TileCulling", TestTileCulling, nullptr },
+    { "BezierTessellation", TestBezierTessellation, nullptr },
+    { "StateFilter", TestStateFilter, nullptr },
+    { "RetiredPageList", TestRetiredPageList, BenchmarkRetiredPageList },
+    { "FrameSliceRing", TestFrameSliceRing, nullptr },
+    { "DescriptorFreeList", TestDescriptorFreeList, nullptr },
+    { "AllocatorShards", TestAllocatorShards, BenchmarkAllocatorShards },
+    { "PipelineStateCache", TestPipelineStateCache, BenchmarkPipelineStateCache },
+    { "SteadyStateFrame", TestSteadyStateFrame, nullptr },
+    { "TessellationSelection", TestTessellationSelection, nullptr },
+};
+
+int main(int argc, char** argv)
+{
+    bool runBenchmarks = false;
+    const char* filter = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (strcmp(argv[i], "--benchmark") == 0)
+        {
+            runBenchmarks = true;
+        }
+        else
+        {
+            filter = argv[i];
+        }
+    }
+
+    for (const TestEntry& entry : s_Tests)
+    {
+        if (filter != nullptr && strcmp(filter, entry.name) != 0)
+        {
+            continue;
+        }
+
+        const int failuresBefore = s_NumFailures;
+        entry.test();
+        printf("%-24s %s\n", entry.name, s_NumFailures == failuresBefore ? "ok" : "FAILED");
+
+        if (runBenchmarks && entry.benchmark != nullptr)
+        {
+            entry.benchmark();
+        }
+    }
+
+    if (s_NumFailures > 0)
+    {
+        printf("%d checks failed\n", s_NumFailures);
+    }
+    return s_NumFailures;
+}
@@ -0,0 +1,84 @@
+//
+// Checks for the parts of the engine that run without a device: allocators,
+// fence bookkeeping, the barrier planner, the encoders and the CPU references
+// of the compute shaders.  Every component has a Test function, some have a
+// Benchmark function as well; TestMain.cpp calls them in order.
+//
+// A failed CHECK is reported and counted, the executable returns the number of
+// failures.  Benchmarks only run with --benchmark and print their numbers.
+//
+
+#pragma once
+
+#include <stdint.h>
+
+namespace Tests
+{
+    void Fail(const char* file, int line, const char* expression);
+
+    // Seconds since the first call
+    double Now();
+
+    // Keeps the thread busy, stands in for CPU or GPU work in the benchmarks
+    void Spin(double seconds);
+
+    // Heap allocations of the process so far, operator new is replaced to count them
+    uint64_t GetNumAllocations();
+}
+
+#define CHECK( isTrue ) \
+    do { if (!(bool)(isTrue)) Tests::Fail(__FILE__, __LINE__, #isTrue); } while (0)
+
+void TestFrameFenceRing();
+void BenchmarkFrameFenceRing();
+
+void TestTaskScheduler();
+void BenchmarkTaskScheduler();
+
+void TestSizeClassCache();
+void BenchmarkSizeClassCache();
+
+void TestBuddyAllocator();
+void BenchmarkBuddyAllocator();
+
+void TestMemoryStatistics();
+void BenchmarkMemoryStatistics();
+
+void TestTimelineFence();
+void BenchmarkTimelineFence();
+
+void TestPipelineLibraryFile();
+
+void TestHash();
+void BenchmarkHash();
+
+void TestResourceStateTracker();
+void BenchmarkResourceStateTracker();
+
+void TestUploadRing();
+
+void TestImageEncoder();
+void BenchmarkImageEncoder();
+
+void TestTileCulling();
+
+void TestBezierTessellation();
+
+void TestStateFilter();
+
+void TestRetiredPageList();
+void BenchmarkRetiredPageList();
+
+void TestFrameSliceRing();
+
+void TestDescriptorFreeList();
+
+void TestAllocatorShards();
+void BenchmarkAllocatorShards();
+
+void TestPipelineStateCache();
+void BenchmarkPipelineStateCache();
+
+void TestSteadyStateFrame();
+
+void TestTessellationSelection();
@@ -0,0 +1,128 @@
+#include "Tests.h"
+
+// The renderer gets UINT from the precompiled header of the app
+#include "pch.h"
+#include "Renderer/TileCulling.h"
+
+#include <vector>
+
+namespace
+{
+    // World x, y in [-10, 10] fills the clip space, one world unit is a tenth of it
+    TileCullConstants MakeConstants(uint32_t numTiles)
+    {
+        TileCullConstants constants = {};
+        constants.clipAxisX[0] = 0.1f;
+        constants.clipAxisY[1] = 0.1f;
+        constants.clipMargin = 0.05f;
+        constants.windowHeightInPixels = 290.0f;
+        constants.minTessellationFactor = 2.0f;
+        constants.maxTessellationFactor = 32.0f;
+        constants.numTiles = numTiles;
+        constants.verticesPerPrimitive = 4;
+        return constants;
+    }
+
+    TileData MakeTile(float minX, float minY, float size, uint32_t firstPrimitive, uint32_t numPrimitives)
+    {
+        TileData tile = {};
+        tile.minX = minX;
+        tile.minY = minY;
+        tile.maxX = minX + size;
+        tile.maxY = minY + size;
+        tile.firstPrimitive = firstPrimitive;
+        tile.numPrimitives = numPrimitives;
+        return tile;
+    }
+
+    bool IsDraw(const TileDrawArguments& draw, const TileData& tile, float tessellationFactor)
+    {
+        return draw.primitiveOffset == tile.firstPrimitive && draw.tessellationFactor == tessellationFactor &&
+            draw.vertexCountPerInstance == tile.numPrimitives * 4 && draw.instanceCount == 1 &&
+            draw.startVertexLocation == tile.firstPrimitive * 4 && draw.startInstanceLocation == 0;
+    }
+}
+
+void TestTileCulling()
+{
+    // A grid of 15 x 10 tiles of 2 units from -15 to 15 and -10 to 10, more tiles than a shader group
+    const uint32_t numColumns = 15;
+    const uint32_t numRows = 10;
+    std::vector<TileData> tiles;
+    uint32_t firstPrimitive = 0;
+    for (uint32_t row = 0; row < numRows; ++row)
+    {
+        for (uint32_t column = 0; column < numColumns; ++column)
+        {
+            const uint32_t numPrimitives = (row * numColumns + column) % 7 == 3 ? 0 : 1 + column % 3;
+            tiles.push_back(MakeTile(-15.0f + 2.0f * column, -10.0f + 2.0f * row, 2.0f, firstPrimitive, numPrimitives));
+            firstPrimitive += numPrimitives;
+        }
+    }
+
+    const TileCullConstants constants = MakeConstants(static_cast<uint32_t>(tiles.size()));
+
+    // Draws beyond the count stay untouched
+    TileDrawArguments unused = {};
+    unused.primitiveOffset = 0xDEADBEEF;
+    std::vector<TileDrawArguments> draws(tiles.size() + 1, unused);
+    const uint32_t numDraws = TileCulling::CullTiles(constants, tiles.data(), draws.data());
+
+    // Columns 2 to 12 reach into x in [-10, 10], the margin of half a world unit does not reach a further column.
+    // Every row is inside.  Empty tiles have nothing to draw.
+    std::vector<uint32_t> expected;
+    for (uint32_t tileIndex = 0; tileIndex < tiles.size(); ++tileIndex)
+    {
+        const uint32_t column = tileIndex % numColumns;
+        if (column >= 2 && column <= 12 && tiles[tileIndex].numPrimitives > 0)
+        {
+            expected.push_back(tileIndex);
+        }
+    }
+
+    // The draws are compacted in tile order.  A tile 2 units high gets 0.1 * 290 / 3 rounded up.
+    CHECK(numDraws == expected.size());
+    uint32_t numWrong = 0;
+    for (uint32_t i = 0; i < numDraws && i < expected.size(); ++i)
+    {
+        numWrong += !IsDraw(draws[i], tiles[expected[i]], 10.0f);
+    }
+    CHECK(numWrong == 0);
+    CHECK(draws[numDraws].primitiveOffset == 0xDEADBEEF);
+
+    // A tile just outside is kept within the margin and culled beyond it, on every side
+    const float justOutside[][2] = { { 10.2f, 0.0f }, { -12.2f, 0.0f }, { 0.0f, 10.2f }, { 0.0f, -12.2f } };
+    const float farOutside[][2] = { { 10.6f, 0.0f }, { -12.6f, 0.0f }, { 0.0f, 10.6f }, { 0.0f, -12.6f } };
+    TileDrawArguments draw;
+    for (uint32_t side = 0; side < 4; ++side)
+    {
+        CHECK(TileCulling::CullTile(constants, MakeTile(justOutside[side][0], justOutside[side][1], 2.0f, 0, 1), draw));
+        CHECK(!TileCulling::CullTile(constants, MakeTile(farOutside[side][0], farOutside[side][1], 2.0f, 0, 1), draw));
+    }
+
+    // A view rotated by 45 degrees culls by the bounds of the rotated corners
+    TileCullConstants rotated = constants;
+    rotated.clipAxisX[0] = 0.1f;
+    rotated.clipAxisX[1] = 0.1f;
+    rotated.clipAxisY[0] = -0.1f;
+    rotated.clipAxisY[1] = 0.1f;
+    CHECK(TileCulling::CullTile(rotated, MakeTile(-1.0f, -1.0f, 2.0f, 0, 1), draw));
+    CHECK(!TileCulling::CullTile(rotated, MakeTile(12.0f, 0.0f, 2.0f, 0, 1), draw));
+    CHECK(TileCulling::CullTile(rotated, MakeTile(9.0f, -1.0f, 2.0f, 0, 1), draw));
+
+    // The tessellation factor follows the projected height and is rounded up, then clamped
+    TileCullConstants zoomed = constants;
+    zoomed.clipAxisX[0] = 0.005f;
+    zoomed.clipAxisY[1] = 0.005f;
+    CHECK(TileCulling::CullTile(zoomed, MakeTile(0.0f, 0.0f, 2.0f, 0, 1), draw) && draw.tessellationFactor == 2.0f);
+    zoomed.clipAxisY[1] = 0.035f;
+    CHECK(TileCulling::CullTile(zoomed, MakeTile(0.0f, 0.0f, 2.0f, 0, 1), draw) && draw.tessellationFactor == 4.0f);
+    zoomed.clipAxisY[1] = 1.0f;
+    CHECK(TileCulling::CullTile(zoomed, MakeTile(0.0f, 0.0f, 0.5f, 0, 1), draw) && draw.tessellationFactor == 32.0f);
+
+    // Nothing visible, and no tiles at all
+    TileCullConstants away = constants;
+    away.clipOrigin[0] = 5.0f;
+    CHECK(TileCulling::CullTiles(away, tiles.data(), draws.data()) == 0);
+    CHECK(TileCulling::CullTiles(MakeConstants(0), tiles.data(), draws.data()) == 0);
+}
@@ -0,0 +1,154 @@
+#include "Tests.h"
+#include "DirectX12/Engine/TimelineFence.h"
+
+#include <stdio.h>
+#include <vector>
+
+namespace
+{
+    // A fence the test completes by hand.  Every wait completes StepPerWait more values, like a GPU making progress.
+    class MockFence : public TimelineFence
+    {
+    public:
+        explicit MockFence(uint64_t stepPerWait = 0) : m_StepPerWait(stepPerWait) {}
+
+        uint64_t completedValue = 0;
+        uint32_t numQueries = 0;
+        uint32_t numWaits = 0;
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            ++numQueries;
+            return completedValue;
+        }
+
+        void WaitForValue(uint64_t, uint32_t) override
+        {
+            ++numWaits;
+            completedValue += m_StepPerWait;
+        }
+
+    private:
+        uint64_t m_StepPerWait;
+    };
+}
+
+void TestTimelineFence()
+{
+    MockFence fence;
+    CHECK(fence.IsComplete(0));
+    CHECK(!fence.IsComplete(1));
+
+    // Values at or below the cached one need no query
+    fence.completedValue = 5;
+    CHECK(fence.IsComplete(3));
+    CHECK(fence.GetLastCompletedValue() == 5);
+    const uint32_t numQueries = fence.numQueries;
+    CHECK(fence.IsComplete(5));
+    CHECK(fence.IsComplete(1));
+    CHECK(fence.numQueries == numQueries);
+    CHECK(!fence.IsComplete(6));
+    CHECK(fence.numQueries == numQueries + 1);
+
+    // The cached value never goes back
+    fence.completedValue = 2;
+    CHECK(fence.GetCompletedValue() == 5);
+
+    // Callbacks run in value order, and in registration order for the same value
+    std::vector<int> order;
+    fence.OnComplete(8, [&order]() { order.push_back(3); });
+    fence.OnComplete(7, [&order]() { order.push_back(1); });
+    fence.OnComplete(7, [&order]() { order.push_back(2); });
+    fence.OnComplete(9, [&order]() { order.push_back(4); });
+    fence.OnComplete(5, [&order]() { order.push_back(0); });
+    CHECK(fence.GetNumPendingCallbacks() == 5);
+
+    fence.completedValue = 5;
+    CHECK(fence.RunCompletedCallbacks() == 1);
+    fence.completedValue = 8;
+    CHECK(fence.RunCompletedCallbacks() == 3);
+    CHECK(order == std::vector<int>({ 0, 1, 2, 3 }));
+    CHECK(fence.GetNumPendingCallbacks() == 1);
+
+    // A callback may register another one, it runs with a later call
+    fence.OnComplete(8, [&fence, &order]()
+    {
+        fence.OnComplete(8, [&order]() { order.push_back(5); });
+    });
+    CHECK(fence.RunCompletedCallbacks() == 1);
+    CHECK(fence.RunCompletedCallbacks() == 1);
+    CHECK(order.back() == 5);
+
+    // Without pending callbacks the fence is not queried
+    fence.completedValue = 8;
+    CHECK(fence.RunAllCallbacks() == 1);
+    CHECK(order.back() == 4);
+    const uint32_t queriesBefore = fence.numQueries;
+    CHECK(fence.RunCompletedCallbacks() == 0);
+    CHECK(fence.numQueries == queriesBefore);
+
+    // Wait keeps waiting until the value completed
+    MockFence progressing(1);
+    progressing.Wait(3);
+    CHECK(progressing.numWaits == 3);
+    CHECK(progressing.IsComplete(3));
+
+    // WaitAll waits for every fence, WaitAny returns the first one done
+    MockFence slow(1);
+    MockFence fast(2);
+    MockFence stuck(0);
+    {
+        TimelineFence* const fences[] = { &slow, &fast };
+        const uint64_t values[] = { 4, 4 };
+        TimelineFence::WaitAll(fences, values, 2);
+        CHECK(slow.IsComplete(4) && fast.IsComplete(4));
+    }
+    {
+        TimelineFence* const fences[] = { &stuck, &fast };
+        const uint64_t values[] = { 1, 10 };
+        CHECK(TimelineFence::WaitAny(fences, values, 2) == 1);
+        CHECK(!stuck.IsComplete(1));
+    }
+    {
+        TimelineFence* const fences[] = { &stuck, &fast };
+        const uint64_t values[] = { 0, 100 };
+        CHECK(TimelineFence::WaitAny(fences, values, 2) == 0);
+    }
+}
+
+void BenchmarkTimelineFence()
+{
+    // A fence query costs about a microsecond on a real device, the cached value makes checks of passed values free
+    class SlowFence : public MockFence
+    {
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            Tests::Spin(0.000001);
+            return MockFence::QueryCompletedValue();
+        }
+    };
+
+    const uint32_t numChecks = 100000;
+    SlowFence fence;
+    fence.completedValue = 1000;
+
+    uint32_t numComplete = 0;
+    double start = Tests::Now();
+    for (uint32_t i = 0; i < numChecks; ++i)
+    {
+        numComplete += fence.IsComplete(i % 1000);
+    }
+    const double cachedSeconds = Tests::Now() - start;
+
+    start = Tests::Now();
+    for (uint32_t i = 0; i < numChecks; ++i)
+    {
+        numComplete += fence.GetCompletedValue() >= i % 1000;
+    }
+    const double querySeconds = Tests::Now() - start;
+
+    printf("    %u checks of passed values: %.1f ns cached, %.1f ns queried\n", numComplete / 2,
+        cachedSeconds * 1e9 / numChecks, querySeconds * 1e9 / numChecks);
+}
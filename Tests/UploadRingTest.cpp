@@ -0,0 +1,153 @@
+#include "Tests.h"
+#include "DirectX12/Engine/UploadRing.h"
+#include "DirectX12/Engine/TimelineFence.h"
+
+#include <vector>
+
+namespace
+{
+    // A copy queue the test completes by hand, a wait completes the value waited for
+    class MockFence : public TimelineFence
+    {
+    public:
+        uint64_t completedValue = 0;
+        uint32_t numWaits = 0;
+
+    protected:
+        uint64_t QueryCompletedValue() override
+        {
+            return completedValue;
+        }
+
+        void WaitForValue(uint64_t value, uint32_t) override
+        {
+            ++numWaits;
+            completedValue = value;
+        }
+    };
+
+    struct Allocation
+    {
+        size_t offset;
+        size_t size;
+        uint64_t fenceValue;
+    };
+
+    uint64_t NextRandom(uint64_t& state)
+    {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return state >> 33;
+    }
+}
+
+void TestUploadRing()
+{
+    const size_t ringSize = 256;
+    const size_t alignment = 16;
+
+    MockFence fence;
+    UploadRing ring;
+    ring.Reset(ringSize, alignment);
+
+    // Allocations are aligned, one that does not fit into the rest of the lap starts the next one
+    size_t offset = 1;
+    CHECK(ring.Allocate(100, fence, offset) && offset == 0);
+    CHECK(ring.Allocate(100, fence, offset) && offset == 112);
+    CHECK(ring.HasOpenAllocations());
+
+    // The space is held by allocations not submitted, the caller has to close the batch first
+    CHECK(!ring.Allocate(100, fence, offset));
+    ring.CloseBatch(1);
+    CHECK(!ring.HasOpenAllocations());
+
+    // Now the ring waits for the batch and wraps around
+    CHECK(ring.Allocate(100, fence, offset) && offset == 0);
+    CHECK(fence.numWaits == 1 && fence.completedValue == 1);
+    CHECK(ring.GetNumStalls() == 1);
+    CHECK(ring.GetNumBatchesInFlight() == 0);
+    ring.CloseBatch(2);
+
+    // A completed batch gives its space back without a wait
+    fence.completedValue = 2;
+    CHECK(ring.Allocate(140, fence, offset) && offset == 112);
+    CHECK(fence.numWaits == 1);
+    ring.CloseBatch(3);
+
+    // With nothing in flight the whole ring is free, even from the middle of a lap
+    fence.completedValue = 3;
+    CHECK(ring.Allocate(ringSize, fence, offset) && offset == 0);
+    CHECK(fence.numWaits == 1);
+    ring.CloseBatch(4);
+    CHECK(ring.Allocate(ringSize, fence, offset) && offset == 0);
+    CHECK(fence.numWaits == 2 && fence.completedValue == 4);
+    ring.CloseBatch(5);
+
+    // Random sizes and submissions over many laps, the GPU falls behind at random.  No allocation may
+    // cross the end of the ring or overlap space of a batch that did not complete.
+    MockFence randomFence;
+    ring.Reset(ringSize, alignment);
+    std::vector<Allocation> live;
+    uint64_t random = 1;
+    uint64_t nextFenceValue = 1;
+    uint32_t numOverlaps = 0;
+    uint32_t numOutside = 0;
+    uint32_t numWraps = 0;
+    size_t lastOffset = 0;
+
+    auto closeBatch = [&]()
+    {
+        for (Allocation& allocation : live)
+        {
+            if (allocation.fenceValue == 0)
+            {
+                allocation.fenceValue = nextFenceValue;
+            }
+        }
+        ring.CloseBatch(nextFenceValue++);
+    };
+
+    for (uint32_t i = 0; i < 100000; ++i)
+    {
+        const size_t size = 1 + NextRandom(random) % (ringSize / 2);
+        while (!ring.Allocate(size, randomFence, offset))
+        {
+            closeBatch();
+        }
+
+        numOutside += offset + size > ringSize || offset % alignment != 0;
+        numWraps += offset < lastOffset;
+        lastOffset = offset;
+
+        for (const Allocation& allocation : live)
+        {
+            const bool done = allocation.fenceValue != 0 && allocation.fenceValue <= randomFence.completedValue;
+            numOverlaps += !done && offset < allocation.offset + allocation.size && allocation.offset < offset + size;
+        }
+        live.push_back({ offset, size, 0 });
+
+        if (NextRandom(random) % 3 == 0)
+        {
+            closeBatch();
+        }
+        if (NextRandom(random) % 4 == 0 && randomFence.completedValue + 1 < nextFenceValue)
+        {
+            randomFence.completedValue += 1 + NextRandom(random) % (nextFenceValue - randomFence.completedValue - 1);
+        }
+
+        // Forget what completed, the list stays short
+        size_t numLive = 0;
+        for (const Allocation& allocation : live)
+        {
+            if (allocation.fenceValue == 0 || allocation.fenceValue > randomFence.completedValue)
+            {
+                live[numLive++] = allocation;
+            }
+        }
+        live.resize(numLive);
+    }
+
+    CHECK(numOutside == 0);
+    CHECK(numOverlaps == 0);
+    CHECK(numWraps > 1000);
+    CHECK(ring.GetNumStalls() > 0);
+}